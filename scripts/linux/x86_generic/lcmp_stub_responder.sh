@@ -0,0 +1,132 @@
+# Broadband Forum IEEE 1905.1/1a stack
+# 
+# Copyright (c) 2017, Broadband Forum
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+# 
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+# 
+# Subject to the terms and conditions of this license, each copyright
+# holder and contributor hereby grants to those receiving rights under
+# this license a perpetual, worldwide, non-exclusive, no-charge,
+# royalty-free, irrevocable (except for failure to satisfy the
+# conditions of this license) patent license to make, have made, use,
+# offer to sell, sell, import, and otherwise transfer this software,
+# where such license applies only to those patent claims, already
+# acquired or hereafter acquired, licensable by such copyright holder or
+# contributor that are necessarily infringed by:
+# 
+# (a) their Contribution(s) (the licensed copyrights of copyright holders
+#     and non-copyrightable additions of contributors, in source or binary
+#     form) alone; or
+# 
+# (b) combination of their Contribution(s) with the work of authorship to
+#     which such Contribution(s) was added by such copyright holder or
+#     contributor, if, at the time the Contribution is added, such addition
+#     causes such combination to be necessarily infringed. The patent
+#     license shall not apply to any other combinations which include the
+#     Contribution.
+# 
+# Except as expressly stated above, no rights or licenses from any
+# copyright holder or contributor is granted under this license, whether
+# expressly, by implication, estoppel or otherwise.
+# 
+# DISCLAIMER
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+# IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+# TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+# TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+# USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+# DAMAGE.
+
+
+##############################################################################
+#
+# Description: This script is a stand-in for the "configlayer" LCMP tool used
+#              to query G.hn/Spirit devices (interfaces of type "ghnspirit").
+#              It lets you test the AL without real G.hn modems.
+#
+#              Install it in the PATH with the name of the real tool:
+#
+#                $ ln -s $PWD/lcmp_stub_responder.sh /tmp/bin/configlayer
+#                $ PATH=/tmp/bin:$PATH al_entity -i eth1:ghnspirit:00139D00111F:bluemoon ...
+#
+#              The parameters of device <MAC> are read from (and, for "SET"
+#              requests, written to) file "$LCMP_STUB_DIR/<MAC>.lcmp" (by
+#              default, "/tmp/<MAC>.lcmp"), one "<PARAM_NAME>=<PARAM_VALUE>"
+#              per line.
+#
+#              Just like the real tool, it answers one request when run with
+#              "-o" and "-p" arguments. When run without them, it behaves as a
+#              persistent LCMP session (see "GHNSPIRIT_LCMP_SESSION" in the
+#              README file): it reads one request per line from its standard
+#              input and answers each of them followed by an empty line.
+#
+###############################################################################
+
+MAC=""
+REQUEST=""
+
+while [ $# -gt 0 ];
+do
+  case "$1" in
+    -i) shift ;;
+    -w) shift ;;
+    -m) shift; MAC=$1 ;;
+    *)  REQUEST="$REQUEST $1" ;;
+  esac
+  shift
+done
+
+PARAMETERS_FILE=${LCMP_STUB_DIR:-/tmp}/$MAC.lcmp
+touch $PARAMETERS_FILE
+
+answer()
+{
+  OPERATION=""
+
+  while [ $# -gt 0 ];
+  do
+    case "$1" in
+      -o) shift; OPERATION=$1 ;;
+      -p) shift
+          if [ "$OPERATION" = "GET" ];
+          then
+            grep -m 1 "^$1=" $PARAMETERS_FILE
+          elif [ "$OPERATION" = "SET" ];
+          then
+            NAME=${1%%=*}
+            grep -v "^$NAME=" $PARAMETERS_FILE > $PARAMETERS_FILE.tmp
+            echo "$1" >> $PARAMETERS_FILE.tmp
+            mv $PARAMETERS_FILE.tmp $PARAMETERS_FILE
+          fi ;;
+    esac
+    shift
+  done
+}
+
+if [ -n "$REQUEST" ];
+then
+  answer $REQUEST
+  exit 0
+fi
+
+while read -r LINE;
+do
+  answer $LINE
+  echo ""
+done
@@ -0,0 +1,196 @@
+# Broadband Forum IEEE 1905.1/1a stack
+# 
+# Copyright (c) 2017, Broadband Forum
+# 
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+# 
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+# 
+# Subject to the terms and conditions of this license, each copyright
+# holder and contributor hereby grants to those receiving rights under
+# this license a perpetual, worldwide, non-exclusive, no-charge,
+# royalty-free, irrevocable (except for failure to satisfy the
+# conditions of this license) patent license to make, have made, use,
+# offer to sell, sell, import, and otherwise transfer this software,
+# where such license applies only to those patent claims, already
+# acquired or hereafter acquired, licensable by such copyright holder or
+# contributor that are necessarily infringed by:
+# 
+# (a) their Contribution(s) (the licensed copyrights of copyright holders
+#     and non-copyrightable additions of contributors, in source or binary
+#     form) alone; or
+# 
+# (b) combination of their Contribution(s) with the work of authorship to
+#     which such Contribution(s) was added by such copyright holder or
+#     contributor, if, at the time the Contribution is added, such addition
+#     causes such combination to be necessarily infringed. The patent
+#     license shall not apply to any other combinations which include the
+#     Contribution.
+# 
+# Except as expressly stated above, no rights or licenses from any
+# copyright holder or contributor is granted under this license, whether
+# expressly, by implication, estoppel or otherwise.
+# 
+# DISCLAIMER
+# 
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+# IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+# TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+# PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+# ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+# TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+# USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+# DAMAGE.
+
+
+
+##############################################################################
+#
+# Description: This script starts (or stops) a simulated network of NODES AL
+#              entities (one process each) connected in a tree (each node has
+#              up to FANOUT children) by "vwire" interfaces. No real network
+#              interfaces (nor root privileges) are needed.
+#
+#                $ ./vwire_mesh.sh start 200 4 latency=5 loss=1 bandwidth=100000
+#                $ ./vwire_mesh.sh stop
+#
+#              Everything after FANOUT is appended to every "link" line of
+#              the generated topology file (see "_parseTopologyFile()" in
+#              "src/al/src_linux/platform_interfaces_vwire.c").
+#
+#              Node <k> (starting at "0", the root) uses AL MAC address
+#              "02:1a:<k>:00:00", interface "eth0" to reach its parent and
+#              "eth1", "eth2", ... to reach its children. Its ALME server
+#              listens on TCP port "$VWIRE_BASE_PORT + <k>" (by default,
+#              "8900 + <k>") and its output is saved to "$VWIRE_DIR/n<k>.log"
+#              ($VWIRE_DIR is "/tmp/vwire" by default).
+#
+#              The "al_entity" binary is searched for in the PATH unless
+#              $AL_ENTITY is set.
+#
+#              NOTE: Each AL entity creates a POSIX message queue of about
+#              160 KB ("MQ_BYTES" below). Two limits apply to them:
+#
+#                - The per-user size limit ("ulimit -q", 800 KB by default,
+#                  ie. only 5 AL entities). The script raises it as much as it
+#                  is allowed to, but the hard limit can only be raised by
+#                  root (ex: in "/etc/security/limits.conf").
+#
+#                - The system wide number of queues ("fs.mqueue.queues_max",
+#                  256 by default), which does not apply to root:
+#
+#                    $ sysctl fs.mqueue.queues_max=4096
+#
+#              The script refuses to start more AL entities than these limits
+#              allow (instead of leaving the extra ones failing to start).
+#
+###############################################################################
+
+DIR=${VWIRE_DIR:-/tmp/vwire}
+BASE_PORT=${VWIRE_BASE_PORT:-8900}
+AL=${AL_ENTITY:-al_entity}
+
+# Bytes of the per-user message queues limit used by each AL entity (100
+# messages of "MAX_NETWORK_SEGMENT_SIZE"+3 bytes, plus the kernel bookkeeping)
+#
+MQ_BYTES=160000
+
+mac()
+{
+  printf "%02x:%02x:%02x" $(($1 >> 8)) $(($1 & 255)) $2
+}
+
+case "$1" in
+  start)
+    NODES=${2:-10}
+    FANOUT=${3:-2}
+    shift
+    [ $# -gt 0 ] && shift
+    [ $# -gt 0 ] && shift
+    LINK_PARAMS="$*"
+
+    mkdir -p $DIR
+    TOPOLOGY=$DIR/topology.txt
+
+    # Endpoints first, then links (as required by the topology file format)
+    #
+    echo "# $NODES nodes, fanout $FANOUT" > $TOPOLOGY
+    for K in $(seq 1 $((NODES - 1)));
+    do
+      PARENT=$(((K - 1) / FANOUT))
+      CHILD=$(((K - 1) % FANOUT + 1))
+      echo "endpoint n$K/eth0 02:16:$(mac $K 0):00"           >> $TOPOLOGY
+      echo "endpoint n$PARENT/eth$CHILD 02:16:$(mac $PARENT $CHILD):00" >> $TOPOLOGY
+    done
+    for K in $(seq 1 $((NODES - 1)));
+    do
+      PARENT=$(((K - 1) / FANOUT))
+      CHILD=$(((K - 1) % FANOUT + 1))
+      echo "link n$K/eth0 n$PARENT/eth$CHILD $LINK_PARAMS" >> $TOPOLOGY
+    done
+
+    ulimit -q unlimited 2>/dev/null || ulimit -q $(ulimit -H -q) 2>/dev/null
+
+    MQ_LIMIT=$(ulimit -q)
+    if [ "$MQ_LIMIT" != "unlimited" ] && [ $((NODES * MQ_BYTES)) -gt $MQ_LIMIT ];
+    then
+      echo "The message queues limit ('ulimit -q' = $MQ_LIMIT bytes) only allows $((MQ_LIMIT / MQ_BYTES)) AL entities ($NODES requested)"
+      exit 1
+    fi
+    QUEUES_MAX=$(cat /proc/sys/fs/mqueue/queues_max 2>/dev/null || echo $NODES)
+    if [ $(id -u) -ne 0 ] && [ $NODES -gt $QUEUES_MAX ];
+    then
+      echo "fs.mqueue.queues_max only allows $QUEUES_MAX AL entities ($NODES requested)"
+      exit 1
+    fi
+
+    rm -f $DIR/pids
+    for K in $(seq 0 $((NODES - 1)));
+    do
+      INTERFACES=""
+      if [ $K -gt 0 ];
+      then
+        INTERFACES="eth0:vwire:$TOPOLOGY:n$K"
+      fi
+      for CHILD in $(seq 1 $FANOUT);
+      do
+        if [ $((K * FANOUT + CHILD)) -lt $NODES ];
+        then
+          INTERFACES="$INTERFACES${INTERFACES:+,}eth$CHILD:vwire:$TOPOLOGY:n$K"
+        fi
+      done
+      if [ -z "$INTERFACES" ];
+      then
+        continue
+      fi
+
+      $AL -m 02:1a:$(mac $K 0):00 -i $INTERFACES -p $((BASE_PORT + K)) > $DIR/n$K.log 2>&1 &
+      echo $! >> $DIR/pids
+    done
+    echo "$NODES AL entities started (topology: $TOPOLOGY)"
+    ;;
+
+  stop)
+    if [ -f $DIR/pids ];
+    then
+      kill $(cat $DIR/pids) 2>/dev/null
+      rm -f $DIR/pids
+    fi
+    ;;
+
+  *)
+    echo "Usage: $0 start [NODES [FANOUT [link parameters...]]] | stop"
+    exit 1
+    ;;
+esac
@@ -78,4 +78,33 @@
 //
 INT8U PLATFORM_SEND_ALME_REPLY(INT8U alme_client_id, INT8U *alme_message, INT16U alme_message_len);
 
+// Same as "PLATFORM_SEND_ALME_REPLY()", but more messages belonging to the same
+// RESPONSE/CONFIRMATION will follow.
+//
+// This is used to send very long replies (which would not fit in a single ALME
+// message) in several pieces, as soon as each of them is ready. The last piece
+// must be sent by calling "PLATFORM_SEND_ALME_REPLY()", which tells the HLE
+// that the reply is complete.
+//
+// Return '0' if there was some problem processing the message, "1" otherwise.
+//
+INT8U PLATFORM_SEND_ALME_PARTIAL_REPLY(INT8U alme_client_id, INT8U *alme_message, INT16U alme_message_len);
+
+// Same as "PLATFORM_SEND_ALME_PARTIAL_REPLY()", but for the messages that the
+// AL entity sends on its own (ie. events) to a client that asked for them and
+// that might not read them as fast as they are produced.
+//
+// Only a limited number of them can be waiting to be delivered to each client.
+// Beyond that, the oldest one that has not started to be sent yet is
+// discarded.
+//
+// 'alme_message' can be NULL (and 'alme_message_len' '0') to just find out
+// whether the client is still there.
+//
+// Return '0' if the client has gone (or events cannot be delivered to it), in
+// which case no more events must be sent and the reply must be terminated with
+// "PLATFORM_SEND_ALME_REPLY()". Return "1" otherwise.
+//
+INT8U PLATFORM_SEND_ALME_EVENT(INT8U alme_client_id, INT8U *alme_message, INT16U alme_message_len);
+
 #endif
@@ -379,6 +379,53 @@ struct interfaceInfo *PLATFORM_GET_1905_INTERFACE_INFO(char *interface_name);
 //
 void PLATFORM_FREE_1905_INTERFACE_INFO(struct interfaceInfo *i);
 
+// Same as "PLATFORM_GET_1905_INTERFACE_INFO()" but, instead of a new structure,
+// return a *borrowed* pointer to a per-interface cached copy, which is only
+// refreshed when it has been invalidated (see
+// "PLATFORM_INVALIDATE_1905_INTERFACE_INFO()") or when it is older than
+// "INTERFACE_INFO_CACHE_TTL" milliseconds (see the README file).
+//
+// This is the function to use in hot paths (packet reception, periodic
+// discovery, building of topology responses, ...) where retrieving the
+// information from the OS (which might involve running external tools) for
+// each call would be too expensive.
+//
+// The returned structure is read-only: the caller must *not* modify it nor call
+// "PLATFORM_FREE_1905_INTERFACE_INFO()" on it. It remains valid across (at
+// least) one refresh of the same interface, but must not be kept for longer
+// than the processing of the current event.
+//
+// This function must only be called from the AL main thread.
+//
+// If something goes wrong (or 'interface_name' is not one of the names
+// returned by "PLATFORM_GET_LIST_OF_1905_INTERFACES()"), return NULL.
+//
+struct interfaceInfo *PLATFORM_GET_1905_INTERFACE_INFO_CACHED(char *interface_name);
+
+// Mark the cached information of 'interface_name' (or of all interfaces, if
+// 'interface_name' is NULL) as stale, so that the next call to
+// "PLATFORM_GET_1905_INTERFACE_INFO_CACHED()" retrieves it again.
+//
+// This must be called whenever an event that might change the interface
+// information (topology change, push button, new authenticated link, ...) is
+// processed.
+//
+void PLATFORM_INVALIDATE_1905_INTERFACE_INFO(char *interface_name);
+
+// Return a counter that is incremented each time the information returned by
+// "PLATFORM_GET_1905_INTERFACE_INFO_CACHED()" for any interface changes (ie.
+// when a refreshed entry turns out to be different from the one it replaces).
+//
+// This lets callers which build something out of the information of all
+// interfaces (such as a topology response) know whether it needs to be built
+// again: they just have to call "PLATFORM_GET_1905_INTERFACE_INFO_CACHED()" for
+// each interface (so that stale entries are refreshed) and then compare this
+// value against the one they saw the last time.
+//
+// This function must only be called from the AL main thread.
+//
+INT32U PLATFORM_GET_1905_INTERFACE_INFO_GENERATION(void);
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Link metrics
@@ -456,6 +503,10 @@ struct linkMetrics
 // Once the caller is done with the returned structure, hw must call
 // "PLATFORM_FREE_LINK_METRICS()" to dispose it
 //
+// The returned values do not need to be obtained at the time of the call: the
+// platform can answer from periodically refreshed samples (this is what the
+// Linux implementation does), as long as they are reasonably recent.
+//
 // [PLATFORM PORTING NOTE]
 //   You will notice how each 'struct linkMetrics' is associated to a LINK and
 //   not to an interface.
@@ -533,6 +584,33 @@ void PLATFORM_FREE_LIST_OF_BRIDGES(struct bridge *x, INT8U nr);
 //
 INT8U PLATFORM_SEND_RAW_PACKET(char *interface_name, INT8U *dst_mac, INT8U *src_mac, INT16U eth_type, INT8U *payload, INT16U payload_len);
 
+// One of the frames to send with "PLATFORM_SEND_RAW_PACKETS()". Fields have the
+// same meaning as the arguments of "PLATFORM_SEND_RAW_PACKET()"
+//
+struct rawPacket
+{
+    char   *interface_name;
+    INT8U  *dst_mac;
+    INT8U  *src_mac;
+    INT16U  eth_type;
+    INT8U  *payload;
+    INT16U  payload_len;
+};
+
+// Same as "PLATFORM_SEND_RAW_PACKET()" but for 'nr' frames (which can go out
+// through different interfaces) at once.
+//
+// This is meant for those places where the AL sends many frames in a row (such
+// as the periodic discovery messages, which are sent on all interfaces), so
+// that the platform can hand all of them to the OS in as few operations as
+// possible.
+//
+// Frames are sent in order. The function returns the number of frames that
+// were sent (ie. if it returns less than 'nr', some of them could not be
+// sent)
+//
+INT16U PLATFORM_SEND_RAW_PACKETS(struct rawPacket *packets, INT16U nr);
+
 
 ////////////////////////////////////////////////////////////////////////////////
 /// Push button configuration
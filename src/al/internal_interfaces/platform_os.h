@@ -398,9 +398,33 @@ INT8U PLATFORM_CREATE_QUEUE(const char *name);
 //       has the following format:
 //
 //         byte 0x00 - PLATFORM_QUEUE_EVENT_TOPOLOGY_CHANGE_NOTIFICATION
+//         byte 0x01 - message length (MSB)
+//         byte 0x02 - message length (LSB)
+//         byte 0x03 - name of the 1905 interface that has changed (including
+//         ...         the NULL terminating character). Not present (ie.
+//         ...         message length is zero) when the platform does not
+//         ...         know which interface(s) the change affects.
+//
+//   - PLATFORM_QUEUE_EVENT_SHUTDOWN:
+//
+//       A new event is generated when the platform wants the AL entity to stop
+//       (for example, because the process has been asked to terminate). When
+//       the AL receives it, it saves whatever state must survive a restart and
+//       then "start1905AL()" returns.
+//
+//       'data' can be set to NULL (it is not used for anything).
+//
+//       When the event takes place, the message that is inserted in the queue
+//       has the following format:
+//
+//         byte 0x00 - PLATFORM_QUEUE_EVENT_SHUTDOWN
 //         byte 0x01 - 0x00
 //         byte 0x02 - 0x00
 //
+//       [PLATFORM PORTING NOTE]
+//         In Linux this event is generated when SIGINT or SIGTERM are
+//         received.
+//
 //
 // In all cases, if there is a problem registering the event, this function
 // returns "0", otherwise it returns "1"
@@ -412,6 +436,7 @@ INT8U PLATFORM_CREATE_QUEUE(const char *name);
 #define PLATFORM_QUEUE_EVENT_PUSH_BUTTON                  (0x04)
 #define PLATFORM_QUEUE_EVENT_AUTHENTICATED_LINK           (0x05)
 #define PLATFORM_QUEUE_EVENT_TOPOLOGY_CHANGE_NOTIFICATION (0x06)
+#define PLATFORM_QUEUE_EVENT_SHUTDOWN                     (0x07)
 
 #define MAX_TIMER_TOKEN (1000)
 
@@ -438,4 +463,114 @@ INT8U PLATFORM_REGISTER_QUEUE_EVENT(INT8U queue_id, INT8U event_type, void *data
 //
 INT8U PLATFORM_READ_QUEUE(INT8U queue_id, INT8U *message_buffer);
 
+
+////////////////////////////////////////////////////////////////////////////////
+// Persistent storage functions
+////////////////////////////////////////////////////////////////////////////////
+
+// Store the 'len' bytes pointed by 'buffer' as the new "data model snapshot",
+// replacing the previous one (if any).
+//
+// The snapshot is an opaque binary blob (generated by "DMsaveSnapshot()") that
+// must survive a restart of the AL entity, so that the next time it starts it
+// can be retrieved with "PLATFORM_MAP_DATAMODEL_SNAPSHOT()".
+//
+// If 'buffer' is NULL nothing is stored: the call only tells whether snapshots
+// are enabled (so that the AL entity does not generate them for nothing).
+//
+// [PLATFORM PORTING NOTE]
+//   The replacement must be atomic: if the device loses power in the middle of
+//   this call, either the old or the new snapshot must be retrieved later, but
+//   never a mix of both.
+//   Platforms that do not have (or do not want to use) persistent storage can
+//   simply return "0".
+//
+// If there is a problem (or snapshots are disabled) this function returns "0",
+// otherwise it returns "1"
+//
+INT8U PLATFORM_SAVE_DATAMODEL_SNAPSHOT(INT8U *buffer, INT32U len);
+
+// Return a read-only pointer to the contents of the last snapshot stored with
+// "PLATFORM_SAVE_DATAMODEL_SNAPSHOT()" and its length in 'len'.
+//
+// If there is no snapshot available, NULL is returned.
+//
+// Once the caller is done with it, the returned pointer must be released with
+// "PLATFORM_UNMAP_DATAMODEL_SNAPSHOT()" (using the same 'len' value)
+//
+// [PLATFORM PORTING NOTE]
+//   Mapping the file directly into memory (instead of reading it into a new
+//   buffer) is the preferred implementation.
+//
+INT8U *PLATFORM_MAP_DATAMODEL_SNAPSHOT(INT32U *len);
+void   PLATFORM_UNMAP_DATAMODEL_SNAPSHOT(INT8U *buffer, INT32U len);
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Shared memory functions
+////////////////////////////////////////////////////////////////////////////////
+
+// Return a pointer to a memory region of (at least) 'size' bytes which is
+// shared with other local processes, where the "topology image" (see
+// "DMpublishTopologyImage()") is published. Its actual size is returned in
+// 'mapped_size'.
+//
+// The first call creates the region. Later calls with a bigger 'size' enlarge
+// it (keeping its contents), in which case the returned pointer can be
+// different from the previous one (which must not be used anymore).
+//
+// If publishing is not enabled (or if there is a problem), NULL is returned.
+//
+// [PLATFORM PORTING NOTE]
+//   The region must be readable by other processes, which must be able to
+//   find it by some well known name.
+//   Platforms that do not want to support this feature can simply return
+//   NULL.
+//
+INT8U *PLATFORM_MAP_TOPOLOGY_IMAGE(INT32U size, INT32U *mapped_size);
+
+// Full memory barrier: all memory accesses placed before this call must be
+// completed (and visible to other processes) before any of the ones placed
+// after it.
+//
+void PLATFORM_MEMORY_BARRIER(void);
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Flight recorder functions
+////////////////////////////////////////////////////////////////////////////////
+
+// Values for the 'direction' argument of "PLATFORM_RECORD_FRAME()"
+//
+#define PLATFORM_FRAME_RECEIVED     (0)
+#define PLATFORM_FRAME_TRANSMITTED  (1)
+
+// Keep a copy of a frame (made of the 14 bytes ethernet 'header' followed by
+// 'payload_len' bytes of 'payload') received or transmitted on interface
+// 'interface_name' (which can be NULL if unknown) in the "flight recorder": a
+// fixed size ring with the last frames that went in and out of the AL entity,
+// which can later be saved with "PLATFORM_DUMP_FLIGHT_RECORDER()".
+//
+// 'annotation' (which can be NULL) is a short description of what happened to
+// the frame (ex: "duplicate"). Only the pointer is stored, thus it must remain
+// valid until the process ends (typically, a string literal).
+//
+// This function is called for every frame, thus it must be cheap (no
+// allocations, no locks, no I/O).
+//
+// [PLATFORM PORTING NOTE]
+//   Platforms that do not want to support this feature can simply do nothing.
+//
+void PLATFORM_RECORD_FRAME(INT8U direction, char *interface_name, INT8U *header, INT8U *payload, INT16U payload_len, char *annotation);
+
+// Save the contents of the flight recorder (oldest frame first) somewhere
+// where they can later be retrieved. Its name is returned in 'destination'
+// (a pointer to an internal string that must not be freed) and the number of
+// saved frames in 'frames_nr'.
+//
+// If the flight recorder is disabled (or if there is a problem) this function
+// returns "0", otherwise it returns "1"
+//
+INT8U PLATFORM_DUMP_FLIGHT_RECORDER(char **destination, INT32U *frames_nr);
+
 #endif
@@ -55,16 +55,25 @@
  *  DAMAGE.
  */
 
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_DATAMODEL
+
 #include "platform.h"
 #include "utils.h"
+#include "packet_tools.h"
 
 #include "al_datamodel.h"
 #include "al_utils.h"
 
 #include "1905_tlvs.h"
 #include "1905_cmdus.h"
+#include "1905_alme.h"
 
 #include "al_extension.h"
+#include "al_metrics_history.h"
+#include "al_events.h"
+
+#include "platform_os.h"
+#include "platform_crypto.h"
 
 ////////////////////////////////////////////////////////////////////////////////
 // Private stuff
@@ -77,31 +86,109 @@ struct _dataModel
     INT8U              registrar_mac_address[6];
 
     INT8U              al_mac_address[6];
-    INT8U              local_interfaces_nr;
 
-    struct _localInterface 
+    // Local interfaces, the 1905 neighbors visible from each of them and the
+    // interfaces of those neighbors are kept in three flat tables linked by
+    // index, so that processing a discovery message only requires scanning a
+    // few contiguous arrays (instead of following pointers and comparing
+    // interface names):
+    //
+    //   - An "interface id" is an index into the "local_interfaces" table.
+    //
+    //   - A "neighbor id" is an index into the "neighbors" table. Each entry
+    //     represents a (local interface, neighbor AL MAC) pair, thus the same
+    //     neighbor appears once for each local interface it is visible from.
+    //
+    //   - A "remote interface id" is an index into the "remote_interfaces"
+    //     table. Each entry represents a (neighbor id, remote MAC) pair.
+    //
+    // Each table is made of parallel arrays (one per field), so that searches
+    // only touch the MAC addresses and parent ids, and the discovery
+    // timestamps (the only fields updated on every discovery message) do not
+    // share cache lines with them.
+    //
+    // The "neighbors" table is sorted by interface id and the
+    // "remote_interfaces" one by neighbor id. Thus the children of each entry
+    // are contiguous, their range is found with a binary search (see
+    // "_firstNeighborId()" and "_firstRemoteInterfaceId()") and lookups only
+    // scan the entries of one parent.
+    // Inserting or removing an entry shifts the ones after it (and updates the
+    // ids that referenced them), which is fine because that only happens when
+    // the topology changes.
+    //
+    // Each remote interface (ie. each link) also records the "generation" (see
+    // below) at which it was created or last changed (ie. became bridged or
+    // stopped being bridged).
+    //
+    struct _localInterfacesTable
+    {
+        INT8U               nr;
+        char              **names;
+        INT8U             (*mac_addresses)[6];
+
+    }                  local_interfaces;
+
+    struct _neighborsTable
     {
-        char               *name;
-        INT8U               mac_address[6];
- 
-        INT8U               neighbors_nr;
+        INT16U              nr;
+        INT16U              size;            // Number of allocated entries
+        INT8U             (*al_mac_addresses)[6];
+        INT8U              *interface_ids;
 
-        struct _neighbor
-        {
-            INT8U               al_mac_address[6];
-            INT8U               remote_interfaces_nr;
+    }                  neighbors;
 
-            struct _remoteInterface
-            {
-                INT8U               mac_address[6];
-                INT32U              last_topology_discovery_ts;
-                INT32U              last_bridge_discovery_ts;
+    struct _remoteInterfacesTable
+    {
+        INT16U              nr;
+        INT16U              size;            // Number of allocated entries
+        INT8U             (*mac_addresses)[6];
+        INT16U             *neighbor_ids;
+        INT32U             *last_topology_discovery_ts;
+        INT32U             *last_bridge_discovery_ts;
+        INT32U             *generations;
+
+    }                  remote_interfaces;
 
-            }                  *remote_interfaces;
+    // Every time a device or a link is created, changed or removed, this
+    // counter is incremented and its new value is stored in the affected
+    // entry. This way clients can ask for "whatever changed since generation
+    // X" (see "DMdumpNetworkDevicesSince()") instead of retrieving the whole
+    // database each time.
+    //
+    // The counter starts from scratch each time the AL entity starts (and it
+    // is not saved in snapshots), thus it is paired with a random "epoch",
+    // chosen at start up, that clients must send back together with the
+    // generation. A generation from another epoch is meaningless.
+    //
+    INT32U             epoch;
+    INT32U             generation;
 
-        }                  *neighbors; 
+    // Incremented every time the local view of the topology changes (see
+    // "DMlocalGenerationGet()")
+    //
+    INT32U             local_generation;
+
+    // Removed entries no longer exist, thus their removal is remembered in a
+    // small circular buffer of "tombstones".
+    // When the buffer is full the oldest tombstone is overwritten and
+    // "tombstones_horizon" is updated to its generation: from that moment on
+    // a client asking for changes since a generation older than that one
+    // must receive a full dump (because some removals have been forgotten).
+    //
+    #define DATAMODEL_TOMBSTONES_NR  (64)
+    struct _tombstone
+    {
+        INT32U              generation;
+        INT8U               interface_id;       // INVALID_INTERFACE_ID when the
+                                                // removed entry is a device
+        INT8U               al_mac_address[6];
+        INT8U               mac_address[6];     // Only used for links
 
-    }                 *local_interfaces;
+    }                  tombstones[DATAMODEL_TOMBSTONES_NR];
+    INT8U              tombstones_nr;
+    INT8U              tombstones_next;         // Position where the next
+                                                // tombstone will be written
+    INT32U             tombstones_horizon;
 
     INT8U              network_devices_nr;
 
@@ -109,6 +196,13 @@ struct _dataModel
     {
             INT32U                                      update_timestamp;
 
+            INT8U                                       stale;  // Set to '1' when
+                                                                // restored from a
+                                                                // snapshot and not
+                                                                // yet revalidated
+
+            INT32U                                      generation;
+
             struct deviceInformationTypeTLV            *info;
                       
             INT8U                                       bridges_nr;
@@ -154,127 +248,238 @@ struct _dataModel
             INT8U                                       extensions_nr;
             struct vendorSpecificTLV                  **extensions;
 
+            INT8U                                      *export_cache;
+            INT32U                                      export_cache_len;
+            INT32U                                      export_cache_generation;
+                                                                // All the TLVs
+                                                                // above, already
+                                                                // serialized (see
+                                                                // "_exportWriteDevice()")
+                                                                // when 'generation'
+                                                                // was this value
+
     }                 *network_devices;
                          // This list will always contain at least ONE entry,
                          // containing the info of the *local* device.
 } data_model;
 
 
-// Given a 'mac_address', return a pointer to the "struct _localInterface" that
-// represents the local interface with that address.
-// Returns NONE if such a local interface could not be found.
+// Value returned by the "*Id()" functions below when an entry is not found
+//
+#define INVALID_INTERFACE_ID  (0xFF)
+#define INVALID_ID            (0xFFFF)
+
+// Remember that an entry (a device when 'interface_id' is
+// INVALID_INTERFACE_ID, a link otherwise) was removed, so that it can later be
+// reported by "DMdumpNetworkDevicesSince()".
+// Returns the generation assigned to the removal.
+//
+static INT32U _recordTombstone(INT8U interface_id, INT8U *al_mac_address, INT8U *mac_address)
+{
+    struct _tombstone *t;
+
+    t = &data_model.tombstones[data_model.tombstones_next];
+
+    if (DATAMODEL_TOMBSTONES_NR == data_model.tombstones_nr)
+    {
+        // The oldest tombstone is going to be overwritten
+        //
+        data_model.tombstones_horizon = t->generation;
+    }
+    else
+    {
+        data_model.tombstones_nr++;
+    }
+
+    t->generation   = ++data_model.generation;
+    t->interface_id = interface_id;
+    PLATFORM_MEMCPY(t->al_mac_address, al_mac_address, 6);
+    if (NULL != mac_address)
+    {
+        PLATFORM_MEMCPY(t->mac_address, mac_address, 6);
+    }
+    else
+    {
+        PLATFORM_MEMSET(t->mac_address, 0x0, 6);
+    }
+
+    data_model.tombstones_next = (data_model.tombstones_next + 1) % DATAMODEL_TOMBSTONES_NR;
+
+    return t->generation;
+}
+
+// Given a 'mac_address', return the id of the local interface with that
+// address.
+// Returns INVALID_INTERFACE_ID if such a local interface could not be found.
 //
-struct _localInterface *_macAddressToLocalInterfaceStruct(INT8U *mac_address)
+static INT8U _macAddressToInterfaceId(INT8U *mac_address)
 {
     INT8U i;
 
     if (NULL != mac_address)
     {
-        for (i=0; i<data_model.local_interfaces_nr; i++)
+        for (i=0; i<data_model.local_interfaces.nr; i++)
         {
-            if (0 == PLATFORM_MEMCMP(data_model.local_interfaces[i].mac_address, mac_address, 6))
+            if (0 == PLATFORM_MEMCMP(data_model.local_interfaces.mac_addresses[i], mac_address, 6))
             {
-                return &data_model.local_interfaces[i];
+                return i;
             }
         }
     }
 
     // Not found!
     //
-    return NULL;
+    return INVALID_INTERFACE_ID;
 }
 
-// Given a 'name', return a pointer to the "struct _localInterface" that
-// represents the local interface with that interface name.
-// Returns NONE if such a local interface could not be found.
+// Given a 'name', return the id of the local interface with that interface
+// name.
+// Returns INVALID_INTERFACE_ID if such a local interface could not be found.
 //
-struct _localInterface *_nameToLocalInterfaceStruct(char *name)
+static INT8U _nameToInterfaceId(char *name)
 {
     INT8U i;
 
     if (NULL != name)
     {
-        for (i=0; i<data_model.local_interfaces_nr; i++)
+        for (i=0; i<data_model.local_interfaces.nr; i++)
         {
-            if (0 == PLATFORM_MEMCMP(data_model.local_interfaces[i].name, name, PLATFORM_STRLEN(data_model.local_interfaces[i].name)+1))
+            if (
+                 PLATFORM_STRLEN(data_model.local_interfaces.names[i]) == PLATFORM_STRLEN(name) &&
+                 0 == PLATFORM_MEMCMP(data_model.local_interfaces.names[i], name, PLATFORM_STRLEN(name))
+               )
             {
-                return &data_model.local_interfaces[i];
+                return i;
             }
         }
     }
 
     // Not found!
     //
-    return NULL;
+    return INVALID_INTERFACE_ID;
 }
 
-// Given an 'al_mac_address', return a pointer to the "struct _neighbor" that
-// represents a 1905 neighbor with that 'al_mac_address' visible from the
-// provided 'local_interface_name'.
-// Returns NONE if such a neighbor could not be found.
+// Return the id of the first neighbor visible from local interface
+// 'interface_id' (or, if there are none, the id where the first one would be
+// inserted).
+// The neighbors of that interface are the ones from there on whose interface
+// id is 'interface_id' (it can be one past the last interface, in which case
+// the number of neighbors is returned).
 //
-struct _neighbor *_alMacAddressToNeighborStruct(char *local_interface_name, INT8U *al_mac_address)
+static INT16U _firstNeighborId(INT16U interface_id)
 {
-    INT8U i;
+    INT16U low, high, middle;
 
-    struct _localInterface *x;
+    low  = 0;
+    high = data_model.neighbors.nr;
 
-    if (NULL == (x = _nameToLocalInterfaceStruct(local_interface_name)))
+    while (low < high)
     {
-        // Non existent interface
-        //
-        return NULL;
+        middle = low + (high - low) / 2;
+
+        if (data_model.neighbors.interface_ids[middle] < interface_id)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+// Same as "_firstNeighborId()", but for the remote interfaces of neighbor
+// 'neighbor_id'
+//
+static INT16U _firstRemoteInterfaceId(INT16U neighbor_id)
+{
+    INT16U low, high, middle;
+
+    low  = 0;
+    high = data_model.remote_interfaces.nr;
+
+    while (low < high)
+    {
+        middle = low + (high - low) / 2;
+
+        if (data_model.remote_interfaces.neighbor_ids[middle] < neighbor_id)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
     }
 
+    return low;
+}
+
+// Given an 'al_mac_address', return the id of the 1905 neighbor with that
+// 'al_mac_address' visible from the provided local interface.
+// Returns INVALID_ID if such a neighbor could not be found.
+//
+static INT16U _alMacAddressToNeighborId(INT8U interface_id, INT8U *al_mac_address)
+{
+    INT16U i;
+
     if (NULL != al_mac_address)
     {
-        for (i=0; i<x->neighbors_nr; i++)
+        for (i=_firstNeighborId(interface_id); i<data_model.neighbors.nr && interface_id == data_model.neighbors.interface_ids[i]; i++)
         {
-            if (0 == PLATFORM_MEMCMP(x->neighbors[i].al_mac_address, al_mac_address, 6))
+            if (0 == PLATFORM_MEMCMP(data_model.neighbors.al_mac_addresses[i], al_mac_address, 6))
             {
-                return &x->neighbors[i];
+                return i;
             }
         }
     }
 
     // Not found!
     //
-    return NULL;
+    return INVALID_ID;
 }
 
-// Given a 'mac_address', return a pointer to the "struct _remoteInterface" that
-// represents an interface in the provided 1905 neighbor (identified by its
-// 'neighbor_al_mac_address' and visible in 'local_interface) that contains that
-// address.
-// Returns NONE if such a remote interface could not be found.
+// Given a 'mac_address', return the id of the remote interface with that
+// address which belongs to the provided 1905 neighbor.
+// Returns INVALID_ID if such a remote interface could not be found.
 //
-struct _remoteInterface *_macAddressToRemoteInterfaceStruct(char *local_interface_name, INT8U *neighbor_al_mac_address, INT8U *mac_address)
+static INT16U _macAddressToRemoteInterfaceId(INT16U neighbor_id, INT8U *mac_address)
 {
-    INT8U i;
-
-    struct _neighbor *x;
-
-    if (NULL == (x = _alMacAddressToNeighborStruct(local_interface_name, neighbor_al_mac_address)))
-    {
-        // Non existent neighbor
-        //
-        return NULL;
-    }
+    INT16U i;
 
     if (NULL != mac_address)
     {
-        for (i=0; i<x->remote_interfaces_nr; i++)
+        for (i=_firstRemoteInterfaceId(neighbor_id); i<data_model.remote_interfaces.nr && neighbor_id == data_model.remote_interfaces.neighbor_ids[i]; i++)
         {
-            if (0 == PLATFORM_MEMCMP(x->remote_interfaces[i].mac_address, mac_address, 6))
+            if (0 == PLATFORM_MEMCMP(data_model.remote_interfaces.mac_addresses[i], mac_address, 6))
             {
-                return &x->remote_interfaces[i];
+                return i;
             }
         }
     }
 
     // Not found!
     //
-    return NULL;
+    return INVALID_ID;
+}
+
+// Same as "_macAddressToRemoteInterfaceId()", but the neighbor is identified by
+// the local interface name and its AL MAC address.
+//
+static INT16U _linkToRemoteInterfaceId(char *local_interface_name, INT8U *neighbor_al_mac_address, INT8U *mac_address)
+{
+    INT16U neighbor_id;
+
+    neighbor_id = _alMacAddressToNeighborId(_nameToInterfaceId(local_interface_name), neighbor_al_mac_address);
+
+    if (INVALID_ID == neighbor_id)
+    {
+        return INVALID_ID;
+    }
+
+    return _macAddressToRemoteInterfaceId(neighbor_id, mac_address);
 }
 
 // When a new 1905 neighbor is discovered on a local interface, this function
@@ -282,42 +487,71 @@ struct _remoteInterface *_macAddressToRemoteInterfaceStruct(char *local_interfac
 // Returns '0' if there was a problem (out of memory, etc...), '2' if the
 // neighbor had already been inserted, '1' if the new neighbor was succesfully
 // inserted.
+// In the last two cases, the id of the neighbor is returned in 'neighbor_id'.
 //
-INT8U _insertNeighbor(char *local_interface_name, INT8U *al_mac_address)
+static INT8U _insertNeighbor(INT8U interface_id, INT8U *al_mac_address, INT16U *neighbor_id)
 {
-    struct _localInterface *x;
+    struct _neighborsTable *t;
+    INT16U                  i;
+
+    t = &data_model.neighbors;
 
     // First, make sure the interface exists
     //
-    if (NULL == (x = _nameToLocalInterfaceStruct(local_interface_name)))
+    if (interface_id >= data_model.local_interfaces.nr)
     {
         return 0;
     }
 
     // Next, make sure this neighbor does not already exist
     //
-    if (NULL != _alMacAddressToNeighborStruct(local_interface_name, al_mac_address))
+    if (INVALID_ID != (*neighbor_id = _alMacAddressToNeighborId(interface_id, al_mac_address)))
     {
         // The neighbor exists! We don't need to do anything special.
         //
         return 2;
     }
 
-    if (0 == x->neighbors_nr)
+    if (INVALID_ID == t->nr)
+    {
+        return 0;
+    }
+
+    if (t->nr == t->size)
     {
-        x->neighbors = (struct _neighbor *)PLATFORM_MALLOC(sizeof (struct _neighbor));
+        // Grow all the arrays at once (doubling their size, so that inserting
+        // new neighbors does not require a "realloc()" each time)
+        //
+        t->size = 0 == t->size ? 4 : (t->size > INVALID_ID/2 ? INVALID_ID : 2 * t->size);
 
+        t->al_mac_addresses = (INT8U (*)[6])PLATFORM_REALLOC(t->al_mac_addresses, sizeof(INT8U[6]) * t->size);
+        t->interface_ids    = (INT8U *)     PLATFORM_REALLOC(t->interface_ids,    sizeof(INT8U)    * t->size);
     }
-    else
+
+    // The new neighbor goes after the last one of its interface. The ones
+    // after it are shifted, thus the remote interfaces that referenced them
+    // must be updated (they remain sorted, as all of them are shifted).
+    //
+    *neighbor_id = _firstNeighborId(interface_id + 1);
+
+    for (i=t->nr; i>*neighbor_id; i--)
+    {
+        PLATFORM_MEMCPY(t->al_mac_addresses[i], t->al_mac_addresses[i-1], 6);
+                        t->interface_ids[i]   = t->interface_ids[i-1];
+    }
+    for (i=_firstRemoteInterfaceId(*neighbor_id); i<data_model.remote_interfaces.nr; i++)
     {
-        x->neighbors = (struct _neighbor *)PLATFORM_REALLOC(x->neighbors, sizeof (struct _neighbor) * (x->neighbors_nr + 1));
+        data_model.remote_interfaces.neighbor_ids[i]++;
     }
 
-    PLATFORM_MEMCPY(x->neighbors[x->neighbors_nr].al_mac_address,        al_mac_address, 6);
-                    x->neighbors[x->neighbors_nr].remote_interfaces_nr = 0;
-                    x->neighbors[x->neighbors_nr].remote_interfaces    = NULL;
+    PLATFORM_MEMCPY(t->al_mac_addresses[*neighbor_id], al_mac_address, 6);
+                    t->interface_ids[*neighbor_id]   = interface_id;
 
-    x->neighbors_nr++;
+    t->nr++;
+
+    data_model.local_generation++;
+
+    EVneighborUp(al_mac_address, data_model.local_interfaces.mac_addresses[interface_id]);
 
     return 1;
 }
@@ -327,1194 +561,2601 @@ INT8U _insertNeighbor(char *local_interface_name, INT8U *al_mac_address)
 // Returns '0' if there was a problem (out of memory, etc...), '2' if the
 // neighbor interface had already been inserted, '1' if the new neighbor
 // interface was successfully inserted.
+// In the last two cases, the id of the remote interface is returned in
+// 'remote_interface_id'.
 //
-INT8U _insertNeighborInterface(char *local_interface_name, INT8U *neighbor_al_mac_address, INT8U *mac_address)
+static INT8U _insertNeighborInterface(INT16U neighbor_id, INT8U *mac_address, INT16U *remote_interface_id)
 {
-    struct _neighbor        *x;
+    struct _remoteInterfacesTable *t;
+    INT16U                         i;
 
-    // First, make sure the interface and neighbor exist
+    t = &data_model.remote_interfaces;
+
+    // First, make sure the neighbor exists
     //
-    if (NULL == (x = _alMacAddressToNeighborStruct(local_interface_name, neighbor_al_mac_address)))
+    if (neighbor_id >= data_model.neighbors.nr)
     {
         return 0;
     }
 
     // Next, make sure this neighbor interface does not already exist
     //
-    if (NULL != _macAddressToRemoteInterfaceStruct(local_interface_name, neighbor_al_mac_address, mac_address))
+    if (INVALID_ID != (*remote_interface_id = _macAddressToRemoteInterfaceId(neighbor_id, mac_address)))
     {
         // The neighbor exists! We don't need to do anything special.
         //
         return 2;
     }
 
-    if (0 == x->remote_interfaces_nr)
+    if (INVALID_ID == t->nr)
+    {
+        return 0;
+    }
+
+    if (t->nr == t->size)
     {
-        x->remote_interfaces    = (struct _remoteInterface *)PLATFORM_MALLOC(sizeof (struct _remoteInterface));
+        t->size = 0 == t->size ? 4 : (t->size > INVALID_ID/2 ? INVALID_ID : 2 * t->size);
+
+        t->mac_addresses              = (INT8U (*)[6])PLATFORM_REALLOC(t->mac_addresses,              sizeof(INT8U[6]) * t->size);
+        t->neighbor_ids               = (INT16U *)    PLATFORM_REALLOC(t->neighbor_ids,               sizeof(INT16U)   * t->size);
+        t->last_topology_discovery_ts = (INT32U *)    PLATFORM_REALLOC(t->last_topology_discovery_ts, sizeof(INT32U)   * t->size);
+        t->last_bridge_discovery_ts   = (INT32U *)    PLATFORM_REALLOC(t->last_bridge_discovery_ts,   sizeof(INT32U)   * t->size);
+        t->generations                = (INT32U *)    PLATFORM_REALLOC(t->generations,                sizeof(INT32U)   * t->size);
     }
-    else
+
+    // The new remote interface goes after the last one of its neighbor
+    //
+    *remote_interface_id = _firstRemoteInterfaceId(neighbor_id + 1);
+
+    for (i=t->nr; i>*remote_interface_id; i--)
     {
-        x->remote_interfaces = (struct _remoteInterface *)PLATFORM_REALLOC(x->remote_interfaces, sizeof (struct _remoteInterface) * (x->remote_interfaces_nr + 1));
+        PLATFORM_MEMCPY(t->mac_addresses[i],                 t->mac_addresses[i-1], 6);
+                        t->neighbor_ids[i]               = t->neighbor_ids[i-1];
+                        t->last_topology_discovery_ts[i] = t->last_topology_discovery_ts[i-1];
+                        t->last_bridge_discovery_ts[i]   = t->last_bridge_discovery_ts[i-1];
+                        t->generations[i]                = t->generations[i-1];
     }
 
-    PLATFORM_MEMCPY(x->remote_interfaces[x->remote_interfaces_nr].mac_address,                 mac_address, 6);
-                    x->remote_interfaces[x->remote_interfaces_nr].last_topology_discovery_ts = 0;
-                    x->remote_interfaces[x->remote_interfaces_nr].last_bridge_discovery_ts   = 0;
+    PLATFORM_MEMCPY(t->mac_addresses[*remote_interface_id],                 mac_address, 6);
+                    t->neighbor_ids[*remote_interface_id]               = neighbor_id;
+                    t->last_topology_discovery_ts[*remote_interface_id] = 0;
+                    t->last_bridge_discovery_ts[*remote_interface_id]   = 0;
+                    t->generations[*remote_interface_id]                = ++data_model.generation;
 
-    x->remote_interfaces_nr++;
+    t->nr++;
+
+    data_model.local_generation++;
 
     return 1;
 }
 
-////////////////////////////////////////////////////////////////////////////////
-// API functions (only available to the 1905 core itself, ie. files inside the
-// 'lib1905' folder)
-////////////////////////////////////////////////////////////////////////////////
-
-void DMinit()
+// Remove a remote interface from the database (the entries after it are
+// shifted to fill the hole) and remember its removal
+//
+static void _removeNeighborInterface(INT16U remote_interface_id)
 {
-    data_model.map_whole_network_flag   = 0;
-
-    data_model.registrar_mac_address[0] = 0x00;
-    data_model.registrar_mac_address[1] = 0x00;
-    data_model.registrar_mac_address[2] = 0x00;
-    data_model.registrar_mac_address[3] = 0x00;
-    data_model.registrar_mac_address[4] = 0x00;
-    data_model.registrar_mac_address[5] = 0x00;
+    struct _remoteInterfacesTable *t;
+    INT16U                         i;
 
-    data_model.al_mac_address[0]        = 0x00;
-    data_model.al_mac_address[1]        = 0x00;
-    data_model.al_mac_address[2]        = 0x00;
-    data_model.al_mac_address[3]        = 0x00;
-    data_model.al_mac_address[4]        = 0x00;
-    data_model.al_mac_address[5]        = 0x00;
+    t = &data_model.remote_interfaces;
 
-    data_model.local_interfaces_nr      = 0;
-    data_model.local_interfaces         = NULL;
+    _recordTombstone(data_model.neighbors.interface_ids[t->neighbor_ids[remote_interface_id]], data_model.neighbors.al_mac_addresses[t->neighbor_ids[remote_interface_id]], t->mac_addresses[remote_interface_id]);
 
-    // Regarding the "network_devices" list, we will init it with one element,
-    // representing the local node
-    //
-    data_model.network_devices_nr       = 1;
-    data_model.network_devices          = (struct _networkDevice *)PLATFORM_MALLOC(sizeof(struct _networkDevice));
+    for (i=remote_interface_id; i<t->nr-1; i++)
+    {
+        PLATFORM_MEMCPY(t->mac_addresses[i],                 t->mac_addresses[i+1], 6);
+                        t->neighbor_ids[i]               = t->neighbor_ids[i+1];
+                        t->last_topology_discovery_ts[i] = t->last_topology_discovery_ts[i+1];
+                        t->last_bridge_discovery_ts[i]   = t->last_bridge_discovery_ts[i+1];
+                        t->generations[i]                = t->generations[i+1];
+    }
 
-    data_model.network_devices[0].update_timestamp          = PLATFORM_GET_TIMESTAMP();
-    data_model.network_devices[0].info                      = NULL;
-    data_model.network_devices[0].bridges_nr                = 0;
-    data_model.network_devices[0].bridges                   = NULL;
-    data_model.network_devices[0].non1905_neighbors_nr      = 0;
-    data_model.network_devices[0].non1905_neighbors         = NULL;
-    data_model.network_devices[0].x1905_neighbors_nr        = 0;
-    data_model.network_devices[0].x1905_neighbors           = NULL;
-    data_model.network_devices[0].power_off_nr              = 0;
-    data_model.network_devices[0].power_off                 = NULL;
-    data_model.network_devices[0].l2_neighbors_nr           = 0;
-    data_model.network_devices[0].l2_neighbors              = NULL;
-    data_model.network_devices[0].generic_phy               = NULL;
-    data_model.network_devices[0].profile                   = NULL;
-    data_model.network_devices[0].identification            = NULL;
-    data_model.network_devices[0].control_url               = NULL;
-    data_model.network_devices[0].ipv4                      = NULL;
-    data_model.network_devices[0].ipv6                      = NULL;
-    data_model.network_devices[0].metrics_with_neighbors_nr = 0;
-    data_model.network_devices[0].metrics_with_neighbors    = NULL;
-    data_model.network_devices[0].extensions                = NULL;
-    data_model.network_devices[0].extensions_nr             = 0;
+    t->nr--;
 
-    return;
+    data_model.local_generation++;
 }
 
-void DMalMacSet(INT8U *al_mac_address)
+// Remove a 1905 neighbor (and all its remote interfaces) from the database.
+// The entries after it are shifted to fill the hole, thus the remote
+// interfaces which referenced them are updated accordingly.
+//
+static void _removeNeighbor(INT16U neighbor_id)
 {
-    PLATFORM_MEMCPY(data_model.al_mac_address, al_mac_address, 6);
+    struct _neighborsTable *t;
+    INT16U                  first;
+    INT16U                  i;
 
-    return;
+    t = &data_model.neighbors;
+
+    EVneighborDown(t->al_mac_addresses[neighbor_id], data_model.local_interfaces.mac_addresses[t->interface_ids[neighbor_id]]);
+
+    first = _firstRemoteInterfaceId(neighbor_id);
+    while (first < data_model.remote_interfaces.nr && neighbor_id == data_model.remote_interfaces.neighbor_ids[first])
+    {
+        _removeNeighborInterface(first);
+    }
+
+    for (i=neighbor_id; i<t->nr-1; i++)
+    {
+        PLATFORM_MEMCPY(t->al_mac_addresses[i], t->al_mac_addresses[i+1], 6);
+                        t->interface_ids[i]   = t->interface_ids[i+1];
+    }
+    for (i=first; i<data_model.remote_interfaces.nr; i++)
+    {
+        data_model.remote_interfaces.neighbor_ids[i]--;
+    }
+
+    t->nr--;
+
+    data_model.local_generation++;
 }
 
-INT8U *DMalMacGet()
+// Data model snapshots ("DMsaveSnapshot()" and "DMloadSnapshot()") have the
+// following format (multi-byte fields in network byte order):
+//
+//   "DMSS"                     (4 bytes, magic)
+//   version                    (1 byte, DATAMODEL_SNAPSHOT_VERSION)
+//   total length               (4 bytes, including this header)
+//   AL MAC address             (6 bytes)
+//   local_interfaces_nr        (1 byte)
+//     name length              (1 byte)
+//     name                     (n bytes, not NULL terminated)
+//     MAC address              (6 bytes)
+//     neighbors_nr             (1 byte)
+//       AL MAC address         (6 bytes)
+//       remote_interfaces_nr   (1 byte)
+//         MAC address          (6 bytes)
+//   network_devices_nr         (1 byte)
+//     tlvs_nr                  (2 bytes)
+//       TLV                    (as generated by "forge_1905_TLV_from_structure()".
+//                              The first one is always the "device
+//                              information" TLV)
+//
+// Note that the local device is never included (it is always regenerated on
+// demand) and that timestamps are not saved (restored entries are marked as
+// "stale" instead)
+//
+#define DATAMODEL_SNAPSHOT_MAGIC    "DMSS"
+#define DATAMODEL_SNAPSHOT_VERSION  (1)
+
+struct _snapshotWriter
 {
-    return data_model.al_mac_address;
-}
+    INT8U  *buffer;
+    INT32U  len;
+    INT32U  size;
+};
 
-void DMregistrarMacSet(INT8U *registrar_mac_address)
+// Make sure there is room for 'n' more bytes in the snapshot buffer and return
+// a pointer to the first one of them
+//
+static INT8U *_snapshotReserve(struct _snapshotWriter *w, INT32U n)
 {
-    PLATFORM_MEMCPY(data_model.registrar_mac_address, registrar_mac_address, 6);
+    INT8U *p;
 
-    return;
+    if (w->len + n > w->size)
+    {
+        while (w->len + n > w->size)
+        {
+            w->size = 0 == w->size ? 4096 : 2 * w->size;
+        }
+
+        if (NULL == w->buffer)
+        {
+            w->buffer = (INT8U *)PLATFORM_MALLOC(w->size);
+        }
+        else
+        {
+            w->buffer = (INT8U *)PLATFORM_REALLOC(w->buffer, w->size);
+        }
+    }
+
+    p       = w->buffer + w->len;
+    w->len += n;
+
+    return p;
 }
 
-INT8U *DMregistrarMacGet()
+static void _snapshotWrite1B(struct _snapshotWriter *w, INT8U x)
 {
-    return data_model.registrar_mac_address;
+    INT8U *p = _snapshotReserve(w, 1);
+    _I1B(&x, &p);
 }
 
-void DMmapWholeNetworkSet(INT8U map_whole_network_flag)
+static void _snapshotWrite2B(struct _snapshotWriter *w, INT16U x)
 {
-    data_model.map_whole_network_flag =  map_whole_network_flag;
+    INT8U *p = _snapshotReserve(w, 2);
+    _I2B(&x, &p);
+}
 
-    return;
+static void _snapshotWrite4B(struct _snapshotWriter *w, INT32U x)
+{
+    INT8U *p = _snapshotReserve(w, 4);
+    _I4B(&x, &p);
 }
 
-INT8U DMmapWholeNetworkGet()
+static void _snapshotWritenB(struct _snapshotWriter *w, void *x, INT32U n)
 {
-    return data_model.map_whole_network_flag;
+    INT8U *p = _snapshotReserve(w, n);
+    _InB(x, &p, n);
 }
 
-INT8U DMinsertInterface(char *name, INT8U *mac_address)
+// Forge 'tlv' and append it to the snapshot buffer, incrementing 'tlvs_nr'.
+// NULL TLVs are ignored.
+//
+static void _snapshotWriteTLV(struct _snapshotWriter *w, INT8U *tlv, INT16U *tlvs_nr)
 {
-    struct _localInterface *x;
+    INT8U  *stream;
+    INT16U  stream_len;
 
-    // First, make sure this interface does not already exist
-    //
-    if (NULL != (x = _nameToLocalInterfaceStruct(name)))
+    if (NULL == tlv)
     {
-        // The interface exists!
-        //
-        // Even if it already exists, if the provided 'mac_address' and the
-        // already existing entry match, do not return an error.
-        //
-        if (0 == PLATFORM_MEMCMP(x->mac_address, mac_address, 6))
-        {
-            // Ok
-            //
-            return 1;
-        }
-        else
-        {
-            // Interface exists and its MAC address is different from the
-            // provided one. Maybe the caller should first "remove" this
-            // interface and then try to add the new one.
-            //
-            return 0;
-        }
+        return;
     }
 
-    if (0 == data_model.local_interfaces_nr)
-    {
-        data_model.local_interfaces = (struct _localInterface *)PLATFORM_MALLOC(sizeof (struct _localInterface));
-
-    }
-    else
+    if (NULL == (stream = forge_1905_TLV_from_structure(tlv, &stream_len)))
     {
-        data_model.local_interfaces = (struct _localInterface *)PLATFORM_REALLOC(data_model.local_interfaces, sizeof (struct _localInterface) * (data_model.local_interfaces_nr + 1));
+        PLATFORM_PRINTF_DEBUG_WARNING("Could not forge TLV (type = %d) for the data model snapshot\n", *tlv);
+        return;
     }
 
-                    data_model.local_interfaces[data_model.local_interfaces_nr].name         = PLATFORM_STRDUP(name);
-    PLATFORM_MEMCPY(data_model.local_interfaces[data_model.local_interfaces_nr].mac_address,   mac_address, 6);
-                    data_model.local_interfaces[data_model.local_interfaces_nr].neighbors    = NULL;
-                    data_model.local_interfaces[data_model.local_interfaces_nr].neighbors_nr = 0;
-
-    data_model.local_interfaces_nr++;
+    _snapshotWritenB(w, stream, stream_len);
+    free_1905_TLV_packet(stream);
 
-    return 1;
+    (*tlvs_nr)++;
 }
 
-
-char *DMmacToInterfaceName(INT8U *mac_address)
+// Append the number of TLVs of a network device entry (2 bytes) followed by
+// all of them (see "_snapshotWriteTLV()") to the snapshot buffer.
+// The "device information" TLV (if present) is always the first one.
+//
+static void _snapshotWriteDeviceTLVs(struct _snapshotWriter *w, struct _networkDevice *x)
 {
-    struct _localInterface *x;
+    INT8U   j;
+    INT16U  tlvs_nr;
+    INT32U  tlvs_nr_offset;
+    INT8U  *p;
 
-    x = _macAddressToLocalInterfaceStruct(mac_address);
+    tlvs_nr        = 0;
+    tlvs_nr_offset = w->len;
+    _snapshotWrite2B(w, 0);
 
-    if (NULL != x)
+    _snapshotWriteTLV(w, (INT8U *)x->info, &tlvs_nr);
+    for (j=0; j<x->bridges_nr; j++)
     {
-        return x->name;
+        _snapshotWriteTLV(w, (INT8U *)x->bridges[j], &tlvs_nr);
     }
-    else
+    for (j=0; j<x->non1905_neighbors_nr; j++)
     {
-        // Not found!
-        //
-        return NULL;
+        _snapshotWriteTLV(w, (INT8U *)x->non1905_neighbors[j], &tlvs_nr);
     }
-}
-
-INT8U *DMinterfaceNameToMac(char *interface_name)
-{
-    INT8U i;
-
-    if (NULL != interface_name)
+    for (j=0; j<x->x1905_neighbors_nr; j++)
     {
-        for (i=0; i<data_model.local_interfaces_nr; i++)
-        {
-            if (0 == PLATFORM_MEMCMP(data_model.local_interfaces[i].name, interface_name, PLATFORM_STRLEN(data_model.local_interfaces[i].name)+1))
-            {
-                return data_model.local_interfaces[i].mac_address;
-            }
-        }
+        _snapshotWriteTLV(w, (INT8U *)x->x1905_neighbors[j], &tlvs_nr);
     }
-
-    // Not found!
-    //
-    return NULL;
-}
-
-
-INT8U (*DMgetListOfInterfaceNeighbors(char *local_interface_name, INT8U *al_mac_addresses_nr))[6]
-{
-    INT8U i;
-    INT8U (*ret)[6];
-
-    struct _localInterface *x;
-
-    if (NULL == (x = _nameToLocalInterfaceStruct(local_interface_name)))
+    for (j=0; j<x->power_off_nr; j++)
     {
-        // Non existent interface
-        //
-        *al_mac_addresses_nr = 0;
-        return NULL;
+        _snapshotWriteTLV(w, (INT8U *)x->power_off[j], &tlvs_nr);
     }
-
-    if (0 == x->neighbors_nr)
+    for (j=0; j<x->l2_neighbors_nr; j++)
     {
-        *al_mac_addresses_nr = 0;
-        return NULL;
+        _snapshotWriteTLV(w, (INT8U *)x->l2_neighbors[j], &tlvs_nr);
     }
-
-    ret = (INT8U (*)[6])PLATFORM_MALLOC(sizeof(INT8U[6]) * x->neighbors_nr);
-
-    for (i=0; i<x->neighbors_nr; i++)
+    _snapshotWriteTLV(w, (INT8U *)x->generic_phy,    &tlvs_nr);
+    _snapshotWriteTLV(w, (INT8U *)x->profile,        &tlvs_nr);
+    _snapshotWriteTLV(w, (INT8U *)x->identification, &tlvs_nr);
+    _snapshotWriteTLV(w, (INT8U *)x->control_url,    &tlvs_nr);
+    _snapshotWriteTLV(w, (INT8U *)x->ipv4,           &tlvs_nr);
+    _snapshotWriteTLV(w, (INT8U *)x->ipv6,           &tlvs_nr);
+    for (j=0; j<x->metrics_with_neighbors_nr; j++)
+    {
+        _snapshotWriteTLV(w, (INT8U *)x->metrics_with_neighbors[j].tx_metrics, &tlvs_nr);
+        _snapshotWriteTLV(w, (INT8U *)x->metrics_with_neighbors[j].rx_metrics, &tlvs_nr);
+    }
+    for (j=0; j<x->extensions_nr; j++)
     {
-        ret[i][0] = x->neighbors[i].al_mac_address[0];
-        ret[i][1] = x->neighbors[i].al_mac_address[1];
-        ret[i][2] = x->neighbors[i].al_mac_address[2];
-        ret[i][3] = x->neighbors[i].al_mac_address[3];
-        ret[i][4] = x->neighbors[i].al_mac_address[4];
-        ret[i][5] = x->neighbors[i].al_mac_address[5];
+        _snapshotWriteTLV(w, (INT8U *)x->extensions[j], &tlvs_nr);
     }
 
-    *al_mac_addresses_nr = x->neighbors_nr;
-    return ret;
+    p = w->buffer + tlvs_nr_offset;
+    _I2B(&tlvs_nr, &p);
 }
 
-INT8U (*DMgetListOfNeighbors(INT8U *al_mac_addresses_nr))[6]
+// Append 'tlv' to a list of TLVs (such as 'bridges', 'non1905_neighbors', ...)
+//
+static void _snapshotAppendTLVToList(INT8U ***list, INT8U *list_nr, INT8U *tlv)
 {
-    INT8U i, j, k;
-
-    INT8U total;
-    INT8U (*ret)[6];
-
-    if (NULL == al_mac_addresses_nr)
+    if (0 == *list_nr)
     {
-        return NULL;
+        *list = (INT8U **)PLATFORM_MALLOC(sizeof(INT8U *));
+    }
+    else
+    {
+        *list = (INT8U **)PLATFORM_REALLOC(*list, sizeof(INT8U *) * (*list_nr + 1));
     }
 
-    total = 0;
-    ret   = NULL;
+    (*list)[*list_nr] = tlv;
+    (*list_nr)++;
+}
+
+// Attach a TLV restored from a snapshot to the given (already existing)
+// network device entry.
+// The TLV becomes responsibility of the data model (or is freed, if it is of
+// an unexpected type)
+//
+static void _snapshotAttachTLV(struct _networkDevice *x, INT8U *tlv)
+{
+    INT8U j;
 
-    for (i=0; i<data_model.local_interfaces_nr; i++)
+    switch (*tlv)
     {
-        for (j=0; j<data_model.local_interfaces[i].neighbors_nr; j++)
+        case TLV_TYPE_DEVICE_BRIDGING_CAPABILITIES:
         {
-            // Check for duplicates
-            //
-            INT8U already_present;
-
-            already_present = 0;
-            for (k=0; k<total; k++)
-            {
-                if (0 == PLATFORM_MEMCMP(&ret[k], data_model.local_interfaces[i].neighbors[j].al_mac_address, 6))
-                {
-                    already_present = 1;
-                    break;
-                }
-            }
-
-            if (1 == already_present)
-            {
-                continue;
-            }
+            _snapshotAppendTLVToList((INT8U ***)&x->bridges, &x->bridges_nr, tlv);
+            break;
+        }
+        case TLV_TYPE_NON_1905_NEIGHBOR_DEVICE_LIST:
+        {
+            _snapshotAppendTLVToList((INT8U ***)&x->non1905_neighbors, &x->non1905_neighbors_nr, tlv);
+            break;
+        }
+        case TLV_TYPE_NEIGHBOR_DEVICE_LIST:
+        {
+            _snapshotAppendTLVToList((INT8U ***)&x->x1905_neighbors, &x->x1905_neighbors_nr, tlv);
+            break;
+        }
+        case TLV_TYPE_POWER_OFF_INTERFACE:
+        {
+            _snapshotAppendTLVToList((INT8U ***)&x->power_off, &x->power_off_nr, tlv);
+            break;
+        }
+        case TLV_TYPE_L2_NEIGHBOR_DEVICE:
+        {
+            _snapshotAppendTLVToList((INT8U ***)&x->l2_neighbors, &x->l2_neighbors_nr, tlv);
+            break;
+        }
+        case TLV_TYPE_VENDOR_SPECIFIC:
+        {
+            _snapshotAppendTLVToList((INT8U ***)&x->extensions, &x->extensions_nr, tlv);
+            break;
+        }
+        case TLV_TYPE_GENERIC_PHY_DEVICE_INFORMATION:
+        {
+            free_1905_TLV_structure((INT8U *)x->generic_phy);
+            x->generic_phy = (struct genericPhyDeviceInformationTypeTLV *)tlv;
+            break;
+        }
+        case TLV_TYPE_1905_PROFILE_VERSION:
+        {
+            free_1905_TLV_structure((INT8U *)x->profile);
+            x->profile = (struct x1905ProfileVersionTLV *)tlv;
+            break;
+        }
+        case TLV_TYPE_DEVICE_IDENTIFICATION:
+        {
+            free_1905_TLV_structure((INT8U *)x->identification);
+            x->identification = (struct deviceIdentificationTypeTLV *)tlv;
+            break;
+        }
+        case TLV_TYPE_CONTROL_URL:
+        {
+            free_1905_TLV_structure((INT8U *)x->control_url);
+            x->control_url = (struct controlUrlTypeTLV *)tlv;
+            break;
+        }
+        case TLV_TYPE_IPV4:
+        {
+            free_1905_TLV_structure((INT8U *)x->ipv4);
+            x->ipv4 = (struct ipv4TypeTLV *)tlv;
+            break;
+        }
+        case TLV_TYPE_IPV6:
+        {
+            free_1905_TLV_structure((INT8U *)x->ipv6);
+            x->ipv6 = (struct ipv6TypeTLV *)tlv;
+            break;
+        }
+        case TLV_TYPE_TRANSMITTER_LINK_METRIC:
+        case TLV_TYPE_RECEIVER_LINK_METRIC:
+        {
+            INT8U *neighbor_al_mac_address;
 
-            // If we get here, this is a new neighbor and we need to add it to
-            // the list
-            //
-            if (NULL == ret)
+            if (TLV_TYPE_TRANSMITTER_LINK_METRIC == *tlv)
             {
-                ret = (INT8U (*)[6])PLATFORM_MALLOC(sizeof(INT8U[6]));
+                neighbor_al_mac_address = ((struct transmitterLinkMetricTLV *)tlv)->neighbor_al_address;
             }
             else
             {
-                ret = (INT8U (*)[6])PLATFORM_REALLOC(ret, sizeof(INT8U[6])*(total + 1));
+                neighbor_al_mac_address = ((struct receiverLinkMetricTLV *)tlv)->neighbor_al_address;
             }
-            PLATFORM_MEMCPY(&ret[total], data_model.local_interfaces[i].neighbors[j].al_mac_address, 6);
-
-            total++;
-        }
-    }
-
-    *al_mac_addresses_nr = total;
-
-    return ret;
-}
-
-INT8U (*DMgetListOfLinksWithNeighbor(INT8U *neighbor_al_mac_address, char ***interfaces, INT8U *links_nr))[6]
-{
-    INT8U i, j, k;
-    INT8U total;
-
-    INT8U (*ret)[6];
-    char  **intfs;
-
-    total = 0;
-    ret   = NULL;
-    intfs = NULL;
 
-    for (i=0; i<data_model.local_interfaces_nr; i++)
-    {
-        for (j=0; j<data_model.local_interfaces[i].neighbors_nr; j++)
-        {
-            // Filter neighbor (we are just interested in
-            // 'neighbor_al_mac_address')
-            //
-            if (0 != PLATFORM_MEMCMP(neighbor_al_mac_address, data_model.local_interfaces[i].neighbors[j].al_mac_address, 6))
+            for (j=0; j<x->metrics_with_neighbors_nr; j++)
             {
-                continue;
+                if (0 == PLATFORM_MEMCMP(x->metrics_with_neighbors[j].neighbor_al_mac_address, neighbor_al_mac_address, 6))
+                {
+                    break;
+                }
             }
-
-            for (k=0; k<data_model.local_interfaces[i].neighbors[j].remote_interfaces_nr; k++)
+            if (j == x->metrics_with_neighbors_nr)
             {
-                // This is a new link between the local AL and the remote AL.
-                // Add it.
-                //
-                if (NULL == ret)
+                if (0 == x->metrics_with_neighbors_nr)
                 {
-                    ret   = (INT8U (*)[6])PLATFORM_MALLOC(sizeof(INT8U[6]));
-                    intfs = (char **)PLATFORM_MALLOC(sizeof(char *));
+                    x->metrics_with_neighbors = (struct _metricsWithNeighbor *)PLATFORM_MALLOC(sizeof(struct _metricsWithNeighbor));
                 }
                 else
                 {
-                    ret   = (INT8U (*)[6])PLATFORM_REALLOC(ret, sizeof(INT8U[6])*(total + 1));
-                    intfs = (char **)PLATFORM_REALLOC(intfs, sizeof(char *)*(total + 1));
+                    x->metrics_with_neighbors = (struct _metricsWithNeighbor *)PLATFORM_REALLOC(x->metrics_with_neighbors, sizeof(struct _metricsWithNeighbor)*(x->metrics_with_neighbors_nr+1));
                 }
-                PLATFORM_MEMCPY(&ret[total], data_model.local_interfaces[i].neighbors[j].remote_interfaces[k].mac_address, 6);
-                intfs[total] = data_model.local_interfaces[i].name;
+                PLATFORM_MEMSET(&x->metrics_with_neighbors[j], 0x0, sizeof(struct _metricsWithNeighbor));
+                PLATFORM_MEMCPY(x->metrics_with_neighbors[j].neighbor_al_mac_address, neighbor_al_mac_address, 6);
+                x->metrics_with_neighbors_nr++;
+            }
 
-                total++;
+            if (TLV_TYPE_TRANSMITTER_LINK_METRIC == *tlv)
+            {
+                free_1905_TLV_structure((INT8U *)x->metrics_with_neighbors[j].tx_metrics);
+                x->metrics_with_neighbors[j].tx_metrics_timestamp = x->update_timestamp;
+                x->metrics_with_neighbors[j].tx_metrics           = (struct transmitterLinkMetricTLV *)tlv;
             }
+            else
+            {
+                free_1905_TLV_structure((INT8U *)x->metrics_with_neighbors[j].rx_metrics);
+                x->metrics_with_neighbors[j].rx_metrics_timestamp = x->update_timestamp;
+                x->metrics_with_neighbors[j].rx_metrics           = (struct receiverLinkMetricTLV *)tlv;
+            }
+            break;
+        }
+        default:
+        {
+            PLATFORM_PRINTF_DEBUG_WARNING("Unexpected TLV (type = %d) in data model snapshot. Ignoring...\n", *tlv);
+            free_1905_TLV_structure(tlv);
+            break;
         }
     }
-
-    *links_nr   = total;
-    *interfaces = intfs;
-
-    return ret;
 }
 
-void DMfreeListOfLinksWithNeighbor(INT8U (*p)[6], char **interfaces, INT8U links_nr)
+// Restore the data model from the contents of a snapshot.
+//
+// Returns '0' if the snapshot is not valid. Note that, in this case, whatever
+// was restored before the problem was detected is still there (see
+// "_snapshotDiscard()").
+//
+static INT8U _snapshotParse(INT8U *buffer, INT32U len)
 {
-    if (0 == links_nr)
-    {
-        return;
-    }
-
-    if (NULL != interfaces)
-    {
-        PLATFORM_FREE(interfaces);
-    }
-
-    if (NULL != p)
-    {
-        PLATFORM_FREE(p);
-    }
+    INT8U  *p;
+    INT8U  *end;
 
-    return;
-}
+    INT8U   version;
+    INT32U  total_len;
+    INT8U   al_mac_address[6];
+    INT8U   interfaces_nr;
+    INT8U   devices_nr;
 
+    INT8U   i, j, k;
 
-INT8U DMupdateDiscoveryTimeStamps(INT8U *receiving_interface_addr, INT8U *al_mac_address, INT8U *mac_address, INT8U timestamp_type, INT32U *ellapsed)
-{
-    char  *receiving_interface_name;
+    // Returns '1' if there are at least 'n' more bytes available
+    //
+    #define SNAPSHOT_AVAILABLE(n) ((INT32U)(end - p) >= (INT32U)(n))
 
-    struct _remoteInterface *x;
+    p   = buffer;
+    end = buffer + len;
 
-    INT32U aux1, aux2;
-    INT8U  insert_result;
-    INT8U  ret;
+    if (!SNAPSHOT_AVAILABLE(4+1+4+6) || 0 != PLATFORM_MEMCMP(p, DATAMODEL_SNAPSHOT_MAGIC, 4))
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("Invalid data model snapshot (bad magic)\n");
+        return 0;
+    }
+    p += 4;
 
-    ret = 2;
+    _E1B(&p, &version);
+    _E4B(&p, &total_len);
+    _EnB(&p, al_mac_address, 6);
 
-    if (NULL == receiving_interface_addr)
+    if (DATAMODEL_SNAPSHOT_VERSION != version)
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("Invalid 'receiving_interface_addr'\n");
+        PLATFORM_PRINTF_DEBUG_WARNING("Unsupported data model snapshot version (%d)\n", version);
         return 0;
     }
-
-    if (NULL == (receiving_interface_name = DMmacToInterfaceName(receiving_interface_addr)))
+    if (total_len != len)
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("The provided 'receiving_interface_addr' (%02x:%02x:%02x:%02x:%02x:%02x) does not match any local interface\n", receiving_interface_addr[0], receiving_interface_addr[1], receiving_interface_addr[2], receiving_interface_addr[3], receiving_interface_addr[4], receiving_interface_addr[5]);
+        PLATFORM_PRINTF_DEBUG_WARNING("Truncated data model snapshot (%d bytes, expected %d)\n", len, total_len);
         return 0;
     }
-
-    if (
-         0 == (insert_result = _insertNeighbor(receiving_interface_name, al_mac_address)) ||
-         0 == _insertNeighborInterface(receiving_interface_name, al_mac_address, mac_address)
-       )
+    if (0 != PLATFORM_MEMCMP(al_mac_address, data_model.al_mac_address, 6))
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("Could not create new entries in the database\n");
+        PLATFORM_PRINTF_DEBUG_WARNING("Data model snapshot belongs to a different AL MAC address. Ignoring...\n");
         return 0;
     }
 
-    if (1 == insert_result)
+    // Local interfaces and their neighbors
+    //
+    if (!SNAPSHOT_AVAILABLE(1))
     {
-        // This is the first time we know of this neighbor (ie. the neighbor
-        // has been inserted in the data model for the first time)
-        //
-        ret = 1;
+        return 0;
     }
+    _E1B(&p, &interfaces_nr);
 
-    x = _macAddressToRemoteInterfaceStruct(receiving_interface_name, al_mac_address, mac_address);
+    for (i=0; i<interfaces_nr; i++)
+    {
+        INT8U  name_len;
+        char   name[256];
+        INT8U  mac_address[6];
+        INT8U  neighbors_nr;
+        INT8U  interface_id;
 
-    PLATFORM_PRINTF_DEBUG_DETAIL("New discovery timestamp udpate:\n");
-    PLATFORM_PRINTF_DEBUG_DETAIL("  - local_interface      : %s\n", receiving_interface_name);
-    PLATFORM_PRINTF_DEBUG_DETAIL("  - 1905 neighbor AL MAC : %02x:%02x:%02x:%02x:%02x:%02x:\n", al_mac_address[0], al_mac_address[1], al_mac_address[2], al_mac_address[3], al_mac_address[4], al_mac_address[5]);
-    PLATFORM_PRINTF_DEBUG_DETAIL("  - remote interface MAC : %02x:%02x:%02x:%02x:%02x:%02x:\n", mac_address[0],    mac_address[1],    mac_address[2],    mac_address[3],    mac_address[4],    mac_address[5]);
+        if (!SNAPSHOT_AVAILABLE(1))
+        {
+            return 0;
+        }
+        _E1B(&p, &name_len);
 
-    aux1 = x->last_topology_discovery_ts;
-    aux2 = x->last_bridge_discovery_ts;
+        if (!SNAPSHOT_AVAILABLE(name_len+6+1))
+        {
+            return 0;
+        }
+        _EnB(&p, name, name_len);
+        name[name_len] = 0x0;
+        _EnB(&p, mac_address, 6);
+        _E1B(&p, &neighbors_nr);
 
-    switch (timestamp_type)
-    {
-        case TIMESTAMP_TOPOLOGY_DISCOVERY:
+        // Only restore neighbors of interfaces which are still present (and
+        // have the same MAC address)
+        //
+        interface_id = _nameToInterfaceId(name);
+        if (INVALID_INTERFACE_ID != interface_id && 0 != PLATFORM_MEMCMP(data_model.local_interfaces.mac_addresses[interface_id], mac_address, 6))
         {
-            INT32U aux;
+            interface_id = INVALID_INTERFACE_ID;
+        }
 
-            aux = PLATFORM_GET_TIMESTAMP();
+        for (j=0; j<neighbors_nr; j++)
+        {
+            INT8U  neighbor_al_mac_address[6];
+            INT8U  remote_interfaces_nr;
+            INT16U neighbor_id;
+            INT16U remote_interface_id;
 
-            if (NULL != ellapsed)
+            if (!SNAPSHOT_AVAILABLE(6+1))
             {
-                if (2 == ret)
-                {
-                    *ellapsed = aux - x->last_topology_discovery_ts;
-                }
-                else
-                {
-                    *ellapsed = 0;
-                }
+                return 0;
             }
+            _EnB(&p, neighbor_al_mac_address, 6);
+            _E1B(&p, &remote_interfaces_nr);
 
-            x->last_topology_discovery_ts = aux;
-            break;
-        }
-        case TIMESTAMP_BRIDGE_DISCOVERY:
-        {
-            INT32U aux;
+            if (!SNAPSHOT_AVAILABLE(6*remote_interfaces_nr))
+            {
+                return 0;
+            }
 
-            aux = PLATFORM_GET_TIMESTAMP();
+            neighbor_id = INVALID_ID;
+            if (INVALID_INTERFACE_ID != interface_id)
+            {
+                _insertNeighbor(interface_id, neighbor_al_mac_address, &neighbor_id);
+            }
 
-            if (NULL != ellapsed)
+            for (k=0; k<remote_interfaces_nr; k++)
             {
-                if (2 == ret)
+                INT8U remote_mac_address[6];
+
+                _EnB(&p, remote_mac_address, 6);
+
+                if (INVALID_ID != neighbor_id)
                 {
-                    *ellapsed = aux - x->last_bridge_discovery_ts;
-                }
-                else
-                {    
-                    *ellapsed = 0;
+                    _insertNeighborInterface(neighbor_id, remote_mac_address, &remote_interface_id);
                 }
             }
-            x->last_bridge_discovery_ts = aux;
-            break;
         }
-        default:
+    }
+
+    // Network devices
+    //
+    if (!SNAPSHOT_AVAILABLE(1))
+    {
+        return 0;
+    }
+    _E1B(&p, &devices_nr);
+
+    for (i=0; i<devices_nr; i++)
+    {
+        INT16U  tlvs_nr;
+        INT16U  t;
+
+        struct _networkDevice *x;
+
+        if (!SNAPSHOT_AVAILABLE(2))
         {
-            PLATFORM_PRINTF_DEBUG_ERROR("Unknown 'timestamp_type' (%d)\n", timestamp_type);
-            
             return 0;
         }
-    }
+        _E2B(&p, &tlvs_nr);
 
-    PLATFORM_PRINTF_DEBUG_DETAIL("  - topology disc TS     : %d --> %d\n",aux1, x->last_topology_discovery_ts);
-    PLATFORM_PRINTF_DEBUG_DETAIL("  - bridge   disc TS     : %d --> %d\n",aux2, x->last_bridge_discovery_ts);
+        x = NULL;
+        for (t=0; t<tlvs_nr; t++)
+        {
+            INT16U  tlv_len;
+            INT8U  *tlv;
 
-    return ret;
-}
+            // Each TLV is "type (1 byte) + length (2 bytes) + value". Make sure
+            // it fits before handing it to the parser.
+            //
+            if (!SNAPSHOT_AVAILABLE(3))
+            {
+                return 0;
+            }
+            tlv_len = (p[1] << 8) | p[2];
+            if (!SNAPSHOT_AVAILABLE(3+tlv_len))
+            {
+                return 0;
+            }
 
-INT8U DMisLinkBridged(char *local_interface_name, INT8U *neighbor_al_mac_address, INT8U *neighbor_mac_address)
-{
-    struct _remoteInterface *x;
+            tlv  = parse_1905_TLV_from_packet(p);
+            p   += 3+tlv_len;
 
-    INT32U aux;
+            if (NULL == tlv)
+            {
+                continue;
+            }
 
-    if (NULL == (x = _macAddressToRemoteInterfaceStruct(local_interface_name, neighbor_al_mac_address, neighbor_mac_address)))
-    {
-        // Non existent neighbor
-        //
-        return 2;
-    }
+            if (0 == t)
+            {
+                // The first TLV must be the "device information" one, which is
+                // used to create the new device entry
+                //
+                struct deviceInformationTypeTLV *info;
 
+                info = (struct deviceInformationTypeTLV *)tlv;
 
-    if (x->last_topology_discovery_ts > x->last_bridge_discovery_ts)
-    {
-        aux = x->last_topology_discovery_ts - x->last_bridge_discovery_ts;
-    }
-    else
-    {
-        aux = x->last_bridge_discovery_ts   - x->last_topology_discovery_ts;
+                if (TLV_TYPE_DEVICE_INFORMATION_TYPE != *tlv || 0 == PLATFORM_MEMCMP(info->al_mac_address, data_model.al_mac_address, 6) || 255 == data_model.network_devices_nr)
+                {
+                    free_1905_TLV_structure(tlv);
+                    continue;
+                }
+
+                data_model.network_devices = (struct _networkDevice *)PLATFORM_REALLOC(data_model.network_devices, sizeof(struct _networkDevice)*(data_model.network_devices_nr+1));
+
+                x = &data_model.network_devices[data_model.network_devices_nr];
+                PLATFORM_MEMSET(x, 0x0, sizeof(struct _networkDevice));
+
+                x->update_timestamp = PLATFORM_GET_TIMESTAMP();
+                x->stale            = 1;
+                x->generation       = ++data_model.generation;
+                x->info             = info;
+
+                data_model.network_devices_nr++;
+            }
+            else if (NULL == x)
+            {
+                // The device entry was not created. Ignore the rest of its TLVs
+                //
+                free_1905_TLV_structure(tlv);
+            }
+            else
+            {
+                _snapshotAttachTLV(x, tlv);
+            }
+        }
     }
 
-    if (aux < DISCOVERY_THRESHOLD_MS)
+    return 1;
+}
+
+// Free a list of TLVs (such as 'bridges', 'non1905_neighbors', ...)
+//
+static void _snapshotFreeTLVList(INT8U **list, INT8U list_nr)
+{
+    INT8U i;
+
+    for (i=0; i<list_nr; i++)
     {
-        // Links is *not* bridged
-        //
-        return 0;
+        free_1905_TLV_structure(list[i]);
     }
-    else
+    if (NULL != list)
     {
-        // Link is bridged
-        //
-        return 1;
+        PLATFORM_FREE(list);
     }
 }
 
-INT8U DMisNeighborBridged(char *local_interface_name, INT8U *neighbor_al_mac_address)
+// Undo a snapshot that "_snapshotParse()" rejected half way through: free all
+// neighbors, remote interfaces and network devices and start over from an
+// empty data model (as "DMinit()" leaves it).
+// The AL MAC address, the registrar, the "map whole network" flag and the
+// local interfaces were set before the snapshot was loaded, thus they are
+// kept.
+//
+static void _snapshotDiscard(void)
 {
-    struct _neighbor *x;
+    INT8U                         al_mac_address[6];
+    INT8U                         registrar_mac_address[6];
+    INT8U                         map_whole_network_flag;
+    INT32U                        local_generation;
+    struct _localInterfacesTable  local_interfaces;
 
-    INT8U i;
+    INT8U i, j;
 
-    if (NULL == (x = _alMacAddressToNeighborStruct(local_interface_name, neighbor_al_mac_address)))
+    for (i=0; i<data_model.network_devices_nr; i++)
     {
-        // Non existent neighbor
-        //
-        return 2;
-    }
+        struct _networkDevice *x;
 
-    for (i=0; i<x->remote_interfaces_nr; i++)
-    {
-        if (1 == DMisLinkBridged(local_interface_name, neighbor_al_mac_address, x->remote_interfaces[i].mac_address))
+        x = &data_model.network_devices[i];
+
+        free_1905_TLV_structure((INT8U *)x->info);
+
+        _snapshotFreeTLVList((INT8U **)x->bridges,           x->bridges_nr);
+        _snapshotFreeTLVList((INT8U **)x->non1905_neighbors, x->non1905_neighbors_nr);
+        _snapshotFreeTLVList((INT8U **)x->x1905_neighbors,   x->x1905_neighbors_nr);
+        _snapshotFreeTLVList((INT8U **)x->power_off,         x->power_off_nr);
+        _snapshotFreeTLVList((INT8U **)x->l2_neighbors,      x->l2_neighbors_nr);
+        _snapshotFreeTLVList((INT8U **)x->extensions,        x->extensions_nr);
+
+        free_1905_TLV_structure((INT8U *)x->generic_phy);
+        free_1905_TLV_structure((INT8U *)x->profile);
+        free_1905_TLV_structure((INT8U *)x->identification);
+        free_1905_TLV_structure((INT8U *)x->control_url);
+        free_1905_TLV_structure((INT8U *)x->ipv4);
+        free_1905_TLV_structure((INT8U *)x->ipv6);
+
+        for (j=0; j<x->metrics_with_neighbors_nr; j++)
         {
-            // If at least one link is bridged, then this neighbor is
-            // considered to be bridged.
-            //
-            return 1;
+            free_1905_TLV_structure((INT8U *)x->metrics_with_neighbors[j].tx_metrics);
+            free_1905_TLV_structure((INT8U *)x->metrics_with_neighbors[j].rx_metrics);
+        }
+        if (NULL != x->metrics_with_neighbors)
+        {
+            PLATFORM_FREE(x->metrics_with_neighbors);
+        }
+
+        if (NULL != x->export_cache)
+        {
+            PLATFORM_FREE(x->export_cache);
         }
     }
+    PLATFORM_FREE(data_model.network_devices);
 
-    // All links are not bridged, thus the neighbor is considered to be not
-    // bridged also.
-    //
-    return 0;
+    PLATFORM_FREE(data_model.neighbors.al_mac_addresses);
+    PLATFORM_FREE(data_model.neighbors.interface_ids);
+
+    PLATFORM_FREE(data_model.remote_interfaces.mac_addresses);
+    PLATFORM_FREE(data_model.remote_interfaces.neighbor_ids);
+    PLATFORM_FREE(data_model.remote_interfaces.last_topology_discovery_ts);
+    PLATFORM_FREE(data_model.remote_interfaces.last_bridge_discovery_ts);
+    PLATFORM_FREE(data_model.remote_interfaces.generations);
+
+    PLATFORM_MEMCPY(al_mac_address,        data_model.al_mac_address,        6);
+    PLATFORM_MEMCPY(registrar_mac_address, data_model.registrar_mac_address, 6);
+    map_whole_network_flag = data_model.map_whole_network_flag;
+    local_generation       = data_model.local_generation;
+    local_interfaces       = data_model.local_interfaces;
+
+    DMinit();
+
+    PLATFORM_MEMCPY(data_model.al_mac_address,        al_mac_address,        6);
+    PLATFORM_MEMCPY(data_model.registrar_mac_address, registrar_mac_address, 6);
+    data_model.map_whole_network_flag = map_whole_network_flag;
+    data_model.local_generation       = local_generation + 1;
+    data_model.local_interfaces       = local_interfaces;
 }
 
-INT8U DMisInterfaceBridged(char *local_interface_name)
+////////////////////////////////////////////////////////////////////////////////
+// API functions (only available to the 1905 core itself, ie. files inside the
+// 'lib1905' folder)
+////////////////////////////////////////////////////////////////////////////////
+
+void DMinit()
 {
-    struct _localInterface *x;
+    data_model.map_whole_network_flag   = 0;
 
-    INT8U i;
+    data_model.registrar_mac_address[0] = 0x00;
+    data_model.registrar_mac_address[1] = 0x00;
+    data_model.registrar_mac_address[2] = 0x00;
+    data_model.registrar_mac_address[3] = 0x00;
+    data_model.registrar_mac_address[4] = 0x00;
+    data_model.registrar_mac_address[5] = 0x00;
+
+    data_model.al_mac_address[0]        = 0x00;
+    data_model.al_mac_address[1]        = 0x00;
+    data_model.al_mac_address[2]        = 0x00;
+    data_model.al_mac_address[3]        = 0x00;
+    data_model.al_mac_address[4]        = 0x00;
+    data_model.al_mac_address[5]        = 0x00;
+
+    data_model.local_interfaces.nr                           = 0;
+    data_model.local_interfaces.names                        = NULL;
+    data_model.local_interfaces.mac_addresses                = NULL;
+
+    data_model.neighbors.nr                                  = 0;
+    data_model.neighbors.size                                = 0;
+    data_model.neighbors.al_mac_addresses                    = NULL;
+    data_model.neighbors.interface_ids                       = NULL;
+
+    data_model.remote_interfaces.nr                          = 0;
+    data_model.remote_interfaces.size                        = 0;
+    data_model.remote_interfaces.mac_addresses               = NULL;
+    data_model.remote_interfaces.neighbor_ids                = NULL;
+    data_model.remote_interfaces.last_topology_discovery_ts  = NULL;
+    data_model.remote_interfaces.last_bridge_discovery_ts    = NULL;
+    data_model.remote_interfaces.generations                 = NULL;
+
+    data_model.generation                                    = 0;
+    data_model.local_generation                              = 0;
+
+    data_model.tombstones_nr                                 = 0;
+    data_model.tombstones_next                               = 0;
+    data_model.tombstones_horizon                            = 0;
 
-    x = _nameToLocalInterfaceStruct(local_interface_name);
-    if (NULL == x)
+    if (0 == PLATFORM_GET_RANDOM_BYTES((INT8U *)&data_model.epoch, sizeof(INT32U)))
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("Invalid local interface name\n");
-        return 2;
+        data_model.epoch = PLATFORM_GET_TIMESTAMP();
     }
-
-    for (i=0; i<x->neighbors_nr; i++)
+    if (0 == data_model.epoch)
     {
-        if (1 == DMisNeighborBridged(local_interface_name, x->neighbors[i].al_mac_address))
-        {
-            // If at least one neighbor is bridged, then this interface is
-            // considered to be bridged.
-            //
-            return 1;
-        }
+        // '0' is what clients send when they have no epoch yet
+        //
+        data_model.epoch = 1;
     }
 
-    // All neighbors are not bridged, thus the interface is considered to be not
-    // bridged also.
+    // Regarding the "network_devices" list, we will init it with one element,
+    // representing the local node
     //
-    return 0;
+    data_model.network_devices_nr       = 1;
+    data_model.network_devices          = (struct _networkDevice *)PLATFORM_MALLOC(sizeof(struct _networkDevice));
+
+    data_model.network_devices[0].update_timestamp          = PLATFORM_GET_TIMESTAMP();
+    data_model.network_devices[0].stale                     = 0;
+    data_model.network_devices[0].generation                = 0;
+    data_model.network_devices[0].info                      = NULL;
+    data_model.network_devices[0].bridges_nr                = 0;
+    data_model.network_devices[0].bridges                   = NULL;
+    data_model.network_devices[0].non1905_neighbors_nr      = 0;
+    data_model.network_devices[0].non1905_neighbors         = NULL;
+    data_model.network_devices[0].x1905_neighbors_nr        = 0;
+    data_model.network_devices[0].x1905_neighbors           = NULL;
+    data_model.network_devices[0].power_off_nr              = 0;
+    data_model.network_devices[0].power_off                 = NULL;
+    data_model.network_devices[0].l2_neighbors_nr           = 0;
+    data_model.network_devices[0].l2_neighbors              = NULL;
+    data_model.network_devices[0].generic_phy               = NULL;
+    data_model.network_devices[0].profile                   = NULL;
+    data_model.network_devices[0].identification            = NULL;
+    data_model.network_devices[0].control_url               = NULL;
+    data_model.network_devices[0].ipv4                      = NULL;
+    data_model.network_devices[0].ipv6                      = NULL;
+    data_model.network_devices[0].metrics_with_neighbors_nr = 0;
+    data_model.network_devices[0].metrics_with_neighbors    = NULL;
+    data_model.network_devices[0].extensions                = NULL;
+    data_model.network_devices[0].extensions_nr             = 0;
+    data_model.network_devices[0].export_cache              = NULL;
+    data_model.network_devices[0].export_cache_len          = 0;
+    data_model.network_devices[0].export_cache_generation   = 0;
+
+    return;
 }
 
+void DMalMacSet(INT8U *al_mac_address)
+{
+    PLATFORM_MEMCPY(data_model.al_mac_address, al_mac_address, 6);
 
+    data_model.local_generation++;
 
-INT8U *DMmacToAlMac(INT8U *mac_address)
+    return;
+}
+
+INT8U *DMalMacGet()
 {
-    INT8U i, j, k;
+    return data_model.al_mac_address;
+}
 
-    INT8U *al_mac;
-    INT8U found;
+void DMregistrarMacSet(INT8U *registrar_mac_address)
+{
+    PLATFORM_MEMCPY(data_model.registrar_mac_address, registrar_mac_address, 6);
 
-    found  = 0;
-    al_mac = (INT8U *)PLATFORM_MALLOC(sizeof(INT8U)*6);
+    return;
+}
 
-    if (0 == PLATFORM_MEMCMP(data_model.al_mac_address, mac_address, 6))
-    {
-        return data_model.al_mac_address;
-    }
-    for (i=0; i<data_model.local_interfaces_nr; i++)
+INT8U *DMregistrarMacGet()
+{
+    return data_model.registrar_mac_address;
+}
+
+void DMmapWholeNetworkSet(INT8U map_whole_network_flag)
+{
+    data_model.map_whole_network_flag =  map_whole_network_flag;
+
+    return;
+}
+
+INT8U DMmapWholeNetworkGet()
+{
+    return data_model.map_whole_network_flag;
+}
+
+INT8U DMinsertInterface(char *name, INT8U *mac_address)
+{
+    struct _localInterfacesTable *t;
+    INT8U                         interface_id;
+
+    t = &data_model.local_interfaces;
+
+    // First, make sure this interface does not already exist
+    //
+    if (INVALID_INTERFACE_ID != (interface_id = _nameToInterfaceId(name)))
     {
-        if (0 == PLATFORM_MEMCMP(data_model.local_interfaces[i].mac_address, mac_address, 6))
+        // The interface exists!
+        //
+        // Even if it already exists, if the provided 'mac_address' and the
+        // already existing entry match, do not return an error.
+        //
+        if (0 == PLATFORM_MEMCMP(t->mac_addresses[interface_id], mac_address, 6))
         {
-            found = 1;
-            PLATFORM_MEMCPY(al_mac, data_model.al_mac_address, 6);
+            // Ok
+            //
+            return 1;
         }
-
-        for (j=0; j<data_model.local_interfaces[i].neighbors_nr; j++)
+        else
         {
-            if (0 == PLATFORM_MEMCMP(data_model.local_interfaces[i].neighbors[j].al_mac_address, mac_address, 6))
-            {
-                found = 1;
-                PLATFORM_MEMCPY(al_mac, data_model.local_interfaces[i].neighbors[j].al_mac_address, 6);
-            }
-
-            for (k=0; k<data_model.local_interfaces[i].neighbors[j].remote_interfaces_nr; k++)
-            {
-                if (0 == PLATFORM_MEMCMP(data_model.local_interfaces[i].neighbors[j].remote_interfaces[k].mac_address, mac_address, 6))
-                {
-                    found = 1;
-                    PLATFORM_MEMCPY(al_mac, data_model.local_interfaces[i].neighbors[j].al_mac_address, 6);
-                }
-            }
+            // Interface exists and its MAC address is different from the
+            // provided one. Maybe the caller should first "remove" this
+            // interface and then try to add the new one.
+            //
+            return 0;
         }
     }
 
-    if (1 == found)
+    if (INVALID_INTERFACE_ID == t->nr)
     {
-        return al_mac;
+        // No more interface ids available
+        //
+        return 0;
+    }
+
+    if (0 == t->nr)
+    {
+        t->names         = (char **)     PLATFORM_MALLOC(sizeof(char *));
+        t->mac_addresses = (INT8U (*)[6])PLATFORM_MALLOC(sizeof(INT8U[6]));
     }
     else
     {
-      // No matching MAC address was found
-      //
-      PLATFORM_FREE(al_mac);
-      return NULL;
+        t->names         = (char **)     PLATFORM_REALLOC(t->names,         sizeof(char *)   * (t->nr + 1));
+        t->mac_addresses = (INT8U (*)[6])PLATFORM_REALLOC(t->mac_addresses, sizeof(INT8U[6]) * (t->nr + 1));
     }
+
+                    t->names[t->nr]        = PLATFORM_STRDUP(name);
+    PLATFORM_MEMCPY(t->mac_addresses[t->nr],  mac_address, 6);
+
+    t->nr++;
+
+    data_model.local_generation++;
+
+    return 1;
 }
 
-INT8U DMupdateNetworkDeviceInfo(INT8U *al_mac_address,
-                                INT8U in_update,  struct deviceInformationTypeTLV             *info, 
-                                INT8U br_update,  struct deviceBridgingCapabilityTLV         **bridges,           INT8U bridges_nr,
-                                INT8U no_update,  struct non1905NeighborDeviceListTLV        **non1905_neighbors, INT8U non1905_neighbors_nr,
-                                INT8U x1_update,  struct neighborDeviceListTLV               **x1905_neighbors,   INT8U x1905_neighbors_nr,
-                                INT8U po_update,  struct powerOffInterfaceTLV                **power_off,         INT8U power_off_nr,
-                                INT8U l2_update,  struct l2NeighborDeviceTLV                 **l2_neighbors,      INT8U l2_neighbors_nr,
-                                INT8U ge_update,  struct genericPhyDeviceInformationTypeTLV   *generic_phy,
-                                INT8U pr_update,  struct x1905ProfileVersionTLV               *profile,
-                                INT8U id_update,  struct deviceIdentificationTypeTLV          *identification,
-                                INT8U co_update,  struct controlUrlTypeTLV                    *control_url,
-                                INT8U v4_update,  struct ipv4TypeTLV                          *ipv4,
-                                INT8U v6_update,  struct ipv6TypeTLV                          *ipv6)
+
+char *DMmacToInterfaceName(INT8U *mac_address)
 {
-    INT8U i,j;
+    INT8U interface_id;
 
-    if (
-         (NULL == al_mac_address)                                                     ||
-         (br_update == 1 && (bridges_nr            > 0 && NULL == bridges)          ) ||
-         (no_update == 1 && (non1905_neighbors_nr  > 0 && NULL == non1905_neighbors)) ||
-         (x1_update == 1 && (x1905_neighbors_nr    > 0 && NULL == x1905_neighbors)  ) ||
-         (po_update == 1 && (power_off_nr          > 0 && NULL == power_off)        ) ||
-         (l2_update == 1 && (l2_neighbors_nr       > 0 && NULL == l2_neighbors)     )
-       )
+    interface_id = _macAddressToInterfaceId(mac_address);
+
+    if (INVALID_INTERFACE_ID != interface_id)
     {
+        return data_model.local_interfaces.names[interface_id];
+    }
+    else
+    {
+        // Not found!
+        //
+        return NULL;
+    }
+}
+
+INT8U *DMinterfaceNameToMac(char *interface_name)
+{
+    INT8U interface_id;
+
+    interface_id = _nameToInterfaceId(interface_name);
+
+    if (INVALID_INTERFACE_ID != interface_id)
+    {
+        return data_model.local_interfaces.mac_addresses[interface_id];
+    }
+    else
+    {
+        // Not found!
+        //
+        return NULL;
+    }
+}
+
+
+INT8U (*DMgetListOfInterfaceNeighbors(char *local_interface_name, INT8U *al_mac_addresses_nr))[6]
+{
+    INT16U i;
+    INT8U  total;
+    INT8U  interface_id;
+    INT8U  (*ret)[6];
+
+    if (INVALID_INTERFACE_ID == (interface_id = _nameToInterfaceId(local_interface_name)))
+    {
+        // Non existent interface
+        //
+        *al_mac_addresses_nr = 0;
+        return NULL;
+    }
+
+    total = 0;
+    ret   = NULL;
+
+    for (i=_firstNeighborId(interface_id); i<data_model.neighbors.nr && interface_id == data_model.neighbors.interface_ids[i]; i++)
+    {
+        if (NULL == ret)
+        {
+            ret = (INT8U (*)[6])PLATFORM_MALLOC(sizeof(INT8U[6]));
+        }
+        else
+        {
+            ret = (INT8U (*)[6])PLATFORM_REALLOC(ret, sizeof(INT8U[6])*(total + 1));
+        }
+        PLATFORM_MEMCPY(&ret[total], data_model.neighbors.al_mac_addresses[i], 6);
+
+        total++;
+    }
+
+    *al_mac_addresses_nr = total;
+    return ret;
+}
+
+INT8U (*DMgetListOfNeighbors(INT8U *al_mac_addresses_nr))[6]
+{
+    INT16U i;
+    INT8U  k;
+
+    INT8U total;
+    INT8U (*ret)[6];
+
+    if (NULL == al_mac_addresses_nr)
+    {
+        return NULL;
+    }
+
+    total = 0;
+    ret   = NULL;
+
+    for (i=0; i<data_model.neighbors.nr; i++)
+    {
+        // Check for duplicates (the same neighbor can be visible from more
+        // than one local interface)
+        //
+        INT8U already_present;
+
+        already_present = 0;
+        for (k=0; k<total; k++)
+        {
+            if (0 == PLATFORM_MEMCMP(&ret[k], data_model.neighbors.al_mac_addresses[i], 6))
+            {
+                already_present = 1;
+                break;
+            }
+        }
+
+        if (1 == already_present)
+        {
+            continue;
+        }
+
+        // If we get here, this is a new neighbor and we need to add it to
+        // the list
+        //
+        if (NULL == ret)
+        {
+            ret = (INT8U (*)[6])PLATFORM_MALLOC(sizeof(INT8U[6]));
+        }
+        else
+        {
+            ret = (INT8U (*)[6])PLATFORM_REALLOC(ret, sizeof(INT8U[6])*(total + 1));
+        }
+        PLATFORM_MEMCPY(&ret[total], data_model.neighbors.al_mac_addresses[i], 6);
+
+        total++;
+    }
+
+    *al_mac_addresses_nr = total;
+
+    return ret;
+}
+
+INT8U (*DMgetListOfLinksWithNeighbor(INT8U *neighbor_al_mac_address, char ***interfaces, INT8U *links_nr))[6]
+{
+    INT16U i;
+    INT16U neighbor_id;
+    INT8U  total;
+
+    INT8U (*ret)[6];
+    char  **intfs;
+
+    total = 0;
+    ret   = NULL;
+    intfs = NULL;
+
+    for (i=0; i<data_model.remote_interfaces.nr; i++)
+    {
+        // Filter neighbor (we are just interested in
+        // 'neighbor_al_mac_address')
+        //
+        neighbor_id = data_model.remote_interfaces.neighbor_ids[i];
+
+        if (0 != PLATFORM_MEMCMP(neighbor_al_mac_address, data_model.neighbors.al_mac_addresses[neighbor_id], 6))
+        {
+            continue;
+        }
+
+        // This is a new link between the local AL and the remote AL.
+        // Add it.
+        //
+        if (NULL == ret)
+        {
+            ret   = (INT8U (*)[6])PLATFORM_MALLOC(sizeof(INT8U[6]));
+            intfs = (char **)PLATFORM_MALLOC(sizeof(char *));
+        }
+        else
+        {
+            ret   = (INT8U (*)[6])PLATFORM_REALLOC(ret, sizeof(INT8U[6])*(total + 1));
+            intfs = (char **)PLATFORM_REALLOC(intfs, sizeof(char *)*(total + 1));
+        }
+        PLATFORM_MEMCPY(&ret[total], data_model.remote_interfaces.mac_addresses[i], 6);
+        intfs[total] = data_model.local_interfaces.names[data_model.neighbors.interface_ids[neighbor_id]];
+
+        total++;
+    }
+
+    *links_nr   = total;
+    *interfaces = intfs;
+
+    return ret;
+}
+
+void DMfreeListOfLinksWithNeighbor(INT8U (*p)[6], char **interfaces, INT8U links_nr)
+{
+    if (0 == links_nr)
+    {
+        return;
+    }
+
+    if (NULL != interfaces)
+    {
+        PLATFORM_FREE(interfaces);
+    }
+
+    if (NULL != p)
+    {
+        PLATFORM_FREE(p);
+    }
+
+    return;
+}
+
+
+// Same as "DMisLinkBridged()", but the link is identified by its remote
+// interface id.
+//
+static INT8U _isRemoteInterfaceBridged(INT16U remote_interface_id)
+{
+    INT32U topology_ts;
+    INT32U bridge_ts;
+    INT32U aux;
+
+    topology_ts = data_model.remote_interfaces.last_topology_discovery_ts[remote_interface_id];
+    bridge_ts   = data_model.remote_interfaces.last_bridge_discovery_ts[remote_interface_id];
+
+    if (topology_ts > bridge_ts)
+    {
+        aux = topology_ts - bridge_ts;
+    }
+    else
+    {
+        aux = bridge_ts   - topology_ts;
+    }
+
+    if (aux < DISCOVERY_THRESHOLD_MS)
+    {
+        // Links is *not* bridged
+        //
+        return 0;
+    }
+    else
+    {
+        // Link is bridged
+        //
+        return 1;
+    }
+}
+
+INT8U DMupdateDiscoveryTimeStamps(INT8U *receiving_interface_addr, INT8U *al_mac_address, INT8U *mac_address, INT8U timestamp_type, INT32U *ellapsed)
+{
+    INT8U   interface_id;
+    INT16U  neighbor_id;
+    INT16U  x;
+
+    INT32U *topology_ts;
+    INT32U *bridge_ts;
+
+    INT32U  aux1, aux2;
+    INT8U   insert_result;
+    INT8U   bridged;
+    INT8U   ret;
+
+    ret = 2;
+
+    if (NULL == receiving_interface_addr)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Invalid 'receiving_interface_addr'\n");
+        return 0;
+    }
+
+    if (INVALID_INTERFACE_ID == (interface_id = _macAddressToInterfaceId(receiving_interface_addr)))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("The provided 'receiving_interface_addr' (%02x:%02x:%02x:%02x:%02x:%02x) does not match any local interface\n", receiving_interface_addr[0], receiving_interface_addr[1], receiving_interface_addr[2], receiving_interface_addr[3], receiving_interface_addr[4], receiving_interface_addr[5]);
+        return 0;
+    }
+
+    if (
+         0 == (insert_result = _insertNeighbor(interface_id, al_mac_address, &neighbor_id)) ||
+         0 == _insertNeighborInterface(neighbor_id, mac_address, &x)
+       )
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Could not create new entries in the database\n");
+        return 0;
+    }
+
+    if (1 == insert_result)
+    {
+        // This is the first time we know of this neighbor (ie. the neighbor
+        // has been inserted in the data model for the first time)
+        //
+        ret = 1;
+    }
+
+    topology_ts = &data_model.remote_interfaces.last_topology_discovery_ts[x];
+    bridge_ts   = &data_model.remote_interfaces.last_bridge_discovery_ts[x];
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("New discovery timestamp udpate:\n");
+    PLATFORM_PRINTF_DEBUG_DETAIL("  - local_interface      : %s\n", data_model.local_interfaces.names[interface_id]);
+    PLATFORM_PRINTF_DEBUG_DETAIL("  - 1905 neighbor AL MAC : %02x:%02x:%02x:%02x:%02x:%02x:\n", al_mac_address[0], al_mac_address[1], al_mac_address[2], al_mac_address[3], al_mac_address[4], al_mac_address[5]);
+    PLATFORM_PRINTF_DEBUG_DETAIL("  - remote interface MAC : %02x:%02x:%02x:%02x:%02x:%02x:\n", mac_address[0],    mac_address[1],    mac_address[2],    mac_address[3],    mac_address[4],    mac_address[5]);
+
+    aux1 = *topology_ts;
+    aux2 = *bridge_ts;
+
+    bridged = _isRemoteInterfaceBridged(x);
+
+    switch (timestamp_type)
+    {
+        case TIMESTAMP_TOPOLOGY_DISCOVERY:
+        {
+            INT32U aux;
+
+            aux = PLATFORM_GET_TIMESTAMP();
+
+            if (NULL != ellapsed)
+            {
+                if (2 == ret)
+                {
+                    *ellapsed = aux - *topology_ts;
+                }
+                else
+                {
+                    *ellapsed = 0;
+                }
+            }
+
+            *topology_ts = aux;
+            break;
+        }
+        case TIMESTAMP_BRIDGE_DISCOVERY:
+        {
+            INT32U aux;
+
+            aux = PLATFORM_GET_TIMESTAMP();
+
+            if (NULL != ellapsed)
+            {
+                if (2 == ret)
+                {
+                    *ellapsed = aux - *bridge_ts;
+                }
+                else
+                {    
+                    *ellapsed = 0;
+                }
+            }
+            *bridge_ts = aux;
+            break;
+        }
+        default:
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("Unknown 'timestamp_type' (%d)\n", timestamp_type);
+            
+            return 0;
+        }
+    }
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("  - topology disc TS     : %d --> %d\n",aux1, *topology_ts);
+    PLATFORM_PRINTF_DEBUG_DETAIL("  - bridge   disc TS     : %d --> %d\n",aux2, *bridge_ts);
+
+    if (bridged != _isRemoteInterfaceBridged(x))
+    {
+        // The link (and maybe the neighbor) has just become bridged (or
+        // stopped being bridged)
+        //
+        data_model.remote_interfaces.generations[x] = ++data_model.generation;
+        data_model.local_generation++;
+    }
+
+    return ret;
+}
+
+// Same as "DMisNeighborBridged()", but the neighbor is identified by its
+// neighbor id.
+//
+static INT8U _isNeighborBridged(INT16U neighbor_id)
+{
+    INT16U i;
+
+    for (i=_firstRemoteInterfaceId(neighbor_id); i<data_model.remote_interfaces.nr && neighbor_id == data_model.remote_interfaces.neighbor_ids[i]; i++)
+    {
+        if (1 == _isRemoteInterfaceBridged(i))
+        {
+            // If at least one link is bridged, then this neighbor is
+            // considered to be bridged.
+            //
+            return 1;
+        }
+    }
+
+    // All links are not bridged, thus the neighbor is considered to be not
+    // bridged also.
+    //
+    return 0;
+}
+
+INT8U DMisLinkBridged(char *local_interface_name, INT8U *neighbor_al_mac_address, INT8U *neighbor_mac_address)
+{
+    INT16U x;
+
+    if (INVALID_ID == (x = _linkToRemoteInterfaceId(local_interface_name, neighbor_al_mac_address, neighbor_mac_address)))
+    {
+        // Non existent neighbor
+        //
+        return 2;
+    }
+
+    return _isRemoteInterfaceBridged(x);
+}
+
+INT8U DMisNeighborBridged(char *local_interface_name, INT8U *neighbor_al_mac_address)
+{
+    INT16U x;
+
+    if (INVALID_ID == (x = _alMacAddressToNeighborId(_nameToInterfaceId(local_interface_name), neighbor_al_mac_address)))
+    {
+        // Non existent neighbor
+        //
+        return 2;
+    }
+
+    return _isNeighborBridged(x);
+}
+
+INT8U DMisInterfaceBridged(char *local_interface_name)
+{
+    INT8U  interface_id;
+    INT16U i;
+
+    interface_id = _nameToInterfaceId(local_interface_name);
+    if (INVALID_INTERFACE_ID == interface_id)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Invalid local interface name\n");
+        return 2;
+    }
+
+    for (i=_firstNeighborId(interface_id); i<data_model.neighbors.nr && interface_id == data_model.neighbors.interface_ids[i]; i++)
+    {
+        if (1 == _isNeighborBridged(i))
+        {
+            // If at least one neighbor is bridged, then this interface is
+            // considered to be bridged.
+            //
+            return 1;
+        }
+    }
+
+    // All neighbors are not bridged, thus the interface is considered to be not
+    // bridged also.
+    //
+    return 0;
+}
+
+
+
+INT8U *DMmacToAlMac(INT8U *mac_address)
+{
+    INT16U i;
+
+    INT8U *al_mac;
+    INT8U found;
+
+    found  = 0;
+    al_mac = (INT8U *)PLATFORM_MALLOC(sizeof(INT8U)*6);
+
+    if (0 == PLATFORM_MEMCMP(data_model.al_mac_address, mac_address, 6))
+    {
+        // Return a copy (and not the data model buffer itself), as the caller
+        // is going to free it
+        //
+        PLATFORM_MEMCPY(al_mac, data_model.al_mac_address, 6);
+        return al_mac;
+    }
+    if (INVALID_INTERFACE_ID != _macAddressToInterfaceId(mac_address))
+    {
+        found = 1;
+        PLATFORM_MEMCPY(al_mac, data_model.al_mac_address, 6);
+    }
+
+    for (i=0; i<data_model.neighbors.nr; i++)
+    {
+        if (0 == PLATFORM_MEMCMP(data_model.neighbors.al_mac_addresses[i], mac_address, 6))
+        {
+            found = 1;
+            PLATFORM_MEMCPY(al_mac, data_model.neighbors.al_mac_addresses[i], 6);
+        }
+    }
+
+    for (i=0; i<data_model.remote_interfaces.nr; i++)
+    {
+        if (0 == PLATFORM_MEMCMP(data_model.remote_interfaces.mac_addresses[i], mac_address, 6))
+        {
+            found = 1;
+            PLATFORM_MEMCPY(al_mac, data_model.neighbors.al_mac_addresses[data_model.remote_interfaces.neighbor_ids[i]], 6);
+        }
+    }
+
+    if (1 == found)
+    {
+        return al_mac;
+    }
+    else
+    {
+      // No matching MAC address was found
+      //
+      PLATFORM_FREE(al_mac);
+      return NULL;
+    }
+}
+
+INT32U DMlocalGenerationGet(void)
+{
+    return data_model.local_generation;
+}
+
+// Return '1' if the contents of 'new_tlv' differ from those of 'old_tlv' (any
+// of them can be NULL), '0' otherwise.
+//
+static INT8U _tlvChanged(INT8U *old_tlv, INT8U *new_tlv)
+{
+    if (NULL == old_tlv || NULL == new_tlv)
+    {
+        return old_tlv == new_tlv ? 0 : 1;
+    }
+
+    return 0 == compare_1905_TLV_structures(old_tlv, new_tlv) ? 0 : 1;
+}
+
+// Same as "_tlvChanged()" but for lists of TLVs
+//
+static INT8U _tlvListChanged(INT8U **old_list, INT8U old_nr, INT8U **new_list, INT8U new_nr)
+{
+    INT8U i;
+
+    if (old_nr != new_nr)
+    {
+        return 1;
+    }
+
+    for (i=0; i<new_nr; i++)
+    {
+        if (1 == _tlvChanged(old_list[i], new_list[i]))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+INT8U DMupdateNetworkDeviceInfo(INT8U *al_mac_address,
+                                INT8U in_update,  struct deviceInformationTypeTLV             *info, 
+                                INT8U br_update,  struct deviceBridgingCapabilityTLV         **bridges,           INT8U bridges_nr,
+                                INT8U no_update,  struct non1905NeighborDeviceListTLV        **non1905_neighbors, INT8U non1905_neighbors_nr,
+                                INT8U x1_update,  struct neighborDeviceListTLV               **x1905_neighbors,   INT8U x1905_neighbors_nr,
+                                INT8U po_update,  struct powerOffInterfaceTLV                **power_off,         INT8U power_off_nr,
+                                INT8U l2_update,  struct l2NeighborDeviceTLV                 **l2_neighbors,      INT8U l2_neighbors_nr,
+                                INT8U ge_update,  struct genericPhyDeviceInformationTypeTLV   *generic_phy,
+                                INT8U pr_update,  struct x1905ProfileVersionTLV               *profile,
+                                INT8U id_update,  struct deviceIdentificationTypeTLV          *identification,
+                                INT8U co_update,  struct controlUrlTypeTLV                    *control_url,
+                                INT8U v4_update,  struct ipv4TypeTLV                          *ipv4,
+                                INT8U v6_update,  struct ipv6TypeTLV                          *ipv6)
+{
+    INT8U i,j;
+    INT8U changed;
+
+    if (
+         (NULL == al_mac_address)                                                     ||
+         (br_update == 1 && (bridges_nr            > 0 && NULL == bridges)          ) ||
+         (no_update == 1 && (non1905_neighbors_nr  > 0 && NULL == non1905_neighbors)) ||
+         (x1_update == 1 && (x1905_neighbors_nr    > 0 && NULL == x1905_neighbors)  ) ||
+         (po_update == 1 && (power_off_nr          > 0 && NULL == power_off)        ) ||
+         (l2_update == 1 && (l2_neighbors_nr       > 0 && NULL == l2_neighbors)     )
+       )
+    {
+        return 0;
+    }
+
+    // First, search for an existing entry with the same AL MAC address
+    // Remember that the first entry holds a reference to the *local* node.
+    //
+    if (0 == PLATFORM_MEMCMP(DMalMacGet(), al_mac_address, 6))
+    {
+        i=0;
+    }
+    else
+    {
+        for (i=1; i<data_model.network_devices_nr; i++)
+        {
+            if (NULL != data_model.network_devices[i].info)
+            {
+                if (0 == PLATFORM_MEMCMP(data_model.network_devices[i].info->al_mac_address, al_mac_address, 6))
+                {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (i == data_model.network_devices_nr)
+    {
+        // A matching entry was *not* found. Create a new one, but only if this
+        // new information contains the "info" TLV (otherwise don't do anything
+        // and wait for the "info" TLV to be received in the future)
+        //
+        if (1 == in_update && NULL != info)
+        {
+            if (0 == data_model.network_devices_nr)
+            {
+                data_model.network_devices = (struct _networkDevice *)PLATFORM_MALLOC(sizeof(struct _networkDevice));
+            }
+            else
+            {
+                data_model.network_devices = (struct _networkDevice *)PLATFORM_REALLOC(data_model.network_devices, sizeof(struct _networkDevice)*(data_model.network_devices_nr+1));
+            }
+
+            data_model.network_devices[data_model.network_devices_nr].update_timestamp          = PLATFORM_GET_TIMESTAMP();
+            data_model.network_devices[data_model.network_devices_nr].stale                     = 0;
+            data_model.network_devices[data_model.network_devices_nr].generation                = ++data_model.generation;
+            data_model.network_devices[data_model.network_devices_nr].info                      = 1 == in_update ? info                 : NULL;
+            data_model.network_devices[data_model.network_devices_nr].bridges_nr                = 1 == br_update ? bridges_nr           : 0;
+            data_model.network_devices[data_model.network_devices_nr].bridges                   = 1 == br_update ? bridges              : NULL;
+            data_model.network_devices[data_model.network_devices_nr].non1905_neighbors_nr      = 1 == no_update ? non1905_neighbors_nr : 0;
+            data_model.network_devices[data_model.network_devices_nr].non1905_neighbors         = 1 == no_update ? non1905_neighbors    : NULL;
+            data_model.network_devices[data_model.network_devices_nr].x1905_neighbors_nr        = 1 == x1_update ? x1905_neighbors_nr   : 0;
+            data_model.network_devices[data_model.network_devices_nr].x1905_neighbors           = 1 == x1_update ? x1905_neighbors      : NULL;
+            data_model.network_devices[data_model.network_devices_nr].power_off_nr              = 1 == po_update ? power_off_nr         : 0;
+            data_model.network_devices[data_model.network_devices_nr].power_off                 = 1 == po_update ? power_off            : NULL;
+            data_model.network_devices[data_model.network_devices_nr].l2_neighbors_nr           = 1 == l2_update ? l2_neighbors_nr      : 0;
+            data_model.network_devices[data_model.network_devices_nr].l2_neighbors              = 1 == l2_update ? l2_neighbors         : NULL;
+            data_model.network_devices[data_model.network_devices_nr].generic_phy               = 1 == ge_update ? generic_phy          : NULL;
+            data_model.network_devices[data_model.network_devices_nr].profile                   = 1 == pr_update ? profile              : NULL;
+            data_model.network_devices[data_model.network_devices_nr].identification            = 1 == id_update ? identification       : NULL;
+            data_model.network_devices[data_model.network_devices_nr].control_url               = 1 == co_update ? control_url          : NULL;
+            data_model.network_devices[data_model.network_devices_nr].ipv4                      = 1 == v4_update ? ipv4                 : NULL;
+            data_model.network_devices[data_model.network_devices_nr].ipv6                      = 1 == v6_update ? ipv6                 : NULL;
+
+            data_model.network_devices[data_model.network_devices_nr].metrics_with_neighbors_nr = 0;
+            data_model.network_devices[data_model.network_devices_nr].metrics_with_neighbors    = NULL;
+
+            data_model.network_devices[data_model.network_devices_nr].extensions                = NULL;
+            data_model.network_devices[data_model.network_devices_nr].extensions_nr             = 0;
+
+            data_model.network_devices[data_model.network_devices_nr].export_cache              = NULL;
+            data_model.network_devices[data_model.network_devices_nr].export_cache_len          = 0;
+            data_model.network_devices[data_model.network_devices_nr].export_cache_generation   = 0;
+
+            data_model.network_devices_nr++;
+
+            EVdeviceChanged(al_mac_address, data_model.generation);
+        }
+    }
+    else
+    {
+        // A matching entry was found. Update it. But first, free the old TLV
+        // structures (but only if a new value was provided!... otherwise retain
+        // the old item)
+        //
+        // Devices are periodically queried even when nothing has changed, thus
+        // the new TLVs are compared against the old ones to find out whether
+        // the entry really needs a new generation.
+        //
+        struct _networkDevice *x;
+
+        x = &data_model.network_devices[i];
+
+        changed = x->stale;
+
+        if (
+             (NULL != info      && _tlvChanged((INT8U *)x->info,           (INT8U *)info))                                                                     ||
+             (1 == br_update    && _tlvListChanged((INT8U **)x->bridges,           x->bridges_nr,           (INT8U **)bridges,           bridges_nr))           ||
+             (1 == no_update    && _tlvListChanged((INT8U **)x->non1905_neighbors, x->non1905_neighbors_nr, (INT8U **)non1905_neighbors, non1905_neighbors_nr)) ||
+             (1 == x1_update    && _tlvListChanged((INT8U **)x->x1905_neighbors,   x->x1905_neighbors_nr,   (INT8U **)x1905_neighbors,   x1905_neighbors_nr))   ||
+             (1 == po_update    && _tlvListChanged((INT8U **)x->power_off,         x->power_off_nr,         (INT8U **)power_off,         power_off_nr))         ||
+             (1 == l2_update    && _tlvListChanged((INT8U **)x->l2_neighbors,      x->l2_neighbors_nr,      (INT8U **)l2_neighbors,      l2_neighbors_nr))      ||
+             (1 == ge_update    && _tlvChanged((INT8U *)x->generic_phy,    (INT8U *)generic_phy))                                                              ||
+             (1 == pr_update    && _tlvChanged((INT8U *)x->profile,        (INT8U *)profile))                                                                  ||
+             (1 == id_update    && _tlvChanged((INT8U *)x->identification, (INT8U *)identification))                                                           ||
+             (1 == co_update    && _tlvChanged((INT8U *)x->control_url,    (INT8U *)control_url))                                                              ||
+             (1 == v4_update    && _tlvChanged((INT8U *)x->ipv4,           (INT8U *)ipv4))                                                                     ||
+             (1 == v6_update    && _tlvChanged((INT8U *)x->ipv6,           (INT8U *)ipv6))
+           )
+        {
+            changed = 1;
+        }
+
+        if (1 == changed)
+        {
+            x->generation = ++data_model.generation;
+        }
+
+        data_model.network_devices[i].update_timestamp = PLATFORM_GET_TIMESTAMP();
+        data_model.network_devices[i].stale            = 0;
+
+        if (NULL != info)
+        {
+            if (NULL != data_model.network_devices[i].info)
+            {
+                free_1905_TLV_structure((INT8U *)data_model.network_devices[i].info);
+            }
+            data_model.network_devices[i].info = info;
+        }
+
+        if (1 == br_update)
+        {
+            for (j=0; j<data_model.network_devices[i].bridges_nr; j++)
+            {
+                free_1905_TLV_structure((INT8U *)data_model.network_devices[i].bridges[j]);
+            }
+            if (data_model.network_devices[i].bridges_nr > 0 && NULL != data_model.network_devices[i].bridges)
+            {
+                PLATFORM_FREE(data_model.network_devices[i].bridges);
+            }
+            data_model.network_devices[i].bridges_nr = bridges_nr;
+            data_model.network_devices[i].bridges    = bridges;
+        }
+
+        if (1 == no_update)
+        {
+            for (j=0; j<data_model.network_devices[i].non1905_neighbors_nr; j++)
+            {
+                free_1905_TLV_structure((INT8U *)data_model.network_devices[i].non1905_neighbors[j]);
+            }
+            if (data_model.network_devices[i].non1905_neighbors_nr > 0 && NULL != data_model.network_devices[i].non1905_neighbors)
+            {
+                PLATFORM_FREE(data_model.network_devices[i].non1905_neighbors);
+            }
+            data_model.network_devices[i].non1905_neighbors_nr = non1905_neighbors_nr;
+            data_model.network_devices[i].non1905_neighbors    = non1905_neighbors;
+        }
+
+        if (1 == x1_update)
+        {
+            for (j=0; j<data_model.network_devices[i].x1905_neighbors_nr; j++)
+            {
+                free_1905_TLV_structure((INT8U *)data_model.network_devices[i].x1905_neighbors[j]);
+            }
+            if (data_model.network_devices[i].x1905_neighbors_nr > 0 && NULL != data_model.network_devices[i].x1905_neighbors)
+            {
+                PLATFORM_FREE(data_model.network_devices[i].x1905_neighbors);
+            }
+            data_model.network_devices[i].x1905_neighbors_nr = x1905_neighbors_nr;
+            data_model.network_devices[i].x1905_neighbors    = x1905_neighbors;
+        }
+
+        if (1 == po_update)
+        {
+            for (j=0; j<data_model.network_devices[i].power_off_nr; j++)
+            {
+                free_1905_TLV_structure((INT8U *)data_model.network_devices[i].power_off[j]);
+            }
+            if (data_model.network_devices[i].power_off_nr > 0 && NULL != data_model.network_devices[i].power_off)
+            {
+                PLATFORM_FREE(data_model.network_devices[i].power_off);
+            }
+            data_model.network_devices[i].power_off_nr = power_off_nr;
+            data_model.network_devices[i].power_off    = power_off;
+        }
+
+        if (1 == l2_update)
+        {
+            for (j=0; j<data_model.network_devices[i].l2_neighbors_nr; j++)
+            {
+                free_1905_TLV_structure((INT8U *)data_model.network_devices[i].l2_neighbors[j]);
+            }
+            if (data_model.network_devices[i].l2_neighbors_nr > 0 && NULL != data_model.network_devices[i].l2_neighbors)
+            {
+                PLATFORM_FREE(data_model.network_devices[i].l2_neighbors);
+            }
+            data_model.network_devices[i].l2_neighbors_nr = l2_neighbors_nr;
+            data_model.network_devices[i].l2_neighbors    = l2_neighbors;
+        }
+
+        if (1 == ge_update)
+        {
+            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].generic_phy);
+            data_model.network_devices[i].generic_phy = generic_phy;
+        }
+
+        if (1 == pr_update)
+        {
+            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].profile);
+            data_model.network_devices[i].profile = profile;
+        }
+
+        if (1 == id_update)
+        {
+            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].identification);
+            data_model.network_devices[i].identification = identification;
+        }
+
+        if (1 == co_update)
+        {
+            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].control_url);
+            data_model.network_devices[i].control_url = control_url;
+        }
+
+        if (1 == v4_update)
+        {
+            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].ipv4);
+            data_model.network_devices[i].ipv4 = ipv4;
+        }
+
+        if (1 == v6_update)
+        {
+            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].ipv6);
+            data_model.network_devices[i].ipv6 = ipv6;
+        }
+
+        if (1 == changed)
+        {
+            EVdeviceChanged(al_mac_address, x->generation);
+        }
+    }
+
+    return 1;
+}
+
+INT8U DMnetworkDeviceInfoNeedsUpdate(INT8U *al_mac_address)
+{
+    INT8U i;
+
+    // First, search for an existing entry with the same AL MAC address
+    //
+    for (i=0; i<data_model.network_devices_nr; i++)
+    {
+        if (NULL != data_model.network_devices[i].info)
+        {
+            if (0 == PLATFORM_MEMCMP(data_model.network_devices[i].info->al_mac_address, al_mac_address, 6))
+            {
+                break;
+            }
+        }
+    }
+
+    if (i == data_model.network_devices_nr)
+    {
+        // A matching entry was *not* found. Thus a refresh of the information
+        // is needed.
+        //
+        return 1;
+    }
+    else
+    {
+        // A matching entry was found. Check its timestamp (entries restored
+        // from a snapshot always need to be refreshed)
+        //
+        if (1 == data_model.network_devices[i].stale || PLATFORM_GET_TIMESTAMP() - data_model.network_devices[i].update_timestamp > MAX_AGE * 1000)
+        {
+            return 1;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+}
+
+INT8U DMupdateNetworkDeviceMetrics(INT8U *metrics)
+{
+    INT8U *FROM_al_mac_address;  // Metrics are reported FROM this AL entity...
+    INT8U *TO_al_mac_address;    // ... TO this other one.
+
+    INT8U i, j;
+
+    if (NULL == metrics)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Invalid 'metrics' argument\n");
+        return 0;
+    }
+
+    // Obtain the AL MAC of the devices involved in the metrics report (ie.
+    // the "from" and the "to" AL MAC addresses).
+    // This information is contained inside the 'metrics' structure itself.
+    //
+    if (TLV_TYPE_TRANSMITTER_LINK_METRIC == *metrics)
+    {
+        struct transmitterLinkMetricTLV *p;
+
+        p = (struct transmitterLinkMetricTLV *)metrics;
+
+        FROM_al_mac_address = p->local_al_address;
+        TO_al_mac_address   = p->neighbor_al_address;
+
+    }
+    else if (TLV_TYPE_RECEIVER_LINK_METRIC == *metrics)
+    {
+        struct receiverLinkMetricTLV *p;
+
+        p = (struct receiverLinkMetricTLV *)metrics;
+
+        FROM_al_mac_address = p->local_al_address;
+        TO_al_mac_address   = p->neighbor_al_address;
+    }
+    else
+    {
+        PLATFORM_PRINTF_DEBUG_DETAIL("Invalid 'metrics' argument. Type = %d\n", *metrics);
+        return 0;
+    }
+
+    // Next, search for an existing entry with the same AL MAC address
+    //
+    for (i=0; i<data_model.network_devices_nr; i++)
+    {
+        if (NULL == data_model.network_devices[i].info)
+        {
+            // We haven't received general info about this device yet.
+            // This can happen, for example, when only metrics have been
+            // received so far.
+            //
+            continue;
+        }
+        if (0 == PLATFORM_MEMCMP(data_model.network_devices[i].info->al_mac_address, FROM_al_mac_address, 6))
+        {
+            break;
+        }
+    }
+
+    if (i == data_model.network_devices_nr)
+    {
+        // A matching entry was *not* found.
+        //
+        // At this point, even if we could just create a new device entry with
+        // everything set to zero (except for the metrics that we have just
+        // received), it is probably wiser to simply discard the data.
+        //
+        // In other words, we should not accept metrics data until the "general
+        // info" for this node has been processed.
+        //
+        PLATFORM_PRINTF_DEBUG_DETAIL("Metrics received from an unknown 1905 node (%02x:%02x:%02x:%02x:%02x:%02x). Ignoring data...\n", FROM_al_mac_address[0], FROM_al_mac_address[1], FROM_al_mac_address[2], FROM_al_mac_address[3], FROM_al_mac_address[4], FROM_al_mac_address[5]);
         return 0;
     }
 
-    // First, search for an existing entry with the same AL MAC address
-    // Remember that the first entry holds a reference to the *local* node.
-    //
-    if (0 == PLATFORM_MEMCMP(DMalMacGet(), al_mac_address, 6))
+    // Keep track of the evolution of the metrics of this link (the TLV itself
+    // is going to be replaced the next time a report is received)
+    //
+    MHaddMetrics(metrics, PLATFORM_GET_TIMESTAMP());
+
+    // ...and let the HLEs that are interested know about it
+    //
+    EVlinkMetricsUpdated(metrics);
+
+    // Now that we have found the corresponding neighbor entry (or created a
+    // new one) search for a sub-entry that matches the AL MAC of the node the
+    // metrics are being reported against.
+    //
+    for (j=0; j<data_model.network_devices[i].metrics_with_neighbors_nr; j++)
+    {
+        if (0 == PLATFORM_MEMCMP(data_model.network_devices[i].metrics_with_neighbors[j].neighbor_al_mac_address, TO_al_mac_address, 6))
+        {
+            break;
+        }
+    }
+    
+    if (j == data_model.network_devices[i].metrics_with_neighbors_nr)
+    {
+        // A matching entry was *not* found. Create a new one
+        //
+        if (0 == data_model.network_devices[i].metrics_with_neighbors_nr)
+        {
+            data_model.network_devices[i].metrics_with_neighbors = (struct _metricsWithNeighbor *)PLATFORM_MALLOC(sizeof(struct _metricsWithNeighbor));
+        }
+        else
+        {
+            data_model.network_devices[i].metrics_with_neighbors = (struct _metricsWithNeighbor *)PLATFORM_REALLOC(data_model.network_devices[i].metrics_with_neighbors, sizeof(struct _metricsWithNeighbor)*(data_model.network_devices[i].metrics_with_neighbors_nr+1));
+        }
+
+        PLATFORM_MEMCPY(data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].neighbor_al_mac_address, TO_al_mac_address, 6);
+
+        if (TLV_TYPE_TRANSMITTER_LINK_METRIC == *metrics)
+        {
+            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].tx_metrics_timestamp = PLATFORM_GET_TIMESTAMP();
+            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].tx_metrics           = (struct transmitterLinkMetricTLV*)metrics;
+
+            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].rx_metrics_timestamp = 0;
+            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].rx_metrics           = NULL;
+        }
+        else 
+        {
+            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].tx_metrics_timestamp = 0;
+            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].tx_metrics           = NULL;
+
+            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].rx_metrics_timestamp = PLATFORM_GET_TIMESTAMP();
+            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].rx_metrics           = (struct receiverLinkMetricTLV*)metrics;
+        }
+
+        data_model.network_devices[i].metrics_with_neighbors_nr++;
+
+        data_model.network_devices[i].generation = ++data_model.generation;
+    }
+    else
+    {
+        // A matching entry was found. Update it. But first, free the old TLV
+        // structures.
+        //
+        if (1 == _tlvChanged(TLV_TYPE_TRANSMITTER_LINK_METRIC == *metrics ? (INT8U *)data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics : (INT8U *)data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics, metrics))
+        {
+            data_model.network_devices[i].generation = ++data_model.generation;
+        }
+
+        if (TLV_TYPE_TRANSMITTER_LINK_METRIC == *metrics)
+        {
+            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics);
+
+            data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics_timestamp = PLATFORM_GET_TIMESTAMP();
+            data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics           = (struct transmitterLinkMetricTLV*)metrics;
+        }
+        else
+        {
+            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics);
+
+            data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics_timestamp = PLATFORM_GET_TIMESTAMP();
+            data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics           = (struct receiverLinkMetricTLV*)metrics;
+        }
+    }
+
+    return 1;
+}
+
+// Return '1' if the metrics reported for a link should be printed when the
+// "max_phy_rate" filter (see "DMqueryNetworkDevices()") is 'max_phy_rate', '0'
+// otherwise.
+//
+static INT8U _metricsMatch(struct _metricsWithNeighbor *m, INT16U max_phy_rate)
+{
+    INT8U i;
+
+    if (0 == max_phy_rate)
     {
-        i=0;
+        return 1;
     }
-    else
+
+    if (NULL != m->tx_metrics)
     {
-        for (i=1; i<data_model.network_devices_nr; i++)
+        for (i=0; i<m->tx_metrics->transmitter_link_metrics_nr; i++)
         {
-            if (NULL != data_model.network_devices[i].info)
+            if (m->tx_metrics->transmitter_link_metrics[i].phy_rate < max_phy_rate)
             {
-                if (0 == PLATFORM_MEMCMP(data_model.network_devices[i].info->al_mac_address, al_mac_address, 6))
-                {
-                    break;
-                }
+                return 1;
             }
         }
     }
 
-    if (i == data_model.network_devices_nr)
+    return 0;
+}
+
+// Print the contents of the 'i'-th entry of the "devices" database using the
+// provided printf-like function.
+//
+// Only the parts selected in 'sections' (a combination of the
+// "CUSTOM_COMMAND_QUERY_SECTION_*" flags) and the metrics that pass the
+// 'max_phy_rate' filter (see "_metricsMatch()") are printed.
+//
+static void _dumpNetworkDevice(INT8U i, INT16U sections, INT16U max_phy_rate, void (*write_function)(const char *fmt, ...))
+{
+    // Buffer size to store a prefix string that will be used to show each
+    // element of a structure on screen
+    //
+    #define MAX_PREFIX  100
+
+    char  new_prefix[MAX_PREFIX];
+    INT8U j;
+    INT8U n;
+
+    PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->", i);
+    new_prefix[MAX_PREFIX-1] = 0x0;
+    write_function("%supdate timestamp: %d\n", new_prefix, data_model.network_devices[i].update_timestamp);
+    write_function("%sgeneration: %u\n", new_prefix, data_model.network_devices[i].generation);
+    if (1 == data_model.network_devices[i].stale)
     {
-        // A matching entry was *not* found. Create a new one, but only if this
-        // new information contains the "info" TLV (otherwise don't do anything
-        // and wait for the "info" TLV to be received in the future)
-        //
-        if (1 == in_update && NULL != info)
+        write_function("%sstale: restored from snapshot, not yet revalidated\n", new_prefix);
+    }
+
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_GENERAL_INFO))
+    {
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->general_info->", i);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        visit_1905_TLV_structure((INT8U* )data_model.network_devices[i].info, print_callback, write_function, new_prefix);
+    }
+
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_BRIDGES))
+    {
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->bridging_capabilities_nr: %d", i, data_model.network_devices[i].bridges_nr);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        write_function("%s\n", new_prefix);
+        for (j=0; j<data_model.network_devices[i].bridges_nr; j++)
         {
-            if (0 == data_model.network_devices_nr)
-            {
-                data_model.network_devices = (struct _networkDevice *)PLATFORM_MALLOC(sizeof(struct _networkDevice));
-            }
-            else
-            {
-                data_model.network_devices = (struct _networkDevice *)PLATFORM_REALLOC(data_model.network_devices, sizeof(struct _networkDevice)*(data_model.network_devices_nr+1));
-            }
+            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->bridging_capabilities[%d]->", i, j);
+            new_prefix[MAX_PREFIX-1] = 0x0;
+            visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].bridges[j], print_callback, write_function, new_prefix);
+        }
+    }
 
-            data_model.network_devices[data_model.network_devices_nr].update_timestamp          = PLATFORM_GET_TIMESTAMP();
-            data_model.network_devices[data_model.network_devices_nr].info                      = 1 == in_update ? info                 : NULL;
-            data_model.network_devices[data_model.network_devices_nr].bridges_nr                = 1 == br_update ? bridges_nr           : 0;
-            data_model.network_devices[data_model.network_devices_nr].bridges                   = 1 == br_update ? bridges              : NULL;
-            data_model.network_devices[data_model.network_devices_nr].non1905_neighbors_nr      = 1 == no_update ? non1905_neighbors_nr : 0;
-            data_model.network_devices[data_model.network_devices_nr].non1905_neighbors         = 1 == no_update ? non1905_neighbors    : NULL;
-            data_model.network_devices[data_model.network_devices_nr].x1905_neighbors_nr        = 1 == x1_update ? x1905_neighbors_nr   : 0;
-            data_model.network_devices[data_model.network_devices_nr].x1905_neighbors           = 1 == x1_update ? x1905_neighbors      : NULL;
-            data_model.network_devices[data_model.network_devices_nr].power_off_nr              = 1 == po_update ? power_off_nr         : 0;
-            data_model.network_devices[data_model.network_devices_nr].power_off                 = 1 == po_update ? power_off            : NULL;
-            data_model.network_devices[data_model.network_devices_nr].l2_neighbors_nr           = 1 == l2_update ? l2_neighbors_nr      : 0;
-            data_model.network_devices[data_model.network_devices_nr].l2_neighbors              = 1 == l2_update ? l2_neighbors         : NULL;
-            data_model.network_devices[data_model.network_devices_nr].generic_phy               = 1 == ge_update ? generic_phy          : NULL;
-            data_model.network_devices[data_model.network_devices_nr].profile                   = 1 == pr_update ? profile              : NULL;
-            data_model.network_devices[data_model.network_devices_nr].identification            = 1 == id_update ? identification       : NULL;
-            data_model.network_devices[data_model.network_devices_nr].control_url               = 1 == co_update ? control_url          : NULL;
-            data_model.network_devices[data_model.network_devices_nr].ipv4                      = 1 == v4_update ? ipv4                 : NULL;
-            data_model.network_devices[data_model.network_devices_nr].ipv6                      = 1 == v6_update ? ipv6                 : NULL;
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_NON_1905_NEIGHBORS))
+    {
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->non_1905_neighbors_nr: %d", i, data_model.network_devices[i].non1905_neighbors_nr);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        write_function("%s\n", new_prefix);
+        for (j=0; j<data_model.network_devices[i].non1905_neighbors_nr; j++)
+        {
+            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->non_1905_neighbors[%d]->", i, j);
+            new_prefix[MAX_PREFIX-1] = 0x0;
+            visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].non1905_neighbors[j], print_callback, write_function, new_prefix);
+        }
+    }
 
-            data_model.network_devices[data_model.network_devices_nr].metrics_with_neighbors_nr = 0;
-            data_model.network_devices[data_model.network_devices_nr].metrics_with_neighbors    = NULL;
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_X1905_NEIGHBORS))
+    {
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->x1905_neighbors_nr: %d", i, data_model.network_devices[i].x1905_neighbors_nr);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        write_function("%s\n", new_prefix);
+        for (j=0; j<data_model.network_devices[i].x1905_neighbors_nr; j++)
+        {
+            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->x1905_neighbors[%d]->", i, j);
+            new_prefix[MAX_PREFIX-1] = 0x0;
+            visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].x1905_neighbors[j], print_callback, write_function, new_prefix);
+        }
+    }
 
-            data_model.network_devices[data_model.network_devices_nr].extensions                = NULL;
-            data_model.network_devices[data_model.network_devices_nr].extensions_nr             = 0;
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_POWER_OFF))
+    {
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->power_off_interfaces_nr: %d", i, data_model.network_devices[i].power_off_nr);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        write_function("%s\n", new_prefix);
+        for (j=0; j<data_model.network_devices[i].power_off_nr; j++)
+        {
+            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->power_off_interfaces[%d]->", i, j);
+            new_prefix[MAX_PREFIX-1] = 0x0;
+            visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].power_off[j], print_callback, write_function, new_prefix);
+        }
+    }
 
-            data_model.network_devices_nr++;
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_L2_NEIGHBORS))
+    {
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->l2_neighbors_nr: %d", i, data_model.network_devices[i].l2_neighbors_nr);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        write_function("%s\n", new_prefix);
+        for (j=0; j<data_model.network_devices[i].l2_neighbors_nr; j++)
+        {
+            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->l2_neighbors[%d]->", i, j);
+            new_prefix[MAX_PREFIX-1] = 0x0;
+            visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].l2_neighbors[j], print_callback, write_function, new_prefix);
         }
     }
-    else
+
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_GENERIC_PHY))
     {
-        // A matching entry was found. Update it. But first, free the old TLV
-        // structures (but only if a new value was provided!... otherwise retain
-        // the old item)
-        //
-        data_model.network_devices[i].update_timestamp = PLATFORM_GET_TIMESTAMP();
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->generic_phys->", i);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        visit_1905_TLV_structure((INT8U* )data_model.network_devices[i].generic_phy, print_callback, write_function, new_prefix);
+    }
 
-        if (NULL != info)
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_PROFILE))
+    {
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->profile->", i);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        visit_1905_TLV_structure((INT8U* )data_model.network_devices[i].profile, print_callback, write_function, new_prefix);
+    }
+
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_IDENTIFICATION))
+    {
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->identification->", i);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        visit_1905_TLV_structure((INT8U* )data_model.network_devices[i].identification, print_callback, write_function, new_prefix);
+    }
+
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_CONTROL_URL))
+    {
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->control_url->", i);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].control_url, print_callback, write_function, new_prefix);
+    }
+
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_IPS))
+    {
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->ipv4->", i);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].ipv4, print_callback, write_function, new_prefix);
+
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->ipv6->", i);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].ipv6, print_callback, write_function, new_prefix);
+    }
+
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_METRICS))
+    {
+        for (n=0, j=0; j<data_model.network_devices[i].metrics_with_neighbors_nr; j++)
         {
-            if (NULL != data_model.network_devices[i].info)
+            n += _metricsMatch(&data_model.network_devices[i].metrics_with_neighbors[j], max_phy_rate);
+        }
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->metrics_nr: %d", i, n);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        write_function("%s\n", new_prefix);
+        for (j=0; j<data_model.network_devices[i].metrics_with_neighbors_nr; j++)
+        {
+            if (0 == _metricsMatch(&data_model.network_devices[i].metrics_with_neighbors[j], max_phy_rate))
             {
-                free_1905_TLV_structure((INT8U *)data_model.network_devices[i].info);
+                continue;
             }
-            data_model.network_devices[i].info = info;
-        }
 
-        if (1 == br_update)
-        {
-            for (j=0; j<data_model.network_devices[i].bridges_nr; j++)
+            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->metrics[%d]->tx->", i, j);
+            new_prefix[MAX_PREFIX-1] = 0x0;
+            if (NULL != data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics)
             {
-                free_1905_TLV_structure((INT8U *)data_model.network_devices[i].bridges[j]);
+                write_function("%slast_updated: %d\n", new_prefix, data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics_timestamp);
+                visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics, print_callback, write_function, new_prefix);
             }
-            if (data_model.network_devices[i].bridges_nr > 0 && NULL != data_model.network_devices[i].bridges)
+            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->metrics[%d]->rx->", i, j);
+            new_prefix[MAX_PREFIX-1] = 0x0;
+            if (NULL != data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics)
             {
-                PLATFORM_FREE(data_model.network_devices[i].bridges);
+                write_function("%slast updated: %d\n", new_prefix, data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics_timestamp);
+                visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics, print_callback, write_function, new_prefix);
             }
-            data_model.network_devices[i].bridges_nr = bridges_nr;
-            data_model.network_devices[i].bridges    = bridges;
         }
+    }
+
+    if (0 != (sections & CUSTOM_COMMAND_QUERY_SECTION_EXTENSIONS))
+    {
+        // Non-standard report section.
+        // Allow registered third-party developers to extend the neighbor info
+        // (ex. BBF adds non-1905 link metrics)
+        //
+        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->", i);
+        new_prefix[MAX_PREFIX-1] = 0x0;
+        dumpExtendedInfo((INT8U **)data_model.network_devices[i].extensions, data_model.network_devices[i].extensions_nr, print_callback, write_function, new_prefix);
+    }
+}
+
+// Print the "links" database entry 'remote_interface_id' using the provided
+// printf-like function.
+//
+static void _dumpLink(INT16U remote_interface_id, INT16U index, void (*write_function)(const char *fmt, ...))
+{
+    INT16U  neighbor_id;
+    INT8U  *al_mac;
+    INT8U  *mac;
+
+    neighbor_id = data_model.remote_interfaces.neighbor_ids[remote_interface_id];
+    al_mac      = data_model.neighbors.al_mac_addresses[neighbor_id];
+    mac         = data_model.remote_interfaces.mac_addresses[remote_interface_id];
+
+    write_function("  link[%d]->local_interface: %s\n", index, data_model.local_interfaces.names[data_model.neighbors.interface_ids[neighbor_id]]);
+    write_function("  link[%d]->neighbor_al_mac_address: %02x:%02x:%02x:%02x:%02x:%02x\n", index, al_mac[0], al_mac[1], al_mac[2], al_mac[3], al_mac[4], al_mac[5]);
+    write_function("  link[%d]->neighbor_mac_address: %02x:%02x:%02x:%02x:%02x:%02x\n", index, mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+    write_function("  link[%d]->bridged: %d\n", index, _isRemoteInterfaceBridged(remote_interface_id));
+    write_function("  link[%d]->generation: %u\n", index, data_model.remote_interfaces.generations[remote_interface_id]);
+}
+
+void DMdumpNetworkDevices(void (*write_function)(const char *fmt, ...))
+{
+    INT8U  i;
+
+    write_function("\n");
+
+    write_function("  epoch: %u\n", data_model.epoch);
+    write_function("  generation: %u\n", data_model.generation);
+    write_function("  device_nr: %d\n", data_model.network_devices_nr);
+
+    for (i=0; i<data_model.network_devices_nr; i++)
+    {
+        _dumpNetworkDevice(i, CUSTOM_COMMAND_QUERY_SECTION_ALL, 0, write_function);
+    }
+
+    return;
+}
+
+void DMdumpNetworkDevicesSince(INT32U epoch, INT32U generation, void (*write_function)(const char *fmt, ...))
+{
+    INT16U  i;
+    INT16U  nr;
+    INT8U   full;
+
+    // If some of the removals that happened after 'generation' have already
+    // been forgotten (or if 'generation' does not belong to this data model
+    // at all, for example because the AL entity has been restarted and thus
+    // the epoch is a different one), a delta cannot be computed and
+    // everything is reported instead.
+    //
+    if (epoch != data_model.epoch || generation < data_model.tombstones_horizon || generation > data_model.generation)
+    {
+        full       = 1;
+        generation = 0;
+    }
+    else
+    {
+        full = 0;
+    }
 
-        if (1 == no_update)
-        {
-            for (j=0; j<data_model.network_devices[i].non1905_neighbors_nr; j++)
-            {
-                free_1905_TLV_structure((INT8U *)data_model.network_devices[i].non1905_neighbors[j]);
-            }
-            if (data_model.network_devices[i].non1905_neighbors_nr > 0 && NULL != data_model.network_devices[i].non1905_neighbors)
-            {
-                PLATFORM_FREE(data_model.network_devices[i].non1905_neighbors);
-            }
-            data_model.network_devices[i].non1905_neighbors_nr = non1905_neighbors_nr;
-            data_model.network_devices[i].non1905_neighbors    = non1905_neighbors;
-        }
+    write_function("\n");
 
-        if (1 == x1_update)
-        {
-            for (j=0; j<data_model.network_devices[i].x1905_neighbors_nr; j++)
-            {
-                free_1905_TLV_structure((INT8U *)data_model.network_devices[i].x1905_neighbors[j]);
-            }
-            if (data_model.network_devices[i].x1905_neighbors_nr > 0 && NULL != data_model.network_devices[i].x1905_neighbors)
-            {
-                PLATFORM_FREE(data_model.network_devices[i].x1905_neighbors);
-            }
-            data_model.network_devices[i].x1905_neighbors_nr = x1905_neighbors_nr;
-            data_model.network_devices[i].x1905_neighbors    = x1905_neighbors;
-        }
+    write_function("  epoch: %u\n", data_model.epoch);
+    write_function("  generation: %u\n", data_model.generation);
+    write_function("  since: %u (%s)\n", generation, 1 == full ? "full" : "delta");
 
-        if (1 == po_update)
+    // Devices created or changed after 'generation'
+    //
+    for (nr=0, i=0; i<data_model.network_devices_nr; i++)
+    {
+        if (data_model.network_devices[i].generation > generation)
         {
-            for (j=0; j<data_model.network_devices[i].power_off_nr; j++)
-            {
-                free_1905_TLV_structure((INT8U *)data_model.network_devices[i].power_off[j]);
-            }
-            if (data_model.network_devices[i].power_off_nr > 0 && NULL != data_model.network_devices[i].power_off)
-            {
-                PLATFORM_FREE(data_model.network_devices[i].power_off);
-            }
-            data_model.network_devices[i].power_off_nr = power_off_nr;
-            data_model.network_devices[i].power_off    = power_off;
+            nr++;
         }
-
-        if (1 == l2_update)
+    }
+    write_function("  device_nr: %d\n", nr);
+    for (i=0; i<data_model.network_devices_nr; i++)
+    {
+        if (data_model.network_devices[i].generation > generation)
         {
-            for (j=0; j<data_model.network_devices[i].l2_neighbors_nr; j++)
-            {
-                free_1905_TLV_structure((INT8U *)data_model.network_devices[i].l2_neighbors[j]);
-            }
-            if (data_model.network_devices[i].l2_neighbors_nr > 0 && NULL != data_model.network_devices[i].l2_neighbors)
-            {
-                PLATFORM_FREE(data_model.network_devices[i].l2_neighbors);
-            }
-            data_model.network_devices[i].l2_neighbors_nr = l2_neighbors_nr;
-            data_model.network_devices[i].l2_neighbors    = l2_neighbors;
+            _dumpNetworkDevice(i, CUSTOM_COMMAND_QUERY_SECTION_ALL, 0, write_function);
         }
+    }
 
-        if (1 == ge_update)
+    // Links created after 'generation'
+    //
+    for (nr=0, i=0; i<data_model.remote_interfaces.nr; i++)
+    {
+        if (data_model.remote_interfaces.generations[i] > generation)
         {
-            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].generic_phy);
-            data_model.network_devices[i].generic_phy = generic_phy;
+            nr++;
         }
-
-        if (1 == pr_update)
+    }
+    write_function("  link_nr: %d\n", nr);
+    for (nr=0, i=0; i<data_model.remote_interfaces.nr; i++)
+    {
+        if (data_model.remote_interfaces.generations[i] > generation)
         {
-            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].profile);
-            data_model.network_devices[i].profile = profile;
+            _dumpLink(i, nr++, write_function);
         }
+    }
 
-        if (1 == id_update)
+    // Devices and links removed after 'generation', from the oldest to the
+    // most recent removal (nothing to report when doing a full dump, as the
+    // client is going to discard everything it knew anyway)
+    //
+    for (nr=0, i=0; i<data_model.tombstones_nr && 0 == full; i++)
+    {
+        if (data_model.tombstones[i].generation > generation)
         {
-            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].identification);
-            data_model.network_devices[i].identification = identification;
+            nr++;
         }
+    }
+    write_function("  removed_nr: %d\n", nr);
+    for (nr=0, i=0; i<data_model.tombstones_nr && 0 == full; i++)
+    {
+        struct _tombstone *t;
 
-        if (1 == co_update)
+        t = &data_model.tombstones[(data_model.tombstones_next + DATAMODEL_TOMBSTONES_NR - data_model.tombstones_nr + i) % DATAMODEL_TOMBSTONES_NR];
+
+        if (t->generation <= generation)
         {
-            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].control_url);
-            data_model.network_devices[i].control_url = control_url;
+            continue;
         }
 
-        if (1 == v4_update)
+        if (INVALID_INTERFACE_ID == t->interface_id)
         {
-            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].ipv4);
-            data_model.network_devices[i].ipv4 = ipv4;
+            write_function("  removed[%d]->device: %02x:%02x:%02x:%02x:%02x:%02x\n", nr, t->al_mac_address[0], t->al_mac_address[1], t->al_mac_address[2], t->al_mac_address[3], t->al_mac_address[4], t->al_mac_address[5]);
         }
-
-        if (1 == v6_update)
+        else
         {
-            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].ipv6);
-            data_model.network_devices[i].ipv6 = ipv6;
+            write_function("  removed[%d]->link: %s %02x:%02x:%02x:%02x:%02x:%02x %02x:%02x:%02x:%02x:%02x:%02x\n", nr, data_model.local_interfaces.names[t->interface_id], t->al_mac_address[0], t->al_mac_address[1], t->al_mac_address[2], t->al_mac_address[3], t->al_mac_address[4], t->al_mac_address[5], t->mac_address[0], t->mac_address[1], t->mac_address[2], t->mac_address[3], t->mac_address[4], t->mac_address[5]);
         }
-
+        write_function("  removed[%d]->generation: %u\n", nr, t->generation);
+        nr++;
     }
 
-    return 1;
+    return;
 }
 
-INT8U DMnetworkDeviceInfoNeedsUpdate(INT8U *al_mac_address)
+// Return '1' if the 'i'-th entry of the "devices" database passes all the
+// filters of "DMqueryNetworkDevices()", '0' otherwise.
+//
+static INT8U _networkDeviceMatches(INT8U i, INT8U al_mac_addresses_nr, INT8U (*al_mac_addresses)[6], INT16U media_type, INT16U max_phy_rate)
 {
-    INT8U i;
+    struct deviceInformationTypeTLV *info;
+    INT8U                            j;
 
-    // First, search for an existing entry with the same AL MAC address
-    //
-    for (i=0; i<data_model.network_devices_nr; i++)
+    info = data_model.network_devices[i].info;
+
+    if (0 != al_mac_addresses_nr)
     {
-        if (NULL != data_model.network_devices[i].info)
+        if (NULL == info)
         {
-            if (0 == PLATFORM_MEMCMP(data_model.network_devices[i].info->al_mac_address, al_mac_address, 6))
+            return 0;
+        }
+        for (j=0; j<al_mac_addresses_nr; j++)
+        {
+            if (0 == PLATFORM_MEMCMP(info->al_mac_address, al_mac_addresses[j], 6))
             {
                 break;
             }
         }
+        if (j == al_mac_addresses_nr)
+        {
+            return 0;
+        }
     }
 
-    if (i == data_model.network_devices_nr)
-    {
-        // A matching entry was *not* found. Thus a refresh of the information
-        // is needed.
-        //
-        return 1;
-    }
-    else
+    if (MEDIA_TYPE_UNKNOWN != media_type)
     {
-        // A matching entry was found. Check its timestamp.
-        //
-        if (PLATFORM_GET_TIMESTAMP() - data_model.network_devices[i].update_timestamp > MAX_AGE * 1000)
+        if (NULL == info)
         {
-            return 1;
+            return 0;
         }
-        else
+        for (j=0; j<info->local_interfaces_nr; j++)
+        {
+            if (media_type == info->local_interfaces[j].media_type)
+            {
+                break;
+            }
+        }
+        if (j == info->local_interfaces_nr)
         {
             return 0;
         }
     }
-}
-
-INT8U DMupdateNetworkDeviceMetrics(INT8U *metrics)
-{
-    INT8U *FROM_al_mac_address;  // Metrics are reported FROM this AL entity...
-    INT8U *TO_al_mac_address;    // ... TO this other one.
-
-    INT8U i, j;
 
-    if (NULL == metrics)
+    if (0 != max_phy_rate)
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("Invalid 'metrics' argument\n");
-        return 0;
+        for (j=0; j<data_model.network_devices[i].metrics_with_neighbors_nr; j++)
+        {
+            if (1 == _metricsMatch(&data_model.network_devices[i].metrics_with_neighbors[j], max_phy_rate))
+            {
+                break;
+            }
+        }
+        if (j == data_model.network_devices[i].metrics_with_neighbors_nr)
+        {
+            return 0;
+        }
     }
 
-    // Obtain the AL MAC of the devices involved in the metrics report (ie.
-    // the "from" and the "to" AL MAC addresses).
-    // This information is contained inside the 'metrics' structure itself.
-    //
-    if (TLV_TYPE_TRANSMITTER_LINK_METRIC == *metrics)
-    {
-        struct transmitterLinkMetricTLV *p;
-
-        p = (struct transmitterLinkMetricTLV *)metrics;
+    return 1;
+}
 
-        FROM_al_mac_address = p->local_al_address;
-        TO_al_mac_address   = p->neighbor_al_address;
+void DMqueryNetworkDevices(INT8U al_mac_addresses_nr, INT8U (*al_mac_addresses)[6], INT16U media_type, INT16U max_phy_rate, INT16U sections, void (*write_function)(const char *fmt, ...))
+{
+    INT8U  i;
+    INT8U  nr;
 
-    }
-    else if (TLV_TYPE_RECEIVER_LINK_METRIC == *metrics)
-    {
-        struct receiverLinkMetricTLV *p;
+    write_function("\n");
 
-        p = (struct receiverLinkMetricTLV *)metrics;
+    write_function("  epoch: %u\n", data_model.epoch);
+    write_function("  generation: %u\n", data_model.generation);
 
-        FROM_al_mac_address = p->local_al_address;
-        TO_al_mac_address   = p->neighbor_al_address;
-    }
-    else
+    for (nr=0, i=0; i<data_model.network_devices_nr; i++)
     {
-        PLATFORM_PRINTF_DEBUG_DETAIL("Invalid 'metrics' argument. Type = %d\n", *metrics);
-        return 0;
+        nr += _networkDeviceMatches(i, al_mac_addresses_nr, al_mac_addresses, media_type, max_phy_rate);
     }
+    write_function("  device_nr: %d\n", nr);
 
-    // Next, search for an existing entry with the same AL MAC address
-    //
     for (i=0; i<data_model.network_devices_nr; i++)
     {
-        if (NULL == data_model.network_devices[i].info)
-        {
-            // We haven't received general info about this device yet.
-            // This can happen, for example, when only metrics have been
-            // received so far.
-            //
-            continue;
-        }
-        if (0 == PLATFORM_MEMCMP(data_model.network_devices[i].info->al_mac_address, FROM_al_mac_address, 6))
+        if (1 == _networkDeviceMatches(i, al_mac_addresses_nr, al_mac_addresses, media_type, max_phy_rate))
         {
-            break;
+            _dumpNetworkDevice(i, sections, max_phy_rate, write_function);
         }
     }
 
-    if (i == data_model.network_devices_nr)
-    {
-        // A matching entry was *not* found.
-        //
-        // At this point, even if we could just create a new device entry with
-        // everything set to zero (except for the metrics that we have just
-        // received), it is probably wiser to simply discard the data.
-        //
-        // In other words, we should not accept metrics data until the "general
-        // info" for this node has been processed.
-        //
-        PLATFORM_PRINTF_DEBUG_DETAIL("Metrics received from an unknown 1905 node (%02x:%02x:%02x:%02x:%02x:%02x). Ignoring data...\n", FROM_al_mac_address[0], FROM_al_mac_address[1], FROM_al_mac_address[2], FROM_al_mac_address[3], FROM_al_mac_address[4], FROM_al_mac_address[5]);
-        return 0;
-    }
+    return;
+}
 
-    // Now that we have found the corresponding neighbor entry (or created a
-    // new one) search for a sub-entry that matches the AL MAC of the node the
-    // metrics are being reported against.
-    //
-    for (j=0; j<data_model.network_devices[i].metrics_with_neighbors_nr; j++)
-    {
-        if (0 == PLATFORM_MEMCMP(data_model.network_devices[i].metrics_with_neighbors[j].neighbor_al_mac_address, TO_al_mac_address, 6))
-        {
-            break;
-        }
-    }
-    
-    if (j == data_model.network_devices[i].metrics_with_neighbors_nr)
+// Append the 'i'-th entry of the "devices" database to a binary export (see
+// "CUSTOM_COMMAND_EXPORT_MAGIC" in "1905_alme.h" for its format).
+//
+// Serializing the TLVs of a device is by far the most expensive part of an
+// export, thus the result is kept in the entry and reused in later exports
+// until the device changes (ie. until its 'generation' is updated).
+//
+static void _exportWriteDevice(struct _snapshotWriter *w, INT8U i)
+{
+    struct _networkDevice *x;
+
+    x = &data_model.network_devices[i];
+
+    if (NULL == x->export_cache || x->export_cache_generation != x->generation)
     {
-        // A matching entry was *not* found. Create a new one
-        //
-        if (0 == data_model.network_devices[i].metrics_with_neighbors_nr)
-        {
-            data_model.network_devices[i].metrics_with_neighbors = (struct _metricsWithNeighbor *)PLATFORM_MALLOC(sizeof(struct _metricsWithNeighbor));
-        }
-        else
-        {
-            data_model.network_devices[i].metrics_with_neighbors = (struct _metricsWithNeighbor *)PLATFORM_REALLOC(data_model.network_devices[i].metrics_with_neighbors, sizeof(struct _metricsWithNeighbor)*(data_model.network_devices[i].metrics_with_neighbors_nr+1));
-        }
+        struct _snapshotWriter aux;
 
-        PLATFORM_MEMCPY(data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].neighbor_al_mac_address, TO_al_mac_address, 6);
+        aux.buffer = NULL;
+        aux.len    = 0;
+        aux.size   = 0;
 
-        if (TLV_TYPE_TRANSMITTER_LINK_METRIC == *metrics)
-        {
-            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].tx_metrics_timestamp = PLATFORM_GET_TIMESTAMP();
-            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].tx_metrics           = (struct transmitterLinkMetricTLV*)metrics;
+        _snapshotWriteDeviceTLVs(&aux, x);
 
-            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].rx_metrics_timestamp = 0;
-            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].rx_metrics           = NULL;
-        }
-        else 
+        if (NULL != x->export_cache)
         {
-            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].tx_metrics_timestamp = 0;
-            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].tx_metrics           = NULL;
-
-            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].rx_metrics_timestamp = PLATFORM_GET_TIMESTAMP();
-            data_model.network_devices[i].metrics_with_neighbors[data_model.network_devices[i].metrics_with_neighbors_nr].rx_metrics           = (struct receiverLinkMetricTLV*)metrics;
+            PLATFORM_FREE(x->export_cache);
         }
-
-        data_model.network_devices[i].metrics_with_neighbors_nr++;
+        x->export_cache            = aux.buffer;
+        x->export_cache_len        = aux.len;
+        x->export_cache_generation = x->generation;
     }
-    else
-    {
-        // A matching entry was found. Update it. But first, free the old TLV
-        // structures.
-        //
-        if (TLV_TYPE_TRANSMITTER_LINK_METRIC == *metrics)
-        {
-            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics);
 
-            data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics_timestamp = PLATFORM_GET_TIMESTAMP();
-            data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics           = (struct transmitterLinkMetricTLV*)metrics;
-        }
-        else
-        {
-            free_1905_TLV_structure((INT8U *)data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics);
+    _snapshotWrite4B(w, x->generation);
+    _snapshotWrite4B(w, x->update_timestamp);
+    _snapshotWrite4B(w, x->export_cache_len);
+    _snapshotWritenB(w, x->export_cache, x->export_cache_len);
+}
+
+// Append all the links (ie. all the "remote_interfaces" entries) to a binary
+// export.
+//
+static void _exportWriteLinks(struct _snapshotWriter *w)
+{
+    INT16U r;
+
+    _snapshotWrite2B(w, data_model.remote_interfaces.nr);
+    for (r=0; r<data_model.remote_interfaces.nr; r++)
+    {
+        INT16U  neighbor_id;
+        char   *name;
+        INT32U  name_len;
 
-            data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics_timestamp = PLATFORM_GET_TIMESTAMP();
-            data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics           = (struct receiverLinkMetricTLV*)metrics;
+        neighbor_id = data_model.remote_interfaces.neighbor_ids[r];
+        name        = data_model.local_interfaces.names[data_model.neighbors.interface_ids[neighbor_id]];
+
+        name_len = PLATFORM_STRLEN(name);
+        if (name_len > 255)
+        {
+            name_len = 255;
         }
-    }
 
-    return 1;
+        _snapshotWrite1B(w, name_len);
+        _snapshotWritenB(w, name, name_len);
+        _snapshotWritenB(w, data_model.neighbors.al_mac_addresses[neighbor_id], 6);
+        _snapshotWritenB(w, data_model.remote_interfaces.mac_addresses[r], 6);
+        _snapshotWrite4B(w, data_model.remote_interfaces.generations[r]);
+    }
 }
 
-void DMdumpNetworkDevices(void (*write_function)(const char *fmt, ...))
+void DMexportNetworkDevices(void (*write_function)(INT8U *buffer, INT32U len))
 {
-    // Buffer size to store a prefix string that will be used to show each
-    // element of a structure on screen
-    //
-    #define MAX_PREFIX  100
+    struct _snapshotWriter w;
 
-    INT8U  i, j;
+    INT8U  i;
 
-    write_function("\n");
+    // The binary export is built with the same helpers used for snapshots,
+    // handing it over to 'write_function' one device at a time, so that the
+    // buffer never grows bigger than the biggest device entry.
+    //
+    w.buffer = NULL;
+    w.len    = 0;
+    w.size   = 0;
 
-    write_function("  device_nr: %d\n", data_model.network_devices_nr);
+    _snapshotWritenB(&w, CUSTOM_COMMAND_EXPORT_MAGIC, 4);
+    _snapshotWrite1B(&w, CUSTOM_COMMAND_EXPORT_VERSION);
+    _snapshotWrite4B(&w, data_model.generation);
+    _snapshotWrite1B(&w, data_model.network_devices_nr);
 
     for (i=0; i<data_model.network_devices_nr; i++)
     {
-        char new_prefix[MAX_PREFIX];
+        _exportWriteDevice(&w, i);
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->", i);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        write_function("%supdate timestamp: %d\n", new_prefix, data_model.network_devices[i].update_timestamp);
+        write_function(w.buffer, w.len);
+        w.len = 0;
+    }
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->general_info->", i);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        visit_1905_TLV_structure((INT8U* )data_model.network_devices[i].info, print_callback, write_function, new_prefix);
+    _exportWriteLinks(&w);
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->bridging_capabilities_nr: %d", i, data_model.network_devices[i].bridges_nr);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        write_function("%s\n", new_prefix);
-        for (j=0; j<data_model.network_devices[i].bridges_nr; j++)
-        {
-            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->bridging_capabilities[%d]->", i, j);
-            new_prefix[MAX_PREFIX-1] = 0x0;
-            visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].bridges[j], print_callback, write_function, new_prefix);
-        }
+    write_function(w.buffer, w.len);
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->non_1905_neighbors_nr: %d", i, data_model.network_devices[i].non1905_neighbors_nr);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        write_function("%s\n", new_prefix);
-        for (j=0; j<data_model.network_devices[i].non1905_neighbors_nr; j++)
-        {
-            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->non_1905_neighbors[%d]->", i, j);
-            new_prefix[MAX_PREFIX-1] = 0x0;
-            visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].non1905_neighbors[j], print_callback, write_function, new_prefix);
-        }
+    PLATFORM_FREE(w.buffer);
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->x1905_neighbors_nr: %d", i, data_model.network_devices[i].x1905_neighbors_nr);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        write_function("%s\n", new_prefix);
-        for (j=0; j<data_model.network_devices[i].x1905_neighbors_nr; j++)
-        {
-            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->x1905_neighbors[%d]->", i, j);
-            new_prefix[MAX_PREFIX-1] = 0x0;
-            visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].x1905_neighbors[j], print_callback, write_function, new_prefix);
-        }
+    return;
+}
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->power_off_interfaces_nr: %d", i, data_model.network_devices[i].power_off_nr);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        write_function("%s\n", new_prefix);
-        for (j=0; j<data_model.network_devices[i].power_off_nr; j++)
-        {
-            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->power_off_interfaces[%d]->", i, j);
-            new_prefix[MAX_PREFIX-1] = 0x0;
-            visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].power_off[j], print_callback, write_function, new_prefix);
-        }
+void DMpublishTopologyImage(void)
+{
+    // The export is built in this buffer (which is kept from one call to the
+    // next one, to avoid reallocating it every time) and then copied into the
+    // shared memory region in one go.
+    //
+    static struct _snapshotWriter  w                    = {NULL, 0, 0};
+    static INT8U                   disabled             = 0;
+    static INT8U                   published            = 0;
+    static INT32U                  published_generation = 0;
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->l2_neighbors_nr: %d", i, data_model.network_devices[i].l2_neighbors_nr);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        write_function("%s\n", new_prefix);
-        for (j=0; j<data_model.network_devices[i].l2_neighbors_nr; j++)
-        {
-            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->l2_neighbors[%d]->", i, j);
-            new_prefix[MAX_PREFIX-1] = 0x0;
-            visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].l2_neighbors[j], print_callback, write_function, new_prefix);
-        }
+    struct topologyImageHeader *header;
+    INT32U                      size;
+    INT8U                       i;
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->generic_phys->", i);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        visit_1905_TLV_structure((INT8U* )data_model.network_devices[i].generic_phy, print_callback, write_function, new_prefix);
+    if (1 == disabled || (1 == published && published_generation == data_model.generation))
+    {
+        // Nothing to do
+        //
+        return;
+    }
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->profile->", i);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        visit_1905_TLV_structure((INT8U* )data_model.network_devices[i].profile, print_callback, write_function, new_prefix);
+    if (NULL == PLATFORM_MAP_TOPOLOGY_IMAGE(sizeof(struct topologyImageHeader), &size))
+    {
+        // Publishing is disabled (or not possible)
+        //
+        disabled = 1;
+        return;
+    }
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->identification->", i);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        visit_1905_TLV_structure((INT8U* )data_model.network_devices[i].identification, print_callback, write_function, new_prefix);
+    w.len = 0;
+    _snapshotWritenB(&w, CUSTOM_COMMAND_EXPORT_MAGIC, 4);
+    _snapshotWrite1B(&w, CUSTOM_COMMAND_EXPORT_VERSION);
+    _snapshotWrite4B(&w, data_model.generation);
+    _snapshotWrite1B(&w, data_model.network_devices_nr);
+    for (i=0; i<data_model.network_devices_nr; i++)
+    {
+        _exportWriteDevice(&w, i);
+    }
+    _exportWriteLinks(&w);
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->control_url->", i);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].control_url, print_callback, write_function, new_prefix);
+    // (The region is enlarged, if needed)
+    //
+    if (NULL == (header = (struct topologyImageHeader *)PLATFORM_MAP_TOPOLOGY_IMAGE(sizeof(struct topologyImageHeader) + w.len, &size)))
+    {
+        return;
+    }
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->ipv4->", i);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].ipv4, print_callback, write_function, new_prefix);
+    // Seqlock write: readers that find an odd 'sequence' (or a 'sequence'
+    // that changes while they are reading) know that the image is being
+    // updated and try again
+    //
+    if (0 != PLATFORM_MEMCMP(header->magic, TOPOLOGY_IMAGE_MAGIC, 4))
+    {
+        header->sequence = 0;
+    }
+    header->sequence++;
+    PLATFORM_MEMORY_BARRIER();
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->ipv6->", i);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].ipv6, print_callback, write_function, new_prefix);
+    PLATFORM_MEMCPY(header->magic, TOPOLOGY_IMAGE_MAGIC, 4);
+    header->version    = TOPOLOGY_IMAGE_VERSION;
+    header->size       = size;
+    header->generation = data_model.generation;
+    header->len        = w.len;
+    PLATFORM_MEMCPY((INT8U *)(header + 1), w.buffer, w.len);
 
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->metrics_nr: %d", i, data_model.network_devices[i].metrics_with_neighbors_nr);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        write_function("%s\n", new_prefix);
-        for (j=0; j<data_model.network_devices[i].metrics_with_neighbors_nr; j++)
-        {
-            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->metrics[%d]->tx->", i, j);
-            new_prefix[MAX_PREFIX-1] = 0x0;
-            if (NULL != data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics)
-            {
-                write_function("%slast_updated: %d\n", new_prefix, data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics_timestamp);
-                visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].metrics_with_neighbors[j].tx_metrics, print_callback, write_function, new_prefix);
-            }
-            PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->metrics[%d]->rx->", i, j);
-            new_prefix[MAX_PREFIX-1] = 0x0;
-            if (NULL != data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics)
-            {
-                write_function("%slast updated: %d\n", new_prefix, data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics_timestamp);
-                visit_1905_TLV_structure((INT8U *)data_model.network_devices[i].metrics_with_neighbors[j].rx_metrics, print_callback, write_function, new_prefix);
-            }
-        }
+    PLATFORM_MEMORY_BARRIER();
+    header->sequence++;
 
-        // Non-standard report section.
-        // Allow registered third-party developers to extend the neighbor info
-        // (ex. BBF adds non-1905 link metrics)
-        //
-        PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "  device[%d]->", i);
-        new_prefix[MAX_PREFIX-1] = 0x0;
-        dumpExtendedInfo((INT8U **)data_model.network_devices[i].extensions, data_model.network_devices[i].extensions_nr, print_callback, write_function, new_prefix);
-    }
+    published            = 1;
+    published_generation = data_model.generation;
 
     return;
 }
@@ -1563,6 +3204,7 @@ INT8U DMrunGarbageCollector(void)
                 // later use
                 //
                 PLATFORM_MEMCPY(al_mac_address, x->info->al_mac_address, 6);
+                _recordTombstone(INVALID_INTERFACE_ID, al_mac_address, NULL);
 
                 PLATFORM_PRINTF_DEBUG_DETAIL("Removing old device entry (%02x:%02x:%02x:%02x:%02x:%02x)\n", x->info->al_mac_address[0], x->info->al_mac_address[1], x->info->al_mac_address[2], x->info->al_mac_address[3], x->info->al_mac_address[4], x->info->al_mac_address[5]);
                 free_1905_TLV_structure((INT8U*)x->info);
@@ -1675,6 +3317,12 @@ INT8U DMrunGarbageCollector(void)
                 x->metrics_with_neighbors = NULL;
             }
 
+            if (NULL != x->export_cache)
+            {
+                PLATFORM_FREE(x->export_cache);
+                x->export_cache = NULL;
+            }
+
             // Next, remove the _networkDevice entry
             //
             if (i == (data_model.network_devices_nr-1))
@@ -1727,6 +3375,8 @@ INT8U DMrunGarbageCollector(void)
 
                 if (original_neighbors_nr != data_model.network_devices[j].metrics_with_neighbors_nr)
                 {
+                    data_model.network_devices[j].generation = ++data_model.generation;
+
                     if (0 == data_model.network_devices[j].metrics_with_neighbors_nr)
                     {
                         PLATFORM_FREE(data_model.network_devices[j].metrics_with_neighbors);
@@ -1741,6 +3391,12 @@ INT8U DMrunGarbageCollector(void)
             // And also from the local interfaces database
             // 
             DMremoveALNeighborFromInterface(al_mac_address, "all");
+
+            // ...and from the metrics history
+            //
+            MHremoveDevice(al_mac_address);
+
+            EVdeviceRemoved(al_mac_address);
         }
 
         if (NULL != p)
@@ -1768,64 +3424,32 @@ INT8U DMrunGarbageCollector(void)
 
 void DMremoveALNeighborFromInterface(INT8U *al_mac_address, char *interface_name)
 {
-    INT8U i, j;
+    INT16U i;
+    INT8U  all;
+    INT8U  interface_id;
 
-    for (i=0; i<data_model.local_interfaces_nr; i++)
-    {
-        INT8U original_neighbors_nr;
+    all          = (3 == PLATFORM_STRLEN(interface_name) && 0 == PLATFORM_MEMCMP(interface_name, "all", 3)) ? 1 : 0;
+    interface_id = _nameToInterfaceId(interface_name);
 
-        if (
-             (0 != PLATFORM_MEMCMP(data_model.local_interfaces[i].name, interface_name, PLATFORM_STRLEN(data_model.local_interfaces[i].name)+1)) &&
-             (0 != PLATFORM_MEMCMP(interface_name,                      "all",          PLATFORM_STRLEN(interface_name)+1))
-           )
+    for (i=0; i<data_model.neighbors.nr; i++)
+    {
+        if (0 != PLATFORM_MEMCMP(al_mac_address, data_model.neighbors.al_mac_addresses[i], 6))
         {
-            // Ignore this interface
-            //
             continue;
         }
 
-        original_neighbors_nr = data_model.local_interfaces[i].neighbors_nr;
-
-        for (j=0; j<data_model.local_interfaces[i].neighbors_nr; j++)
+        if (0 == all && interface_id != data_model.neighbors.interface_ids[i])
         {
-            if (0 == PLATFORM_MEMCMP(al_mac_address, data_model.local_interfaces[i].neighbors[j].al_mac_address, 6))
-            {
-                if (data_model.local_interfaces[i].neighbors[j].remote_interfaces_nr > 0 && NULL != data_model.local_interfaces[i].neighbors[j].remote_interfaces)
-                {
-                    PLATFORM_FREE(data_model.local_interfaces[i].neighbors[j].remote_interfaces);
-
-                    data_model.local_interfaces[i].neighbors[j].remote_interfaces    = NULL;
-                    data_model.local_interfaces[i].neighbors[j].remote_interfaces_nr = 0;
-                }
-
-                // Place last element here (we don't care about preserving
-                // order)
-                //
-                if (j == (data_model.local_interfaces[i].neighbors_nr-1))
-                {
-                    // Last element. It will automatically be removed
-                    // below (keep reading)
-                }
-                else
-                {
-                    data_model.local_interfaces[i].neighbors[j] = data_model.local_interfaces[i].neighbors[data_model.local_interfaces[i].neighbors_nr-1];
-                    j--;
-                }
-                data_model.local_interfaces[i].neighbors_nr--;
-            }
+            // Ignore this interface
+            //
+            continue;
         }
 
-        if (original_neighbors_nr != data_model.local_interfaces[i].neighbors_nr)
-        {
-            if (0 == data_model.local_interfaces[i].neighbors_nr)
-            {
-                PLATFORM_FREE(data_model.local_interfaces[i].neighbors);
-            }
-            else
-            {
-                data_model.local_interfaces[i].neighbors = (struct _neighbor *)PLATFORM_REALLOC(data_model.local_interfaces[i].neighbors, sizeof(struct _neighbor)*(data_model.local_interfaces[i].neighbors_nr));
-            }
-        }
+        // The next element is shifted here, thus this position must be
+        // checked again
+        //
+        _removeNeighbor(i);
+        i--;
     }
 }
 
@@ -1867,11 +3491,169 @@ struct vendorSpecificTLV ***DMextensionsGet(INT8U *al_mac_address, INT8U **nr)
     }
     else
     {
-        // Point to the datamodel extensions section
+        // Point to the datamodel extensions section (the caller is going to
+        // update it, thus the device is considered changed)
         //
+        data_model.network_devices[i].generation = ++data_model.generation;
+
         extensions = &data_model.network_devices[i].extensions;
         *nr        = &data_model.network_devices[i].extensions_nr;
     }
 
     return extensions;
 }
+
+INT8U DMsaveSnapshot(void)
+{
+    struct _snapshotWriter w;
+
+    INT8U  i;
+    INT8U  devices_nr;
+    INT32U devices_nr_offset;
+    INT8U  ret;
+    INT8U *p;
+
+    w.buffer = NULL;
+    w.len    = 0;
+    w.size   = 0;
+
+    // Header (the total length is filled at the end)
+    //
+    _snapshotWritenB(&w, DATAMODEL_SNAPSHOT_MAGIC, 4);
+    _snapshotWrite1B(&w, DATAMODEL_SNAPSHOT_VERSION);
+    _snapshotWrite4B(&w, 0);
+    _snapshotWritenB(&w, data_model.al_mac_address, 6);
+
+    // Local interfaces and their neighbors
+    //
+    _snapshotWrite1B(&w, data_model.local_interfaces.nr);
+    for (i=0; i<data_model.local_interfaces.nr; i++)
+    {
+        INT32U name_len;
+        INT16U n, r;
+        INT8U  neighbors_nr;
+        INT32U neighbors_nr_offset;
+
+        name_len = PLATFORM_STRLEN(data_model.local_interfaces.names[i]);
+        if (name_len > 255)
+        {
+            name_len = 255;
+        }
+
+        _snapshotWrite1B(&w, name_len);
+        _snapshotWritenB(&w, data_model.local_interfaces.names[i], name_len);
+        _snapshotWritenB(&w, data_model.local_interfaces.mac_addresses[i], 6);
+
+        // The number of neighbors of this interface is filled once they have
+        // all been written
+        //
+        neighbors_nr        = 0;
+        neighbors_nr_offset = w.len;
+        _snapshotWrite1B(&w, 0);
+
+        for (n=_firstNeighborId(i); n<data_model.neighbors.nr && i == data_model.neighbors.interface_ids[n]; n++)
+        {
+            INT8U  remote_interfaces_nr;
+            INT32U remote_interfaces_nr_offset;
+
+            if (255 == neighbors_nr)
+            {
+                break;
+            }
+
+            _snapshotWritenB(&w, data_model.neighbors.al_mac_addresses[n], 6);
+
+            remote_interfaces_nr        = 0;
+            remote_interfaces_nr_offset = w.len;
+            _snapshotWrite1B(&w, 0);
+
+            for (r=_firstRemoteInterfaceId(n); r<data_model.remote_interfaces.nr && n == data_model.remote_interfaces.neighbor_ids[r]; r++)
+            {
+                if (255 == remote_interfaces_nr)
+                {
+                    break;
+                }
+
+                _snapshotWritenB(&w, data_model.remote_interfaces.mac_addresses[r], 6);
+                remote_interfaces_nr++;
+            }
+
+            p = w.buffer + remote_interfaces_nr_offset;
+            _I1B(&remote_interfaces_nr, &p);
+
+            neighbors_nr++;
+        }
+
+        p = w.buffer + neighbors_nr_offset;
+        _I1B(&neighbors_nr, &p);
+    }
+
+    // Network devices (the number of entries is filled at the end, as some of
+    // them are skipped)
+    //
+    devices_nr        = 0;
+    devices_nr_offset = w.len;
+    _snapshotWrite1B(&w, 0);
+
+    for (i=0; i<data_model.network_devices_nr; i++)
+    {
+        struct _networkDevice *x;
+
+        x = &data_model.network_devices[i];
+
+        if (NULL == x->info || 0 == PLATFORM_MEMCMP(x->info->al_mac_address, data_model.al_mac_address, 6))
+        {
+            // Devices we know nothing about and the local device (which is
+            // always regenerated on demand) are not saved
+            //
+            continue;
+        }
+
+        _snapshotWriteDeviceTLVs(&w, x);
+
+        devices_nr++;
+    }
+
+    p = w.buffer + devices_nr_offset;
+    _I1B(&devices_nr, &p);
+
+    p = w.buffer + 4 + 1;
+    _I4B(&w.len, &p);
+
+    ret = PLATFORM_SAVE_DATAMODEL_SNAPSHOT(w.buffer, w.len);
+
+    if (1 == ret)
+    {
+        PLATFORM_PRINTF_DEBUG_DETAIL("Data model snapshot saved (%d devices, %d bytes)\n", devices_nr, w.len);
+    }
+
+    PLATFORM_FREE(w.buffer);
+
+    return ret;
+}
+
+INT8U DMloadSnapshot(void)
+{
+    INT8U  *buffer;
+    INT32U  len;
+    INT8U   ret;
+
+    if (NULL == (buffer = PLATFORM_MAP_DATAMODEL_SNAPSHOT(&len)))
+    {
+        // No snapshot available
+        //
+        return 0;
+    }
+
+    if (0 == (ret = _snapshotParse(buffer, len)))
+    {
+        // Do not keep a half restored data model
+        //
+        _snapshotDiscard();
+    }
+
+    PLATFORM_UNMAP_DATAMODEL_SNAPSHOT(buffer, len);
+
+    return ret;
+}
+
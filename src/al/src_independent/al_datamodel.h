@@ -261,6 +261,19 @@ INT8U DMisInterfaceBridged(char *local_interface_name);
 //
 INT8U *DMmacToAlMac(INT8U *mac_addresses);
 
+// Return a counter that is incremented every time something which is part of
+// the local view of the topology changes: the AL MAC address, the list of
+// local interfaces, the 1905 neighbors (and their interfaces) seen on each of
+// them and whether they are bridged or not.
+//
+// In other words, whenever the result of "DMgetListOfInterfaceNeighbors()",
+// "DMmacToAlMac()" or "DMisNeighborBridged()" might have changed.
+//
+// Changes in the information of other devices (including the remote ends of
+// local links) do not increment it.
+//
+INT32U DMlocalGenerationGet(void);
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // (Global) network topology related functions
@@ -392,8 +405,72 @@ INT8U DMupdateNetworkDeviceMetrics(INT8U *metrics);
 // Print the contents of the "devices" database using the provided printf-like
 // function.
 //
+// The current "generation" of the database is also printed: every time a
+// device or a link is created, changed or removed this counter is incremented
+// (and its new value is attached to the affected entry). So is the "epoch", a
+// random number that identifies this run of the AL entity.
+//
 void DMdumpNetworkDevices(void (*write_function)(const char *fmt, ...));
 
+// Same as "DMdumpNetworkDevices()", but only the devices and links created or
+// changed after 'generation' (and the ones removed since then) are printed.
+//
+// If the changes since 'generation' can no longer be computed (because it is
+// too old or because 'epoch' is not the current one, ie. it belongs to a
+// previous run of the AL entity) the whole database is printed instead, and
+// this is indicated in the output (so that the client discards whatever it
+// knew before).
+//
+// Clients are expected to poll using the "epoch" and "generation" values they
+// obtained from the previous dump.
+//
+void DMdumpNetworkDevicesSince(INT32U epoch, INT32U generation, void (*write_function)(const char *fmt, ...));
+
+// Same as "DMdumpNetworkDevices()", but only the devices that match all the
+// given filters are printed, and only the parts of them selected in
+// 'sections' (a combination of the "CUSTOM_COMMAND_QUERY_SECTION_*" flags
+// defined in "1905_alme.h"):
+//
+//   - 'al_mac_addresses': if 'al_mac_addresses_nr' is not '0', only devices
+//     whose AL MAC address is one of these ones.
+//
+//   - 'media_type': if not "MEDIA_TYPE_UNKNOWN", only devices with at least
+//     one interface of this type.
+//
+//   - 'max_phy_rate': if not '0', only devices with at least one link whose
+//     transmitter PHY rate (in Mbps) is below this value. In this case only
+//     the metrics of those links are printed.
+//
+void DMqueryNetworkDevices(INT8U al_mac_addresses_nr, INT8U (*al_mac_addresses)[6], INT16U media_type, INT16U max_phy_rate, INT16U sections, void (*write_function)(const char *fmt, ...));
+
+// Same information as "DMdumpNetworkDevices()", but in the compact binary
+// format described next to "CUSTOM_COMMAND_EXPORT_MAGIC" (in "1905_alme.h")
+// instead of as text.
+//
+// The export is handed over to 'write_function' in several consecutive pieces
+// (which must be concatenated), so that it never needs to be completely
+// built in memory.
+//
+void DMexportNetworkDevices(void (*write_function)(INT8U *buffer, INT32U len));
+
+// Publish the contents of "DMexportNetworkDevices()" in the shared memory
+// region provided by the platform (see "PLATFORM_MAP_TOPOLOGY_IMAGE()"), so
+// that local processes can read the topology without having to send ALME
+// requests (and without any intervention from the AL entity).
+//
+// Updates are protected by a sequence counter, as explained next to
+// "struct topologyImageHeader" in "1905_alme.h".
+//
+// This function is meant to be called after processing each event: if the
+// data model has not changed (ie. its "generation" is the same) since the
+// previous call, nothing is done. Otherwise only the devices that have changed
+// are serialized again (the rest are copied as they were), and the image is
+// replaced.
+//
+// Note that update timestamps are only refreshed when the image is replaced.
+//
+void DMpublishTopologyImage(void);
+
 // This function must be called from time to time (every "x" seconds, where "x"
 // should be a number slightly greate than "GC_MAX_AGE") to remove device
 // entries from the database.
@@ -447,5 +524,34 @@ void DMremoveALNeighborFromInterface(INT8U *al_mac_address, char *interface_name
 //
 struct vendorSpecificTLV ***DMextensionsGet(INT8U *al_mac_address, INT8U **nr);
 
+// Serialize the contents of the database (local interfaces, their neighbors and
+// all the remote devices information) into a compact, versioned binary
+// "snapshot" and hand it to the platform so that it survives a restart of the
+// AL entity (see "PLATFORM_SAVE_DATAMODEL_SNAPSHOT()").
+//
+// Return '0' if there was a problem (or if the platform does not support
+// snapshots), '1' otherwise.
+//
+INT8U DMsaveSnapshot(void);
+
+// Restore the contents of the database from the snapshot previously saved with
+// "DMsaveSnapshot()".
+//
+// It must be called *after* all local interfaces have been inserted with
+// "DMinsertInterface()" (neighbors seen on interfaces that no longer exist are
+// discarded) and only if the snapshot was taken by an AL entity with the same
+// AL MAC address.
+//
+// Restored devices are marked as "stale": they are reported as needing an
+// update by "DMnetworkDeviceInfoNeedsUpdate()" (so that the regular discovery
+// process revalidates them as soon as possible) and, if nothing is heard from
+// them in "GC_MAX_AGE" seconds, they are removed by the garbage collector.
+//
+// Return '0' if there was a problem (no snapshot, corrupted snapshot, ...), '1'
+// otherwise. When a corrupted snapshot is detected half way through, whatever
+// had already been restored from it is discarded.
+//
+INT8U DMloadSnapshot(void);
+
 #endif
 
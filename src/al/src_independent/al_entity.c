@@ -78,6 +78,10 @@
 #include "al_recv.h"
 #include "al_utils.h"
 #include "al_extension.h"
+#include "al_requests.h"
+#include "al_notifications.h"
+#include "al_receive_stats.h"
+#include "al_events.h"
 
 #include "platform_interfaces.h"
 #include "platform_os.h"
@@ -85,6 +89,19 @@
 
 #define TIMER_TOKEN_DISCOVERY          (1)
 #define TIMER_TOKEN_GARBAGE_COLLECTOR  (2)
+#define TIMER_TOKEN_DATAMODEL_SNAPSHOT (3)
+#define TIMER_TOKEN_TICK               (4)
+
+// Period (in milliseconds) of the "TIMER_TOKEN_TICK" timer, which drives all
+// the short timers of the other modules (requests retransmissions, held down
+// notifications and events subscriptions) so that a single periodic timer is
+// needed for all of them. It must divide the period of each of them.
+//
+#define TICK_TIMER_PERIOD              (100)
+
+#if (REQUESTS_TIMER_PERIOD % TICK_TIMER_PERIOD) || (NOTIFICATIONS_TIMER_PERIOD % TICK_TIMER_PERIOD) || (EVENTS_TIMER_PERIOD % TICK_TIMER_PERIOD)
+#error The period of the tick timer must divide the period of all the timers it drives
+#endif
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -730,27 +747,19 @@ void _checkForwarding(INT8U *receiving_interface_addr, INT8U *destination_mac_ad
     return;
 }
 
-// This function sends an "AP-autoconfig search" message on all authenticated
+// Send an "AP-autoconfig search" message (with MID 'mid') on all authenticated
 // interfaces BUT ONLY if there is at least one unconfigured AP interface on
 // this node.
-// 
-// A function has been created for this because the same code is executed from
-// three different places:
 //
-//   - When a new interface becomes authenticated
+// Returns '0' if there is no unconfigured AP interface (ie. if there is
+// nothing to search for), '1' otherwise.
 //
-//   - When the *local* push button is pressed and there is at least one
-//     interface which does not support this configuration mechanism (ex:
-//     ethernet)
+// Its arguments are the ones "RQsendRequest()" expects ('interface_name' and
+// 'al_mac_address' are not used)
 //
-//   - After a local unconfigured AP interface becomes configured (this is
-//     needed in the unlikely situation where there are more than one
-//     unconfigured APs in the same node)
-//
-void _triggerAPSearchProcess(void)
+static INT8U _sendAPSearch(__attribute__((unused)) char *interface_name, INT16U mid, __attribute__((unused)) INT8U *al_mac_address)
 {
     INT8U  i;
-    INT16U mid;
 
     char **ifs_names;
     INT8U  ifs_nr;
@@ -829,7 +838,6 @@ void _triggerAPSearchProcess(void)
 
     if (1 == unconfigured_ap_exists)
     {
-        mid = getNextMid();
         for (i=0; i<ifs_nr; i++)
         {
             INT8U authenticated;
@@ -877,6 +885,60 @@ void _triggerAPSearchProcess(void)
     }
 
     PLATFORM_FREE_LIST_OF_1905_INTERFACES(ifs_names, ifs_nr);
+
+    return unconfigured_ap_exists;
+}
+
+// Start the "AP-autoconfig search" process (see "_sendAPSearch()").
+//
+// A function has been created for this because the same code is executed from
+// three different places:
+//
+//   - When a new interface becomes authenticated
+//
+//   - When the *local* push button is pressed and there is at least one
+//     interface which does not support this configuration mechanism (ex:
+//     ethernet)
+//
+//   - After a local unconfigured AP interface becomes configured (this is
+//     needed in the unlikely situation where there are more than one
+//     unconfigured APs in the same node)
+//
+void _triggerAPSearchProcess(void)
+{
+    INT8U mcast_address[] = MCAST_1905;
+
+    // The search is not sent to any particular node, thus it is tracked (and
+    // retransmitted until a registrar answers) using the multicast address as
+    // its destination
+    //
+    if (0 == RQsendRequest(mcast_address, CMDU_TYPE_AP_AUTOCONFIGURATION_SEARCH, 0, NULL, _sendAPSearch, NULL))
+    {
+        PLATFORM_PRINTF_DEBUG_DETAIL("No AP-autoconfiguration search was sent\n");
+    }
+}
+
+// Called once a received frame ('frame_len' bytes long, starting with its
+// ethernet header) has been completely processed: keep a copy of it in the
+// flight recorder (annotated with its 'verdict') and update the receive
+// pipeline statistics (see "RSframeEnd()").
+//
+static void _receivedFrameDone(char *interface_name, INT8U *frame, INT16U frame_len, INT8U verdict, INT16U ether_type, INT16U cmdu_type)
+{
+    static char *annotations[RECEIVE_VERDICTS_NR] =
+    {
+        "processed",
+        "fragment",
+        "duplicate",
+        "discarded",
+    };
+
+    if (frame_len >= 14)
+    {
+        PLATFORM_RECORD_FRAME(PLATFORM_FRAME_RECEIVED, interface_name, frame, frame + 14, frame_len - 14, annotations[verdict]);
+    }
+
+    RSframeEnd(verdict, ether_type, cmdu_type);
 }
 
 
@@ -888,6 +950,7 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
 {
     INT8U   queue_id;
     INT8U  *queue_message;
+    INT32U  ticks;
 
     char   **interfaces_names;
     INT8U    interfaces_nr;
@@ -989,6 +1052,16 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
         PLATFORM_FREE_1905_INTERFACE_INFO(x);
     }
 
+    // If the data model was saved before the last shutdown, restore it now
+    // (now that all local interfaces are known). Restored entries will be
+    // revalidated by the regular discovery process.
+    //
+    PLATFORM_PRINTF_DEBUG_DETAIL("Restoring data model snapshot...\n");
+    if (1 == DMloadSnapshot())
+    {
+        PLATFORM_PRINTF_DEBUG_INFO("Data model restored from snapshot\n");
+    }
+
     // Create a queue that will later be used by the platform code to notify us
     // when certain types of "events" take place
     //
@@ -1058,6 +1131,44 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
         }
     }
 
+    // ...and another one to periodically save the data model so that it can be
+    // restored after a restart (only if the platform is going to store it)
+    //
+    if (1 == PLATFORM_SAVE_DATAMODEL_SNAPSHOT(NULL, 0))
+    {
+        struct eventTimeOut aux;
+
+        PLATFORM_PRINTF_DEBUG_DETAIL("Registering DATAMODEL SNAPSHOT time out event (periodic)...\n");
+
+        aux.timeout_ms = 300000;  // 5 minutes
+        aux.token      = TIMER_TOKEN_DATAMODEL_SNAPSHOT;
+
+        if (0 == PLATFORM_REGISTER_QUEUE_EVENT(queue_id, PLATFORM_QUEUE_EVENT_TIMEOUT_PERIODIC, &aux))
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("Could not register timer callback\n");
+            return AL_ERROR_OS;
+        }
+    }
+
+    // ...and a short one which drives the timers of other modules: it
+    // retransmits (or gives up on) the queries that have not been answered in
+    // time, sends the topology change notifications that have been held down
+    // and ends the events subscriptions of the HLEs that have gone away
+    //
+    PLATFORM_PRINTF_DEBUG_DETAIL("Registering TICK time out event (periodic)...\n");
+    {
+        struct eventTimeOut aux;
+
+        aux.timeout_ms = TICK_TIMER_PERIOD;
+        aux.token      = TIMER_TOKEN_TICK;
+
+        if (0 == PLATFORM_REGISTER_QUEUE_EVENT(queue_id, PLATFORM_QUEUE_EVENT_TIMEOUT_PERIODIC, &aux))
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("Could not register timer callback\n");
+            return AL_ERROR_OS;
+        }
+    }
+
     // As soon as we enter the queue message processing loop we want to start
     // the discovery process as if a "DISCOVERY timeout" event had just
     // happened.
@@ -1122,6 +1233,16 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
         return AL_ERROR_OS;
     }
 
+    // ...and the "shutdown" event, so that we have the chance to save the data
+    // model before exiting.
+    //
+    PLATFORM_PRINTF_DEBUG_DETAIL("Registering the SHUTDOWN event...\n");
+    if (0 == PLATFORM_REGISTER_QUEUE_EVENT(queue_id, PLATFORM_QUEUE_EVENT_SHUTDOWN, NULL))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Could not register 'shutdown' event\n");
+        return AL_ERROR_OS;
+    }
+
     // Any third-party software based on ieee1905 can extend the protocol
     // behaviour
     //
@@ -1136,6 +1257,8 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
     PLATFORM_PRINTF_DEBUG_DETAIL("Allocating memory to hold a queue message...\n");
     queue_message = (INT8U *)PLATFORM_MALLOC(MAX_NETWORK_SEGMENT_SIZE+3);
     
+    ticks = 0;
+
     PLATFORM_PRINTF_DEBUG_DETAIL("Entering read-process loop...\n");
     while(1)
     {
@@ -1173,6 +1296,11 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                 INT8U  receiving_interface_addr[6];
                 char  *receiving_interface_name;
 
+                INT8U  verdict;
+                INT16U cmdu_type;
+
+                RSframeStart();
+
                 // The first six bytes of the message payload contain the MAC
                 // address of the interface where the packet was received
                 //
@@ -1182,22 +1310,26 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                 if (NULL == receiving_interface_name)
                 {
                     PLATFORM_PRINTF_DEBUG_ERROR("A packet was receiving on MAC %02x:%02x:%02x:%02x:%02x:%02x, which does not match any local interface\n",receiving_interface_addr[0], receiving_interface_addr[1], receiving_interface_addr[2], receiving_interface_addr[3], receiving_interface_addr[4], receiving_interface_addr[5]);
+                    _receivedFrameDone(NULL, p, message_len - 6, RECEIVE_VERDICT_DISCARDED, 0, 0);
                     continue;
                 }
 
-                x = PLATFORM_GET_1905_INTERFACE_INFO(receiving_interface_name);
+                x = PLATFORM_GET_1905_INTERFACE_INFO_CACHED(receiving_interface_name);
                 if (NULL == x)
                 {
                     PLATFORM_PRINTF_DEBUG_WARNING("Could not retrieve info of interface %s\n", receiving_interface_name);
+                    _receivedFrameDone(receiving_interface_name, p, message_len - 6, RECEIVE_VERDICT_DISCARDED, 0, 0);
                     continue;
                 }
                 if (0 == x->is_secured)
                 {
                     PLATFORM_PRINTF_DEBUG_WARNING("This interface (%s) is not secured. No packets should be received. Ignoring...\n", receiving_interface_name);
-                    PLATFORM_FREE_1905_INTERFACE_INFO(x);
+                    _receivedFrameDone(receiving_interface_name, p, message_len - 6, RECEIVE_VERDICT_DISCARDED, 0, 0);
                     continue;
                 }
-                PLATFORM_FREE_1905_INTERFACE_INFO(x);
+
+                verdict   = RECEIVE_VERDICT_DISCARDED;
+                cmdu_type = 0;
 
                 q = p;
 
@@ -1235,6 +1367,8 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                             processLlpdPayload(payload, receiving_interface_addr);
 
                             free_lldp_PAYLOAD_structure(payload);
+
+                            verdict = RECEIVE_VERDICT_PROCESSED;
                         }
 
                         break;
@@ -1253,6 +1387,8 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                             // This was just a fragment part of a big CMDU.
                             // The data has been internally cached, waiting for
                             // the rest of pieces.
+                            //
+                            verdict = RECEIVE_VERDICT_FRAGMENT;
                         }
                         else
                         {
@@ -1261,11 +1397,16 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                                )
                             {
                                PLATFORM_PRINTF_DEBUG_WARNING("Receiving on %s a CMDU which is a duplicate of a previous one (mid = %d). Discarding...\n", receiving_interface_name, c->message_id);
+
+                               verdict = RECEIVE_VERDICT_DUPLICATE;
                             }
                             else
                             {
                                 INT8U res;
 
+                                verdict   = RECEIVE_VERDICT_PROCESSED;
+                                cmdu_type = c->message_type;
+
                                 PLATFORM_PRINTF_DEBUG_DETAIL("CMDU message contents:\n");
                                 visit_1905_CMDU_structure(c, print_callback, PLATFORM_PRINTF_DEBUG_DETAIL, "");
 
@@ -1297,6 +1438,8 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                     }
                 }
 
+                _receivedFrameDone(receiving_interface_name, p, message_len - 6, verdict, ether_type, cmdu_type);
+
                 break;
             }
 
@@ -1355,6 +1498,9 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                         char **ifs_names;
                         INT8U  ifs_nr;
 
+                        char **discovery_ifs_names;
+                        INT8U  discovery_ifs_nr;
+
                         // According to "Section 8.2.1.1" and "Section 8.2.1.2"
                         // we now have to send a "Topology discovery message"
                         // followed by a "802.1 bridge discovery message" but,
@@ -1362,8 +1508,13 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                         // and every of the *authenticated* 1905 interfaces
                         // that are in the state of "PWR_ON" or "PWR_SAVE"
                         //
+                        // All of them are sent together at the end, in one
+                        // single batch.
+                        //
                         ifs_names = PLATFORM_GET_LIST_OF_1905_INTERFACES(&ifs_nr);
                         mid       = getNextMid();
+                        discovery_ifs_names = (char **)PLATFORM_MALLOC(sizeof(char *) * (ifs_nr > 0 ? ifs_nr : 1));
+                        discovery_ifs_nr    = 0;
                         for (i=0; i<ifs_nr; i++)
                         {
                             INT8U authenticated;
@@ -1371,7 +1522,7 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
 
                             struct interfaceInfo *x;
 
-                            x = PLATFORM_GET_1905_INTERFACE_INFO(ifs_names[i]);
+                            x = PLATFORM_GET_1905_INTERFACE_INFO_CACHED(ifs_names[i]);
                             if (NULL == x)
                             {
                                 PLATFORM_PRINTF_DEBUG_WARNING("Could not retrieve info of interface %s\n", ifs_names[i]);
@@ -1382,8 +1533,6 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                             {
                                 authenticated = x->is_secured;
                                 power_state   = x->power_state;
-
-                                PLATFORM_FREE_1905_INTERFACE_INFO(x);
                             }
 
                             if (
@@ -1397,21 +1546,31 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                                 continue;
                             }
 
-                            // Topology discovery message
-                            //
-                            if (0 == send1905TopologyDiscoveryPacket(ifs_names[i], mid))
-                            {
-                                PLATFORM_PRINTF_DEBUG_WARNING("Could not send 1905 topology discovery message\n");
-                            }
+                            discovery_ifs_names[discovery_ifs_nr++] = ifs_names[i];
+                        }
 
-                            // 802.1 bridge discovery message
-                            //
-                            if (0 == sendLLDPBridgeDiscoveryPacket(ifs_names[i]))
+                        // Topology discovery message and 802.1 bridge
+                        // discovery message
+                        //
+                        if (0 == send1905DiscoveryPackets(discovery_ifs_names, discovery_ifs_nr, mid))
+                        {
+                            PLATFORM_PRINTF_DEBUG_WARNING("Could not send 1905 topology discovery and LLDP bridge discovery messages\n");
+                        }
+                        PLATFORM_FREE(discovery_ifs_names);
+                        PLATFORM_FREE_LIST_OF_1905_INTERFACES(ifs_names, ifs_nr);
+
+                        // When the topology image is being published, the
+                        // local device entry must also be kept up to date (as
+                        // nobody is going to ask for it)
+                        //
+                        {
+                            INT32U size;
+
+                            if (NULL != PLATFORM_MAP_TOPOLOGY_IMAGE(sizeof(struct topologyImageHeader), &size))
                             {
-                                PLATFORM_PRINTF_DEBUG_WARNING("Could not send LLDP bridge discovery message\n");
+                                _updateLocalDeviceData();
                             }
                         }
-                        PLATFORM_FREE_LIST_OF_1905_INTERFACES(ifs_names, ifs_nr);
 
                         break;
                     }
@@ -1422,62 +1581,45 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
 
                         if (DMrunGarbageCollector() > 0)
                         {
-                            INT16U mid;
-
-                            char **ifs_names;
-                            INT8U  ifs_nr;
-
-                            PLATFORM_PRINTF_DEBUG_DETAIL("Some elements were removed. Sending a topology change notification...");
+                            PLATFORM_PRINTF_DEBUG_DETAIL("Some elements were removed. Scheduling a topology change notification...\n");
 
                             // According to "Section 8.2.2.3" and "Section
                             // 7.2", we now have to send a "Topology
-                            // Notification message) on all *authenticated*
-                            // interfaces that are in the state of "PWR_ON" or
-                            // "PWR_SAVE"
+                            // Notification message" (see
+                            // "NTtopologyChanged()" for details on when and
+                            // on which interfaces it is sent)
                             //
-                            ifs_names = PLATFORM_GET_LIST_OF_1905_INTERFACES(&ifs_nr);
-                            mid       = getNextMid();
-                            for (i=0; i<ifs_nr; i++)
-                            {
-                                INT8U authenticated;
-                                INT8U power_state;
-
-                                struct interfaceInfo *x;
+                            NTtopologyChanged(NOTIFICATION_REASON_NODES_REMOVED);
+                        }
+                        break;
+                    }
 
-                                x = PLATFORM_GET_1905_INTERFACE_INFO(ifs_names[i]);
-                                if (NULL == x)
-                                {
-                                    PLATFORM_PRINTF_DEBUG_WARNING("Could not retrieve info of interface %s\n", ifs_names[i]);
-                                    authenticated = 0;
-                                    power_state   = INTERFACE_POWER_STATE_OFF;
-                                }
-                                else
-                                {
-                                    authenticated = x->is_secured;
-                                    power_state   = x->power_state;
+                    case TIMER_TOKEN_DATAMODEL_SNAPSHOT:
+                    {
+                        PLATFORM_PRINTF_DEBUG_DETAIL("Saving data model snapshot...\n");
 
-                                    PLATFORM_FREE_1905_INTERFACE_INFO(x);
-                                }
+                        DMsaveSnapshot();
+                        break;
+                    }
 
-                                if (
-                                    (0 == authenticated                                                                     ) ||
-                                    ((power_state != INTERFACE_POWER_STATE_ON) && (power_state!= INTERFACE_POWER_STATE_SAVE))
-                                   )
-                                {
-                                    // Do not send the topology notification  messages on
-                                    // this interface
-                                    //
-                                    continue;
-                                }
+                    case TIMER_TOKEN_TICK:
+                    {
+                        // Each module is only called when its own period
+                        // has elapsed
+                        //
+                        ticks++;
 
-                                // Topology notification message
-                                //
-                                if (0 == send1905TopologyNotificationPacket(ifs_names[i], mid))
-                                {
-                                    PLATFORM_PRINTF_DEBUG_WARNING("Could not send 1905 topology discovery message\n");
-                                }
-                            }
-                            PLATFORM_FREE_LIST_OF_1905_INTERFACES(ifs_names, ifs_nr);
+                        if (0 == ticks % (REQUESTS_TIMER_PERIOD / TICK_TIMER_PERIOD))
+                        {
+                            RQprocessTimers();
+                        }
+                        if (0 == ticks % (NOTIFICATIONS_TIMER_PERIOD / TICK_TIMER_PERIOD))
+                        {
+                            NTprocessTimers();
+                        }
+                        if (0 == ticks % (EVENTS_TIMER_PERIOD / TICK_TIMER_PERIOD))
+                        {
+                            EVprocessTimers();
                         }
                         break;
                     }
@@ -1504,6 +1646,11 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
 
                 PLATFORM_PRINTF_DEBUG_DETAIL("New queue message arrived: push button event\n");
 
+                // The "push button" status of the interfaces is about to
+                // change. Make sure the cached info is not used from now on.
+                //
+                PLATFORM_INVALIDATE_1905_INTERFACE_INFO(NULL);
+
                 // According to "Section 9.2.2.1", we must first make sure that
                 // none of the interfaces is in the middle of a previous "push
                 // button" configuration sequence.
@@ -1541,6 +1688,8 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                     break;
                 }
 
+                EVpushButton(CUSTOM_COMMAND_EVENT_PUSH_BUTTON_PRESSED, DMalMacGet(), NULL);
+
                 // If we get here, none of the interfaces is in the middle of a
                 // "push button" configuration process, thus we can initialize
                 // the "push button event" on all of our interfaces that support
@@ -1630,6 +1779,8 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                     {
                         PLATFORM_PRINTF_DEBUG_INFO("Starting push button configuration process on interface %s\n", ifs_names[i]);
                         PLATFORM_START_PUSH_BUTTON_CONFIGURATION(ifs_names[i], queue_id, DMalMacGet(), mid);
+
+                        EVpushButton(CUSTOM_COMMAND_EVENT_PUSH_BUTTON_STARTED, DMalMacGet(), DMinterfaceNameToMac(ifs_names[i]));
                     }
                     if (2 == no_push_button[i])
                     {
@@ -1732,6 +1883,10 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                 //
                 _EnB(&p, local_mac_addr, 6);
 
+                // The security status of the interface has changed
+                //
+                PLATFORM_INVALIDATE_1905_INTERFACE_INFO(NULL);
+
                 // The next six bytes contain the MAC address of the interface
                 // successfully authenticated at the other end.
                 //
@@ -1753,6 +1908,8 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                 PLATFORM_PRINTF_DEBUG_DETAIL("    Original AL MAC       : %02x:%02x:%02x:%02x:%02x:%02x\n", original_al_mac_addr[0], original_al_mac_addr[1], original_al_mac_addr[2], original_al_mac_addr[3], original_al_mac_addr[4], original_al_mac_addr[5]);
                 PLATFORM_PRINTF_DEBUG_DETAIL("    Original MID          : %d\n", original_mid);
 
+                EVpushButton(CUSTOM_COMMAND_EVENT_PUSH_BUTTON_AUTHENTICATED, DMalMacGet(), local_mac_addr);
+
                 ifs_names = PLATFORM_GET_LIST_OF_1905_INTERFACES(&ifs_nr);
 
                 // If "new_mac_addr" is NULL, this means the interface was
@@ -1840,12 +1997,28 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
 
             case PLATFORM_QUEUE_EVENT_TOPOLOGY_CHANGE_NOTIFICATION:
             {
-                INT16U mid;
+                PLATFORM_PRINTF_DEBUG_DETAIL("New queue message arrived: topology change notification event\n");
 
-                char **ifs_names;
-                INT8U  ifs_nr;
+                // Something has changed in (at least) one of the local
+                // interfaces. Drop its cached info (or the info of all of
+                // them, if the platform does not know which one it was).
+                //
+                if (message_len > 0)
+                {
+                    p[message_len-1] = 0x0;
+                    PLATFORM_INVALIDATE_1905_INTERFACE_INFO((char *)p);
+                }
+                else
+                {
+                    PLATFORM_INVALIDATE_1905_INTERFACE_INFO(NULL);
+                }
 
-                PLATFORM_PRINTF_DEBUG_DETAIL("New queue message arrived: topology change notification event\n");
+                // Changes in the information of interfaces and in the
+                // neighbors are detected when building the next topology
+                // response, but others (such as an interface joining or
+                // leaving a bridge) are only known through this event
+                //
+                invalidateTopologyResponse();
 
                 // TODO:
                 //   1. Find which L2 neighbors are no longer available
@@ -1858,55 +2031,27 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                 // expires.
 
                 // According to "Section 8.2.2.3" and "Section 7.2", we now
-                // have to send a "Topology Notification" message) on all
-                // *authenticated* interfaces that are in the state of "PWR_ON"
-                // or "PWR_SAVE"
+                // have to send a "Topology Notification" message (see
+                // "NTtopologyChanged()" for details on when and on which
+                // interfaces it is sent)
                 //
-                ifs_names = PLATFORM_GET_LIST_OF_1905_INTERFACES(&ifs_nr);
-                mid       = getNextMid();
-                for (i=0; i<ifs_nr; i++)
-                {
-                    INT8U authenticated;
-                    INT8U power_state;
-
-                    struct interfaceInfo *x;
+                NTtopologyChanged(NOTIFICATION_REASON_INTERFACE_CHANGE);
 
-                    x = PLATFORM_GET_1905_INTERFACE_INFO(ifs_names[i]);
-                    if (NULL == x)
-                    {
-                        PLATFORM_PRINTF_DEBUG_WARNING("Could not retrieve info of interface %s\n", ifs_names[i]);
-                        authenticated = 0;
-                        power_state   = INTERFACE_POWER_STATE_OFF;
-                    }
-                    else
-                    {
-                        authenticated = x->is_secured;
-                        power_state   = x->power_state;
+                break;
+            }
 
-                        PLATFORM_FREE_1905_INTERFACE_INFO(x);
-                    }
+            case PLATFORM_QUEUE_EVENT_SHUTDOWN:
+            {
+                PLATFORM_PRINTF_DEBUG_INFO("New queue message arrived: shutdown event\n");
 
-                    if (
-                        (0 == authenticated                                                                     ) ||
-                        ((power_state != INTERFACE_POWER_STATE_ON) && (power_state!= INTERFACE_POWER_STATE_SAVE))
-                       )
-                    {
-                        // Do not send the topology notification  messages on
-                        // this interface
-                        //
-                        continue;
-                    }
+                // Save the data model one last time so that the next run can
+                // start from it instead of rediscovering the whole network
+                //
+                DMsaveSnapshot();
 
-                    // Topology notification message
-                    //
-                    if (0 == send1905TopologyNotificationPacket(ifs_names[i], mid))
-                    {
-                        PLATFORM_PRINTF_DEBUG_WARNING("Could not send 1905 topology discovery message\n");
-                    }
-                }
-                PLATFORM_FREE_LIST_OF_1905_INTERFACES(ifs_names, ifs_nr);
+                PLATFORM_FREE(queue_message);
 
-                break;
+                return 0;
             }
 
             default:
@@ -1916,6 +2061,11 @@ INT8U start1905AL(INT8U *al_mac_address, INT8U map_whole_network_flag, char *reg
                 break;
             }
         }
+
+        // Let local readers know about whatever has changed while processing
+        // this message
+        //
+        DMpublishTopologyImage();
     }
 
     return 0;
@@ -0,0 +1,536 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_SEND
+
+#include "platform.h"
+#include "packet_tools.h"
+
+#include "1905_tlvs.h"
+#include "1905_alme.h"
+
+#include "al_datamodel.h"
+#include "al_events.h"
+
+#include "platform_alme_server.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Private functions and data
+////////////////////////////////////////////////////////////////////////////////
+
+// Maximum length of an event (the longest one is
+// CUSTOM_COMMAND_EVENT_LINK_METRIC)
+//
+#define EVENT_MAX_LEN  (CUSTOM_COMMAND_EVENT_HEADER_LEN + 6 + 6 + 6 + 1 + 2 + 2)
+
+// Last value of each link metric sent to a subscriber (the next one is only
+// sent when it differs from it by more than the subscriber threshold, thus
+// slow drifts are also reported)
+//
+struct _metricBaseline
+{
+    INT8U   al_mac_address[6];
+    INT8U   neighbor_al_mac_address[6];
+    INT8U   local_interface_address[6];
+    INT8U   neighbor_interface_address[6];
+    INT8U   metric;
+    INT16U  value;
+};
+
+struct _subscriber
+{
+    INT8U                    in_use;
+    INT8U                    alme_client_id;
+
+    INT16U                   events;
+    INT8U                    metric_threshold;
+    INT8U                    al_mac_addresses_nr;
+    INT8U                  (*al_mac_addresses)[6];
+
+    INT32U                   sequence;      // Of the next event
+
+    struct _metricBaseline  *baselines;
+    INT32U                   baselines_nr;
+};
+
+static struct _subscriber subscribers[EVENTS_MAX_SUBSCRIBERS];
+static INT32U             subscribers_nr = 0;
+
+// End the subscription of 's' (terminating the reply to its request)
+//
+static void _removeSubscriber(struct _subscriber *s)
+{
+    struct customCommandResponseALME  out;
+
+    INT8U   *packet;
+    INT16U   packet_len;
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("Events subscriber (client id %d) has gone. Removing it...\n", s->alme_client_id);
+
+    out.alme_type = ALME_TYPE_CUSTOM_COMMAND_RESPONSE;
+    out.bytes_nr  = 0;
+    out.bytes     = NULL;
+
+    packet = forge_1905_ALME_from_structure((INT8U *)&out, &packet_len);
+    PLATFORM_SEND_ALME_REPLY(s->alme_client_id, packet, NULL == packet ? 0 : packet_len);
+    if (NULL != packet)
+    {
+        free_1905_ALME_packet(packet);
+    }
+
+    if (NULL != s->al_mac_addresses)
+    {
+        PLATFORM_FREE(s->al_mac_addresses);
+    }
+    if (NULL != s->baselines)
+    {
+        PLATFORM_FREE(s->baselines);
+    }
+    PLATFORM_MEMSET(s, 0x0, sizeof(struct _subscriber));
+
+    subscribers_nr--;
+}
+
+// Return '1' if subscriber 's' wants to receive events of type 'type' that
+// refer to device 'al_mac_address' (or to 'other_al_mac_address', which can be
+// NULL)
+//
+static INT8U _wants(struct _subscriber *s, INT8U type, INT8U *al_mac_address, INT8U *other_al_mac_address)
+{
+    INT8U i;
+
+    if (0 == s->in_use || 0 == (s->events & (1 << type)))
+    {
+        return 0;
+    }
+
+    if (0 == s->al_mac_addresses_nr)
+    {
+        return 1;
+    }
+
+    for (i=0; i<s->al_mac_addresses_nr; i++)
+    {
+        if (
+             0 == PLATFORM_MEMCMP(s->al_mac_addresses[i], al_mac_address, 6) ||
+             (NULL != other_al_mac_address && 0 == PLATFORM_MEMCMP(s->al_mac_addresses[i], other_al_mac_address, 6))
+           )
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Send an event of type 'type' that refers to device 'al_mac_address' (and
+// whose type specific fields are the 'payload_len' bytes of 'payload') to
+// subscriber 's'.
+//
+// If its client has gone, the subscription is ended (and '0' returned).
+//
+static INT8U _send(struct _subscriber *s, INT8U type, INT8U *al_mac_address, INT8U *payload, INT16U payload_len)
+{
+    struct customCommandResponseALME  out;
+
+    INT8U    event[EVENT_MAX_LEN];
+    INT8U   *p;
+    INT32U   now;
+
+    INT8U   *packet;
+    INT16U   packet_len;
+    INT8U    ret;
+
+    now = PLATFORM_GET_TIMESTAMP();
+
+    p = event;
+    _I1B(&type,          &p);
+    _I4B(&s->sequence,   &p);
+    _I4B(&now,           &p);
+    _InB(al_mac_address, &p, 6);
+    if (payload_len > 0)
+    {
+        _InB(payload, &p, payload_len);
+    }
+
+    s->sequence++;
+
+    out.alme_type = ALME_TYPE_CUSTOM_COMMAND_RESPONSE;
+    out.bytes_nr  = p - event;
+    out.bytes     = (char *)event;
+
+    packet = forge_1905_ALME_from_structure((INT8U *)&out, &packet_len);
+    if (NULL == packet)
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("forge_1905_ALME_from_structure() failed.\n");
+        return 1;
+    }
+
+    ret = PLATFORM_SEND_ALME_EVENT(s->alme_client_id, packet, packet_len);
+
+    free_1905_ALME_packet(packet);
+
+    if (0 == ret)
+    {
+        _removeSubscriber(s);
+    }
+
+    return ret;
+}
+
+// Send an event to all the subscribers that want it
+//
+static void _sendToAll(INT8U type, INT8U *al_mac_address, INT8U *other_al_mac_address, INT8U *payload, INT16U payload_len)
+{
+    INT32U i;
+
+    for (i=0; i<EVENTS_MAX_SUBSCRIBERS; i++)
+    {
+        if (1 == _wants(&subscribers[i], type, al_mac_address, other_al_mac_address))
+        {
+            _send(&subscribers[i], type, al_mac_address, payload, payload_len);
+        }
+    }
+}
+
+// Send a CUSTOM_COMMAND_EVENT_LINK_METRIC event to all the subscribers that
+// want it and for which 'value' has changed enough since the last one
+//
+static void _linkMetric(INT8U *al_mac_address, INT8U *neighbor_al_mac_address, INT8U *local_interface_address, INT8U *neighbor_interface_address, INT8U metric, INT16U value)
+{
+    INT32U i, j;
+
+    for (i=0; i<EVENTS_MAX_SUBSCRIBERS; i++)
+    {
+        struct _subscriber     *s;
+        struct _metricBaseline *b;
+
+        INT8U    payload[6 + 6 + 6 + 1 + 2 + 2];
+        INT8U   *p;
+        INT16U   previous;
+        INT32U   diff;
+
+        s = &subscribers[i];
+
+        if (0 == _wants(s, CUSTOM_COMMAND_EVENT_LINK_METRIC, al_mac_address, neighbor_al_mac_address))
+        {
+            continue;
+        }
+
+        for (j=0; j<s->baselines_nr; j++)
+        {
+            b = &s->baselines[j];
+
+            if (
+                 metric == b->metric                                                              &&
+                 0 == PLATFORM_MEMCMP(b->al_mac_address,             al_mac_address,             6) &&
+                 0 == PLATFORM_MEMCMP(b->neighbor_al_mac_address,    neighbor_al_mac_address,    6) &&
+                 0 == PLATFORM_MEMCMP(b->local_interface_address,    local_interface_address,    6) &&
+                 0 == PLATFORM_MEMCMP(b->neighbor_interface_address, neighbor_interface_address, 6)
+               )
+            {
+                break;
+            }
+        }
+
+        if (j < s->baselines_nr)
+        {
+            diff = value > b->value ? value - b->value : b->value - value;
+
+            if (diff * 100 <= (INT32U)s->metric_threshold * b->value)
+            {
+                continue;
+            }
+            previous = b->value;
+        }
+        else
+        {
+            // First time this link is reported to this subscriber
+            //
+            s->baselines = (struct _metricBaseline *)PLATFORM_REALLOC(s->baselines, sizeof(struct _metricBaseline) * (s->baselines_nr + 1));
+            b = &s->baselines[s->baselines_nr++];
+
+            PLATFORM_MEMCPY(b->al_mac_address,             al_mac_address,             6);
+            PLATFORM_MEMCPY(b->neighbor_al_mac_address,    neighbor_al_mac_address,    6);
+            PLATFORM_MEMCPY(b->local_interface_address,    local_interface_address,    6);
+            PLATFORM_MEMCPY(b->neighbor_interface_address, neighbor_interface_address, 6);
+            b->metric = metric;
+
+            previous = 0;
+        }
+        b->value = value;
+
+        p = payload;
+        _InB(neighbor_al_mac_address,    &p, 6);
+        _InB(local_interface_address,    &p, 6);
+        _InB(neighbor_interface_address, &p, 6);
+        _I1B(&metric,                    &p);
+        _I2B(&previous,                  &p);
+        _I2B(&value,                     &p);
+
+        _send(s, CUSTOM_COMMAND_EVENT_LINK_METRIC, al_mac_address, payload, p - payload);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Public functions (exported only to files in this same folder)
+////////////////////////////////////////////////////////////////////////////////
+
+INT8U EVsubscribe(INT8U alme_client_id, INT16U events, INT8U al_mac_addresses_nr, INT8U (*al_mac_addresses)[6], INT8U metric_threshold)
+{
+    struct _subscriber *s;
+    INT8U               payload[2];
+    INT8U              *p;
+    INT32U              i;
+
+    for (i=0; i<EVENTS_MAX_SUBSCRIBERS; i++)
+    {
+        if (0 == subscribers[i].in_use)
+        {
+            break;
+        }
+    }
+    if (EVENTS_MAX_SUBSCRIBERS == i)
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("Too many events subscribers. Ignoring new one (client id %d)...\n", alme_client_id);
+        return 0;
+    }
+
+    s = &subscribers[i];
+
+    s->in_use              = 1;
+    s->alme_client_id      = alme_client_id;
+    s->events              = events & CUSTOM_COMMAND_EVENTS_ALL;
+    s->metric_threshold    = metric_threshold;
+    s->al_mac_addresses_nr = al_mac_addresses_nr;
+    s->al_mac_addresses    = NULL;
+    s->sequence            = 0;
+    s->baselines           = NULL;
+    s->baselines_nr        = 0;
+
+    if (al_mac_addresses_nr > 0)
+    {
+        s->al_mac_addresses = (INT8U (*)[6])PLATFORM_MALLOC(sizeof(INT8U[6]) * al_mac_addresses_nr);
+        PLATFORM_MEMCPY(s->al_mac_addresses, al_mac_addresses, sizeof(INT8U[6]) * al_mac_addresses_nr);
+    }
+
+    subscribers_nr++;
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("New events subscriber (client id %d, events = 0x%04x, %d devices, threshold = %d%%)\n", alme_client_id, s->events, al_mac_addresses_nr, metric_threshold);
+
+    p = payload;
+    _I2B(&s->events, &p);
+
+    _send(s, CUSTOM_COMMAND_EVENT_SUBSCRIBED, DMalMacGet(), payload, p - payload);
+
+    return 1;
+}
+
+void EVneighborUp(INT8U *al_mac_address, INT8U *interface_mac_address)
+{
+    if (0 == subscribers_nr)
+    {
+        return;
+    }
+
+    _sendToAll(CUSTOM_COMMAND_EVENT_NEIGHBOR_UP, al_mac_address, NULL, interface_mac_address, 6);
+}
+
+void EVneighborDown(INT8U *al_mac_address, INT8U *interface_mac_address)
+{
+    if (0 == subscribers_nr)
+    {
+        return;
+    }
+
+    _sendToAll(CUSTOM_COMMAND_EVENT_NEIGHBOR_DOWN, al_mac_address, NULL, interface_mac_address, 6);
+}
+
+void EVdeviceChanged(INT8U *al_mac_address, INT32U generation)
+{
+    INT8U  payload[4];
+    INT8U *p;
+
+    if (0 == subscribers_nr)
+    {
+        return;
+    }
+
+    p = payload;
+    _I4B(&generation, &p);
+
+    _sendToAll(CUSTOM_COMMAND_EVENT_DEVICE_CHANGED, al_mac_address, NULL, payload, p - payload);
+}
+
+void EVdeviceRemoved(INT8U *al_mac_address)
+{
+    INT32U i, j;
+
+    if (0 == subscribers_nr)
+    {
+        return;
+    }
+
+    // Forget the metrics of all the links of this device (if it comes back,
+    // they will be reported again as new ones)
+    //
+    for (i=0; i<EVENTS_MAX_SUBSCRIBERS; i++)
+    {
+        struct _subscriber *s;
+
+        s = &subscribers[i];
+
+        for (j=0; j<s->baselines_nr; j++)
+        {
+            if (
+                 0 == PLATFORM_MEMCMP(s->baselines[j].al_mac_address,          al_mac_address, 6) ||
+                 0 == PLATFORM_MEMCMP(s->baselines[j].neighbor_al_mac_address, al_mac_address, 6)
+               )
+            {
+                // Place the last element here (we don't care about preserving
+                // order)
+                //
+                s->baselines[j] = s->baselines[s->baselines_nr-1];
+                s->baselines_nr--;
+                j--;
+            }
+        }
+    }
+
+    _sendToAll(CUSTOM_COMMAND_EVENT_DEVICE_REMOVED, al_mac_address, NULL, NULL, 0);
+}
+
+void EVlinkMetricsUpdated(INT8U *metrics)
+{
+    INT8U i;
+
+    if (0 == subscribers_nr || NULL == metrics)
+    {
+        return;
+    }
+
+    if (TLV_TYPE_TRANSMITTER_LINK_METRIC == *metrics)
+    {
+        struct transmitterLinkMetricTLV *t;
+
+        t = (struct transmitterLinkMetricTLV *)metrics;
+
+        for (i=0; i<t->transmitter_link_metrics_nr; i++)
+        {
+            _linkMetric(t->local_al_address, t->neighbor_al_address,
+                        t->transmitter_link_metrics[i].local_interface_address, t->transmitter_link_metrics[i].neighbor_interface_address,
+                        CUSTOM_COMMAND_EVENT_METRIC_MAC_THROUGHPUT, t->transmitter_link_metrics[i].mac_throughput_capacity);
+        }
+    }
+    else if (TLV_TYPE_RECEIVER_LINK_METRIC == *metrics)
+    {
+        struct receiverLinkMetricTLV *t;
+
+        t = (struct receiverLinkMetricTLV *)metrics;
+
+        for (i=0; i<t->receiver_link_metrics_nr; i++)
+        {
+            _linkMetric(t->local_al_address, t->neighbor_al_address,
+                        t->receiver_link_metrics[i].local_interface_address, t->receiver_link_metrics[i].neighbor_interface_address,
+                        CUSTOM_COMMAND_EVENT_METRIC_RSSI, t->receiver_link_metrics[i].rssi);
+        }
+    }
+}
+
+void EVpushButton(INT8U stage, INT8U *al_mac_address, INT8U *interface_mac_address)
+{
+    INT8U  payload[1 + 6];
+    INT8U *p;
+
+    if (0 == subscribers_nr)
+    {
+        return;
+    }
+
+    p = payload;
+    _I1B(&stage, &p);
+    if (NULL == interface_mac_address)
+    {
+        PLATFORM_MEMSET(p, 0x0, 6);
+        p += 6;
+    }
+    else
+    {
+        _InB(interface_mac_address, &p, 6);
+    }
+
+    _sendToAll(CUSTOM_COMMAND_EVENT_PUSH_BUTTON, al_mac_address, NULL, payload, p - payload);
+}
+
+void EVprocessTimers(void)
+{
+    INT32U i;
+
+    if (0 == subscribers_nr)
+    {
+        return;
+    }
+
+    for (i=0; i<EVENTS_MAX_SUBSCRIBERS; i++)
+    {
+        if (1 == subscribers[i].in_use && 0 == PLATFORM_SEND_ALME_EVENT(subscribers[i].alme_client_id, NULL, 0))
+        {
+            _removeSubscriber(&subscribers[i]);
+        }
+    }
+}
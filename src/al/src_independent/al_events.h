@@ -0,0 +1,137 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#ifndef _AL_EVENTS_H_
+#define _AL_EVENTS_H_
+
+// HLEs that need to react to changes in the network (for example, to steer
+// traffic) would otherwise have to poll the AL entity (and read mostly
+// unchanged information each time). Instead, they can subscribe (with the
+// CUSTOM_COMMAND_SUBSCRIBE_EVENTS ALME) to the types of events they are
+// interested in (see "CUSTOM_COMMAND_EVENT_*" in "1905_alme.h").
+//
+// From then on, each event is sent to them as soon as it takes place (the data
+// model and the "push button" code call the functions below right where the
+// corresponding change happens), over the same connection where the
+// subscription was received, which is kept open until the client goes away.
+//
+// Events are sent with "PLATFORM_SEND_ALME_EVENT()", which keeps a bounded
+// queue for each subscriber: when it does not read them fast enough, the oldest
+// ones are discarded (the client finds out thanks to the gap in the sequence
+// numbers).
+
+// Compile time parameters
+//
+#ifndef EVENTS_MAX_SUBSCRIBERS
+#  define EVENTS_MAX_SUBSCRIBERS  (8)
+#endif
+
+// Period (in milliseconds) at which "EVprocessTimers()" must be called (the AL
+// entity calls it from its shared "tick" timer)
+//
+#define EVENTS_TIMER_PERIOD       (1000)
+
+// Subscribe the client that made the request with id 'alme_client_id' to the
+// events whose types are set in 'events' (a combination of
+// "1 << CUSTOM_COMMAND_EVENT_*" flags) and that refer to one of the
+// 'al_mac_addresses_nr' devices in 'al_mac_addresses' (or to any of them, if
+// '0'). Link metric events are only sent when the value has changed by more
+// than 'metric_threshold' percent from the last one sent to this subscriber.
+//
+// The CUSTOM_COMMAND_EVENT_SUBSCRIBED event is sent right away.
+//
+// Returns '0' if there is no room for another subscriber (in which case the
+// caller must reply to the request). Otherwise the reply is taken care of by
+// the functions in this file (and terminated once the client goes away).
+//
+INT8U EVsubscribe(INT8U alme_client_id, INT16U events, INT8U al_mac_addresses_nr, INT8U (*al_mac_addresses)[6], INT8U metric_threshold);
+
+// The data model calls these functions every time a 1905 neighbor (with AL MAC
+// address 'al_mac_address') is discovered on (or lost from) the local
+// interface whose MAC address is 'interface_mac_address'...
+//
+void EVneighborUp(INT8U *al_mac_address, INT8U *interface_mac_address);
+void EVneighborDown(INT8U *al_mac_address, INT8U *interface_mac_address);
+
+// ...every time the information of a device is received for the first time or
+// changes (and its new generation is 'generation')...
+//
+void EVdeviceChanged(INT8U *al_mac_address, INT32U generation);
+
+// ...every time a device is removed...
+//
+void EVdeviceRemoved(INT8U *al_mac_address);
+
+// ...and every time a new transmitter or receiver link metrics TLV ('metrics')
+// is received.
+//
+void EVlinkMetricsUpdated(INT8U *metrics);
+
+// Call this function every time the "push button" (or WSC) configuration
+// process reaches a new 'stage' (one of "CUSTOM_COMMAND_EVENT_PUSH_BUTTON_*").
+// 'al_mac_address' and 'interface_mac_address' (which can be NULL) are the
+// device and the interface it refers to.
+//
+void EVpushButton(INT8U stage, INT8U *al_mac_address, INT8U *interface_mac_address);
+
+// This function must be called every "EVENTS_TIMER_PERIOD" milliseconds. It
+// ends the subscriptions whose clients have gone away (even if no events have
+// been sent to them lately).
+//
+void EVprocessTimers(void);
+
+#endif
@@ -57,6 +57,8 @@
 
 
 
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_EXTENSIONS
+
 #include "platform.h"
 #include "1905_cmdus.h"
 #include "1905_tlvs.h"
@@ -83,6 +85,11 @@ struct _ieee1905CmduExtension
 
 } ieee1905_cmdu_extension = {0, NULL};
 
+// Incremented every time the data added by CMDU extensions might have changed
+// (see "get1905CmduExtensionsGeneration()")
+//
+static INT32U cmdu_extensions_generation = 0;
+
 
 // Structure for datamodel extensions management
 //
@@ -204,6 +211,11 @@ INT8U free1905CmduExtensions(struct CMDU *c)
     return 1;
 }
 
+INT32U get1905CmduExtensionsGeneration(void)
+{
+    return cmdu_extensions_generation;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // Public functions (data model callback processing).
 ////////////////////////////////////////////////////////////////////////////////
@@ -522,9 +534,16 @@ INT8U register1905CmduExtension(char *name,
 
     t->entries_nr++;
 
+    cmdu_extensions_generation++;
+
     return 1;
 }
 
+void notify1905CmduExtensionsChange(void)
+{
+    cmdu_extensions_generation++;
+}
+
 INT8U register1905AlmeDumpExtension(char *name,
                                     DM_OBTAIN_LOCAL_INFO_CBK obtain,
                                     DM_UPDATE_LOCAL_INFO_CBK update,
@@ -143,6 +143,16 @@ INT8U send1905CmduExtensions(struct CMDU *c);
 //
 INT8U free1905CmduExtensions(struct CMDU *c);
 
+// Return a counter that is incremented every time the data that registered
+// 'send' callbacks add to outgoing CMDUs might have changed (ie. when a new
+// extension is registered or when one of them calls
+// "notify1905CmduExtensionsChange()").
+//
+// This is used to know when CMDUs that are kept already forged (see
+// "send1905TopologyResponsePacket()") must be built again.
+//
+INT32U get1905CmduExtensionsGeneration(void);
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Public functions (data model callback processing).
@@ -293,6 +303,13 @@ INT8U register1905CmduExtension(char *name,
                                 CMDU_EXTENSION_CBK process,
                                 CMDU_EXTENSION_CBK send);
 
+// Extensions whose 'send' callback adds data which changes over time (and
+// not only depending on the type of the CMDU) must call this function every
+// time that data changes. Otherwise CMDUs which are kept already forged (such
+// as the "topology response") would keep carrying the old data.
+//
+void notify1905CmduExtensionsChange(void);
+
 // This function registers the callbacks required to extend the ALME 'dnd'
 // report.
 //
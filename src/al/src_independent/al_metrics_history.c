@@ -0,0 +1,522 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_DATAMODEL
+
+#include "platform.h"
+
+#include "al_metrics_history.h"
+
+#include "1905_tlvs.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Private functions and data
+////////////////////////////////////////////////////////////////////////////////
+
+// Number of samples kept for each resolution
+//
+#define MH_RAW_SAMPLES     (60)
+#define MH_MINUTE_SAMPLES  (60)   // One hour worth of "minute" samples
+#define MH_HOUR_SAMPLES    (24)   // One day worth of "hour" samples
+
+#define MH_MINUTE_MS       (60*1000)
+#define MH_HOUR_MS         (60*60*1000)
+
+// A "transmitter" and a "receiver" link metrics TLV are typically received (one
+// right after the other) as part of the same response CMDU. Reports for the
+// same link that arrive within this window are merged into a single raw sample
+//
+#define MH_MERGE_WINDOW_MS (2000)
+
+// One sample. Fields are ordered so that the compiler does not need to add any
+// padding (28 bytes)
+//
+struct _mhSample
+{
+    INT32U  timestamp;                 // When the sample was taken (for
+                                       // downsampled entries: start of the
+                                       // minute/hour they represent)
+
+    INT32U  tx_packet_errors;          // Last value reported in the period
+    INT32U  tx_packets;                // Last value reported in the period
+    INT32U  rx_packet_errors;          // Last value reported in the period
+    INT32U  rx_packets;                // Last value reported in the period
+
+    INT16U  phy_rate;                  // Average in the period
+    INT16U  phy_rate_min;              // Minimum in the period
+    INT16U  mac_throughput_capacity;   // Average in the period
+
+    INT8U   link_availability;         // Average in the period
+    INT8U   rssi;                      // Average in the period
+};
+
+// Fixed size ring buffer "header". The samples themselves live in an array
+// owned by the structure containing the ring.
+//
+struct _mhRing
+{
+    INT8U  first;                      // Index of the oldest sample
+    INT8U  nr;                         // Number of valid samples
+};
+
+// Running sums used to build one "minute" or "hour" sample out of all the raw
+// samples that fall in that period
+//
+struct _mhAccumulator
+{
+    INT32U            bucket;          // "timestamp / period" of the samples
+                                       // being accumulated
+    INT32U            samples_nr;
+
+    INT32U            phy_rate_sum;
+    INT32U            mac_throughput_capacity_sum;
+    INT32U            link_availability_sum;
+    INT32U            rssi_sum;
+    INT16U            phy_rate_min;
+
+    struct _mhSample  last;            // Last raw sample (used for counters)
+};
+
+struct _linkHistory
+{
+    INT8U                  from_al_mac_address[6];
+    INT8U                  to_al_mac_address[6];
+    INT8U                  local_interface_address[6];
+    INT8U                  neighbor_interface_address[6];
+    INT16U                 intf_type;
+
+    INT32U                 last_update_ts;
+
+    // Latest values received for this link (tx and rx metrics are reported in
+    // separate TLVs, so each report only updates half of it)
+    //
+    struct _mhSample       current;
+
+    // Timestamp of the last raw sample, which is still "open" (ie. it can be
+    // updated by reports arriving inside the merge window). It is fed to the
+    // accumulators once a new raw sample is created.
+    //
+    INT32U                 open_ts;
+
+    struct _mhAccumulator  minute_acc;
+    struct _mhAccumulator  hour_acc;
+
+    struct _mhRing         raw;
+    struct _mhRing         minute;
+    struct _mhRing         hour;
+
+    struct _mhSample       raw_samples[MH_RAW_SAMPLES];
+    struct _mhSample       minute_samples[MH_MINUTE_SAMPLES];
+    struct _mhSample       hour_samples[MH_HOUR_SAMPLES];
+};
+
+// Maximum number of links whose history fits inside the memory budget
+//
+#define MH_MAX_LINKS  (METRICS_HISTORY_MAX_MEMORY / (sizeof(struct _linkHistory) + sizeof(struct _linkHistory *)))
+
+static struct _linkHistory **links    = NULL;
+static INT32U                links_nr = 0;
+
+// Append 'sample' to a ring whose samples are stored in 'samples' (with room
+// for 'max' elements), overwriting the oldest one if the ring is full
+//
+static void _ringPush(struct _mhRing *ring, struct _mhSample *samples, INT8U max, struct _mhSample *sample)
+{
+    if (ring->nr < max)
+    {
+        samples[(ring->first + ring->nr) % max] = *sample;
+        ring->nr++;
+    }
+    else
+    {
+        samples[ring->first] = *sample;
+        ring->first = (ring->first + 1) % max;
+    }
+}
+
+// Return a pointer to the newest sample of a ring (or NULL if it is empty)
+//
+static struct _mhSample *_ringLast(struct _mhRing *ring, struct _mhSample *samples, INT8U max)
+{
+    if (0 == ring->nr)
+    {
+        return NULL;
+    }
+
+    return &samples[(ring->first + ring->nr - 1) % max];
+}
+
+// Add a (closed) raw sample to an accumulator. If the sample belongs to a new
+// period, the previous one is first averaged and pushed into the corresponding
+// ring.
+//
+static void _accumulate(struct _mhAccumulator *acc, INT32U period, struct _mhSample *sample, struct _mhRing *ring, struct _mhSample *samples, INT8U max)
+{
+    INT32U bucket;
+
+    bucket = sample->timestamp / period;
+
+    if (acc->samples_nr > 0 && bucket != acc->bucket)
+    {
+        struct _mhSample out;
+
+        out                         = acc->last;
+        out.timestamp               = acc->bucket * period;
+        out.phy_rate                = acc->phy_rate_sum                / acc->samples_nr;
+        out.phy_rate_min            = acc->phy_rate_min;
+        out.mac_throughput_capacity = acc->mac_throughput_capacity_sum / acc->samples_nr;
+        out.link_availability       = acc->link_availability_sum       / acc->samples_nr;
+        out.rssi                    = acc->rssi_sum                    / acc->samples_nr;
+
+        _ringPush(ring, samples, max, &out);
+
+        acc->samples_nr = 0;
+    }
+
+    if (0 == acc->samples_nr)
+    {
+        acc->bucket                      = bucket;
+        acc->phy_rate_sum                = 0;
+        acc->mac_throughput_capacity_sum = 0;
+        acc->link_availability_sum       = 0;
+        acc->rssi_sum                    = 0;
+        acc->phy_rate_min                = sample->phy_rate;
+    }
+
+    acc->samples_nr++;
+    acc->phy_rate_sum                += sample->phy_rate;
+    acc->mac_throughput_capacity_sum += sample->mac_throughput_capacity;
+    acc->link_availability_sum       += sample->link_availability;
+    acc->rssi_sum                    += sample->rssi;
+    acc->last                         = *sample;
+
+    if (sample->phy_rate < acc->phy_rate_min)
+    {
+        acc->phy_rate_min = sample->phy_rate;
+    }
+}
+
+// Record the current values of a link as a new raw sample (or update the last
+// one, if it is still inside the merge window)
+//
+static void _addSample(struct _linkHistory *l, INT32U timestamp)
+{
+    struct _mhSample *last;
+
+    l->current.phy_rate_min = l->current.phy_rate;
+    l->last_update_ts       = timestamp;
+
+    last = _ringLast(&l->raw, l->raw_samples, MH_RAW_SAMPLES);
+
+    if (NULL != last && timestamp - l->open_ts < MH_MERGE_WINDOW_MS)
+    {
+        *last           = l->current;
+        last->timestamp = l->open_ts;
+        return;
+    }
+
+    if (NULL != last)
+    {
+        // Close the previous sample
+        //
+        _accumulate(&l->minute_acc, MH_MINUTE_MS, last, &l->minute, l->minute_samples, MH_MINUTE_SAMPLES);
+        _accumulate(&l->hour_acc,   MH_HOUR_MS,   last, &l->hour,   l->hour_samples,   MH_HOUR_SAMPLES);
+    }
+
+    l->open_ts           = timestamp;
+    l->current.timestamp = timestamp;
+    _ringPush(&l->raw, l->raw_samples, MH_RAW_SAMPLES, &l->current);
+}
+
+// Return the history entry associated to the given link, creating a new one
+// (or recycling the least recently updated one) if needed.
+// Returns NULL if there is no memory available.
+//
+static struct _linkHistory *_getLink(INT8U *from_al_mac_address, INT8U *to_al_mac_address, INT8U *local_interface_address, INT8U *neighbor_interface_address, INT16U intf_type)
+{
+    INT32U i;
+
+    struct _linkHistory *l;
+
+    for (i=0; i<links_nr; i++)
+    {
+        l = links[i];
+
+        if (
+             0 == PLATFORM_MEMCMP(l->from_al_mac_address,        from_al_mac_address,        6) &&
+             0 == PLATFORM_MEMCMP(l->to_al_mac_address,          to_al_mac_address,          6) &&
+             0 == PLATFORM_MEMCMP(l->local_interface_address,    local_interface_address,    6) &&
+             0 == PLATFORM_MEMCMP(l->neighbor_interface_address, neighbor_interface_address, 6)
+           )
+        {
+            return l;
+        }
+    }
+
+    if (0 == MH_MAX_LINKS)
+    {
+        return NULL;
+    }
+
+    if (links_nr < MH_MAX_LINKS)
+    {
+        // There is still room for a new link
+        //
+        l = (struct _linkHistory *)PLATFORM_MALLOC(sizeof(struct _linkHistory));
+
+        if (0 == links_nr)
+        {
+            links = (struct _linkHistory **)PLATFORM_MALLOC(sizeof(struct _linkHistory *));
+        }
+        else
+        {
+            links = (struct _linkHistory **)PLATFORM_REALLOC(links, sizeof(struct _linkHistory *)*(links_nr+1));
+        }
+        links[links_nr++] = l;
+    }
+    else
+    {
+        // Memory budget exhausted. Recycle the link that has gone the longest
+        // without receiving new metrics.
+        //
+        INT32U oldest;
+
+        oldest = 0;
+        for (i=1; i<links_nr; i++)
+        {
+            if (PLATFORM_GET_TIMESTAMP() - links[i]->last_update_ts > PLATFORM_GET_TIMESTAMP() - links[oldest]->last_update_ts)
+            {
+                oldest = i;
+            }
+        }
+        l = links[oldest];
+
+        PLATFORM_PRINTF_DEBUG_DETAIL("Metrics history memory budget exhausted. Recycling link entry %d\n", oldest);
+    }
+
+    PLATFORM_MEMSET(l, 0x0, sizeof(struct _linkHistory));
+
+    PLATFORM_MEMCPY(l->from_al_mac_address,        from_al_mac_address,        6);
+    PLATFORM_MEMCPY(l->to_al_mac_address,          to_al_mac_address,          6);
+    PLATFORM_MEMCPY(l->local_interface_address,    local_interface_address,    6);
+    PLATFORM_MEMCPY(l->neighbor_interface_address, neighbor_interface_address, 6);
+    l->intf_type = intf_type;
+
+    return l;
+}
+
+// Print all samples from a ring, from oldest to newest
+//
+static void _dumpRing(void (*write_function)(const char *fmt, ...), const char *name, struct _mhRing *ring, struct _mhSample *samples, INT8U max, INT32U now)
+{
+    INT8U i;
+
+    write_function("    %s (%d sample(s)):\n", name, ring->nr);
+
+    for (i=0; i<ring->nr; i++)
+    {
+        struct _mhSample *s;
+
+        s = &samples[(ring->first + i) % max];
+
+        write_function("      age=%6ds  phy_rate=%5d (min %5d)  mac_throughput=%5d  availability=%3d%%  rssi=%3d  tx_errors=%u  tx_packets=%u  rx_errors=%u  rx_packets=%u\n",
+                       (now - s->timestamp) / 1000, s->phy_rate, s->phy_rate_min, s->mac_throughput_capacity, s->link_availability, s->rssi,
+                       s->tx_packet_errors, s->tx_packets, s->rx_packet_errors, s->rx_packets);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Public functions
+////////////////////////////////////////////////////////////////////////////////
+
+INT8U MHaddMetrics(INT8U *metrics, INT32U timestamp)
+{
+    INT8U i;
+
+    struct _linkHistory *l;
+
+    if (NULL == metrics)
+    {
+        return 0;
+    }
+
+    if (TLV_TYPE_TRANSMITTER_LINK_METRIC == *metrics)
+    {
+        struct transmitterLinkMetricTLV *p;
+
+        p = (struct transmitterLinkMetricTLV *)metrics;
+
+        for (i=0; i<p->transmitter_link_metrics_nr; i++)
+        {
+            struct _transmitterLinkMetricEntries *e;
+
+            e = &p->transmitter_link_metrics[i];
+
+            if (NULL == (l = _getLink(p->local_al_address, p->neighbor_al_address, e->local_interface_address, e->neighbor_interface_address, e->intf_type)))
+            {
+                return 0;
+            }
+
+            l->current.tx_packet_errors        = e->packet_errors;
+            l->current.tx_packets              = e->transmitted_packets;
+            l->current.mac_throughput_capacity = e->mac_throughput_capacity;
+            l->current.link_availability       = e->link_availability > 100 ? 100 : e->link_availability;
+            l->current.phy_rate                = e->phy_rate;
+
+            _addSample(l, timestamp);
+        }
+    }
+    else if (TLV_TYPE_RECEIVER_LINK_METRIC == *metrics)
+    {
+        struct receiverLinkMetricTLV *p;
+
+        p = (struct receiverLinkMetricTLV *)metrics;
+
+        for (i=0; i<p->receiver_link_metrics_nr; i++)
+        {
+            struct _receiverLinkMetricEntries *e;
+
+            e = &p->receiver_link_metrics[i];
+
+            if (NULL == (l = _getLink(p->local_al_address, p->neighbor_al_address, e->local_interface_address, e->neighbor_interface_address, e->intf_type)))
+            {
+                return 0;
+            }
+
+            l->current.rx_packet_errors = e->packet_errors;
+            l->current.rx_packets       = e->packets_received;
+            l->current.rssi             = e->rssi;
+
+            _addSample(l, timestamp);
+        }
+    }
+    else
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+void MHremoveDevice(INT8U *al_mac_address)
+{
+    INT32U i;
+    INT32U original_links_nr;
+
+    original_links_nr = links_nr;
+
+    for (i=0; i<links_nr; i++)
+    {
+        if (
+             0 == PLATFORM_MEMCMP(links[i]->from_al_mac_address, al_mac_address, 6) ||
+             0 == PLATFORM_MEMCMP(links[i]->to_al_mac_address,   al_mac_address, 6)
+           )
+        {
+            PLATFORM_FREE(links[i]);
+
+            // Place the last element here (we don't care about preserving
+            // order)
+            //
+            links[i] = links[links_nr-1];
+            links_nr--;
+            i--;
+        }
+    }
+
+    if (original_links_nr != links_nr)
+    {
+        if (0 == links_nr)
+        {
+            PLATFORM_FREE(links);
+            links = NULL;
+        }
+        else
+        {
+            links = (struct _linkHistory **)PLATFORM_REALLOC(links, sizeof(struct _linkHistory *)*links_nr);
+        }
+    }
+}
+
+void MHdumpMetricsHistory(void (*write_function)(const char *fmt, ...))
+{
+    INT32U i;
+    INT32U now;
+
+    now = PLATFORM_GET_TIMESTAMP();
+
+    write_function("\n");
+    write_function("Metrics history (%d link(s), %d bytes per link, %d links max)\n", links_nr, (int)sizeof(struct _linkHistory), (int)MH_MAX_LINKS);
+
+    for (i=0; i<links_nr; i++)
+    {
+        struct _linkHistory *l;
+
+        l = links[i];
+
+        write_function("  Link %02x:%02x:%02x:%02x:%02x:%02x (%02x:%02x:%02x:%02x:%02x:%02x) --> %02x:%02x:%02x:%02x:%02x:%02x (%02x:%02x:%02x:%02x:%02x:%02x), intf_type = 0x%04x\n",
+                       l->from_al_mac_address[0],        l->from_al_mac_address[1],        l->from_al_mac_address[2],        l->from_al_mac_address[3],        l->from_al_mac_address[4],        l->from_al_mac_address[5],
+                       l->local_interface_address[0],    l->local_interface_address[1],    l->local_interface_address[2],    l->local_interface_address[3],    l->local_interface_address[4],    l->local_interface_address[5],
+                       l->to_al_mac_address[0],          l->to_al_mac_address[1],          l->to_al_mac_address[2],          l->to_al_mac_address[3],          l->to_al_mac_address[4],          l->to_al_mac_address[5],
+                       l->neighbor_interface_address[0], l->neighbor_interface_address[1], l->neighbor_interface_address[2], l->neighbor_interface_address[3], l->neighbor_interface_address[4], l->neighbor_interface_address[5],
+                       l->intf_type);
+
+        _dumpRing(write_function, "raw",    &l->raw,    l->raw_samples,    MH_RAW_SAMPLES,    now);
+        _dumpRing(write_function, "minute", &l->minute, l->minute_samples, MH_MINUTE_SAMPLES, now);
+        _dumpRing(write_function, "hour",   &l->hour,   l->hour_samples,   MH_HOUR_SAMPLES,   now);
+    }
+}
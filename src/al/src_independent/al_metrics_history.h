@@ -0,0 +1,121 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#ifndef _AL_METRICS_HISTORY_H_
+#define _AL_METRICS_HISTORY_H_
+
+#include "1905_tlvs.h"
+
+// The data model only keeps the *latest* "transmitter/receiver link metric"
+// TLVs received for each (device, neighbor) pair. Every time a new response
+// arrives, the old TLV is freed and replaced, and thus the evolution of a link
+// (PHY rate going down, packet errors going up, RSSI degrading, ...) is lost.
+//
+// The functions in this file keep a compact time series for each individual
+// link (ie. each "local interface <--> neighbor interface" pair reported in a
+// metrics TLV) at three different resolutions:
+//
+//   - "raw"    : one sample for every metrics report received
+//   - "minute" : one sample per minute, averaging all raw samples of that
+//                minute
+//   - "hour"   : one sample per hour, averaging all raw samples of that hour
+//
+// Each resolution is stored in a fixed size ring buffer (the oldest samples
+// are overwritten), so the memory used by a single link never grows.
+// In addition, the total amount of memory used by all links is capped by
+// "METRICS_HISTORY_MAX_MEMORY" (in bytes). When a new link is discovered and
+// there is no room left, the link that has gone the longest without an update
+// is recycled.
+
+// Maximum amount of memory (in bytes) that the history of all links is allowed
+// to use. It can be overridden at compile time. Set it to "0" to disable the
+// history altogether.
+//
+#ifndef METRICS_HISTORY_MAX_MEMORY
+#  define METRICS_HISTORY_MAX_MEMORY  (256*1024)
+#endif
+
+// Feed a new metrics TLV into the history.
+//
+// 'metrics' must point to either a "struct transmitterLinkMetricTLV" or a
+// "struct receiverLinkMetricTLV". The structure is only read (ie. it is not
+// retained nor freed).
+//
+// 'timestamp' is the time (as returned by "PLATFORM_GET_TIMESTAMP()") at which
+// the metrics were received.
+//
+// Returns '0' if there was a problem (invalid TLV type, out of memory, ...),
+// '1' otherwise.
+//
+INT8U MHaddMetrics(INT8U *metrics, INT32U timestamp);
+
+// Forget all samples from links where 'al_mac_address' is either the reporting
+// device or the neighbor.
+//
+// This is meant to be called when a device is removed from the data model.
+//
+void MHremoveDevice(INT8U *al_mac_address);
+
+// Dump the history of all links using the provided 'write_function()' (which
+// has the same semantics as "printf()").
+//
+// Samples are printed from oldest to newest. Their timestamps are shown as the
+// number of seconds elapsed since they were taken.
+//
+void MHdumpMetricsHistory(void (*write_function)(const char *fmt, ...));
+
+#endif
@@ -0,0 +1,306 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_SEND
+
+#include "platform.h"
+
+#include "al_notifications.h"
+#include "al_send.h"
+#include "al_utils.h"
+
+#include "platform_interfaces.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Private functions and data
+////////////////////////////////////////////////////////////////////////////////
+
+struct _interface
+{
+    char    *name;
+
+    INT32U   pending_nr;         // Changes not notified yet on this interface
+    INT32U   first_pending;      // Timestamp of the oldest of them
+
+    INT8U    has_sent;           // Set to '1' once a notification has been sent
+    INT32U   last_sent;          // Timestamp of the last one
+
+    INT32U   notifications_nr;   // Notifications sent...
+    INT32U   changes_nr;         // ...and changes folded into them
+    INT32U   folded_last;        // Changes folded into the last notification...
+    INT32U   folded_max;         // ...and into the one that folded the most
+
+    INT32U   dropped_nr;         // Changes not notified because the interface
+                                 // was not authenticated (or powered on)
+    INT32U   failed_nr;          // Notifications that could not be sent
+};
+
+static struct _interface **interfaces    = NULL;
+static INT32U              interfaces_nr = 0;
+
+static INT32U              pending_nr    = 0;  // Sum of the 'pending_nr' of
+                                               // all interfaces
+static INT32U              changes_nr[NOTIFICATION_REASONS_NR];
+static INT32U              messages_nr   = 0;  // Different MIDs sent
+
+// Return the entry of interface 'interface_name' (creating it if it does not
+// exist yet)
+//
+static struct _interface *_getInterface(char *interface_name)
+{
+    struct _interface *x;
+    INT32U             i;
+
+    for (i=0; i<interfaces_nr; i++)
+    {
+        if (0 == PLATFORM_MEMCMP(interfaces[i]->name, interface_name, PLATFORM_STRLEN(interface_name) + 1))
+        {
+            return interfaces[i];
+        }
+    }
+
+    x = (struct _interface *)PLATFORM_MALLOC(sizeof(struct _interface));
+    PLATFORM_MEMSET(x, 0x0, sizeof(struct _interface));
+
+    x->name = PLATFORM_STRDUP(interface_name);
+
+    interfaces = (struct _interface **)PLATFORM_REALLOC(interfaces, sizeof(struct _interface *) * (interfaces_nr + 1));
+    interfaces[interfaces_nr++] = x;
+
+    return x;
+}
+
+// Return '1' if "topology notification" messages must be sent on interface
+// 'interface_name' (ie. if it is authenticated and in the "PWR_ON" or
+// "PWR_SAVE" state), '0' otherwise
+//
+static INT8U _mustNotify(char *interface_name)
+{
+    struct interfaceInfo *x;
+
+    x = PLATFORM_GET_1905_INTERFACE_INFO_CACHED(interface_name);
+    if (NULL == x)
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("Could not retrieve info of interface %s\n", interface_name);
+        return 0;
+    }
+
+    if (
+        (0 == x->is_secured                                                                             ) ||
+        ((x->power_state != INTERFACE_POWER_STATE_ON) && (x->power_state != INTERFACE_POWER_STATE_SAVE))
+       )
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Public functions (exported only to files in this same folder)
+////////////////////////////////////////////////////////////////////////////////
+
+void NTtopologyChanged(INT8U reason)
+{
+    char **ifs_names;
+    INT8U  ifs_nr;
+    INT8U  i;
+    INT32U now;
+
+    if (reason < NOTIFICATION_REASONS_NR)
+    {
+        changes_nr[reason]++;
+    }
+
+    now = PLATFORM_GET_TIMESTAMP();
+
+    // The change is pending on all interfaces. On those where another one was
+    // already pending, it will be notified together with it.
+    //
+    ifs_names = PLATFORM_GET_LIST_OF_1905_INTERFACES(&ifs_nr);
+    for (i=0; i<ifs_nr; i++)
+    {
+        struct _interface *x;
+
+        x = _getInterface(ifs_names[i]);
+
+        if (0 == x->pending_nr)
+        {
+            x->first_pending = now;
+        }
+        x->pending_nr++;
+        pending_nr++;
+    }
+    PLATFORM_FREE_LIST_OF_1905_INTERFACES(ifs_names, ifs_nr);
+
+    if (0 == NOTIFICATIONS_HOLD_DOWN)
+    {
+        NTprocessTimers();
+    }
+}
+
+void NTprocessTimers(void)
+{
+    INT32U i;
+    INT32U now;
+    INT16U mid;
+    INT8U  mid_set;
+
+    if (0 == pending_nr)
+    {
+        return;
+    }
+
+    now     = PLATFORM_GET_TIMESTAMP();
+    mid     = 0;
+    mid_set = 0;
+
+    for (i=0; i<interfaces_nr; i++)
+    {
+        struct _interface *x;
+
+        x = interfaces[i];
+
+        if (0 == x->pending_nr)
+        {
+            continue;
+        }
+
+        if (
+            (0 == timestampReached(now, x->first_pending + NOTIFICATIONS_HOLD_DOWN))                  ||
+            (1 == x->has_sent && 0 == timestampReached(now, x->last_sent + NOTIFICATIONS_MIN_INTERVAL))
+           )
+        {
+            // Keep on folding changes
+            //
+            continue;
+        }
+
+        if (0 == _mustNotify(x->name))
+        {
+            x->dropped_nr += x->pending_nr;
+        }
+        else
+        {
+            // All the interfaces that are ready in this same round send the
+            // same message (ie. with the same MID)
+            //
+            if (0 == mid_set)
+            {
+                mid     = getNextMid();
+                mid_set = 1;
+                messages_nr++;
+            }
+
+            PLATFORM_PRINTF_DEBUG_DETAIL("Sending topology notification on %s (%d change(s) folded)\n", x->name, x->pending_nr);
+
+            if (0 == send1905TopologyNotificationPacket(x->name, mid))
+            {
+                PLATFORM_PRINTF_DEBUG_WARNING("Could not send 1905 topology notification message\n");
+                x->failed_nr++;
+            }
+            else
+            {
+                x->notifications_nr++;
+                x->changes_nr  += x->pending_nr;
+                x->folded_last  = x->pending_nr;
+                if (x->pending_nr > x->folded_max)
+                {
+                    x->folded_max = x->pending_nr;
+                }
+
+                x->has_sent  = 1;
+                x->last_sent = now;
+            }
+        }
+
+        pending_nr    -= x->pending_nr;
+        x->pending_nr  = 0;
+    }
+}
+
+void NTdumpNotifications(void (*write_function)(const char *fmt, ...))
+{
+    INT32U i;
+    INT32U now;
+
+    now = PLATFORM_GET_TIMESTAMP();
+
+    write_function("\n");
+    write_function("Topology notifications (hold down = %d ms, min interval = %d ms)\n", NOTIFICATIONS_HOLD_DOWN, NOTIFICATIONS_MIN_INTERVAL);
+    write_function("  changes: interface changes = %d, nodes removed = %d\n", changes_nr[NOTIFICATION_REASON_INTERFACE_CHANGE], changes_nr[NOTIFICATION_REASON_NODES_REMOVED]);
+    write_function("  messages sent = %d\n", messages_nr);
+
+    write_function("Interfaces (%d)\n", interfaces_nr);
+
+    for (i=0; i<interfaces_nr; i++)
+    {
+        struct _interface *x;
+
+        x = interfaces[i];
+
+        write_function("  %s: notifications = %d, changes notified = %d, changes dropped = %d, failed = %d, pending = %d\n",
+                       x->name, x->notifications_nr, x->changes_nr, x->dropped_nr, x->failed_nr, x->pending_nr);
+
+        if (x->notifications_nr > 0)
+        {
+            write_function("    changes per notification: last = %d, avg = %d, max = %d. Last one sent %d ms ago\n",
+                           x->folded_last, x->changes_nr / x->notifications_nr, x->folded_max, now - x->last_sent);
+        }
+    }
+}
@@ -0,0 +1,128 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#ifndef _AL_NOTIFICATIONS_H_
+#define _AL_NOTIFICATIONS_H_
+
+// According to "Section 8.2.2.3" and "Section 7.2", a "topology notification"
+// must be sent on all authenticated interfaces every time something changes in
+// the local node (its interfaces, its neighbors, ...). Each of them makes all
+// neighbors query us again (and relay the notification to their own
+// neighbors), thus, when changes happen in bursts (ex: a Wi-Fi roaming storm
+// or several nodes leaving at once) the whole network ends up flooded with
+// notifications and queries that carry (almost) the same information.
+//
+// The functions in this file take care of sending these notifications:
+//
+//   - Topology changes are not notified right away. Instead, all the changes
+//     that take place during "NOTIFICATIONS_HOLD_DOWN" milliseconds (counted
+//     from the first one) are notified with a single message.
+//
+//   - No more than one notification is sent on the same interface every
+//     "NOTIFICATIONS_MIN_INTERVAL" milliseconds. Changes that take place in
+//     the meantime are notified once that time has elapsed.
+//
+// Set both of them to "0" to notify each change as soon as it takes place.
+
+// Compile time parameters (all times are in milliseconds)
+//
+#ifndef NOTIFICATIONS_HOLD_DOWN
+#  define NOTIFICATIONS_HOLD_DOWN     (500)
+#endif
+#ifndef NOTIFICATIONS_MIN_INTERVAL
+#  define NOTIFICATIONS_MIN_INTERVAL  (2000)
+#endif
+
+// Period at which "NTprocessTimers()" must be called (the AL entity calls it
+// from its shared "tick" timer). It is also the resolution of the timers
+// above.
+//
+#define NOTIFICATIONS_TIMER_PERIOD    (100)
+
+// Reasons of a topology change (they are only used for statistics)
+//
+#define NOTIFICATION_REASON_INTERFACE_CHANGE  (0)  // The platform reported a
+                                                   // change in a local
+                                                   // interface
+#define NOTIFICATION_REASON_NODES_REMOVED     (1)  // The garbage collector
+                                                   // removed some nodes
+#define NOTIFICATION_REASONS_NR               (2)
+
+// Call this function every time something changes in the local node that must
+// be notified to the rest of the network. 'reason' is one of the
+// "NOTIFICATION_REASON_*" values.
+//
+// The "topology notification" message will be sent (on all authenticated
+// interfaces that are powered on) once the hold down time has elapsed, which
+// can be right now if it is set to "0".
+//
+void NTtopologyChanged(INT8U reason);
+
+// This function must be called every "NOTIFICATIONS_TIMER_PERIOD"
+// milliseconds. It sends the "topology notification" messages whose hold down
+// time (and minimum interval) has elapsed.
+//
+void NTprocessTimers(void);
+
+// Dump the statistics of the topology notifications (number of changes, number
+// of messages sent on each interface and how many changes were folded into
+// each of them) using the provided 'write_function()' (which has the same
+// semantics as "printf()").
+//
+void NTdumpNotifications(void (*write_function)(const char *fmt, ...));
+
+#endif
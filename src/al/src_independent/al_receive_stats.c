@@ -0,0 +1,227 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#include "platform.h"
+
+#include "al_receive_stats.h"
+
+#include "1905_cmdus.h"
+#include "1905_l2.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Private functions and data
+////////////////////////////////////////////////////////////////////////////////
+
+// One row per standard CMDU type, followed by these other ones
+//
+#define _ROW_OTHER_CMDU   (CMDU_TYPE_GENERIC_PHY_RESPONSE + 1)
+#define _ROW_LLDP         (_ROW_OTHER_CMDU + 1)
+#define _ROW_FRAGMENT     (_ROW_LLDP       + 1)
+#define _ROW_DUPLICATE    (_ROW_FRAGMENT   + 1)
+#define _ROW_DISCARDED    (_ROW_DUPLICATE  + 1)
+#define _ROWS_NR          (_ROW_DISCARDED  + 1)
+
+struct _receiveStats
+{
+    INT32U   frames_nr;
+    INT32U   total_us;
+    INT32U   max_us;
+    INT32U   allocs_nr;
+};
+
+static struct _receiveStats rows[_ROWS_NR];
+
+static INT32U frame_start_us;        // Set by "RSframeStart()"...
+static INT32U frame_start_allocs;    // ...for the frame being processed
+
+static INT32U frames_nr = 0;         // Sum of all rows 'frames_nr'
+static INT32U first_frame_start;     // Timestamps (in ms) of the first and
+static INT32U last_frame_end;        // last frames
+
+////////////////////////////////////////////////////////////////////////////////
+// Public functions (exported only to files in this same folder)
+////////////////////////////////////////////////////////////////////////////////
+
+void RSframeStart(void)
+{
+    if (0 == frames_nr)
+    {
+        first_frame_start = PLATFORM_GET_TIMESTAMP();
+    }
+
+    frame_start_allocs = PLATFORM_MEMORY_ALLOCATIONS_NR();
+    frame_start_us     = PLATFORM_GET_TIMESTAMP_US();
+}
+
+void RSframeEnd(INT8U verdict, INT16U ether_type, INT16U cmdu_type)
+{
+    struct _receiveStats *r;
+    INT32U                elapsed;
+
+    elapsed = PLATFORM_GET_TIMESTAMP_US() - frame_start_us;
+
+    switch (verdict)
+    {
+        case RECEIVE_VERDICT_PROCESSED:
+        {
+            if (ETHERTYPE_LLDP == ether_type)
+            {
+                r = &rows[_ROW_LLDP];
+            }
+            else if (cmdu_type < _ROW_OTHER_CMDU)
+            {
+                r = &rows[cmdu_type];
+            }
+            else
+            {
+                r = &rows[_ROW_OTHER_CMDU];
+            }
+            break;
+        }
+        case RECEIVE_VERDICT_FRAGMENT:
+        {
+            r = &rows[_ROW_FRAGMENT];
+            break;
+        }
+        case RECEIVE_VERDICT_DUPLICATE:
+        {
+            r = &rows[_ROW_DUPLICATE];
+            break;
+        }
+        default:
+        {
+            r = &rows[_ROW_DISCARDED];
+            break;
+        }
+    }
+
+    frames_nr++;
+
+    r->frames_nr++;
+    r->total_us  += elapsed;
+    r->allocs_nr += PLATFORM_MEMORY_ALLOCATIONS_NR() - frame_start_allocs;
+
+    if (elapsed > r->max_us)
+    {
+        r->max_us = elapsed;
+    }
+
+    last_frame_end = PLATFORM_GET_TIMESTAMP();
+}
+
+void RSdumpReceiveStats(void (*write_function)(const char *fmt, ...))
+{
+    struct _receiveStats  total;
+    INT32U                i;
+    INT32U                elapsed;
+
+    PLATFORM_MEMSET(&total, 0x0, sizeof(total));
+
+    for (i=0; i<_ROWS_NR; i++)
+    {
+        total.frames_nr += rows[i].frames_nr;
+        total.total_us  += rows[i].total_us;
+        total.allocs_nr += rows[i].allocs_nr;
+    }
+
+    write_function("\n");
+
+    if (0 == total.frames_nr)
+    {
+        write_function("Receive pipeline: no frames received yet\n");
+        return;
+    }
+
+    elapsed = last_frame_end - first_frame_start;
+
+    write_function("Receive pipeline: %d frames in %d ms (%d frames/s). Processing alone takes %d us per frame (%d frames/s)\n",
+                   total.frames_nr, elapsed,
+                   0 == elapsed        ? 0 : (INT32U)(((unsigned long long)total.frames_nr * 1000) / elapsed),
+                   total.total_us / total.frames_nr,
+                   0 == total.total_us ? 0 : (INT32U)(((unsigned long long)total.frames_nr * 1000000) / total.total_us));
+
+#ifndef MEMORY_ACCOUNTING
+    write_function("  (allocations are not counted: rebuild with MEMORY_ACCOUNTING defined)\n");
+#endif
+
+    write_function("  %-42s %10s %12s %8s %8s %10s %8s\n", "type", "frames", "total us", "avg us", "max us", "allocs", "allocs/f");
+
+    for (i=0; i<_ROWS_NR; i++)
+    {
+        struct _receiveStats *r;
+        char                 *name;
+
+        r = &rows[i];
+
+        if (0 == r->frames_nr)
+        {
+            continue;
+        }
+
+        switch (i)
+        {
+            case _ROW_OTHER_CMDU: name = "other CMDUs";        break;
+            case _ROW_LLDP:       name = "LLDP";               break;
+            case _ROW_FRAGMENT:   name = "(CMDU fragments)";   break;
+            case _ROW_DUPLICATE:  name = "(duplicate CMDUs)";  break;
+            case _ROW_DISCARDED:  name = "(discarded frames)"; break;
+            default:              name = convert_1905_CMDU_type_to_string((INT8U)i); break;
+        }
+
+        write_function("  %-42s %10u %12u %8u %8u %10u %8u\n", name, r->frames_nr, r->total_us, r->total_us / r->frames_nr, r->max_us, r->allocs_nr, r->allocs_nr / r->frames_nr);
+    }
+}
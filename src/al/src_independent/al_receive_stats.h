@@ -0,0 +1,103 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#ifndef _AL_RECEIVE_STATS_H_
+#define _AL_RECEIVE_STATS_H_
+
+// The functions in this file measure how long it takes (and how many memory
+// allocations are made) to process each frame received by the AL entity, from
+// the moment it is taken from the events queue until it has been completely
+// processed (which includes parsing it, updating the data model and sending
+// whatever responses it triggers).
+//
+// Results are kept per CMDU type, so that the cost of each message (and the
+// whole receive pipeline throughput) can be checked while the AL is running or
+// when replaying captured traffic (see the "replay" interfaces in the README
+// file).
+
+// What happened to each received frame
+//
+#define RECEIVE_VERDICT_PROCESSED  (0)  // A whole CMDU (or LLDP payload) was
+                                        // processed
+#define RECEIVE_VERDICT_FRAGMENT   (1)  // Fragment of a CMDU, kept until the
+                                        // rest of them arrive
+#define RECEIVE_VERDICT_DUPLICATE  (2)  // CMDU already received (same MID)
+#define RECEIVE_VERDICT_DISCARDED  (3)  // Malformed, unknown ether type or
+                                        // received on an unknown (or not
+                                        // authenticated) interface
+#define RECEIVE_VERDICTS_NR        (4)
+
+// Call this function right before a received frame starts being processed...
+//
+void RSframeStart(void);
+
+// ...and this one once it has been completely processed. 'verdict' is one of
+// the "RECEIVE_VERDICT_*" values. 'ether_type' and 'cmdu_type' are only used
+// for RECEIVE_VERDICT_PROCESSED frames (and the latter only if the former is
+// ETHERTYPE_1905).
+//
+void RSframeEnd(INT8U verdict, INT16U ether_type, INT16U cmdu_type);
+
+// Dump the statistics (number of frames, processing time and allocations for
+// each CMDU type and the overall frames per second) using the provided
+// 'write_function()' (which has the same semantics as "printf()").
+//
+// Allocations are only counted when the "MEMORY_ACCOUNTING" flag is defined.
+//
+void RSdumpReceiveStats(void (*write_function)(const char *fmt, ...));
+
+#endif
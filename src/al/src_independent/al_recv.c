@@ -63,6 +63,8 @@
 #include "al_send.h"
 #include "al_wsc.h"
 #include "al_extension.h"
+#include "al_requests.h"
+#include "al_events.h"
 
 #include "1905_tlvs.h"
 #include "1905_cmdus.h"
@@ -75,6 +77,93 @@
 #include "platform_alme_server.h"
 
 
+////////////////////////////////////////////////////////////////////////////////
+// Private functions and data
+////////////////////////////////////////////////////////////////////////////////
+
+// Called once a query sent by "_sendQuery()" finishes
+//
+static void _queryCompleted(INT8U *al_mac_address, INT16U query_type, INT8U result)
+{
+    if (REQUEST_RESULT_ANSWERED != result)
+    {
+        // Nothing else can be done: the information we have about this node
+        // will be refreshed the next time it is discovered (or removed by the
+        // garbage collector if it is not)
+        //
+        PLATFORM_PRINTF_DEBUG_WARNING("'%s' to %02x:%02x:%02x:%02x:%02x:%02x %s\n", convert_1905_CMDU_type_to_string(query_type), al_mac_address[0], al_mac_address[1], al_mac_address[2], al_mac_address[3], al_mac_address[4], al_mac_address[5], REQUEST_RESULT_TIMED_OUT == result ? "was never answered" : "could not be sent");
+    }
+}
+
+// Send a query of type 'query_type' (CMDU_TYPE_TOPOLOGY_QUERY,
+// CMDU_TYPE_LINK_METRIC_QUERY, CMDU_TYPE_HIGHER_LAYER_QUERY or
+// CMDU_TYPE_GENERIC_PHY_QUERY) to 'al_mac_address' through 'interface_name'.
+//
+// The query is retransmitted if no response arrives in time and it is not
+// sent at all if an identical one is still waiting for a response (see
+// "RQsendRequest()" for the details and for the meaning of 'force')
+//
+static void _sendQuery(INT16U query_type, char *interface_name, INT8U *al_mac_address, INT8U force)
+{
+    INT8U (*send_function)(char *interface_name, INT16U mid, INT8U *al_mac_address);
+
+    switch (query_type)
+    {
+        case CMDU_TYPE_TOPOLOGY_QUERY:
+        {
+            send_function = send1905TopologyQueryPacket;
+            break;
+        }
+        case CMDU_TYPE_LINK_METRIC_QUERY:
+        {
+            send_function = send1905MetricsQueryPacket;
+            break;
+        }
+        case CMDU_TYPE_HIGHER_LAYER_QUERY:
+        {
+            send_function = send1905HighLayerQueryPacket;
+            break;
+        }
+        case CMDU_TYPE_GENERIC_PHY_QUERY:
+        {
+            send_function = send1905GenericPhyQueryPacket;
+            break;
+        }
+        default:
+        {
+            return;
+        }
+    }
+
+    if (0 == RQsendRequest(al_mac_address, query_type, force, interface_name, send_function, _queryCompleted))
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("Could not send '%s' message\n", convert_1905_CMDU_type_to_string(query_type));
+    }
+}
+
+
+// Call "RQrequestFinish()" for a response CMDU 'c' received from 'src_addr'.
+//
+// Responses are sent from the AL MAC address of the node that answers, but
+// (just in case some other implementation uses the MAC address of one of its
+// interfaces instead) the source address is translated when it is known to
+// belong to another AL entity.
+//
+static void _requestFinish(struct CMDU *c, INT8U *src_addr)
+{
+    INT8U *al_mac_address;
+
+    al_mac_address = DMmacToAlMac(src_addr);
+
+    RQrequestFinish(c->message_type, c->message_id, NULL == al_mac_address ? src_addr : al_mac_address);
+
+    if (NULL != al_mac_address)
+    {
+        PLATFORM_FREE(al_mac_address);
+    }
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // Public functions (exported only to files in this same folder)
 ////////////////////////////////////////////////////////////////////////////////
@@ -217,10 +306,10 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
                 break;
             }
 
-            if ( 0 == send1905TopologyQueryPacket(DMmacToInterfaceName(receiving_interface_addr), getNextMid(), al_mac_address))
-            {
-                PLATFORM_PRINTF_DEBUG_WARNING("Could not send 'topology query' message\n");
-            }
+            // If the node is heard through several interfaces at once, the
+            // query is only sent once (see "RQsendRequest()")
+            //
+            _sendQuery(CMDU_TYPE_TOPOLOGY_QUERY, DMmacToInterfaceName(receiving_interface_addr), al_mac_address, 0);
 
             break;
         }
@@ -307,11 +396,10 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
             // discovery" case) if we recently updated the data model or not.
             // This is because a "topology notification" *always* implies
             // network changes and thus the device must always be (re)-queried.
+            // For the same reason, a query that might still be pending is
+            // replaced by this new one (its response could be outdated)
             //
-            if ( 0 == send1905TopologyQueryPacket(DMmacToInterfaceName(receiving_interface_addr), getNextMid(), al_mac_address))
-            {
-                PLATFORM_PRINTF_DEBUG_WARNING("Could not send 'topology query' message\n");
-            }
+            _sendQuery(CMDU_TYPE_TOPOLOGY_QUERY, DMmacToInterfaceName(receiving_interface_addr), al_mac_address, 1);
 
             break;
         }
@@ -386,6 +474,10 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
             
             PLATFORM_PRINTF_DEBUG_INFO("<-- CMDU_TYPE_TOPOLOGY_RESPONSE (%s)\n", DMmacToInterfaceName(receiving_interface_addr));
 
+            // Stop waiting for it (and account the time it took to arrive)
+            //
+            _requestFinish(c, src_addr);
+
             if (NULL == c->list_of_TLVs)
             {
                 PLATFORM_PRINTF_DEBUG_ERROR("Malformed structure.");
@@ -584,14 +676,8 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
             // And finally, send other queries to the device so that we can
             // keep updating the database once the responses are received
             //
-            if ( 0 == send1905MetricsQueryPacket(DMmacToInterfaceName(receiving_interface_addr), getNextMid(), info->al_mac_address))
-            {
-                PLATFORM_PRINTF_DEBUG_WARNING("Could not send 'metrics query' message\n");
-            }
-            if ( 0 == send1905HighLayerQueryPacket(DMmacToInterfaceName(receiving_interface_addr), getNextMid(), info->al_mac_address))
-            {
-                PLATFORM_PRINTF_DEBUG_WARNING("Could not send 'high layer query' message\n");
-            }
+            _sendQuery(CMDU_TYPE_LINK_METRIC_QUERY,  DMmacToInterfaceName(receiving_interface_addr), info->al_mac_address, 0);
+            _sendQuery(CMDU_TYPE_HIGHER_LAYER_QUERY, DMmacToInterfaceName(receiving_interface_addr), info->al_mac_address, 0);
             for (i=0; i<info->local_interfaces_nr; i++)
             {
                 if (MEDIA_TYPE_UNKNOWN == info->local_interfaces[i].media_type)
@@ -599,10 +685,7 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
                     // There is *at least* one generic inteface in the response,
                     // thus query for more information
                     //
-                    if ( 0 == send1905GenericPhyQueryPacket(DMmacToInterfaceName(receiving_interface_addr), getNextMid(), info->al_mac_address))
-                    {
-                        PLATFORM_PRINTF_DEBUG_WARNING("Could not send 'generic phy query' message\n");
-                    }
+                    _sendQuery(CMDU_TYPE_GENERIC_PHY_QUERY, DMmacToInterfaceName(receiving_interface_addr), info->al_mac_address, 0);
                     break;
                 }
             }
@@ -666,10 +749,11 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
                             continue;
                         }
 
-                        if ( 0 == send1905TopologyQueryPacket(DMmacToInterfaceName(receiving_interface_addr), getNextMid(), z[i]->neighbors[j].mac_address))
-                        {
-                            PLATFORM_PRINTF_DEBUG_WARNING("Could not send 'topology query' message\n");
-                        }
+                        // Note that several neighbors will probably list
+                        // the same nodes, which are only queried once (see
+                        // "RQsendRequest()")
+                        //
+                        _sendQuery(CMDU_TYPE_TOPOLOGY_QUERY, DMmacToInterfaceName(receiving_interface_addr), z[i]->neighbors[j].mac_address, 0);
                     }
                 }
             }
@@ -816,6 +900,8 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
 
             PLATFORM_PRINTF_DEBUG_INFO("<-- CMDU_TYPE_LINK_METRIC_RESPONSE (%s)\n", DMmacToInterfaceName(receiving_interface_addr));
 
+            _requestFinish(c, src_addr);
+
             if (NULL == c->list_of_TLVs)
             {
                 PLATFORM_PRINTF_DEBUG_ERROR("Malformed structure.");
@@ -1053,6 +1139,8 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
 
             PLATFORM_PRINTF_DEBUG_INFO("<-- CMDU_TYPE_AP_AUTOCONFIGURATION_RESPONSE (%s)\n", DMmacToInterfaceName(receiving_interface_addr));
 
+            _requestFinish(c, src_addr);
+
             if (NULL == c->list_of_TLVs)
             {
                 PLATFORM_PRINTF_DEBUG_ERROR("Malformed structure.");
@@ -1201,6 +1289,10 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
                     {
                         PLATFORM_PRINTF_DEBUG_WARNING("Could not send 'AP autoconfiguration WSC-M1' message\n");
                     }
+                    else
+                    {
+                        EVpushButton(CUSTOM_COMMAND_EVENT_PUSH_BUTTON_WSC_M1_SENT, DMalMacGet(), DMinterfaceNameToMac(ifs_names[i]));
+                    }
 
                     if (NULL != p)
                     {
@@ -1284,6 +1376,8 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
                 wscProcessM2(NULL, NULL, 0, wsc_frame, wsc_frame_size);
                   // NOTE: this function will automatically free M1.
 
+                EVpushButton(CUSTOM_COMMAND_EVENT_PUSH_BUTTON_WSC_M2_RECEIVED, DMalMacGet(), NULL);
+
                 // One more thing: This node *might* have other unconfigured AP
                 // interfaces (in addition to the one we have just configured),
                 // thus, re-trigger the AP discovery process, just in case.
@@ -1337,6 +1431,10 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
                 {
                     PLATFORM_PRINTF_DEBUG_WARNING("Could not send 'AP autoconfiguration WSC-M2' message\n");
                 }
+                else
+                {
+                    EVpushButton(CUSTOM_COMMAND_EVENT_PUSH_BUTTON_WSC_M2_SENT, dst_mac, NULL);
+                }
 
                 if (NULL != p)
                 {
@@ -1453,6 +1551,8 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
                 return PROCESS_CMDU_KO;
             }
 
+            EVpushButton(CUSTOM_COMMAND_EVENT_PUSH_BUTTON_REMOTE, al_mac_address, NULL);
+
             // Next, switch on all interfaces
             //
             ifs_names = PLATFORM_GET_LIST_OF_1905_INTERFACES(&ifs_nr);
@@ -1534,8 +1634,30 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
         }
         case CMDU_TYPE_PUSH_BUTTON_JOIN_NOTIFICATION:
         {
+            INT8U *p;
+            INT8U  i;
+
             PLATFORM_PRINTF_DEBUG_INFO("<-- CMDU_TYPE_PUSH_BUTTON_JOIN_NOTIFICATION (%s)\n", DMmacToInterfaceName(receiving_interface_addr));
-            // TODO: Somehow "signal" upper layers (?)
+
+            if (NULL == c->list_of_TLVs)
+            {
+                PLATFORM_PRINTF_DEBUG_ERROR("Malformed structure.");
+                break;
+            }
+
+            // Let the HLEs that are interested know about the new interface
+            //
+            i = 0;
+            while (NULL != (p = c->list_of_TLVs[i]))
+            {
+                if (TLV_TYPE_PUSH_BUTTON_JOIN_NOTIFICATION == *p)
+                {
+                    struct pushButtonJoinNotificationTLV *t = (struct pushButtonJoinNotificationTLV *)p;
+
+                    EVpushButton(CUSTOM_COMMAND_EVENT_PUSH_BUTTON_JOINED, t->al_mac_address, t->new_mac_address);
+                }
+                i++;
+            }
 
             break;
         }
@@ -1600,6 +1722,8 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
 
             PLATFORM_PRINTF_DEBUG_INFO("<-- CMDU_TYPE_GENERIC_PHY_RESPONSE (%s)\n", DMmacToInterfaceName(receiving_interface_addr));
 
+            _requestFinish(c, src_addr);
+
             if (NULL == c->list_of_TLVs)
             {
                 PLATFORM_PRINTF_DEBUG_ERROR("Malformed structure.");
@@ -1738,6 +1862,8 @@ INT8U process1905Cmdu(struct CMDU *c, INT8U *receiving_interface_addr, INT8U *sr
 
             PLATFORM_PRINTF_DEBUG_INFO("<-- CMDU_TYPE_HIGHER_LAYER_RESPONSE (%s)\n", DMmacToInterfaceName(receiving_interface_addr));
 
+            _requestFinish(c, src_addr);
+
             if (NULL == c->list_of_TLVs)
             {
                 PLATFORM_PRINTF_DEBUG_ERROR("Malformed structure.");
@@ -2195,7 +2321,7 @@ INT8U process1905Alme(INT8U *alme_tlv, INT8U alme_client_id)
 
             p = (struct customCommandRequestALME *)alme_tlv;
 
-            send1905CustomCommandResponseALME(alme_client_id, p->command);
+            send1905CustomCommandResponseALME(alme_client_id, p);
 
             break;
         }
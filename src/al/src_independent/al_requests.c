@@ -0,0 +1,740 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_SEND
+
+#include "platform.h"
+
+#include "al_requests.h"
+#include "al_utils.h"
+
+#include "1905_cmdus.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Private functions and data
+////////////////////////////////////////////////////////////////////////////////
+
+// Query types being tracked. Each response type is the one right after its
+// query type in the CMDU types list (ex: CMDU_TYPE_TOPOLOGY_QUERY and
+// CMDU_TYPE_TOPOLOGY_RESPONSE)
+//
+static INT16U query_types[] =
+{
+    CMDU_TYPE_TOPOLOGY_QUERY,
+    CMDU_TYPE_LINK_METRIC_QUERY,
+    CMDU_TYPE_AP_AUTOCONFIGURATION_SEARCH,
+    CMDU_TYPE_GENERIC_PHY_QUERY,
+    CMDU_TYPE_HIGHER_LAYER_QUERY,
+};
+#define RQ_QUERY_TYPES_NR  (sizeof(query_types)/sizeof(query_types[0]))
+
+// Destinations without queries are forgotten after this time (in
+// milliseconds)
+//
+#define RQ_DESTINATION_TTL  (10*60*1000)
+
+// Round trip time estimation for one destination
+//
+struct _destination
+{
+    INT8U   al_mac_address[6];
+
+    INT8U   requests_nr;               // Queries to this destination (pending
+                                       // or waiting to be sent)
+    INT8U   outstanding_nr;            // ...of which, pending (ie. sent and
+                                       // waiting for a response)
+
+    INT8U   has_rtt;                   // '1' once 'srtt' and 'rttvar' contain
+                                       // a valid estimation
+    INT32U  srtt;                      // Smoothed round trip time
+    INT32U  rttvar;                    // Round trip time variation
+    INT32U  rto;                       // Retransmission timeout
+
+    INT32U  last_used;                 // Last time a query was sent to (or
+                                       // answered by) it
+};
+
+// One query
+//
+#define RQ_STATE_WAITING  (0)          // Not sent yet (too many queries to
+                                       // the same destination)
+#define RQ_STATE_PENDING  (1)          // Sent. Waiting for a response.
+
+struct _request
+{
+    INT8U   al_mac_address[6];         // Destination of the query
+    INT8U   query_type_index;          // Index into "query_types[]"
+    INT8U   state;                     // One of the "RQ_STATE_*" values
+
+    INT8U   transmissions_nr;          // Number of times it has been sent
+    INT16U  mids[REQUESTS_MAX_RETRIES+1];
+    INT32U  timestamps[REQUESTS_MAX_RETRIES+1];
+                                       // MID used in each transmission and
+                                       // when it took place
+
+    INT32U  rto;                       // Time to wait for a response to the
+                                       // last transmission...
+    INT32U  deadline;                  // ...which ends here
+
+    char   *interface_name;
+    INT8U (*send_function)(char *interface_name, INT16U mid, INT8U *al_mac_address);
+    void  (*completion_function)(INT8U *al_mac_address, INT16U query_type, INT8U result);
+};
+
+// Statistics of one query type
+//
+struct _requestStats
+{
+    INT32U  requests;                  // Queries requested...
+    INT32U  coalesced;                 // ...not sent because an identical one
+                                       // was pending
+    INT32U  superseded;                // ...sent again right away because a
+                                       // newer one was "forced"
+    INT32U  deferred;                  // ...that had to wait for others to
+                                       // the same destination
+    INT32U  retransmissions;           // Transmissions after a timeout
+    INT32U  answered;                  // Queries that got a response...
+    INT32U  timed_out;                 // ...that did not get it after all
+                                       // retries
+    INT32U  failed;                    // ...that could not be sent
+    INT32U  unmatched;                 // Responses not matching any query
+
+    INT32U  rtt_last;                  // Round trip times of all 'answered'
+    INT32U  rtt_min;                   // queries
+    INT32U  rtt_max;
+    INT32U  rtt_sum;
+};
+
+static struct _request     **requests        = NULL;
+static INT32U                requests_nr     = 0;
+
+static struct _destination **destinations    = NULL;
+static INT32U                destinations_nr = 0;
+
+static struct _requestStats  stats[RQ_QUERY_TYPES_NR];
+
+// Return the index into "query_types[]" of query type 'type' (or of the query
+// type whose response is 'type' when 'is_response' is set to '1'), or
+// "RQ_QUERY_TYPES_NR" if it is not tracked
+//
+static INT8U _queryTypeIndex(INT16U type, INT8U is_response)
+{
+    INT8U i;
+
+    for (i=0; i<RQ_QUERY_TYPES_NR; i++)
+    {
+        if (query_types[i] + (1 == is_response ? 1 : 0) == type)
+        {
+            return i;
+        }
+    }
+
+    return RQ_QUERY_TYPES_NR;
+}
+
+// Return the destination entry of 'al_mac_address' (creating it if it does not
+// exist yet)
+//
+static struct _destination *_getDestination(INT8U *al_mac_address)
+{
+    struct _destination *d;
+    INT32U               i;
+
+    for (i=0; i<destinations_nr; i++)
+    {
+        if (0 == PLATFORM_MEMCMP(destinations[i]->al_mac_address, al_mac_address, 6))
+        {
+            return destinations[i];
+        }
+    }
+
+    d = (struct _destination *)PLATFORM_MALLOC(sizeof(struct _destination));
+    PLATFORM_MEMSET(d, 0x0, sizeof(struct _destination));
+    PLATFORM_MEMCPY(d->al_mac_address, al_mac_address, 6);
+    d->rto = REQUESTS_INITIAL_RTO;
+
+    destinations = (struct _destination **)PLATFORM_REALLOC(destinations, sizeof(struct _destination *) * (destinations_nr + 1));
+    destinations[destinations_nr++] = d;
+
+    return d;
+}
+
+// Forget the destinations that have not been used for a long time
+//
+static void _pruneDestinations(INT32U now)
+{
+    INT32U i;
+
+    i = 0;
+    while (i < destinations_nr)
+    {
+        if (0 == destinations[i]->requests_nr && timestampReached(now, destinations[i]->last_used + RQ_DESTINATION_TTL))
+        {
+            PLATFORM_FREE(destinations[i]);
+            destinations[i] = destinations[destinations_nr-1];
+            destinations_nr--;
+        }
+        else
+        {
+            i++;
+        }
+    }
+
+    if (0 == destinations_nr && NULL != destinations)
+    {
+        PLATFORM_FREE(destinations);
+        destinations = NULL;
+    }
+}
+
+// Update the round trip time estimation of 'd' with a new sample (see
+// "RFC 6298, section 2")
+//
+static void _addRttSample(struct _destination *d, INT32U rtt)
+{
+    INT32U delta;
+
+    if (0 == d->has_rtt)
+    {
+        d->srtt    = rtt;
+        d->rttvar  = rtt / 2;
+        d->has_rtt = 1;
+    }
+    else
+    {
+        delta     = d->srtt > rtt ? d->srtt - rtt : rtt - d->srtt;
+        d->rttvar = (3 * d->rttvar + delta) / 4;
+        d->srtt   = (7 * d->srtt   + rtt)   / 8;
+    }
+
+    d->rto = d->srtt + (4 * d->rttvar > REQUESTS_TIMER_PERIOD ? 4 * d->rttvar : REQUESTS_TIMER_PERIOD);
+
+    if (d->rto < REQUESTS_MIN_RTO)
+    {
+        d->rto = REQUESTS_MIN_RTO;
+    }
+    if (d->rto > REQUESTS_MAX_RTO)
+    {
+        d->rto = REQUESTS_MAX_RTO;
+    }
+}
+
+// Return the index into "requests[]" of the query of type 'query_type_index'
+// to 'al_mac_address', or "requests_nr" if there is none
+//
+static INT32U _findRequest(INT8U *al_mac_address, INT8U query_type_index)
+{
+    INT32U i;
+
+    for (i=0; i<requests_nr; i++)
+    {
+        if (
+             requests[i]->query_type_index == query_type_index &&
+             0 == PLATFORM_MEMCMP(requests[i]->al_mac_address, al_mac_address, 6)
+           )
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+// Send query 'r' (again) with a new MID.
+// Returns '0' if it could not be sent, '1' otherwise.
+//
+static INT8U _transmit(struct _request *r, INT32U now)
+{
+    INT16U mid;
+
+    mid = getNextMid();
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("Sending %s to %02x:%02x:%02x:%02x:%02x:%02x (MID %d, transmission #%d, rto = %d ms)\n", convert_1905_CMDU_type_to_string(query_types[r->query_type_index]), r->al_mac_address[0], r->al_mac_address[1], r->al_mac_address[2], r->al_mac_address[3], r->al_mac_address[4], r->al_mac_address[5], mid, r->transmissions_nr+1, r->rto);
+
+    if (0 == r->send_function(r->interface_name, mid, r->al_mac_address))
+    {
+        return 0;
+    }
+
+    r->mids      [r->transmissions_nr] = mid;
+    r->timestamps[r->transmissions_nr] = now;
+    r->transmissions_nr++;
+
+    r->deadline = now + r->rto;
+
+    return 1;
+}
+
+static void _startWaitingRequests(INT8U *al_mac_address, INT32U now);
+
+// Remove query 'i' from the list (releasing its slot in its destination) and
+// call its completion callback with 'result'
+//
+static void _finishRequest(INT32U i, INT8U result, INT32U now)
+{
+    struct _request     *r;
+    struct _destination *d;
+    INT32U               j;
+
+    r = requests[i];
+
+    for (j=i; j<requests_nr-1; j++)
+    {
+        requests[j] = requests[j+1];
+    }
+    requests_nr--;
+    if (0 == requests_nr)
+    {
+        PLATFORM_FREE(requests);
+        requests = NULL;
+    }
+
+    d = _getDestination(r->al_mac_address);
+    d->requests_nr--;
+    if (RQ_STATE_PENDING == r->state)
+    {
+        d->outstanding_nr--;
+    }
+    d->last_used = now;
+
+    switch (result)
+    {
+        case REQUEST_RESULT_ANSWERED:  stats[r->query_type_index].answered++;  break;
+        case REQUEST_RESULT_TIMED_OUT: stats[r->query_type_index].timed_out++; break;
+        default:                       stats[r->query_type_index].failed++;    break;
+    }
+
+    // The query is no longer in the list, thus the callback is free to send
+    // new ones
+    //
+    if (NULL != r->completion_function)
+    {
+        r->completion_function(r->al_mac_address, query_types[r->query_type_index], result);
+    }
+
+    _startWaitingRequests(r->al_mac_address, now);
+
+    if (NULL != r->interface_name)
+    {
+        PLATFORM_FREE(r->interface_name);
+    }
+    PLATFORM_FREE(r);
+}
+
+// Send query 'r' for the first time (or leave it waiting if there are already
+// too many pending queries to its destination).
+// Returns '0' if it could not be sent (in which case it has already been
+// finished and freed), '1' otherwise.
+//
+static INT8U _startRequest(struct _request *r, INT32U now)
+{
+    struct _destination *d;
+
+    d = _getDestination(r->al_mac_address);
+
+    if (d->outstanding_nr >= REQUESTS_MAX_PER_DESTINATION)
+    {
+        return 1;
+    }
+
+    r->state = RQ_STATE_PENDING;
+    r->rto   = d->rto;
+    d->outstanding_nr++;
+
+    if (0 == _transmit(r, now))
+    {
+        _finishRequest(_findRequest(r->al_mac_address, r->query_type_index), REQUEST_RESULT_FAILED, now);
+        return 0;
+    }
+
+    return 1;
+}
+
+// Send the queries to 'al_mac_address' that were waiting for a free slot
+//
+static void _startWaitingRequests(INT8U *al_mac_address, INT32U now)
+{
+    INT32U i;
+
+    for (i=0; i<requests_nr; i++)
+    {
+        if (
+             RQ_STATE_WAITING == requests[i]->state &&
+             0 == PLATFORM_MEMCMP(requests[i]->al_mac_address, al_mac_address, 6)
+           )
+        {
+            if (0 == _startRequest(requests[i], now))
+            {
+                // The list has changed. Start over.
+                //
+                i = (INT32U)-1;
+                continue;
+            }
+            if (RQ_STATE_WAITING == requests[i]->state)
+            {
+                // No free slots left
+                //
+                break;
+            }
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Public functions (exported only to files in this same folder)
+////////////////////////////////////////////////////////////////////////////////
+
+INT8U RQsendRequest(INT8U *al_mac_address, INT16U query_type, INT8U force, char *interface_name,
+                    INT8U (*send_function)(char *interface_name, INT16U mid, INT8U *al_mac_address),
+                    void  (*completion_function)(INT8U *al_mac_address, INT16U query_type, INT8U result))
+{
+    struct _request     *r;
+    struct _destination *d;
+    INT8U                t;
+    INT32U               i;
+    INT32U               now;
+
+    t = _queryTypeIndex(query_type, 0);
+    if (RQ_QUERY_TYPES_NR == t)
+    {
+        // Not tracked. Just send it.
+        //
+        return send_function(interface_name, getNextMid(), al_mac_address);
+    }
+
+    now = PLATFORM_GET_TIMESTAMP();
+
+    d = _getDestination(al_mac_address);
+    d->last_used = now;
+
+    i = _findRequest(al_mac_address, t);
+    if (i < requests_nr)
+    {
+        r = requests[i];
+
+        if (1 != force)
+        {
+            PLATFORM_PRINTF_DEBUG_DETAIL("%s to %02x:%02x:%02x:%02x:%02x:%02x already pending. Not sending it again.\n", convert_1905_CMDU_type_to_string(query_type), al_mac_address[0], al_mac_address[1], al_mac_address[2], al_mac_address[3], al_mac_address[4], al_mac_address[5]);
+
+            stats[t].coalesced++;
+            return 1;
+        }
+
+        stats[t].superseded++;
+
+        if (NULL != r->interface_name)
+        {
+            PLATFORM_FREE(r->interface_name);
+        }
+        r->interface_name      = NULL == interface_name ? NULL : PLATFORM_STRDUP(interface_name);
+        r->send_function       = send_function;
+        r->completion_function = completion_function;
+
+        if (RQ_STATE_PENDING == r->state)
+        {
+            // Start all over again (responses to previous transmissions will
+            // no longer be matched)
+            //
+            r->transmissions_nr = 0;
+            r->rto              = d->rto;
+
+            if (0 == _transmit(r, now))
+            {
+                _finishRequest(i, REQUEST_RESULT_FAILED, now);
+                return 0;
+            }
+        }
+
+        return 1;
+    }
+
+    r = (struct _request *)PLATFORM_MALLOC(sizeof(struct _request));
+    PLATFORM_MEMSET(r, 0x0, sizeof(struct _request));
+
+    PLATFORM_MEMCPY(r->al_mac_address, al_mac_address, 6);
+    r->query_type_index    = t;
+    r->state               = RQ_STATE_WAITING;
+    r->interface_name      = NULL == interface_name ? NULL : PLATFORM_STRDUP(interface_name);
+    r->send_function       = send_function;
+    r->completion_function = completion_function;
+
+    requests = (struct _request **)PLATFORM_REALLOC(requests, sizeof(struct _request *) * (requests_nr + 1));
+    requests[requests_nr++] = r;
+    d->requests_nr++;
+
+    stats[t].requests++;
+
+    if (0 == _startRequest(r, now))
+    {
+        return 0;
+    }
+
+    if (RQ_STATE_WAITING == r->state)
+    {
+        PLATFORM_PRINTF_DEBUG_DETAIL("Too many queries pending for %02x:%02x:%02x:%02x:%02x:%02x. %s will be sent later.\n", al_mac_address[0], al_mac_address[1], al_mac_address[2], al_mac_address[3], al_mac_address[4], al_mac_address[5], convert_1905_CMDU_type_to_string(query_type));
+
+        stats[t].deferred++;
+    }
+
+    return 1;
+}
+
+INT8U RQrequestFinish(INT16U response_type, INT16U mid, INT8U *al_mac_address)
+{
+    struct _request *r;
+    INT8U            t;
+    INT8U            k;
+    INT32U           i;
+    INT32U           now;
+    INT32U           rtt;
+
+    t = _queryTypeIndex(response_type, 1);
+    if (RQ_QUERY_TYPES_NR == t)
+    {
+        return 0;
+    }
+
+    r = NULL;
+    k = 0;
+    for (i=0; i<requests_nr; i++)
+    {
+        if (RQ_STATE_PENDING != requests[i]->state || t != requests[i]->query_type_index)
+        {
+            continue;
+        }
+        if (0 == (requests[i]->al_mac_address[0] & 0x01) && 0 != PLATFORM_MEMCMP(requests[i]->al_mac_address, al_mac_address, 6))
+        {
+            // MIDs are only unique per sender, thus a response from a node
+            // other than the one the query was sent to cannot be the answer
+            // (unless the query was sent to a multicast address, in which
+            // case any node can answer it)
+            //
+            continue;
+        }
+        for (k=0; k<requests[i]->transmissions_nr; k++)
+        {
+            if (requests[i]->mids[k] == mid)
+            {
+                r = requests[i];
+                break;
+            }
+        }
+        if (NULL != r)
+        {
+            break;
+        }
+    }
+
+    if (NULL == r)
+    {
+        stats[t].unmatched++;
+        return 0;
+    }
+
+    // Each transmission uses its own MID, thus we know exactly which one this
+    // response belongs to (and the round trip time sample is valid even if
+    // the query was retransmitted)
+    //
+    now = PLATFORM_GET_TIMESTAMP();
+    rtt = now - r->timestamps[k];
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("%s (MID %d) received after %d ms\n", convert_1905_CMDU_type_to_string(response_type), mid, rtt);
+
+    _addRttSample(_getDestination(r->al_mac_address), rtt);
+
+    if (0 == stats[t].answered || rtt < stats[t].rtt_min)
+    {
+        stats[t].rtt_min = rtt;
+    }
+    if (rtt > stats[t].rtt_max)
+    {
+        stats[t].rtt_max = rtt;
+    }
+    stats[t].rtt_last  = rtt;
+    stats[t].rtt_sum  += rtt;
+
+    _finishRequest(i, REQUEST_RESULT_ANSWERED, now);
+
+    return 1;
+}
+
+void RQprocessTimers(void)
+{
+    struct _request     *r;
+    struct _destination *d;
+    INT32U               i;
+    INT32U               now;
+
+    now = PLATFORM_GET_TIMESTAMP();
+
+    for (i=0; i<requests_nr; i++)
+    {
+        r = requests[i];
+
+        if (RQ_STATE_PENDING != r->state || 0 == timestampReached(now, r->deadline))
+        {
+            continue;
+        }
+
+        if (r->transmissions_nr > REQUESTS_MAX_RETRIES)
+        {
+            PLATFORM_PRINTF_DEBUG_DETAIL("%s to %02x:%02x:%02x:%02x:%02x:%02x was never answered\n", convert_1905_CMDU_type_to_string(query_types[r->query_type_index]), r->al_mac_address[0], r->al_mac_address[1], r->al_mac_address[2], r->al_mac_address[3], r->al_mac_address[4], r->al_mac_address[5]);
+
+            _finishRequest(i, REQUEST_RESULT_TIMED_OUT, now);
+
+            // The list has changed. Start over.
+            //
+            i = (INT32U)-1;
+            continue;
+        }
+
+        // Exponential backoff. The destination RTO is also increased, so that
+        // other queries to the same (unresponsive) node do not insist so much
+        // (it will go back to normal once new round trip time samples arrive)
+        //
+        r->rto = 2 * r->rto > REQUESTS_MAX_RTO ? REQUESTS_MAX_RTO : 2 * r->rto;
+
+        d = _getDestination(r->al_mac_address);
+        if (d->rto < r->rto)
+        {
+            d->rto = r->rto;
+        }
+
+        stats[r->query_type_index].retransmissions++;
+
+        if (0 == _transmit(r, now))
+        {
+            _finishRequest(i, REQUEST_RESULT_FAILED, now);
+
+            i = (INT32U)-1;
+            continue;
+        }
+    }
+
+    _pruneDestinations(now);
+}
+
+void RQdumpRequests(void (*write_function)(const char *fmt, ...))
+{
+    INT32U i;
+    INT32U now;
+
+    now = PLATFORM_GET_TIMESTAMP();
+
+    write_function("\n");
+    write_function("Queries statistics (rto = %d..%d ms, %d retries max, %d pending queries per destination max)\n", REQUESTS_MIN_RTO, REQUESTS_MAX_RTO, REQUESTS_MAX_RETRIES, REQUESTS_MAX_PER_DESTINATION);
+
+    for (i=0; i<RQ_QUERY_TYPES_NR; i++)
+    {
+        write_function("  %s: requested = %d, coalesced = %d, superseded = %d, deferred = %d, retransmissions = %d, answered = %d, timed out = %d, failed = %d, unmatched responses = %d\n",
+                       convert_1905_CMDU_type_to_string(query_types[i]),
+                       stats[i].requests, stats[i].coalesced, stats[i].superseded, stats[i].deferred, stats[i].retransmissions,
+                       stats[i].answered, stats[i].timed_out, stats[i].failed, stats[i].unmatched);
+
+        if (stats[i].answered > 0)
+        {
+            write_function("    rtt (ms): last = %d, min = %d, avg = %d, max = %d\n",
+                           stats[i].rtt_last, stats[i].rtt_min, stats[i].rtt_sum / stats[i].answered, stats[i].rtt_max);
+        }
+    }
+
+    write_function("Destinations (%d)\n", destinations_nr);
+
+    for (i=0; i<destinations_nr; i++)
+    {
+        struct _destination *d;
+
+        d = destinations[i];
+
+        if (1 == d->has_rtt)
+        {
+            write_function("  %02x:%02x:%02x:%02x:%02x:%02x: srtt = %d ms, rttvar = %d ms, rto = %d ms, %d queries (%d pending)\n",
+                           d->al_mac_address[0], d->al_mac_address[1], d->al_mac_address[2], d->al_mac_address[3], d->al_mac_address[4], d->al_mac_address[5],
+                           d->srtt, d->rttvar, d->rto, d->requests_nr, d->outstanding_nr);
+        }
+        else
+        {
+            write_function("  %02x:%02x:%02x:%02x:%02x:%02x: no rtt samples, rto = %d ms, %d queries (%d pending)\n",
+                           d->al_mac_address[0], d->al_mac_address[1], d->al_mac_address[2], d->al_mac_address[3], d->al_mac_address[4], d->al_mac_address[5],
+                           d->rto, d->requests_nr, d->outstanding_nr);
+        }
+    }
+
+    write_function("Queries (%d)\n", requests_nr);
+
+    for (i=0; i<requests_nr; i++)
+    {
+        struct _request *r;
+
+        r = requests[i];
+
+        if (RQ_STATE_PENDING == r->state)
+        {
+            write_function("  %s to %02x:%02x:%02x:%02x:%02x:%02x: pending, %d transmission(s), last MID %d, next timeout in %d ms\n",
+                           convert_1905_CMDU_type_to_string(query_types[r->query_type_index]),
+                           r->al_mac_address[0], r->al_mac_address[1], r->al_mac_address[2], r->al_mac_address[3], r->al_mac_address[4], r->al_mac_address[5],
+                           r->transmissions_nr, r->mids[r->transmissions_nr-1], timestampReached(now, r->deadline) ? 0 : r->deadline - now);
+        }
+        else
+        {
+            write_function("  %s to %02x:%02x:%02x:%02x:%02x:%02x: waiting\n",
+                           convert_1905_CMDU_type_to_string(query_types[r->query_type_index]),
+                           r->al_mac_address[0], r->al_mac_address[1], r->al_mac_address[2], r->al_mac_address[3], r->al_mac_address[4], r->al_mac_address[5]);
+        }
+    }
+}
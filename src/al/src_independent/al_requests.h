@@ -0,0 +1,184 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#ifndef _AL_REQUESTS_H_
+#define _AL_REQUESTS_H_
+
+// Every time a "topology discovery" or a "topology notification" is received
+// (and every time a "topology response" lists new 1905 neighbors) the AL sends
+// a query to the involved node. In dense networks the same node is heard
+// through several interfaces (and listed by several neighbors) at the same
+// time, and thus it ends up being asked for the same thing many times in a
+// row. In addition, queries (and their responses) travel over backhauls (PLC,
+// Wi-Fi, ...) where frames are lost now and then and, when that happens, the
+// information about that node is not updated until the next discovery cycle.
+//
+// The functions in this file take care of sending queries and waiting for
+// their responses:
+//
+//   - There is at most one query of each type pending for each destination
+//     AL MAC address. A new query is not sent when an identical one is still
+//     pending (it is "coalesced" with it).
+//
+//   - Responses are matched (by MID) with the query that caused them.
+//
+//   - Queries that are not answered in time are sent again (with a new MID,
+//     as receivers discard messages whose MID they have already seen) up to
+//     "REQUESTS_MAX_RETRIES" times. The time to wait (the "retransmission
+//     timeout", or RTO) is obtained for each destination from the round trip
+//     times measured so far (in the same way TCP does it, see RFC 6298), and
+//     it is doubled after each retransmission.
+//
+//   - No more than "REQUESTS_MAX_PER_DESTINATION" queries are pending for the
+//     same destination at the same time. Additional queries wait until one of
+//     them finishes.
+//
+//   - Once a query finishes (because it was answered, because it was never
+//     answered or because it could not be sent) an (optional) callback is
+//     called.
+
+// Compile time parameters (all times are in milliseconds)
+//
+#ifndef REQUESTS_INITIAL_RTO
+#  define REQUESTS_INITIAL_RTO          (1000)  // RTO used for destinations
+                                                // without any RTT sample yet
+#endif
+#ifndef REQUESTS_MIN_RTO
+#  define REQUESTS_MIN_RTO              (200)
+#endif
+#ifndef REQUESTS_MAX_RTO
+#  define REQUESTS_MAX_RTO              (8000)
+#endif
+#ifndef REQUESTS_MAX_RETRIES
+#  define REQUESTS_MAX_RETRIES          (3)
+#endif
+#ifndef REQUESTS_MAX_PER_DESTINATION
+#  define REQUESTS_MAX_PER_DESTINATION  (2)
+#endif
+
+// Period at which "RQprocessTimers()" must be called (the AL entity calls it
+// from its shared "tick" timer). It is also the resolution of the
+// retransmission timers.
+//
+#define REQUESTS_TIMER_PERIOD           (100)
+
+// Values passed to the completion callback
+//
+#define REQUEST_RESULT_ANSWERED   (0)  // A response was received
+#define REQUEST_RESULT_TIMED_OUT  (1)  // No response after all retries
+#define REQUEST_RESULT_FAILED     (2)  // The query could not be sent
+
+// Send a query of type 'query_type' (one of the "CMDU_TYPE_*_QUERY" values or
+// CMDU_TYPE_AP_AUTOCONFIGURATION_SEARCH) to the node whose AL MAC address is
+// 'al_mac_address' (for queries sent to a multicast address, such as the
+// "AP autoconfiguration search", use that address instead).
+//
+// The query is actually sent (now and when retransmitting it) by calling
+// 'send_function()' with 'interface_name' (which is copied, thus it can be
+// freed as soon as this function returns), a new MID and 'al_mac_address' as
+// arguments. Its signature matches the "send1905*QueryPacket()" functions and,
+// just like them, it must return '0' if the packet could not be sent and '1'
+// otherwise.
+//
+// 'completion_function()' (which can be NULL) is called once the query
+// finishes, with 'al_mac_address', 'query_type' and one of the
+// "REQUEST_RESULT_*" values as arguments.
+//
+// If an identical query (same type and destination) is still pending, this
+// one is not sent (and its callback is never called). However, when 'force' is
+// set to '1', the pending one is sent again right away (with a new MID) and
+// with the new 'interface_name', 'send_function' and 'completion_function'.
+// This is meant for those cases where the pending query could have been
+// answered with data that is already known to be outdated (ex: a "topology
+// notification" has just been received).
+//
+// Returns '0' if the query could not be sent, '1' otherwise (ie. if it was
+// sent, coalesced or is waiting for other queries to the same destination to
+// finish).
+//
+INT8U RQsendRequest(INT8U *al_mac_address, INT16U query_type, INT8U force, char *interface_name,
+                    INT8U (*send_function)(char *interface_name, INT16U mid, INT8U *al_mac_address),
+                    void  (*completion_function)(INT8U *al_mac_address, INT16U query_type, INT8U result));
+
+// Call this function when a response of type 'response_type' (one of the
+// "CMDU_TYPE_*_RESPONSE" values or CMDU_TYPE_AP_AUTOCONFIGURATION_RESPONSE)
+// with MID 'mid' is received from the node whose AL MAC address is
+// 'al_mac_address'.
+//
+// If it matches (any of the transmissions of) a pending query sent to that
+// same node (or to a multicast address), the round trip time is accounted,
+// the query is no longer pending and its completion callback is called.
+//
+// Returns '1' if the response matched a pending query, '0' otherwise (ex: the
+// query was sent by somebody else).
+//
+INT8U RQrequestFinish(INT16U response_type, INT16U mid, INT8U *al_mac_address);
+
+// This function must be called every "REQUESTS_TIMER_PERIOD" milliseconds. It
+// retransmits (or gives up on) the queries that have not been answered in
+// time.
+//
+void RQprocessTimers(void);
+
+// Dump the list of pending queries, the round trip time estimations of each
+// destination and the statistics (number of queries sent, coalesced,
+// retransmitted, answered, ...) of each query type using the provided
+// 'write_function()' (which has the same semantics as "printf()").
+//
+void RQdumpRequests(void (*write_function)(const char *fmt, ...));
+
+#endif
@@ -55,6 +55,8 @@
  *  DAMAGE.
  */
 
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_SEND
+
 #include "platform.h"
 #include "utils.h"
 
@@ -66,6 +68,11 @@
 #include "al_send.h"
 #include "al_datamodel.h"
 #include "al_utils.h"
+#include "al_metrics_history.h"
+#include "al_requests.h"
+#include "al_notifications.h"
+#include "al_receive_stats.h"
+#include "al_events.h"
 
 #include "1905_tlvs.h"
 #include "1905_cmdus.h"
@@ -130,7 +137,7 @@ void _obtainLocalDeviceInfoTLV(struct deviceInformationTypeTLV *device_info)
     {
         struct interfaceInfo *x;
 
-        if (NULL == (x = PLATFORM_GET_1905_INTERFACE_INFO(interfaces_names[i])))
+        if (NULL == (x = PLATFORM_GET_1905_INTERFACE_INFO_CACHED(interfaces_names[i])))
         {
             // Error retrieving information for this interface.
             // Ignore it.
@@ -144,7 +151,6 @@ void _obtainLocalDeviceInfoTLV(struct deviceInformationTypeTLV *device_info)
             // be included in the "power off" TLV, later, on this same
             // CMDU)
             //
-            PLATFORM_FREE_1905_INTERFACE_INFO(x);
             continue;
         }
 
@@ -208,8 +214,6 @@ void _obtainLocalDeviceInfoTLV(struct deviceInformationTypeTLV *device_info)
             }
         }
         device_info->local_interfaces_nr++;
-
-        PLATFORM_FREE_1905_INTERFACE_INFO(x);
     }
 
     PLATFORM_FREE_LIST_OF_1905_INTERFACES(interfaces_names, interfaces_names_nr);
@@ -345,7 +349,7 @@ void _obtainLocalNeighborsTLV(struct non1905NeighborDeviceListTLV ***non_1905_ne
         struct non1905NeighborDeviceListTLV  *no;
         struct neighborDeviceListTLV         *yes;
 
-        if (NULL == (x = PLATFORM_GET_1905_INTERFACE_INFO(interfaces_names[i])))
+        if (NULL == (x = PLATFORM_GET_1905_INTERFACE_INFO_CACHED(interfaces_names[i])))
         {
             PLATFORM_PRINTF_DEBUG_WARNING("Could not retrieve neighbors of interface %s\n", interfaces_names[i]);
             continue;
@@ -498,7 +502,6 @@ void _obtainLocalNeighborsTLV(struct non1905NeighborDeviceListTLV ***non_1905_ne
                     PLATFORM_FREE(al_mac);
                 }
             }
-            PLATFORM_FREE_1905_INTERFACE_INFO(x);
 
             // Update the datamodel so that those neighbours whose MAC addresses
             // have not been reported are removed.
@@ -677,7 +680,7 @@ void _obtainLocalPowerOffInterfacesTLV(struct powerOffInterfaceTLV *power_off)
     {
         struct interfaceInfo *x;
 
-        if (NULL == (x = PLATFORM_GET_1905_INTERFACE_INFO(interfaces_names[i])))
+        if (NULL == (x = PLATFORM_GET_1905_INTERFACE_INFO_CACHED(interfaces_names[i])))
         {
             // Error retrieving information for this interface.
             // Ignore it.
@@ -689,7 +692,6 @@ void _obtainLocalPowerOffInterfacesTLV(struct powerOffInterfaceTLV *power_off)
         {
             // Ignore interfaces that are not in "POWER OFF" mode
             //
-            PLATFORM_FREE_1905_INTERFACE_INFO(x);
             continue;
         }
 
@@ -821,8 +823,6 @@ void _obtainLocalPowerOffInterfacesTLV(struct powerOffInterfaceTLV *power_off)
             }
         }
         power_off->power_off_interfaces_nr++;
-
-        PLATFORM_FREE_1905_INTERFACE_INFO(x);
     }
 
     PLATFORM_FREE_LIST_OF_1905_INTERFACES(interfaces_names, interfaces_names_nr);
@@ -876,7 +876,7 @@ void _obtainLocalL2NeighborsTLV(struct l2NeighborDeviceTLV *l2_neighbors)
     {
         struct interfaceInfo *x;
 
-        if (NULL == (x = PLATFORM_GET_1905_INTERFACE_INFO(interfaces_names[i])))
+        if (NULL == (x = PLATFORM_GET_1905_INTERFACE_INFO_CACHED(interfaces_names[i])))
         {
             // Error retrieving information for this interface.
             // Ignore it.
@@ -889,7 +889,6 @@ void _obtainLocalL2NeighborsTLV(struct l2NeighborDeviceTLV *l2_neighbors)
             // Ignore interfaces that do not have (or cannot report) L2
             // neighbors
             //
-            PLATFORM_FREE_1905_INTERFACE_INFO(x);
             continue;
         }
 
@@ -920,8 +919,6 @@ void _obtainLocalL2NeighborsTLV(struct l2NeighborDeviceTLV *l2_neighbors)
         }
 
         l2_neighbors->local_interfaces_nr++;
-
-        PLATFORM_FREE_1905_INTERFACE_INFO(x);
     }
 
     PLATFORM_FREE_LIST_OF_1905_INTERFACES(interfaces_names, interfaces_names_nr);
@@ -1140,7 +1137,7 @@ void _obtainLocalMetricsTLVs(INT8U destination, INT8U *specific_neighbor, INT8U
                 struct interfaceInfo *f;
                 struct linkMetrics   *l;
 
-                f = PLATFORM_GET_1905_INTERFACE_INFO(local_interfaces[j]);
+                f = PLATFORM_GET_1905_INTERFACE_INFO_CACHED(local_interfaces[j]);
                 l = PLATFORM_GET_LINK_METRICS(local_interfaces[j], remote_macs[j]);
 
                 if (NULL != tx_tlvs)
@@ -1204,10 +1201,6 @@ void _obtainLocalMetricsTLVs(INT8U destination, INT8U *specific_neighbor, INT8U
                     }
                 }
 
-                if (NULL != f)
-                {
-                    PLATFORM_FREE_1905_INTERFACE_INFO(f);
-                }
                 if (NULL != l)
                 {
                     PLATFORM_FREE_LINK_METRICS(l);
@@ -1572,7 +1565,7 @@ void _obtainLocalGenericPhyTLV(struct genericPhyDeviceInformationTypeTLV *generi
     {
         struct interfaceInfo *x;
 
-        if (NULL == (x = PLATFORM_GET_1905_INTERFACE_INFO(interfaces_names[i])))
+        if (NULL == (x = PLATFORM_GET_1905_INTERFACE_INFO_CACHED(interfaces_names[i])))
         {
             // Error retrieving information for this interface.
             // Ignore it.
@@ -1623,7 +1616,6 @@ void _obtainLocalGenericPhyTLV(struct genericPhyDeviceInformationTypeTLV *generi
 
             generic_phy->local_interfaces_nr++;
         }
-        PLATFORM_FREE_1905_INTERFACE_INFO(x);
     }
 
     PLATFORM_FREE_LIST_OF_1905_INTERFACES(interfaces_names, interfaces_names_nr);
@@ -1774,7 +1766,7 @@ void _obtainLocalIpsTLVs(struct ipv4TypeTLV *ipv4, struct ipv6TypeTLV *ipv6)
     {
         struct interfaceInfo *y;
 
-        y = PLATFORM_GET_1905_INTERFACE_INFO(ifs_names[i]);
+        y = PLATFORM_GET_1905_INTERFACE_INFO_CACHED(ifs_names[i]);
         if (NULL == y)
         {
             PLATFORM_PRINTF_DEBUG_WARNING("Could not retrieve info of interface %s\n", ifs_names[i]);
@@ -1882,8 +1874,6 @@ void _obtainLocalIpsTLVs(struct ipv4TypeTLV *ipv4, struct ipv6TypeTLV *ipv6)
 
             ipv6->ipv6_interfaces_nr++;
         }
-
-        PLATFORM_FREE_1905_INTERFACE_INFO(y);
     }
 
     PLATFORM_FREE_LIST_OF_1905_INTERFACES(ifs_names, ifs_nr);
@@ -1927,45 +1917,134 @@ void _freeLocalIpsTLVs(struct ipv4TypeTLV *ipv4, struct ipv6TypeTLV *ipv6)
 //******************************************************************************
 //
 // The following "buffer writer" related variables and functions are used to
-// "trick" the "DMdumpNetworkDevices()" function to print to a memory buffer
-// instead of to a file descriptor (ex: STDOUT)
+// "trick" the "DMdumpNetworkDevices()" function (and other similar ones) to
+// print to a memory buffer instead of to a file descriptor (ex: STDOUT)
+//
+// The buffer has a fixed size. Every time it fills up, its contents are sent
+// right away to the ALME client as one piece of the reply (see
+// "PLATFORM_SEND_ALME_PARTIAL_REPLY()") and the buffer is reused. Whatever is
+// left in the buffer at the end is sent by the caller as the last piece.
+// This way dumps of any size are sent complete, and (because the length of the
+// buffer contents is tracked instead of recomputed after each write) they take
+// linear time to generate.
 //
-//   TODO: Review this mechanism so that such a huge malloc is not needed.
-//         Because the information contained in this buffer is meant to be sent
-//         through a TCP socket, maybe we could allocate small chunks and keep
-//         sending them through the socket... however this would require several
-//         changes in the way things operate now...
-//         Think about it (and, who knows... maybe we decide to leave it as it
-//         is now after all).
+#define MEMORY_BUFFER_SIZE (16*1024)
+char   *memory_buffer                = NULL;
+INT16U  memory_buffer_i              = 0;
+INT8U   memory_buffer_alme_client_id = 0;
+
+// Request being answered by the dump that is writing to the buffer (see the
+// "Custom command dumps" section)
 //
-#define MEMORY_BUFFER_SIZE (63*1024)
-char   *memory_buffer     = NULL;
-INT16U  memory_buffer_i   = 0;
+struct customCommandRequestALME *custom_command_request = NULL;
+
+void _memoryBufferWriterInit(INT8U alme_client_id)
+{
+    memory_buffer                = (char *)PLATFORM_MALLOC(MEMORY_BUFFER_SIZE);
+    memory_buffer_i              = 0;
+    memory_buffer_alme_client_id = alme_client_id;
+}
+void _memoryBufferWriterFlush()
+{
+    struct customCommandResponseALME  out;
+
+    INT8U   *packet;
+    INT16U   packet_len;
+
+    if (0 == memory_buffer_i)
+    {
+        return;
+    }
+
+    memory_buffer[memory_buffer_i] = 0x0;
+
+    out.alme_type = ALME_TYPE_CUSTOM_COMMAND_RESPONSE;
+    out.bytes_nr  = memory_buffer_i+1;
+    out.bytes     = memory_buffer;
+
+    packet = forge_1905_ALME_from_structure((INT8U *)&out, &packet_len);
+    if (NULL == packet)
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("forge_1905_ALME_from_structure() failed.\n");
+    }
+    else
+    {
+        PLATFORM_SEND_ALME_PARTIAL_REPLY(memory_buffer_alme_client_id, packet, packet_len);
+        free_1905_ALME_packet(packet);
+    }
 
-void _memoryBufferWriterInit()
+    memory_buffer_i = 0;
+}
+void _memoryBufferBytesWriter(INT8U *buffer, INT32U len)
 {
-    memory_buffer     = (char *)PLATFORM_MALLOC(MEMORY_BUFFER_SIZE);
-    memory_buffer_i   = 0;
+    // Same as "_memoryBufferWriter()", but for raw (ex: binary) data
+    //
+    INT32U  done;
+
+    for (done=0; done<len; )
+    {
+        INT32U n;
+
+        if (memory_buffer_i == MEMORY_BUFFER_SIZE-1)
+        {
+            _memoryBufferWriterFlush();
+        }
+
+        n = len - done;
+        if (n > (INT32U)(MEMORY_BUFFER_SIZE-1-memory_buffer_i))
+        {
+            n = MEMORY_BUFFER_SIZE-1-memory_buffer_i;
+        }
+
+        PLATFORM_MEMCPY(memory_buffer + memory_buffer_i, buffer + done, n);
+        memory_buffer_i += n;
+        done            += n;
+    }
 }
 void _memoryBufferWriter(const char *fmt, ...)
 {
     va_list arglist;
+    va_list arglist_copy;
+    INT32U  len;
 
-    if (memory_buffer_i >= MEMORY_BUFFER_SIZE-1)
+    va_start(arglist, fmt);
+    va_copy(arglist_copy, arglist);
+
+    len = PLATFORM_VSNPRINTF(memory_buffer + memory_buffer_i, MEMORY_BUFFER_SIZE - memory_buffer_i, fmt, arglist);
+
+    if (memory_buffer_i + len < MEMORY_BUFFER_SIZE)
     {
-        // Too big...
+        // It fits (including the NULL terminator)
         //
-        PLATFORM_PRINTF_DEBUG_WARNING("Memory buffer overflow.\n");
-        return;
+        memory_buffer_i += len;
     }
-    
-    va_start(arglist, fmt);
-    PLATFORM_VSNPRINTF(memory_buffer + memory_buffer_i, MEMORY_BUFFER_SIZE - memory_buffer_i, fmt, arglist);
-    va_end(arglist);
+    else if (len < MEMORY_BUFFER_SIZE)
+    {
+        // It does not fit in what is left of the buffer, but it does fit in an
+        // empty one. Send what we had so far and write it again.
+        //
+        _memoryBufferWriterFlush();
 
-    memory_buffer[MEMORY_BUFFER_SIZE-1] = 0x0;
-    memory_buffer_i = PLATFORM_STRLEN(memory_buffer);
-    memory_buffer[memory_buffer_i] = 0x0;
+        PLATFORM_VSNPRINTF(memory_buffer, MEMORY_BUFFER_SIZE, fmt, arglist_copy);
+        memory_buffer_i = len;
+    }
+    else
+    {
+        // It is bigger than the whole buffer: format it somewhere else and
+        // copy it piece by piece
+        //
+        char   *p;
+
+        p = (char *)PLATFORM_MALLOC(len+1);
+        PLATFORM_VSNPRINTF(p, len+1, fmt, arglist_copy);
+
+        _memoryBufferBytesWriter((INT8U *)p, len);
+
+        PLATFORM_FREE(p);
+    }
+
+    va_end(arglist_copy);
+    va_end(arglist);
 
     return;
 }
@@ -1975,10 +2054,29 @@ void _memoryBufferWriterEnd()
     {
         PLATFORM_FREE(memory_buffer);
 
+        memory_buffer     = NULL;
         memory_buffer_i   = 0;
     }
+    custom_command_request = NULL;
+
     return;
 }
+void _sendChunkedDump(INT8U alme_client_id, struct customCommandResponseALME *out, void (*dump)(void (*write_function)(const char *fmt, ...)))
+{
+    // Run 'dump' on a new buffer (sending each piece to 'alme_client_id' as
+    // soon as the buffer fills up) and leave the last piece in 'out', to be
+    // sent by the caller.
+    // Once 'out' has been sent, "_memoryBufferWriterEnd()" must be called.
+    //
+    _memoryBufferWriterInit(alme_client_id);
+
+    dump(_memoryBufferWriter);
+
+    memory_buffer[memory_buffer_i] = 0x0;
+
+    out->bytes_nr = memory_buffer_i+1;
+    out->bytes    = memory_buffer;
+}
 
 //******************************************************************************
 //******* Local device data dump ***********************************************
@@ -2115,37 +2213,40 @@ void _updateLocalDeviceData()
     freeExtendedLocalInfo(&extensions, &extensions_nr);
 }
 
-////////////////////////////////////////////////////////////////////////////////
-// Public functions (exported only to files in this same folder)
-////////////////////////////////////////////////////////////////////////////////
+//******************************************************************************
+//******* Already forged CMDUs *************************************************
+//******************************************************************************
+//
+// Some CMDUs are sent very often and their contents only change when something
+// in the local device changes. Instead of building and forging them each time,
+// the forged streams can be kept and, before sending them again, only the
+// fields that differ from one send to the next (the MID) are updated.
 
-INT8U send1905RawPacket(char *interface_name, INT16U mid, INT8U *dst_mac_address, struct CMDU *cmdu)
+// Update the MID of all the fragments in 'streams' (as returned by
+// "forge_1905_CMDU_from_structure()")
+//
+static void _patchStreamsMid(INT8U **streams, INT16U mid)
 {
-    INT8U  **streams;
-    INT16U  *streams_lens;
-
-    INT8U total_streams, x;
+    INT8U x;
 
-    // Insert protocol extensions to the CMDU, which has been already built at
-    // this point.
+    // The MID is found right after the message version (1 byte), the
+    // reserved field (1 byte) and the message type (2 bytes) of each fragment
+    // header
     //
-    send1905CmduExtensions(cmdu);
-
-    PLATFORM_PRINTF_DEBUG_DETAIL("Contents of CMDU to send:\n");
-    visit_1905_CMDU_structure(cmdu, print_callback, PLATFORM_PRINTF_DEBUG_DETAIL, "");
-
-    streams = forge_1905_CMDU_from_structure(cmdu, &streams_lens);
-    if (NULL == streams)
+    for (x=0; NULL != streams[x]; x++)
     {
-        // Could not forge the packet. Error?
-        //
-        PLATFORM_PRINTF_DEBUG_WARNING("forge_1905_CMDU_from_structure() failed!\n");
-        return 0;
+        streams[x][4] = (mid >> 8) & 0xff;
+        streams[x][5] =  mid       & 0xff;
     }
+}
 
-    // Free previously allocated CMDU extensions (no longer needed)
-    //
-    free1905CmduExtensions(cmdu);
+// Send all the fragments in 'streams' (as returned by
+// "forge_1905_CMDU_from_structure()") to 'dst_mac_address' through interface
+// 'interface_name'
+//
+static void _send1905Streams(char *interface_name, INT16U mid, INT8U *dst_mac_address, INT8U **streams, INT16U *streams_lens)
+{
+    INT8U total_streams, x;
 
     total_streams = 0;
     while(streams[total_streams])
@@ -2153,17 +2254,6 @@ INT8U send1905RawPacket(char *interface_name, INT16U mid, INT8U *dst_mac_address
         total_streams++;
     }
 
-    if (0 == total_streams)
-    {
-        // Could not forge the packet. Error?
-        //
-        PLATFORM_PRINTF_DEBUG_WARNING("forge_1905_CMDU_from_structure() returned 0 streams!\n");
-
-        free_1905_CMDU_packets(streams);
-        PLATFORM_FREE(streams_lens);
-        return 0;
-    }
-
     x = 0;
     while(streams[x])
     {
@@ -2180,59 +2270,133 @@ INT8U send1905RawPacket(char *interface_name, INT16U mid, INT8U *dst_mac_address
 
         x++;
     }
-
-    free_1905_CMDU_packets(streams);
-    PLATFORM_FREE(streams_lens);
-
-    return 1;
 }
 
-INT8U send1905RawALME(INT8U alme_client_id, INT8U *alme)
+// The "topology response" CMDU is the same no matter who asks for it (only
+// the MID changes), thus it is only built again when any of the things it is
+// made of has changed:
+//
+//   - The information of local interfaces (see
+//     "PLATFORM_GET_1905_INTERFACE_INFO_GENERATION()")
+//   - The neighbors seen on each of them (see "DMlocalGenerationGet()")
+//   - The data added by protocol extensions (see
+//     "get1905CmduExtensionsGeneration()")
+//   - Bridges, which are only reported as part of "topology change" events
+//     (see "invalidateTopologyResponse()")
+//
+static struct _topologyResponseCache
 {
-    INT8U    *packet_out;
-    INT16U    packet_out_len;
+    INT8U     valid;
 
-    PLATFORM_PRINTF_DEBUG_DETAIL("Contents of ALME reply to send:\n");
-    visit_1905_ALME_structure((INT8U *)alme, print_callback, PLATFORM_PRINTF_DEBUG_DETAIL, "");
+    INT32U    interfaces_generation;
+    INT32U    datamodel_generation;
+    INT32U    extensions_generation;
 
-    // Use the getIntfListResponseALME structure to forge the packet
-    // bit stream
-    //
-    packet_out = forge_1905_ALME_from_structure((INT8U *)alme, &packet_out_len);
-    if (NULL == packet_out)
+    INT8U   **streams;
+    INT16U   *streams_lens;
+
+} topology_response_cache;
+
+static void _freeTopologyResponseCache(void)
+{
+    if (NULL != topology_response_cache.streams)
     {
-        PLATFORM_PRINTF_DEBUG_WARNING("forge_1905_ALME_from_structure() failed.\n");
+        free_1905_CMDU_packets(topology_response_cache.streams);
+        PLATFORM_FREE(topology_response_cache.streams_lens);
+    }
 
-        PLATFORM_SEND_ALME_REPLY(alme_client_id, NULL, 0);
+    topology_response_cache.streams      = NULL;
+    topology_response_cache.streams_lens = NULL;
+    topology_response_cache.valid        = 0;
+}
+
+// Return '1' if the cached "topology response" can be sent, '0' if it must be
+// built again
+//
+static INT8U _topologyResponseCacheIsValid(void)
+{
+    char  **ifs_names;
+    INT8U   ifs_nr;
+    INT8U   i;
+
+    if (0 == topology_response_cache.valid)
+    {
         return 0;
     }
 
-    // Send the ALME reply back
+    // Make sure the information of all interfaces is fresh, so that the
+    // generation we are about to check accounts for all changes
     //
-    PLATFORM_SEND_ALME_REPLY(alme_client_id, packet_out, packet_out_len);
+    ifs_names = PLATFORM_GET_LIST_OF_1905_INTERFACES(&ifs_nr);
+    for (i=0; i<ifs_nr; i++)
+    {
+        PLATFORM_GET_1905_INTERFACE_INFO_CACHED(ifs_names[i]);
+    }
+    PLATFORM_FREE_LIST_OF_1905_INTERFACES(ifs_names, ifs_nr);
 
-    free_1905_ALME_packet(packet_out);
+    if (
+         topology_response_cache.interfaces_generation != PLATFORM_GET_1905_INTERFACE_INFO_GENERATION() ||
+         topology_response_cache.datamodel_generation  != DMlocalGenerationGet()                        ||
+         topology_response_cache.extensions_generation != get1905CmduExtensionsGeneration()
+       )
+    {
+        return 0;
+    }
 
     return 1;
 }
 
-INT8U send1905TopologyDiscoveryPacket(char *interface_name, INT16U mid)
+// The "topology discovery" and "LLDP bridge discovery" messages sent on each
+// interface are always the same (only the MID of the former changes), thus
+// they are forged once per interface and kept here.
+//
+// A template is forged again when the interface MAC address, the AL MAC
+// address or the data added by protocol extensions changes.
+//
+struct _discoveryTemplate
+{
+    char    *interface_name;
+
+    INT8U    valid;
+
+    INT8U    interface_mac_address[6];
+    INT8U    al_mac_address[6];
+    INT32U   extensions_generation;
+
+    INT8U  **streams;                // "Topology discovery" CMDU fragments
+    INT16U  *streams_lens;
+
+    INT8U   *lldp_stream;            // "LLDP bridge discovery" payload
+    INT16U   lldp_stream_len;
+};
+
+// Templates are allocated one by one (and never moved) because callers keep
+// pointers to several of them at the same time.
+//
+static struct _discoveryTemplate **discovery_templates    = NULL;
+static INT8U                       discovery_templates_nr = 0;
+
+static INT8U mcast_1905_address[] = MCAST_1905;
+static INT8U mcast_lldp_address[] = MCAST_LLDP;
+
+// Forge the "topology discovery" CMDU for an interface whose MAC address is
+// 'interface_mac_address' (the MID is left to zero).
+//
+// Returns the list of streams (and their lengths in 'streams_lens') or NULL if
+// there was a problem. Free them with "free_1905_CMDU_packets()" (and
+// "PLATFORM_FREE()" for the lengths).
+//
+static INT8U **_forgeTopologyDiscovery(INT8U *interface_mac_address, INT16U **streams_lens)
 {
     // The "topology discovery" message is a CMDU with two TLVs:
     //   - One AL MAC address type TLV
     //   - One MAC address type TLV
 
-    INT8U  interface_mac_address[6];
-
-    INT8U  mcast_address[] = MCAST_1905;
-
     struct CMDU                discovery_message;
     struct alMacAddressTypeTLV al_mac_addr_tlv;
     struct macAddressTypeTLV   mac_addr_tlv;
 
-    PLATFORM_PRINTF_DEBUG_INFO("--> CMDU_TYPE_TOPOLOGY_DISCOVERY (%s)\n", interface_name);
-
-    PLATFORM_MEMCPY(interface_mac_address, DMinterfaceNameToMac(interface_name), 6);
+    INT8U **streams;
 
     // Fill the AL MAC address type TLV
     //
@@ -2252,68 +2416,412 @@ INT8U send1905TopologyDiscoveryPacket(char *interface_name, INT16U mid)
     //
     discovery_message.message_version = CMDU_MESSAGE_VERSION_1905_1_2013;
     discovery_message.message_type    = CMDU_TYPE_TOPOLOGY_DISCOVERY;
-    discovery_message.message_id      = mid;
+    discovery_message.message_id      = 0;
     discovery_message.relay_indicator = 0;
     discovery_message.list_of_TLVs    = (INT8U **)PLATFORM_MALLOC(sizeof(INT8U *)*3);
     discovery_message.list_of_TLVs[0] = (INT8U *)&al_mac_addr_tlv;
     discovery_message.list_of_TLVs[1] = (INT8U *)&mac_addr_tlv;
     discovery_message.list_of_TLVs[2] = NULL;
 
-    // Send the packet
+    // Insert protocol extensions and forge it
     //
-    if (0 == send1905RawPacket(interface_name, mid, mcast_address, &discovery_message))
+    send1905CmduExtensions(&discovery_message);
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("Contents of CMDU to send:\n");
+    visit_1905_CMDU_structure(&discovery_message, print_callback, PLATFORM_PRINTF_DEBUG_DETAIL, "");
+
+    streams = forge_1905_CMDU_from_structure(&discovery_message, streams_lens);
+
+    free1905CmduExtensions(&discovery_message);
+
+    if (NULL == streams)
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("Could not send the 1905 packet\n");
-        PLATFORM_FREE(discovery_message.list_of_TLVs);
-        return 0;
+        PLATFORM_PRINTF_DEBUG_WARNING("forge_1905_CMDU_from_structure() failed!\n");
     }
-    
+    else if (NULL == streams[0])
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("forge_1905_CMDU_from_structure() returned 0 streams!\n");
+
+        free_1905_CMDU_packets(streams);
+        PLATFORM_FREE(*streams_lens);
+        streams = NULL;
+    }
+
     // Free memory
     //
     _freeLocalAlMacAddressTLV(&al_mac_addr_tlv);
 
     PLATFORM_FREE(discovery_message.list_of_TLVs);
-    return 1;
+
+    return streams;
 }
 
-INT8U send1905TopologyQueryPacket(char *interface_name, INT16U mid, INT8U *destination_al_mac_address)
+// Forge the "LLDP bridge discovery" payload for an interface whose MAC address
+// is 'interface_mac_address'.
+//
+// Returns the payload (and its length in 'stream_len') or NULL if there was a
+// problem. Free it with "free_lldp_PAYLOAD_packet()".
+//
+static INT8U *_forgeLLDPBridgeDiscovery(INT8U *interface_mac_address, INT16U *stream_len)
 {
-    // The "topology query" message is a CMDU with no TLVs
+    INT8U  al_mac_address[6];
 
-    INT8U ret;
+    struct chassisIdTLV      chassis_id_tlv;
+    struct portIdTLV         port_id_tlv;
+    struct timeToLiveTypeTLV time_to_live_tlv;
 
-    struct CMDU  query_message;
+    struct PAYLOAD payload;
 
-    PLATFORM_PRINTF_DEBUG_INFO("--> CMDU_TYPE_TOPOLOGY_QUERY (%s)\n", interface_name);
-    PLATFORM_PRINTF_DEBUG_DETAIL("Sending to %02x:%02x:%02x:%02x:%02x:%02x\n", destination_al_mac_address[0], destination_al_mac_address[1], destination_al_mac_address[2], destination_al_mac_address[3], destination_al_mac_address[4], destination_al_mac_address[5]);
+    INT8U  *stream;
 
-    // Build the CMDU
-    //
-    query_message.message_version = CMDU_MESSAGE_VERSION_1905_1_2013;
-    query_message.message_type    = CMDU_TYPE_TOPOLOGY_QUERY;
-    query_message.message_id      = mid;
-    query_message.relay_indicator = 0;
-    query_message.list_of_TLVs    = (INT8U **)PLATFORM_MALLOC(sizeof(INT8U *));
-    query_message.list_of_TLVs[0] = NULL;
+    PLATFORM_MEMCPY(al_mac_address, DMalMacGet(), 6);
 
-    // Send the packet
+    // Fill the chassis ID TLV
     //
-    if (0 == send1905RawPacket(interface_name, mid, destination_al_mac_address, &query_message))
-    {
-        PLATFORM_PRINTF_DEBUG_WARNING("Could not send packet\n");
-        ret = 0;
-    }
-    else
-    {
-        ret = 1;
-    }
-    
-    // Free memory
+    chassis_id_tlv.tlv_type           = TLV_TYPE_CHASSIS_ID;
+    chassis_id_tlv.chassis_id_subtype = CHASSIS_ID_TLV_SUBTYPE_MAC_ADDRESS;
+    chassis_id_tlv.chassis_id[0]      = al_mac_address[0];
+    chassis_id_tlv.chassis_id[1]      = al_mac_address[1];
+    chassis_id_tlv.chassis_id[2]      = al_mac_address[2];
+    chassis_id_tlv.chassis_id[3]      = al_mac_address[3];
+    chassis_id_tlv.chassis_id[4]      = al_mac_address[4];
+    chassis_id_tlv.chassis_id[5]      = al_mac_address[5];
+
+    // Fill the port ID TLV
     //
-    PLATFORM_FREE(query_message.list_of_TLVs);
+    port_id_tlv.tlv_type            = TLV_TYPE_PORT_ID;
+    port_id_tlv.port_id_subtype     = PORT_ID_TLV_SUBTYPE_MAC_ADDRESS;
+    port_id_tlv.port_id[0]          = interface_mac_address[0];
+    port_id_tlv.port_id[1]          = interface_mac_address[1];
+    port_id_tlv.port_id[2]          = interface_mac_address[2];
+    port_id_tlv.port_id[3]          = interface_mac_address[3];
+    port_id_tlv.port_id[4]          = interface_mac_address[4];
+    port_id_tlv.port_id[5]          = interface_mac_address[5];
 
-    return ret;
-}
+    // Fill the time to live TLV
+    //
+    time_to_live_tlv.tlv_type       = TLV_TYPE_TIME_TO_LIVE;
+    time_to_live_tlv.ttl            = TIME_TO_LIVE_TLV_1905_DEFAULT_VALUE;
+
+    // Forge the LLDP payload containing all these TLVs
+    //
+    payload.list_of_TLVs[0] = (INT8U *)&chassis_id_tlv;
+    payload.list_of_TLVs[1] = (INT8U *)&port_id_tlv;
+    payload.list_of_TLVs[2] = (INT8U *)&time_to_live_tlv;
+    payload.list_of_TLVs[3] = NULL;
+
+    stream = forge_lldp_PAYLOAD_from_structure(&payload, stream_len);
+    if (NULL == stream)
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("forge_lldp_PAYLOAD_from_structure() failed!\n");
+    }
+
+    return stream;
+}
+
+static void _freeDiscoveryTemplate(struct _discoveryTemplate *t)
+{
+    if (NULL != t->streams)
+    {
+        free_1905_CMDU_packets(t->streams);
+        PLATFORM_FREE(t->streams_lens);
+    }
+    if (NULL != t->lldp_stream)
+    {
+        free_lldp_PAYLOAD_packet(t->lldp_stream);
+    }
+
+    t->streams      = NULL;
+    t->streams_lens = NULL;
+    t->lldp_stream  = NULL;
+    t->valid        = 0;
+}
+
+// Return the (up to date) discovery template of interface 'interface_name' or
+// NULL if it could not be built
+//
+static struct _discoveryTemplate *_getDiscoveryTemplate(char *interface_name)
+{
+    struct _discoveryTemplate *t;
+
+    INT8U *interface_mac_address;
+    INT8U *al_mac_address;
+    INT8U  i;
+
+    interface_mac_address = DMinterfaceNameToMac(interface_name);
+    al_mac_address        = DMalMacGet();
+
+    if (NULL == interface_mac_address || NULL == al_mac_address)
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("Unknown MAC address of interface %s\n", interface_name);
+        return NULL;
+    }
+
+    t = NULL;
+    for (i=0; i<discovery_templates_nr; i++)
+    {
+        if (0 == PLATFORM_MEMCMP(discovery_templates[i]->interface_name, interface_name, PLATFORM_STRLEN(interface_name) + 1))
+        {
+            t = discovery_templates[i];
+            break;
+        }
+    }
+
+    if (NULL == t)
+    {
+        if (0xff == discovery_templates_nr)
+        {
+            PLATFORM_PRINTF_DEBUG_WARNING("Too many discovery templates\n");
+            return NULL;
+        }
+
+        t = (struct _discoveryTemplate *)PLATFORM_MALLOC(sizeof(struct _discoveryTemplate));
+        PLATFORM_MEMSET(t, 0x0, sizeof(struct _discoveryTemplate));
+        t->interface_name = PLATFORM_STRDUP(interface_name);
+
+        discovery_templates = (struct _discoveryTemplate **)PLATFORM_REALLOC(discovery_templates, sizeof(struct _discoveryTemplate *) * (discovery_templates_nr + 1));
+        discovery_templates[discovery_templates_nr++] = t;
+    }
+
+    if (
+         1 == t->valid                                                             &&
+         0 == PLATFORM_MEMCMP(t->interface_mac_address, interface_mac_address, 6) &&
+         0 == PLATFORM_MEMCMP(t->al_mac_address,        al_mac_address,        6) &&
+         t->extensions_generation == get1905CmduExtensionsGeneration()
+       )
+    {
+        return t;
+    }
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("Building discovery templates for interface %s\n", interface_name);
+
+    _freeDiscoveryTemplate(t);
+
+    PLATFORM_MEMCPY(t->interface_mac_address, interface_mac_address, 6);
+    PLATFORM_MEMCPY(t->al_mac_address,        al_mac_address,        6);
+    t->extensions_generation = get1905CmduExtensionsGeneration();
+
+    t->streams     = _forgeTopologyDiscovery(interface_mac_address, &t->streams_lens);
+    t->lldp_stream = _forgeLLDPBridgeDiscovery(interface_mac_address, &t->lldp_stream_len);
+
+    if (NULL == t->streams || NULL == t->lldp_stream)
+    {
+        _freeDiscoveryTemplate(t);
+        return NULL;
+    }
+
+    t->valid = 1;
+
+    return t;
+}
+
+// Add to 'packets' (which must have enough room) the frames of the
+// "topology discovery" message in template 't' (with its MID set to 'mid')
+// and increase 'packets_nr' accordingly
+//
+static void _queueTopologyDiscovery(struct _discoveryTemplate *t, INT16U mid, struct rawPacket *packets, INT16U *packets_nr)
+{
+    INT8U x;
+
+    _patchStreamsMid(t->streams, mid);
+
+    for (x=0; NULL != t->streams[x]; x++)
+    {
+        packets[*packets_nr].interface_name = t->interface_name;
+        packets[*packets_nr].dst_mac        = mcast_1905_address;
+        packets[*packets_nr].src_mac        = t->al_mac_address;
+        packets[*packets_nr].eth_type       = ETHERTYPE_1905;
+        packets[*packets_nr].payload        = t->streams[x];
+        packets[*packets_nr].payload_len    = t->streams_lens[x];
+
+        (*packets_nr)++;
+    }
+}
+
+// Same as "_queueTopologyDiscovery()" for the "LLDP bridge discovery" message
+//
+static void _queueLLDPBridgeDiscovery(struct _discoveryTemplate *t, struct rawPacket *packets, INT16U *packets_nr)
+{
+    packets[*packets_nr].interface_name = t->interface_name;
+    packets[*packets_nr].dst_mac        = mcast_lldp_address;
+    packets[*packets_nr].src_mac        = t->interface_mac_address;
+    packets[*packets_nr].eth_type       = ETHERTYPE_LLDP;
+    packets[*packets_nr].payload        = t->lldp_stream;
+    packets[*packets_nr].payload_len    = t->lldp_stream_len;
+
+    (*packets_nr)++;
+}
+
+// Return the number of fragments of the "topology discovery" message in
+// template 't'
+//
+static INT8U _topologyDiscoveryStreamsNr(struct _discoveryTemplate *t)
+{
+    INT8U x;
+
+    for (x=0; NULL != t->streams[x]; x++);
+
+    return x;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Public functions (exported only to files in this same folder)
+////////////////////////////////////////////////////////////////////////////////
+
+INT8U send1905RawPacket(char *interface_name, INT16U mid, INT8U *dst_mac_address, struct CMDU *cmdu)
+{
+    INT8U  **streams;
+    INT16U  *streams_lens;
+
+    INT8U total_streams;
+
+    // Insert protocol extensions to the CMDU, which has been already built at
+    // this point.
+    //
+    send1905CmduExtensions(cmdu);
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("Contents of CMDU to send:\n");
+    visit_1905_CMDU_structure(cmdu, print_callback, PLATFORM_PRINTF_DEBUG_DETAIL, "");
+
+    streams = forge_1905_CMDU_from_structure(cmdu, &streams_lens);
+    if (NULL == streams)
+    {
+        // Could not forge the packet. Error?
+        //
+        PLATFORM_PRINTF_DEBUG_WARNING("forge_1905_CMDU_from_structure() failed!\n");
+        return 0;
+    }
+
+    // Free previously allocated CMDU extensions (no longer needed)
+    //
+    free1905CmduExtensions(cmdu);
+
+    total_streams = 0;
+    while(streams[total_streams])
+    {
+        total_streams++;
+    }
+
+    if (0 == total_streams)
+    {
+        // Could not forge the packet. Error?
+        //
+        PLATFORM_PRINTF_DEBUG_WARNING("forge_1905_CMDU_from_structure() returned 0 streams!\n");
+
+        free_1905_CMDU_packets(streams);
+        PLATFORM_FREE(streams_lens);
+        return 0;
+    }
+
+    _send1905Streams(interface_name, mid, dst_mac_address, streams, streams_lens);
+
+    free_1905_CMDU_packets(streams);
+    PLATFORM_FREE(streams_lens);
+
+    return 1;
+}
+
+INT8U send1905RawALME(INT8U alme_client_id, INT8U *alme)
+{
+    INT8U    *packet_out;
+    INT16U    packet_out_len;
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("Contents of ALME reply to send:\n");
+    visit_1905_ALME_structure((INT8U *)alme, print_callback, PLATFORM_PRINTF_DEBUG_DETAIL, "");
+
+    // Use the getIntfListResponseALME structure to forge the packet
+    // bit stream
+    //
+    packet_out = forge_1905_ALME_from_structure((INT8U *)alme, &packet_out_len);
+    if (NULL == packet_out)
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("forge_1905_ALME_from_structure() failed.\n");
+
+        PLATFORM_SEND_ALME_REPLY(alme_client_id, NULL, 0);
+        return 0;
+    }
+
+    // Send the ALME reply back
+    //
+    PLATFORM_SEND_ALME_REPLY(alme_client_id, packet_out, packet_out_len);
+
+    free_1905_ALME_packet(packet_out);
+
+    return 1;
+}
+
+INT8U send1905TopologyDiscoveryPacket(char *interface_name, INT16U mid)
+{
+    struct _discoveryTemplate *t;
+    struct rawPacket          *packets;
+    INT16U                     packets_nr;
+    INT16U                     sent;
+
+    PLATFORM_PRINTF_DEBUG_INFO("--> CMDU_TYPE_TOPOLOGY_DISCOVERY (%s)\n", interface_name);
+
+    t = _getDiscoveryTemplate(interface_name);
+    if (NULL == t)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Could not send the 1905 packet\n");
+        return 0;
+    }
+
+    packets    = (struct rawPacket *)PLATFORM_MALLOC(sizeof(struct rawPacket) * _topologyDiscoveryStreamsNr(t));
+    packets_nr = 0;
+
+    _queueTopologyDiscovery(t, mid, packets, &packets_nr);
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("Sending 1905 message on interface %s, MID %d, %d fragment(s)\n", interface_name, mid, packets_nr);
+    sent = PLATFORM_SEND_RAW_PACKETS(packets, packets_nr);
+
+    PLATFORM_FREE(packets);
+
+    if (sent != packets_nr)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Packet could not be sent!\n");
+    }
+
+    return 1;
+}
+
+INT8U send1905TopologyQueryPacket(char *interface_name, INT16U mid, INT8U *destination_al_mac_address)
+{
+    // The "topology query" message is a CMDU with no TLVs
+
+    INT8U ret;
+
+    struct CMDU  query_message;
+
+    PLATFORM_PRINTF_DEBUG_INFO("--> CMDU_TYPE_TOPOLOGY_QUERY (%s)\n", interface_name);
+    PLATFORM_PRINTF_DEBUG_DETAIL("Sending to %02x:%02x:%02x:%02x:%02x:%02x\n", destination_al_mac_address[0], destination_al_mac_address[1], destination_al_mac_address[2], destination_al_mac_address[3], destination_al_mac_address[4], destination_al_mac_address[5]);
+
+    // Build the CMDU
+    //
+    query_message.message_version = CMDU_MESSAGE_VERSION_1905_1_2013;
+    query_message.message_type    = CMDU_TYPE_TOPOLOGY_QUERY;
+    query_message.message_id      = mid;
+    query_message.relay_indicator = 0;
+    query_message.list_of_TLVs    = (INT8U **)PLATFORM_MALLOC(sizeof(INT8U *));
+    query_message.list_of_TLVs[0] = NULL;
+
+    // Send the packet
+    //
+    if (0 == send1905RawPacket(interface_name, mid, destination_al_mac_address, &query_message))
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("Could not send packet\n");
+        ret = 0;
+    }
+    else
+    {
+        ret = 1;
+    }
+    
+    // Free memory
+    //
+    PLATFORM_FREE(query_message.list_of_TLVs);
+
+    return ret;
+}
 
 INT8U send1905TopologyResponsePacket(char *interface_name, INT16U mid, INT8U* destination_al_mac_address)
 {
@@ -2336,8 +2844,6 @@ INT8U send1905TopologyResponsePacket(char *interface_name, INT16U mid, INT8U* de
     //   more!) TLVs of these type. However, in reception (see
     //   "process1905Cmdu()") we will be ready to receive more.
 
-    INT8U  ret;
-
     struct CMDU                            response_message;
     struct deviceInformationTypeTLV        device_info;
     struct deviceBridgingCapabilityTLV     bridge_info;
@@ -2352,109 +2858,154 @@ INT8U send1905TopologyResponsePacket(char *interface_name, INT16U mid, INT8U* de
     INT8U                                 total_tlvs            = 0;
     INT8U                                 i, j;
 
+    INT8U                               **streams;
+    INT16U                               *streams_lens;
+
     PLATFORM_PRINTF_DEBUG_INFO("--> CMDU_TYPE_TOPOLOGY_RESPONSE (%s)\n", interface_name);
     PLATFORM_PRINTF_DEBUG_DETAIL("Sending to %02x:%02x:%02x:%02x:%02x:%02x\n", destination_al_mac_address[0], destination_al_mac_address[1], destination_al_mac_address[2], destination_al_mac_address[3], destination_al_mac_address[4], destination_al_mac_address[5]);
 
-    // Fill all the needed TLVs
-    //
-    _obtainLocalDeviceInfoTLV          (&device_info);
-    _obtainLocalBridgingCapabilitiesTLV(&bridge_info);
-    _obtainLocalNeighborsTLV           (&non_1905_neighbors, &non_1905_neighbors_nr, &neighbors, &neighbors_nr);
-    _obtainLocalPowerOffInterfacesTLV  (&power_off);
-    _obtainLocalL2NeighborsTLV         (&l2_neighbors);
+    if (1 == _topologyResponseCacheIsValid())
+    {
+        PLATFORM_PRINTF_DEBUG_DETAIL("Nothing has changed since the last topology response. Reusing it\n");
+    }
+    else
+    {
+        // Fill all the needed TLVs
+        //
+        _obtainLocalDeviceInfoTLV          (&device_info);
+        _obtainLocalBridgingCapabilitiesTLV(&bridge_info);
+        _obtainLocalNeighborsTLV           (&non_1905_neighbors, &non_1905_neighbors_nr, &neighbors, &neighbors_nr);
+        _obtainLocalPowerOffInterfacesTLV  (&power_off);
+        _obtainLocalL2NeighborsTLV         (&l2_neighbors);
 
-    // Build the CMDU
-    //
-    total_tlvs = 1;                      // Device information type TLV
+        // Build the CMDU
+        //
+        total_tlvs = 1;                      // Device information type TLV
 
 #ifndef SEND_EMPTY_TLVS
-    if (bridge_info.bridging_tuples_nr != 0)
+        if (bridge_info.bridging_tuples_nr != 0)
 #endif
-    {
-        total_tlvs++;                    // Device bridging capability TLV
-    }
+        {
+            total_tlvs++;                    // Device bridging capability TLV
+        }
 
-    total_tlvs += neighbors_nr;          // Non-1905 neighbor device list TLVs
-    total_tlvs += non_1905_neighbors_nr; // 1905 Neighbor device list TLVs
+        total_tlvs += neighbors_nr;          // Non-1905 neighbor device list TLVs
+        total_tlvs += non_1905_neighbors_nr; // 1905 Neighbor device list TLVs
 
 #ifndef SEND_EMPTY_TLVS
-    if (power_off.power_off_interfaces_nr != 0)
+        if (power_off.power_off_interfaces_nr != 0)
 #endif
-    {
-        total_tlvs++;                    // Power off interface TLV
-    }
+        {
+            total_tlvs++;                    // Power off interface TLV
+        }
 
 #ifndef SEND_EMPTY_TLVS
-    if (l2_neighbors.local_interfaces_nr != 0)
+        if (l2_neighbors.local_interfaces_nr != 0)
 #endif
-    {
-        total_tlvs++;                    // L2 neighbor device TLV
-    }
+        {
+            total_tlvs++;                    // L2 neighbor device TLV
+        }
 
-    response_message.message_version = CMDU_MESSAGE_VERSION_1905_1_2013;
-    response_message.message_type    = CMDU_TYPE_TOPOLOGY_RESPONSE;
-    response_message.message_id      = mid;
-    response_message.relay_indicator = 0;
-    response_message.list_of_TLVs    = (INT8U **)PLATFORM_MALLOC(sizeof(INT8U *)*(total_tlvs+1));
-    response_message.list_of_TLVs[0] = (INT8U *)&device_info;
+        response_message.message_version = CMDU_MESSAGE_VERSION_1905_1_2013;
+        response_message.message_type    = CMDU_TYPE_TOPOLOGY_RESPONSE;
+        response_message.message_id      = mid;
+        response_message.relay_indicator = 0;
+        response_message.list_of_TLVs    = (INT8U **)PLATFORM_MALLOC(sizeof(INT8U *)*(total_tlvs+1));
+        response_message.list_of_TLVs[0] = (INT8U *)&device_info;
 
-    i = 1;
+        i = 1;
 #ifndef SEND_EMPTY_TLVS
-    if (bridge_info.bridging_tuples_nr != 0)
+        if (bridge_info.bridging_tuples_nr != 0)
 #endif
-    {
-        response_message.list_of_TLVs[i++] = (INT8U *)&bridge_info;
-    }
+        {
+            response_message.list_of_TLVs[i++] = (INT8U *)&bridge_info;
+        }
 
-    for (j=0; j<non_1905_neighbors_nr; j++)
-    {
-        response_message.list_of_TLVs[i++] = (INT8U *)non_1905_neighbors[j];
-    }
+        for (j=0; j<non_1905_neighbors_nr; j++)
+        {
+            response_message.list_of_TLVs[i++] = (INT8U *)non_1905_neighbors[j];
+        }
 
-    for (j=0; j<neighbors_nr; j++)
-    {
-        response_message.list_of_TLVs[i++] = (INT8U *)neighbors[j];
-    }
+        for (j=0; j<neighbors_nr; j++)
+        {
+            response_message.list_of_TLVs[i++] = (INT8U *)neighbors[j];
+        }
 
 #ifndef SEND_EMPTY_TLVS
-    if (power_off.power_off_interfaces_nr != 0)
+        if (power_off.power_off_interfaces_nr != 0)
 #endif
-    {
-        response_message.list_of_TLVs[i++] = (INT8U *)&power_off;
-    }
+        {
+            response_message.list_of_TLVs[i++] = (INT8U *)&power_off;
+        }
 
 #ifndef SEND_EMPTY_TLVS
-    if (l2_neighbors.local_interfaces_nr != 0)
+        if (l2_neighbors.local_interfaces_nr != 0)
 #endif
-    {
-        response_message.list_of_TLVs[i++] = (INT8U *)&l2_neighbors;
-    }
+        {
+            response_message.list_of_TLVs[i++] = (INT8U *)&l2_neighbors;
+        }
 
-    response_message.list_of_TLVs[i] = NULL;
+        response_message.list_of_TLVs[i] = NULL;
 
-    // Send the packet
-    //
-    if (0 == send1905RawPacket(interface_name, mid, destination_al_mac_address, &response_message))
-    {
-        PLATFORM_PRINTF_DEBUG_WARNING("Could not send packet\n");
-        ret = 0 ;
-    }
-    else
-    {
-        ret = 1;
+        // Forge it (including whatever protocol extensions add to it)
+        //
+        send1905CmduExtensions(&response_message);
+
+        PLATFORM_PRINTF_DEBUG_DETAIL("Contents of CMDU to send:\n");
+        visit_1905_CMDU_structure(&response_message, print_callback, PLATFORM_PRINTF_DEBUG_DETAIL, "");
+
+        streams = forge_1905_CMDU_from_structure(&response_message, &streams_lens);
+
+        // Free all allocated (and no longer needed) memory
+        //
+        free1905CmduExtensions(&response_message);
+
+        _freeLocalDeviceInfoTLV          (&device_info);
+        _freeLocalBridgingCapabilitiesTLV(&bridge_info);
+        _freeLocalNeighborsTLV           (&non_1905_neighbors, &non_1905_neighbors_nr, &neighbors, &neighbors_nr);
+        _freeLocalPowerOffInterfacesTLV  (&power_off);
+        _freeLocalL2NeighborsTLV         (&l2_neighbors);
+
+        PLATFORM_FREE(response_message.list_of_TLVs);
+
+        if (NULL == streams || NULL == streams[0])
+        {
+            PLATFORM_PRINTF_DEBUG_WARNING("forge_1905_CMDU_from_structure() failed!\n");
+
+            if (NULL != streams)
+            {
+                free_1905_CMDU_packets(streams);
+                PLATFORM_FREE(streams_lens);
+            }
+            return 0;
+        }
+
+        // Keep it for the next time. Note that generations are read *after*
+        // the CMDU has been built, as building it might have refreshed
+        // interfaces information or removed neighbors which are no longer
+        // there
+        //
+        _freeTopologyResponseCache();
+
+        topology_response_cache.streams               = streams;
+        topology_response_cache.streams_lens          = streams_lens;
+        topology_response_cache.interfaces_generation = PLATFORM_GET_1905_INTERFACE_INFO_GENERATION();
+        topology_response_cache.datamodel_generation  = DMlocalGenerationGet();
+        topology_response_cache.extensions_generation = get1905CmduExtensionsGeneration();
+        topology_response_cache.valid                 = 1;
     }
-    
-    // Free all allocated (and no longer needed) memory
+
+    // Send the packet
     //
-    _freeLocalDeviceInfoTLV          (&device_info);
-    _freeLocalBridgingCapabilitiesTLV(&bridge_info);
-    _freeLocalNeighborsTLV           (&non_1905_neighbors, &non_1905_neighbors_nr, &neighbors, &neighbors_nr);
-    _freeLocalPowerOffInterfacesTLV  (&power_off);
-    _freeLocalL2NeighborsTLV         (&l2_neighbors);
+    _patchStreamsMid(topology_response_cache.streams, mid);
+    _send1905Streams(interface_name, mid, destination_al_mac_address, topology_response_cache.streams, topology_response_cache.streams_lens);
 
-    PLATFORM_FREE(response_message.list_of_TLVs);
+    return 1;
+}
 
-    return ret;
+void invalidateTopologyResponse(void)
+{
+    _freeTopologyResponseCache();
 }
 
 INT8U send1905TopologyNotificationPacket(char *interface_name, INT16U mid)
@@ -3612,81 +4163,96 @@ INT8U send1905InterfacePowerChangeResponsePacket(char *interface_name, INT16U mi
 
 INT8U sendLLDPBridgeDiscoveryPacket(char *interface_name)
 {
-    INT8U  al_mac_address[6];
-    INT8U  interface_mac_address[6];
-
-    struct chassisIdTLV      chassis_id_tlv;
-    struct portIdTLV         port_id_tlv;
-    struct timeToLiveTypeTLV time_to_live_tlv;
-
-    struct PAYLOAD payload;
-
-    INT8U  *stream;
-    INT16U  stream_len;
+    struct _discoveryTemplate *t;
+    struct rawPacket           packet;
+    INT16U                     packets_nr;
 
     PLATFORM_PRINTF_DEBUG_INFO("--> LLDP BRIDGE DISCOVERY (%s)\n", interface_name);
 
-    PLATFORM_MEMCPY(al_mac_address,        DMalMacGet(),                         6);
-    PLATFORM_MEMCPY(interface_mac_address, DMinterfaceNameToMac(interface_name), 6);
+    t = _getDiscoveryTemplate(interface_name);
+    if (NULL == t)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Could not send the LLDP packet\n");
+        return 0;
+    }
 
-    // Fill the chassis ID TLV
-    //
-    chassis_id_tlv.tlv_type           = TLV_TYPE_CHASSIS_ID;
-    chassis_id_tlv.chassis_id_subtype = CHASSIS_ID_TLV_SUBTYPE_MAC_ADDRESS;
-    chassis_id_tlv.chassis_id[0]      = al_mac_address[0];
-    chassis_id_tlv.chassis_id[1]      = al_mac_address[1];
-    chassis_id_tlv.chassis_id[2]      = al_mac_address[2];
-    chassis_id_tlv.chassis_id[3]      = al_mac_address[3];
-    chassis_id_tlv.chassis_id[4]      = al_mac_address[4];
-    chassis_id_tlv.chassis_id[5]      = al_mac_address[5];
+    packets_nr = 0;
+    _queueLLDPBridgeDiscovery(t, &packet, &packets_nr);
 
-    // Fill the port ID TLV
-    //
-    port_id_tlv.tlv_type            = TLV_TYPE_PORT_ID;
-    port_id_tlv.port_id_subtype     = PORT_ID_TLV_SUBTYPE_MAC_ADDRESS;
-    port_id_tlv.port_id[0]          = interface_mac_address[0];
-    port_id_tlv.port_id[1]          = interface_mac_address[1];
-    port_id_tlv.port_id[2]          = interface_mac_address[2];
-    port_id_tlv.port_id[3]          = interface_mac_address[3];
-    port_id_tlv.port_id[4]          = interface_mac_address[4];
-    port_id_tlv.port_id[5]          = interface_mac_address[5];
+    PLATFORM_PRINTF_DEBUG_DETAIL("Sending LLDP bridge discovery message on interface %s\n", interface_name);
+    if (1 != PLATFORM_SEND_RAW_PACKETS(&packet, packets_nr))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Packet could not be sent!\n");
+    }
 
-    // Fill the time to live TLV
-    //
-    time_to_live_tlv.tlv_type       = TLV_TYPE_TIME_TO_LIVE;
-    time_to_live_tlv.ttl            = TIME_TO_LIVE_TLV_1905_DEFAULT_VALUE;
+    return 1;
+}
 
-    // Forge the LLDP payload containing all these TLVs
-    //
-    payload.list_of_TLVs[0] = (INT8U *)&chassis_id_tlv;
-    payload.list_of_TLVs[1] = (INT8U *)&port_id_tlv;
-    payload.list_of_TLVs[2] = (INT8U *)&time_to_live_tlv;
-    payload.list_of_TLVs[3] = NULL;
+INT8U send1905DiscoveryPackets(char **interfaces_names, INT8U interfaces_nr, INT16U mid)
+{
+    struct _discoveryTemplate **templates;
+    struct rawPacket           *packets;
+    INT16U                      packets_nr;
+    INT16U                      sent;
+    INT32U                      total;
+    INT8U                       i;
+    INT8U                       ret;
+
+    if (0 == interfaces_nr)
+    {
+        return 1;
+    }
 
-    stream = forge_lldp_PAYLOAD_from_structure(&payload, &stream_len);
+    ret = 1;
 
-    // Finally, send the packet!
+    // Get (or build) the templates of all interfaces first, so that we know
+    // how many frames are going to be sent
     //
+    templates = (struct _discoveryTemplate **)PLATFORM_MALLOC(sizeof(struct _discoveryTemplate *) * interfaces_nr);
+    total     = 0;
+    for (i=0; i<interfaces_nr; i++)
     {
-        INT8U   mcast_address[] = MCAST_LLDP;
+        PLATFORM_PRINTF_DEBUG_INFO("--> CMDU_TYPE_TOPOLOGY_DISCOVERY (%s)\n", interfaces_names[i]);
+        PLATFORM_PRINTF_DEBUG_INFO("--> LLDP BRIDGE DISCOVERY (%s)\n",        interfaces_names[i]);
 
-        PLATFORM_PRINTF_DEBUG_DETAIL("Sending LLDP bridge discovery message on interface %s\n", interface_name);
-        if (0 == PLATFORM_SEND_RAW_PACKET(interface_name,
-                                          mcast_address,
-                                          interface_mac_address,
-                                          ETHERTYPE_LLDP,
-                                          stream,
-                                          stream_len))
+        templates[i] = _getDiscoveryTemplate(interfaces_names[i]);
+        if (NULL == templates[i])
         {
-            PLATFORM_PRINTF_DEBUG_ERROR("Packet could not be sent!\n");
+            PLATFORM_PRINTF_DEBUG_ERROR("Could not send the discovery packets on interface %s\n", interfaces_names[i]);
+            ret = 0;
+            continue;
         }
+        total += _topologyDiscoveryStreamsNr(templates[i]) + 1;
     }
 
-    // Free memory
+    // Now queue all frames (on each interface, the "topology discovery"
+    // message goes first and the "LLDP bridge discovery" one right after it,
+    // just like when they were sent one by one) and send them at once
     //
-    free_lldp_PAYLOAD_packet(stream);
+    packets    = (struct rawPacket *)PLATFORM_MALLOC(sizeof(struct rawPacket) * (total > 0 ? total : 1));
+    packets_nr = 0;
+    for (i=0; i<interfaces_nr; i++)
+    {
+        if (NULL == templates[i])
+        {
+            continue;
+        }
 
-    return 1;
+        _queueTopologyDiscovery  (templates[i], mid, packets, &packets_nr);
+        _queueLLDPBridgeDiscovery(templates[i],      packets, &packets_nr);
+    }
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("Sending discovery messages on %d interface(s), MID %d, %d frame(s)\n", interfaces_nr, mid, packets_nr);
+    sent = PLATFORM_SEND_RAW_PACKETS(packets, packets_nr);
+    if (sent != packets_nr)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("%d out of %d discovery frames could not be sent!\n", packets_nr - sent, packets_nr);
+    }
+
+    PLATFORM_FREE(packets);
+    PLATFORM_FREE(templates);
+
+    return ret;
 }
 
 INT8U send1905InterfaceListResponseALME(INT8U alme_client_id)
@@ -3905,7 +4471,74 @@ INT8U send1905MetricsResponseALME(INT8U alme_client_id, INT8U *mac_address)
     return ret;
 }
 
-INT8U send1905CustomCommandResponseALME(INT8U alme_client_id, INT8U command)
+//******************************************************************************
+//******* Custom command dumps *************************************************
+//******************************************************************************
+//
+// Adapters used by "send1905CustomCommandResponseALME()" to give all dumps the
+// same prototype (see "_sendChunkedDump()"). Those which need the arguments of
+// the request take them from "custom_command_request" (which is only set
+// while one of them is running, and cleared by "_memoryBufferWriterEnd()").
+//
+
+void _dumpNetworkDevices(void (*write_function)(const char *fmt, ...))
+{
+    // Update the information regarding the local node and dump the database
+    // (which contains information from the local and remote nodes)
+    //
+    _updateLocalDeviceData();
+
+    DMdumpNetworkDevices(write_function);
+}
+void _dumpNetworkDevicesSince(void (*write_function)(const char *fmt, ...))
+{
+    // Same as above, but only dump what has changed since the provided
+    // generation
+    //
+    _updateLocalDeviceData();
+
+    DMdumpNetworkDevicesSince(custom_command_request->epoch, custom_command_request->generation, write_function);
+}
+void _queryNetworkDevices(void (*write_function)(const char *fmt, ...))
+{
+    // Same as above, but only dump the devices (and the parts of them) that
+    // match the filters contained in the request
+    //
+    _updateLocalDeviceData();
+
+    DMqueryNetworkDevices(custom_command_request->al_mac_addresses_nr, custom_command_request->al_mac_addresses, custom_command_request->media_type, custom_command_request->max_phy_rate, custom_command_request->sections, write_function);
+}
+void _exportNetworkDevices(__attribute__((unused)) void (*write_function)(const char *fmt, ...))
+{
+    // Same as "_dumpNetworkDevices()", but in binary format
+    //
+    _updateLocalDeviceData();
+
+    DMexportNetworkDevices(_memoryBufferBytesWriter);
+}
+void _dumpFlightRecorder(void (*write_function)(const char *fmt, ...))
+{
+    // Save the flight recorder contents and report where (the frames
+    // themselves are too big to be sent as a response)
+    //
+    char   *destination;
+    INT32U  frames_nr;
+
+    if (1 == PLATFORM_DUMP_FLIGHT_RECORDER(&destination, &frames_nr))
+    {
+        write_function("%d frames saved to %s\n", frames_nr, destination);
+    }
+    else if (NULL == destination)
+    {
+        write_function("The flight recorder is disabled\n");
+    }
+    else
+    {
+        write_function("Could not save the flight recorder to %s\n", destination);
+    }
+}
+
+INT8U send1905CustomCommandResponseALME(INT8U alme_client_id, struct customCommandRequestALME *request)
 {
     INT8U   ret;
 
@@ -3918,25 +4551,94 @@ INT8U send1905CustomCommandResponseALME(INT8U alme_client_id, INT8U command)
     out = (struct customCommandResponseALME *)PLATFORM_MALLOC(sizeof(struct customCommandResponseALME));
     out->alme_type = ALME_TYPE_CUSTOM_COMMAND_RESPONSE;
 
-    switch (command)
+    switch (request->command)
     {
         case CUSTOM_COMMAND_DUMP_NETWORK_DEVICES:
         {
-            // Update the information regarding the local node
-            //
-            _updateLocalDeviceData();
+            _sendChunkedDump(alme_client_id, out, _dumpNetworkDevices);
+            break;
+        }
+
+        case CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE:
+        {
+            custom_command_request = request;
+            _sendChunkedDump(alme_client_id, out, _dumpNetworkDevicesSince);
+            break;
+        }
+
+        case CUSTOM_COMMAND_QUERY_NETWORK_DEVICES:
+        {
+            custom_command_request = request;
+            _sendChunkedDump(alme_client_id, out, _queryNetworkDevices);
+            break;
+        }
+
+        case CUSTOM_COMMAND_EXPORT_NETWORK_DEVICES:
+        {
+            _sendChunkedDump(alme_client_id, out, _exportNetworkDevices);
+            break;
+        }
+
+        case CUSTOM_COMMAND_DUMP_METRICS_HISTORY:
+        {
+            _sendChunkedDump(alme_client_id, out, MHdumpMetricsHistory);
+            break;
+        }
 
-            // Dump the database (which contains information from the local and
-            // remote nodes) into a text buffer and send that as a reponse
+        case CUSTOM_COMMAND_DUMP_PENDING_QUERIES:
+        {
+            _sendChunkedDump(alme_client_id, out, RQdumpRequests);
+            break;
+        }
+
+        case CUSTOM_COMMAND_DUMP_NOTIFICATIONS:
+        {
+            _sendChunkedDump(alme_client_id, out, NTdumpNotifications);
+            break;
+        }
+
+        case CUSTOM_COMMAND_DUMP_RECEIVE_STATS:
+        {
+            _sendChunkedDump(alme_client_id, out, RSdumpReceiveStats);
+            break;
+        }
+
+        case CUSTOM_COMMAND_DUMP_FLIGHT_RECORDER:
+        {
+            _sendChunkedDump(alme_client_id, out, _dumpFlightRecorder);
+            break;
+        }
+
+        case CUSTOM_COMMAND_DUMP_MEMORY_USAGE:
+        {
+            _sendChunkedDump(alme_client_id, out, PLATFORM_MEMORY_ACCOUNTING_DUMP);
+            break;
+        }
+
+        case CUSTOM_COMMAND_SUBSCRIBE_EVENTS:
+        {
+            // From now on, events are sent (as they take place) instead of a
+            // regular response. If the subscription cannot be accepted, the
+            // response is empty.
             //
-            _memoryBufferWriterInit();
+            out->bytes_nr = 0;
+            out->bytes    = NULL;
 
-            DMdumpNetworkDevices(_memoryBufferWriter);
+            if (1 == EVsubscribe(alme_client_id, request->events, request->al_mac_addresses_nr, request->al_mac_addresses, request->metric_threshold))
+            {
+                free_1905_ALME_structure((INT8U *)out);
+                return 0;
+            }
+
+            break;
+        }
 
-            memory_buffer[memory_buffer_i] = 0x0;
+        default:
+        {
+            PLATFORM_PRINTF_DEBUG_WARNING("Unknown custom command (%d)\n", request->command);
 
-            out->bytes_nr = memory_buffer_i+1;
-            out->bytes    = memory_buffer;
+            out->bytes_nr = 0;
+            out->bytes    = NULL;
 
             break;
         }
@@ -3956,7 +4658,7 @@ INT8U send1905CustomCommandResponseALME(INT8U alme_client_id, INT8U command)
 
     // Free memory not needed anymore
     //
-    if (CUSTOM_COMMAND_DUMP_NETWORK_DEVICES == command)
+    if (NULL != out->bytes)
     {
         // Here we will free the memory buffer *and* set the pointer in the
         // "out" structure to NULL, so that later "free_1905_ALME_structure()"
@@ -60,6 +60,7 @@
 
 #include "1905_cmdus.h"
 #include "1905_tlvs.h"
+#include "1905_alme.h"
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -152,10 +153,23 @@ INT8U send1905TopologyQueryPacket(char *interface_name, INT16U mid, INT8U *desti
 //
 // The format of this packet is detailed in "Section 6.3.3"
 //
+// The packet is only built (and forged) again when something it depends on has
+// changed since the last time. Otherwise the previous one is sent again (with
+// the new 'mid').
+//
 // Return "0" if a problem was found. "1" otherwise.
 //
 INT8U send1905TopologyResponsePacket(char *interface_name, INT16U mid, INT8U *destination_al_mac_address);
 
+// Force the next call to "send1905TopologyResponsePacket()" to build the
+// packet again.
+//
+// Most changes are detected automatically, but this must be called whenever a
+// local "topology change" event is processed (bridges, for example, are only
+// known to have changed that way)
+//
+void invalidateTopologyResponse(void);
+
 // This function sends a "1905 topology notification packet" on the provided
 // interface.
 //
@@ -544,6 +558,23 @@ INT8U send1905InterfacePowerChangeResponsePacket(char *interface_name, INT16U mi
 //
 INT8U sendLLDPBridgeDiscoveryPacket(char *interface_name);
 
+// This function sends both a "1905 topology discovery packet" and a "LLDP
+// bridge discovery packet" on each of the 'interfaces_nr' interfaces contained
+// in 'interfaces_names', all of them in one single batch (see
+// "PLATFORM_SEND_RAW_PACKETS()").
+//
+// 'mid' is the "Message identifier" all the "topology discovery" packets will
+// contain.
+//
+// Both this function, "send1905TopologyDiscoveryPacket()" and
+// "sendLLDPBridgeDiscoveryPacket()" keep the forged packets of each interface
+// and only forge them again when the interface MAC address, the AL MAC address
+// or the registered protocol extensions change.
+//
+// Return "0" if a problem was found on any interface. "1" otherwise.
+//
+INT8U send1905DiscoveryPackets(char **interfaces_names, INT8U interfaces_nr, INT16U mid);
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Functions to send ALME reply messages
@@ -571,10 +602,19 @@ INT8U send1905MetricsResponseALME(INT8U alme_client_id, INT8U *mac_address);
 //
 // 'alme_client_id' must be the same one used to receive the original request.
 //
-// 'command' is the particular custom command whose response is going to be
-// generated and sent back (ie. the 'command' contained in the original request)
-// This 'command' can take any of the "CUSTOM_COMMAND_*" available values.
+// 'request' is the original request. Its 'command' (which can take any of the
+// "CUSTOM_COMMAND_*" available values) selects the response that is going to
+// be generated and sent back, and the rest of its fields are the arguments of
+// that particular command (ex: 'generation' for
+// "CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE" or the filters for
+// "CUSTOM_COMMAND_QUERY_NETWORK_DEVICES")
+//
+INT8U send1905CustomCommandResponseALME(INT8U alme_client_id, struct customCommandRequestALME *request);
+
+
+// Refresh the data model entry of the local device (which, unlike the ones of
+// remote devices, is not updated when CMDUs are received)
 //
-INT8U send1905CustomCommandResponseALME(INT8U alme_client_id, INT8U command);
+void _updateLocalDeviceData();
 
 #endif
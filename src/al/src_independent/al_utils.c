@@ -88,3 +88,7 @@ INT16U getNextMid(void)
     return mid;
 }
 
+INT8U timestampReached(INT32U a, INT32U b)
+{
+    return (INT32S)(a - b) >= 0 ? 1 : 0;
+}
@@ -63,5 +63,12 @@
 //
 INT16U getNextMid(void);
 
+// Return '1' if timestamp 'a' (as returned by "PLATFORM_GET_TIMESTAMP()") is
+// later than (or equal to) 'b', '0' otherwise.
+// The timestamps counter wraps around, thus they must never be compared
+// directly (this works as long as they are less than ~24 days apart).
+//
+INT8U timestampReached(INT32U a, INT32U b);
+
 #endif
 
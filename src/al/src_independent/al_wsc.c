@@ -55,6 +55,8 @@
  *  DAMAGE.
  */
 
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_WSC
+
 #include "platform.h"
 
 #include "al_wsc.h"
@@ -382,6 +384,9 @@ INT8U  wscBuildM1(char *interface_name, INT8U **m1, INT16U *m1_size, void **key)
         private_key->key_len = priv_len;
         PLATFORM_MEMCPY(private_key->key, priv, priv_len);
         PLATFORM_MEMCPY(private_key->mac, x->mac_address, 6);
+
+        PLATFORM_FREE(priv);
+        PLATFORM_FREE(pub);
     }
 
     // AUTHENTICATION TYPES
@@ -822,7 +827,6 @@ INT8U  wscProcessM2(void *key, INT8U *m1, INT16U m1_size, INT8U *m2, INT16U m2_s
         len[0]  = shared_secret_len;
 
         PLATFORM_SHA256(1, addr, len, dhkey);
-        PLATFORM_FREE(shared_secret);
 
         // Next, concatenate three things (the enrolle nonce contained in M1, 
         // the enrolle MAC address, and the nonce we just generated before, and
@@ -859,6 +863,8 @@ INT8U  wscProcessM2(void *key, INT8U *m1, INT16U m1_size, INT8U *m2, INT16U m2_s
         PLATFORM_PRINTF_DEBUG_DETAIL("  authkey           (%3d bytes): 0x%02x, 0x%02x, 0x%02x, ..., 0x%02x, 0x%02x, 0x%02x\n", authkey[0], authkey[1], authkey[2], authkey[WPS_AUTHKEY_LEN-3], authkey[WPS_AUTHKEY_LEN-2], authkey[WPS_AUTHKEY_LEN-1]);
         PLATFORM_PRINTF_DEBUG_DETAIL("  keywrapkey        (%3d bytes): 0x%02x, 0x%02x, 0x%02x, ..., 0x%02x, 0x%02x, 0x%02x\n", keywrapkey[0], keywrapkey[1], keywrapkey[2], keywrapkey[WPS_KEYWRAPKEY_LEN-3], keywrapkey[WPS_KEYWRAPKEY_LEN-2], keywrapkey[WPS_KEYWRAPKEY_LEN-1]);
         PLATFORM_PRINTF_DEBUG_DETAIL("  emsk              (%3d bytes): 0x%02x, 0x%02x, 0x%02x, ..., 0x%02x, 0x%02x, 0x%02x\n", emsk[0], emsk[1], emsk[2], emsk[WPS_EMSK_LEN-3], emsk[WPS_EMSK_LEN-2], emsk[WPS_EMSK_LEN-1]);
+
+        PLATFORM_FREE(shared_secret);
     }
 
     // With the just computed key, check the message authentication
@@ -1184,6 +1190,8 @@ INT8U wscBuildM2(INT8U *m1, INT16U m1_size, INT8U **m2, INT16U *m2_size)
         //
         local_privkey     = priv;
         local_privkey_len = priv_len;
+
+        PLATFORM_FREE(pub);
     }
 
     // Key derivation (no bytes are written to the output buffer in the next
@@ -1218,7 +1226,6 @@ INT8U wscBuildM2(INT8U *m1, INT16U m1_size, INT8U **m2, INT16U *m2_size)
         len[0]  = shared_secret_len;
 
         PLATFORM_SHA256(1, addr, len, dhkey);
-        PLATFORM_FREE(shared_secret);
 
         // Next, concatenate three things (the enrollee nonce contained in M1, 
         // the enrolle MAC address -also contained in M1-, and the nonce we just
@@ -1255,6 +1262,9 @@ INT8U wscBuildM2(INT8U *m1, INT16U m1_size, INT8U **m2, INT16U *m2_size)
         PLATFORM_PRINTF_DEBUG_DETAIL("  authkey           (%3d bytes): 0x%02x, 0x%02x, 0x%02x, ..., 0x%02x, 0x%02x, 0x%02x\n", authkey[0], authkey[1], authkey[2], authkey[WPS_AUTHKEY_LEN-3], authkey[WPS_AUTHKEY_LEN-2], authkey[WPS_AUTHKEY_LEN-1]);
         PLATFORM_PRINTF_DEBUG_DETAIL("  keywrapkey        (%3d bytes): 0x%02x, 0x%02x, 0x%02x, ..., 0x%02x, 0x%02x, 0x%02x\n", keywrapkey[0], keywrapkey[1], keywrapkey[2], keywrapkey[WPS_KEYWRAPKEY_LEN-3], keywrapkey[WPS_KEYWRAPKEY_LEN-2], keywrapkey[WPS_KEYWRAPKEY_LEN-1]);
         PLATFORM_PRINTF_DEBUG_DETAIL("  emsk              (%3d bytes): 0x%02x, 0x%02x, 0x%02x, ..., 0x%02x, 0x%02x, 0x%02x\n", emsk[0], emsk[1], emsk[2], emsk[WPS_EMSK_LEN-3], emsk[WPS_EMSK_LEN-2], emsk[WPS_EMSK_LEN-1]);
+
+        PLATFORM_FREE(shared_secret);
+        PLATFORM_FREE(local_privkey);
     }
 
     // AUTHENTICATION TYPES
@@ -55,6 +55,8 @@
  *  DAMAGE.
  */
 
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_EXTENSIONS
+
 #include "al_datamodel.h"
 #include "al_recv.h"
 #include "al_extension.h" // VendorSpecificTLVDuplicate
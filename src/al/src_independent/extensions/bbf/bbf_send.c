@@ -55,6 +55,8 @@
  *  DAMAGE.
  */
 
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_EXTENSIONS
+
 #include "utils.h"
 #include "al_send.h"
 #include "1905_cmdus.h"
@@ -59,7 +59,11 @@
 #include "platform_interfaces_priv.h"            // addInterface
 #include "platform_interfaces_ghnspirit_priv.h"  // registerGhnSpiritInterfaceType
 #include "platform_interfaces_simulated_priv.h"  // registerSimulatedInterfaceType
+#include "platform_interfaces_vwire_priv.h"      // registerVirtualWireInterfaceType
+#include "platform_interfaces_replay_priv.h"     // registerReplayInterfaceType
 #include "platform_alme_server_priv.h"           // almeServerPortSet()
+#include "platform_os_priv.h"                    // datamodelSnapshotFileSet(), topologyImageNameSet()
+#include "platform_flight_recorder_priv.h"       // flightRecorderStart()
 #include "al.h"                                  // start1905AL
 
 #include <stdio.h>   // printf
@@ -182,7 +186,7 @@ static void _printUsage(char *program_name)
 {
     printf("AL entity (build %s)\n", _BUILD_NUMBER_);
     printf("\n");
-    printf("Usage: %s -m <al_mac_address> -i <interfaces_list> [-w] [-r <registrar_interface>] [-v] [-p <alme_port_number>]\n", program_name);
+    printf("Usage: %s -m <al_mac_address> -i <interfaces_list> [-w] [-r <registrar_interface>] [-v] [-p <alme_port_number>] [-s <snapshot_file>] [-t <topology_image_name>] [-f <flight_recorder_file>[:<frames>]]\n", program_name);
     printf("\n");
     printf("  ...where:\n");
     printf("       '<al_mac_address>' is the AL MAC address that this AL entity will receive\n");
@@ -204,6 +208,18 @@ static void _printUsage(char *program_name)
     printf("       '<alme_port_number>', is the port number where a TCP socket will be opened to receive\n");
     printf("       ALME messages. If this argument is not given, a default value of '8888' is used.\n");
     printf("\n");
+    printf("       '<snapshot_file>', if present, is the path to a file where the AL entity will periodically\n");
+    printf("       (and when terminated with SIGINT/SIGTERM) save its data model, so that it can be restored\n");
+    printf("       (and revalidated) the next time it starts instead of rediscovering the whole network.\n");
+    printf("\n");
+    printf("       '<topology_image_name>', if present, is the name of a POSIX shared memory object (ex: '/al_topology')\n");
+    printf("       where the AL entity will keep an up to date copy of its data model, so that local processes can\n");
+    printf("       read it without sending ALME requests (see 'struct topologyImageHeader' in '1905_alme.h').\n");
+    printf("\n");
+    printf("       '<flight_recorder_file>', if present, is the path to a file where the last '<frames>' (1024 by\n");
+    printf("       default) frames received and transmitted by the AL entity will be saved (in pcapng format) when\n");
+    printf("       asked to (with the 'dfr' ALME custom command or with SIGUSR1) and when the AL entity crashes.\n");
+    printf("\n");
 
     return;
 }
@@ -223,13 +239,19 @@ int main(int argc, char *argv[])
     char *al_interfaces       = NULL;
     int  alme_port_number     = 0;
     char *registrar_interface = NULL;
+    char *snapshot_file       = NULL;
+    char *topology_image      = NULL;
+    char *flight_recorder     = NULL;
+    int   flight_recorder_nr  = 0;
 
     int verbosity_counter = 1; // Only ERROR and WARNING messages
 
     registerGhnSpiritInterfaceType();
     registerSimulatedInterfaceType();
+    registerVirtualWireInterfaceType();
+    registerReplayInterfaceType();
 
-    while ((c = getopt (argc, argv, "m:i:wr:vh:p:")) != -1)
+    while ((c = getopt (argc, argv, "m:i:wr:vh:p:s:t:f:")) != -1)
     {
         switch (c)
         {
@@ -287,6 +309,37 @@ int main(int argc, char *argv[])
                 break;
             }
 
+            case 's':
+            {
+                // Data model snapshot file
+                //
+                snapshot_file = optarg;
+                break;
+            }
+
+            case 't':
+            {
+                // Topology image shared memory object name
+                //
+                topology_image = optarg;
+                break;
+            }
+
+            case 'f':
+            {
+                // Flight recorder file (and, optionally, number of frames)
+                //
+                char *aux;
+
+                flight_recorder = optarg;
+                if (NULL != (aux = strrchr(optarg, ':')))
+                {
+                    *aux               = 0x0;
+                    flight_recorder_nr = atoi(aux + 1);
+                }
+                break;
+            }
+
             case 'h':
             {
                 _printUsage(argv[0]);
@@ -313,8 +366,18 @@ int main(int argc, char *argv[])
     _asciiToMac(al_mac, al_mac_address);
 
     almeServerPortSet(alme_port_number);
+    datamodelSnapshotFileSet(snapshot_file);
+    topologyImageNameSet(topology_image);
+    flightRecorderStart(flight_recorder, flight_recorder_nr);
 
     start1905AL(al_mac_address, map_whole_network, registrar_interface);
 
+#ifdef MEMORY_ACCOUNTING
+    // Whatever is still alive at this point is either a leak or long lived
+    // state (data model, ...). Either way, it is worth reporting.
+    //
+    PLATFORM_MEMORY_ACCOUNTING_DUMP(PLATFORM_PRINTF);
+#endif
+
     return 0;
 }
@@ -60,15 +60,18 @@
 #include "platform_alme_server_priv.h"
 #include "platform_os.h"
 #include "platform_os_priv.h"
+#include "1905_alme.h"  // ALME_FRAME_*
 
-#include <arpa/inet.h>  // socket(), AF_INET, htons(), ...
-#include <errno.h>      // errno
-#include <pthread.h>    // threads and mutex functions
-#include <mqueue.h>     // mq_*() functions
-#include <string.h>     // strerror()
-#include <stdio.h>      // snprintf(), ...
-#include <stdlib.h>     // free(), malloc(), ...
-#include <unistd.h>     // close(), ...
+#include <arpa/inet.h>    // socket(), AF_INET, htons(), ...
+#include <netinet/tcp.h>  // TCP_NODELAY, TCP_KEEPIDLE, ...
+#include <errno.h>        // errno
+#include <fcntl.h>        // fcntl(), O_NONBLOCK
+#include <poll.h>         // poll()
+#include <pthread.h>      // threads and mutex functions
+#include <string.h>       // strerror()
+#include <stdio.h>        // snprintf(), ...
+#include <stdlib.h>       // free(), malloc(), ...
+#include <unistd.h>       // close(), pipe(), ...
 
 // Each platform/implementation decides how ALME messages are received by the AL
 // (ie. the standard does not specify how this is done).
@@ -82,59 +85,490 @@
 //   1. Prepare an ALME bit stream compatible with the output of
 //      "forge_1905_ALME_from_structure()".
 //
-//   2. Open a TCP connection to the AL entity TCP server.
+//   2. Open a TCP connection to the AL entity TCP server (or reuse one that it
+//      already has open).
 //
-//   3. Send the ALME bit stream and nothing else.
+//   3. Send the ALME bit stream preceded by a frame header (see
+//      "ALME_FRAME_HEADER_LEN" in "1905_alme.h") containing a request id of
+//      its choice. More requests can be sent right away, without waiting for
+//      the reply to this one.
 //
-//   4. Close the socket.
+//   4. Read frames until the one with "ALME_FRAME_FLAG_LAST" set (for that
+//      same request id) arrives.
 //
-// The ALME TCP server will then forward the data to the system queue that the
-// main 1905 thread uses to receive events.
+// Replies to event subscriptions never end: they last until the client closes
+// its writing end (or the whole connection).
 //
-// The following structure is passed to the thread in charge of running the TCP
-// server. It contains the "queue id" needed to be able to later forward all the
-// ALME messages from the TCP socket to the 1905 main thread.
+// Older clients that send a single ALME bit stream (without header) and then
+// close their writing end are also supported: they receive the reply (without
+// headers either) and then the connection is closed.
+//
+// All connections are served by a single thread which never blocks on any of
+// them, thus a slow client (or one that does not read its replies) does not
+// delay the rest.
+//
+// Each request is forwarded to the system queue that the main 1905 thread uses
+// to receive events with its own "ALME client id", which is later used to find
+// out to which connection (and request id) each reply belongs.
 
 
 ////////////////////////////////////////////////////////////////////////////////
 // Private functions, structures and macros
 ////////////////////////////////////////////////////////////////////////////////
 
-#define ALME_CLIENT_ID_TCP_SOCKET                   0x1
 #define ALME_CLIENT_ID_1905_VENDOR_SPECIFIC_TUNNEL  0x2
 
-// These global variables and mutex are used to send information from the AL
-// main thread (the one running "start1905AL()") to the ALME TCP server thread
+// Client ids from this one on are assigned to the requests received on TCP
+// connections (one for each request that has not been completely answered
+// yet)
+//
+#define ALME_CLIENT_ID_FIRST_TCP_REQUEST            0x10
+#define ALME_CLIENT_IDS_NR                          0x100
+
+#define ALME_TCP_SERVER_MAX_MESSAGE_SIZE (3*MAX_NETWORK_SEGMENT_SIZE)
+
+// Limits that keep a single client from taking all the resources: no new
+// connections are accepted beyond ALME_SERVER_MAX_CONNECTIONS, and no more
+// requests are read from a connection while it has ALME_SERVER_MAX_REQUESTS
+// of them in flight or more than ALME_SERVER_MAX_OUTPUT bytes of replies it
+// has not read yet.
+//
+#define ALME_SERVER_MAX_CONNECTIONS  (64)
+#define ALME_SERVER_MAX_REQUESTS     (16)
+#define ALME_SERVER_MAX_OUTPUT       (256*1024)
+
+// Clients can close their writing end (see above) and still be waiting for
+// replies (or events) that may take a long time to be sent, thus whether they
+// are still there is checked with TCP keep alive probes, sent after this
+// number of seconds of inactivity (a client that has gone away answers them
+// with a reset, and one whose host has disappeared does not answer them at
+// all), which ends its requests (and event subscriptions).
 //
-static pthread_mutex_t tcp_server_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t  tcp_server_cond  = PTHREAD_COND_INITIALIZER;
-static int             tcp_server_flag  = 0;
+#define ALME_SERVER_KEEPALIVE        (5)
+
+// Events (see "PLATFORM_SEND_ALME_EVENT()") of a single request that can be
+// waiting to be sent. When a new one arrives beyond this limit, the oldest one
+// that has not started to be sent yet is discarded.
+//
+#define ALME_SERVER_MAX_EVENTS       (64)
+
+// Bytes waiting to be sent on a connection
+//
+struct _almeOutput
+{
+    INT8U               *bytes;
+    INT32U               len;
+    INT32U               sent;
+
+    INT8U                event;        // Set to '1' if it can be discarded...
+    INT8U                client_id;    // ...and, in that case, the request it
+    INT32U               order;        // belongs to
 
-static INT8U  *alme_response;
-static INT16U  alme_response_len;
+    struct _almeOutput  *next;
+};
+
+struct _almeConnection
+{
+    int                      fd;
+
+    #define ALME_CONNECTION_MODE_UNKNOWN   (0)  // Nothing received yet
+    #define ALME_CONNECTION_MODE_FRAMED    (1)  // Persistent, with headers
+    #define ALME_CONNECTION_MODE_ONE_SHOT  (2)  // Older clients (see above)
+    INT8U                    mode;
+
+    INT8U                    input[ALME_FRAME_HEADER_LEN + ALME_TCP_SERVER_MAX_MESSAGE_SIZE];
+    INT32U                   input_len;
+
+    INT8U                    broken;       // Protocol or socket error: it must
+                                           // be closed right away
+
+    // The rest of the fields are also accessed by the AL main thread (when
+    // replying) and are protected by 'alme_server_mutex'
+    //
+    INT8U                    eof;          // The client closed its writing end
+    INT32U                   requests_nr;  // Requests in flight
+    struct _almeOutput      *output_first;
+    struct _almeOutput      *output_last;
+    INT32U                   output_len;
+
+    struct _almeConnection  *next;
+};
+
+// Only used by the server thread
+//
+static struct _almeConnection *alme_connections    = NULL;
+static INT32U                  alme_connections_nr = 0;
+
+// Requests in flight, indexed by "ALME client id".
+//
+// The AL entity processes ALME requests one at a time (in the same order in
+// which they were queued) and starts replying to each of them before taking
+// the next one (only event subscriptions keep on being answered afterwards).
+// Thus, once the reply to a request is complete, any older request that has
+// not received anything yet (because the AL entity ignored it, for example
+// because it was malformed) never will: it is terminated (with an empty reply)
+// so that its client is not kept waiting forever.
+//
+static struct _almeRequest
+{
+    INT8U                    in_use;
+    struct _almeConnection  *connection;   // NULL once it has been closed
+    INT32U                   request_id;
+    INT32U                   order;        // Increases with each request
+
+    INT8U                    answered;     // Some reply was already queued
+    INT32U                   events_nr;    // Events waiting to be sent
+    INT32U                   dropped_nr;   // Events discarded
+
+} alme_requests[ALME_CLIENT_IDS_NR];
+
+static INT32U  alme_requests_nr    = 0;
+static INT32U  alme_requests_order = 0;
+static INT32U  alme_requests_next  = ALME_CLIENT_ID_FIRST_TCP_REQUEST;
+
+// Protects 'alme_requests' and the fields of each connection that the AL main
+// thread (the one running "start1905AL()") uses to queue replies
+//
+static pthread_mutex_t alme_server_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// The AL main thread writes one byte here every time it queues a reply, to
+// wake up the server thread
+//
+static int alme_server_wakeup[2] = {-1, -1};
 
 // This variable holds the number of the port number the server will use
 //
 static int alme_server_port = 0;
 
+// Queue 'len' bytes of 'bytes' (preceded by 'header', if not NULL) to be sent
+// on connection 'c'. Returns the new entry of the output list (or NULL if
+// nothing was queued).
+//
+// The mutex must be held when calling this function.
+//
+static struct _almeOutput *_queueOutput(struct _almeConnection *c, INT8U *header, INT8U *bytes, INT16U len)
+{
+    struct _almeOutput *o;
+    INT32U              header_len;
 
-////////////////////////////////////////////////////////////////////////////////
-// Internal API: to be used by other platform-specific files (functions
-// declaration is found in "./platform_alme_server_priv.h")
-////////////////////////////////////////////////////////////////////////////////
+    header_len = NULL == header ? 0 : ALME_FRAME_HEADER_LEN;
+    if (0 == header_len + len)
+    {
+        return NULL;
+    }
 
-void *almeServerThread(void *p)
+    o = (struct _almeOutput *)malloc(sizeof(struct _almeOutput));
+    if (NULL != o && NULL == (o->bytes = (INT8U *)malloc(header_len + len)))
+    {
+        free(o);
+        o = NULL;
+    }
+    if (NULL == o)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Cannot allocate memory for the ALME RESPONSE/CONFIRMATION message\n");
+        c->broken = 1;
+        return NULL;
+    }
+
+    if (NULL != header)
+    {
+        memcpy(o->bytes, header, header_len);
+    }
+    if (0 != len)
+    {
+        memcpy(o->bytes + header_len, bytes, len);
+    }
+    o->len   = header_len + len;
+    o->sent  = 0;
+    o->event = 0;
+    o->next  = NULL;
+
+    if (NULL == c->output_last)
+    {
+        c->output_first = o;
+    }
+    else
+    {
+        c->output_last->next = o;
+    }
+    c->output_last  = o;
+    c->output_len  += o->len;
+
+    return o;
+}
+
+// Send 'alme_message' (which can be NULL) to the client that made request 'r',
+// in the format it expects. 'last' is '1' for the last message of the reply.
+// Returns the new entry of the output list of its connection (or NULL if
+// nothing was queued).
+//
+// The mutex must be held when calling this function.
+//
+static struct _almeOutput *_replyToClient(struct _almeRequest *r, INT8U *alme_message, INT16U alme_message_len, INT8U last)
 {
-    int socketfd;
+    struct _almeConnection *c;
+    INT8U                   header[ALME_FRAME_HEADER_LEN];
 
-    struct sockaddr_in server_addr;
+    if (NULL == (c = r->connection))
+    {
+        // The client has already gone
+        //
+        return NULL;
+    }
+
+    if (0 != alme_message_len)
+    {
+        r->answered = 1;
+    }
+
+    if (ALME_CONNECTION_MODE_FRAMED == c->mode)
+    {
+        header[0] = ALME_FRAME_MARKER;
+        header[1] = 1 == last ? ALME_FRAME_FLAG_LAST : 0x0;
+        header[2] = (alme_message_len >> 8) & 0xff;
+        header[3] = (alme_message_len     ) & 0xff;
+        header[4] = (r->request_id >> 24) & 0xff;
+        header[5] = (r->request_id >> 16) & 0xff;
+        header[6] = (r->request_id >>  8) & 0xff;
+        header[7] = (r->request_id      ) & 0xff;
+
+        return _queueOutput(c, header, alme_message, alme_message_len);
+    }
+    else
+    {
+        return _queueOutput(c, NULL, alme_message, alme_message_len);
+    }
+}
+
+// Remove the oldest event of request 'r' that has not started to be sent yet
+// from the output list of its connection. Returns '0' if there was none.
+//
+// The first entry of the list is never removed (the server thread might be
+// sending it right now).
+//
+// The mutex must be held when calling this function.
+//
+static INT8U _dropOldestEvent(struct _almeRequest *r)
+{
+    struct _almeConnection *c;
+    struct _almeOutput     *o, *prev;
+
+    c = r->connection;
+
+    if (NULL == (prev = c->output_first))
+    {
+        return 0;
+    }
+
+    for (o=prev->next; NULL != o; prev=o, o=o->next)
+    {
+        if (1 == o->event && &alme_requests[o->client_id] == r && o->order == r->order)
+        {
+            break;
+        }
+    }
+    if (NULL == o)
+    {
+        return 0;
+    }
+
+    prev->next = o->next;
+    if (c->output_last == o)
+    {
+        c->output_last = prev;
+    }
+    c->output_len -= o->len;
 
-    #define ALME_TCP_SERVER_MAX_MESSAGE_SIZE (3*MAX_NETWORK_SEGMENT_SIZE)
-    INT8U  queue_message[4+ALME_TCP_SERVER_MAX_MESSAGE_SIZE];
-    INT8U *alme_message;
+    free(o->bytes);
+    free(o);
 
-    // The first three bytes of the message that this thread is going to insert
-    // into the AL queue every time a new ALME message arrives looks like this:
+    r->events_nr--;
+    r->dropped_nr++;
+
+    return 1;
+}
+
+// Free the client id of request 'r' once it has been completely answered.
+//
+// The mutex must be held when calling this function.
+//
+static void _releaseRequest(struct _almeRequest *r)
+{
+    if (NULL != r->connection)
+    {
+        r->connection->requests_nr--;
+    }
+
+    r->in_use     = 0;
+    r->connection = NULL;
+
+    alme_requests_nr--;
+}
+
+// Hand a copy of 'alme_message' to the ALME TCP server thread, which will send
+// it to the client that made the request with id 'alme_client_id'. 'last' must
+// be set to '1' when no more messages belonging to the same reply will follow.
+// 'alme_message' can be NULL (in that case nothing is queued, but the reply is
+// still terminated when 'last' is '1').
+//
+static void _queueAlmeResponse(INT8U alme_client_id, INT8U *alme_message, INT16U alme_message_len, INT8U last)
+{
+    struct _almeRequest *r;
+    INT32U               i;
+
+    if (NULL == alme_message)
+    {
+        alme_message_len = 0;
+    }
+
+    pthread_mutex_lock(&alme_server_mutex);
+
+    r = &alme_requests[alme_client_id];
+    if (0 == r->in_use)
+    {
+        pthread_mutex_unlock(&alme_server_mutex);
+        PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] ALME reply for unknown client id %d. Discarding...\n", alme_client_id);
+        return;
+    }
+
+    if (0 != alme_message_len || 1 == last)
+    {
+        _replyToClient(r, alme_message, alme_message_len, last);
+    }
+
+    if (1 == last)
+    {
+        // Older requests won't be answered anymore (see 'alme_requests')
+        //
+        for (i=ALME_CLIENT_ID_FIRST_TCP_REQUEST; i<ALME_CLIENT_IDS_NR; i++)
+        {
+            if (1 == alme_requests[i].in_use && 0 == alme_requests[i].answered && (INT32S)(alme_requests[i].order - r->order) < 0)
+            {
+                PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] ALME request %d was not answered by the AL entity\n", alme_requests[i].request_id);
+                _replyToClient(&alme_requests[i], NULL, 0, 1);
+                _releaseRequest(&alme_requests[i]);
+            }
+        }
+        _releaseRequest(r);
+    }
+
+    pthread_mutex_unlock(&alme_server_mutex);
+
+    if (-1 == write(alme_server_wakeup[1], "", 1) && EAGAIN != errno)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] write() to the ALME server thread returned with errno=%d (%s)\n", errno, strerror(errno));
+    }
+}
+
+// Same as "_queueAlmeResponse()" (with 'last' set to '0'), but for events: if
+// the client already has "ALME_SERVER_MAX_EVENTS" of them waiting to be sent,
+// the oldest one is discarded.
+// 'alme_message' can be NULL, and then nothing is queued.
+//
+// Returns '0' if the client that made the request has gone, '1' otherwise.
+//
+static INT8U _queueAlmeEvent(INT8U alme_client_id, INT8U *alme_message, INT16U alme_message_len)
+{
+    struct _almeRequest *r;
+    struct _almeOutput  *o;
+
+    pthread_mutex_lock(&alme_server_mutex);
+
+    r = &alme_requests[alme_client_id];
+    if (0 == r->in_use || NULL == r->connection)
+    {
+        pthread_mutex_unlock(&alme_server_mutex);
+        return 0;
+    }
+
+    if (NULL == alme_message || 0 == alme_message_len)
+    {
+        // Only checking whether the client is still there. Clients using
+        // frame headers do not close their writing end until they are done
+        // (and, as event subscriptions never end by themselves, that means
+        // they are no longer interested in them)
+        //
+        INT8U gone;
+
+        gone = ALME_CONNECTION_MODE_FRAMED == r->connection->mode && 1 == r->connection->eof;
+
+        pthread_mutex_unlock(&alme_server_mutex);
+        return 1 == gone ? 0 : 1;
+    }
+
+    if (r->events_nr >= ALME_SERVER_MAX_EVENTS && 1 == _dropOldestEvent(r) && 1 == r->dropped_nr)
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] ALME request %d is not reading its events fast enough. Discarding the oldest ones...\n", r->request_id);
+    }
+
+    if (NULL != (o = _replyToClient(r, alme_message, alme_message_len, 0)))
+    {
+        o->event     = 1;
+        o->client_id = alme_client_id;
+        o->order     = r->order;
+
+        r->events_nr++;
+    }
+
+    pthread_mutex_unlock(&alme_server_mutex);
+
+    if (-1 == write(alme_server_wakeup[1], "", 1) && EAGAIN != errno)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] write() to the ALME server thread returned with errno=%d (%s)\n", errno, strerror(errno));
+    }
+
+    return 1;
+}
+
+// Forward a REQUEST ('alme_message', 'alme_message_len' bytes long) received
+// on connection 'c' (where it is identified by 'request_id') to the AL queue
+// whose id is 'queue_id'.
+//
+// If the connection has too many requests in flight (or there are no free
+// client ids) the request is not forwarded and this function returns "0" (so
+// that it can be retried later). Otherwise it returns "1".
+//
+static INT8U _forwardRequest(struct _almeConnection *c, INT32U request_id, INT8U *alme_message, INT16U alme_message_len, INT8U queue_id)
+{
+    INT8U                queue_message[4+ALME_TCP_SERVER_MAX_MESSAGE_SIZE];
+    INT16U               message_len;
+    INT32U               client_id;
+    struct _almeRequest *r;
+
+    pthread_mutex_lock(&alme_server_mutex);
+
+    if (c->requests_nr >= ALME_SERVER_MAX_REQUESTS || alme_requests_nr >= ALME_CLIENT_IDS_NR - ALME_CLIENT_ID_FIRST_TCP_REQUEST)
+    {
+        pthread_mutex_unlock(&alme_server_mutex);
+        return 0;
+    }
+
+    // Ids are handed out round robin, so that the same one is not reused
+    // right away
+    //
+    client_id = alme_requests_next;
+    while (1 == alme_requests[client_id].in_use)
+    {
+        client_id = client_id + 1 == ALME_CLIENT_IDS_NR ? ALME_CLIENT_ID_FIRST_TCP_REQUEST : client_id + 1;
+    }
+    alme_requests_next = client_id + 1 == ALME_CLIENT_IDS_NR ? ALME_CLIENT_ID_FIRST_TCP_REQUEST : client_id + 1;
+
+    r = &alme_requests[client_id];
+    r->in_use     = 1;
+    r->connection = c;
+    r->request_id = request_id;
+    r->order      = alme_requests_order++;
+    r->answered   = 0;
+    r->events_nr  = 0;
+    r->dropped_nr = 0;
+
+    c->requests_nr++;
+    alme_requests_nr++;
+
+    pthread_mutex_unlock(&alme_server_mutex);
+
+    // The message that this thread is going to insert into the AL queue looks
+    // like this:
     //
     //    byte 0x00 - PLATFORM_QUEUE_EVENT_NEW_ALME_MESSAGE
     //    byte 0x01 - Message length MSB
@@ -142,9 +576,291 @@ void *almeServerThread(void *p)
     //    byte 0x03 - ALME client ID
     //    byte 0x04... ALME payload
     //
-    // Thus, the actual ALME payload starts at byte #5
+    message_len = alme_message_len + 1;
+
+    queue_message[0] = PLATFORM_QUEUE_EVENT_NEW_ALME_MESSAGE;
+    queue_message[1] = (message_len >> 8) & 0xff;
+    queue_message[2] = (message_len     ) & 0xff;
+    queue_message[3] = client_id;
+    memcpy(&queue_message[4], alme_message, alme_message_len);
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *ALME server thread* Forwarding request %d (client id %d, %d bytes) to the AL queue\n", request_id, client_id, alme_message_len);
+
+    if (0 == sendMessageToAlQueue(queue_id, queue_message, 3+message_len))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *ALME server thread* Error sending message to queue\n");
+
+        pthread_mutex_lock(&alme_server_mutex);
+        _replyToClient(r, NULL, 0, 1);
+        _releaseRequest(r);
+        pthread_mutex_unlock(&alme_server_mutex);
+    }
+
+    return 1;
+}
+
+// Return '1' if connection 'c' has received a whole request that has not been
+// forwarded yet
+//
+static INT8U _requestReceived(struct _almeConnection *c)
+{
+    if (ALME_CONNECTION_MODE_FRAMED == c->mode)
+    {
+        return c->input_len >= ALME_FRAME_HEADER_LEN && c->input_len >= ALME_FRAME_HEADER_LEN + ((c->input[2] << 8) | c->input[3]);
+    }
+    else if (ALME_CONNECTION_MODE_ONE_SHOT == c->mode)
+    {
+        return 1 == c->eof && 0 != c->input_len;
+    }
+
+    return 0;
+}
+
+// Forward all the requests received on connection 'c' (as long as the limits
+// allow it) to the AL queue whose id is 'queue_id'
+//
+static void _processInput(struct _almeConnection *c, INT8U queue_id)
+{
+    INT32U len;
+    INT32U request_id;
+
+    if (ALME_CONNECTION_MODE_FRAMED == c->mode)
+    {
+        while (c->input_len >= ALME_FRAME_HEADER_LEN)
+        {
+            len = (c->input[2] << 8) | c->input[3];
+
+            if (ALME_FRAME_MARKER != c->input[0] || len > ALME_TCP_SERVER_MAX_MESSAGE_SIZE)
+            {
+                PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] *ALME server thread* Invalid frame received. Closing connection...\n");
+                c->broken = 1;
+                return;
+            }
+
+            if (0 == _requestReceived(c))
+            {
+                return;
+            }
+
+            request_id = (c->input[4] << 24) | (c->input[5] << 16) | (c->input[6] << 8) | c->input[7];
+
+            if (0 == _forwardRequest(c, request_id, &c->input[ALME_FRAME_HEADER_LEN], len, queue_id))
+            {
+                return;
+            }
+
+            c->input_len -= ALME_FRAME_HEADER_LEN + len;
+            memmove(c->input, &c->input[ALME_FRAME_HEADER_LEN + len], c->input_len);
+        }
+    }
+    else if (ALME_CONNECTION_MODE_ONE_SHOT == c->mode)
+    {
+        if (1 == _requestReceived(c) && 1 == _forwardRequest(c, 0, c->input, c->input_len, queue_id))
+        {
+            c->input_len = 0;
+        }
+    }
+}
+
+// Read whatever is available on connection 'c'
+//
+static void _readFromConnection(struct _almeConnection *c)
+{
+    ssize_t ret;
+
+    if (c->input_len == sizeof(c->input))
+    {
+        return;
+    }
+
+    ret = recv(c->fd, c->input + c->input_len, sizeof(c->input) - c->input_len, 0);
+    if (0 == ret)
+    {
+        pthread_mutex_lock(&alme_server_mutex);
+        c->eof = 1;
+        pthread_mutex_unlock(&alme_server_mutex);
+        return;
+    }
+    else if (-1 == ret)
+    {
+        if (EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno)
+        {
+            PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *ALME server thread* recv() failed with errno=%d (%s)\n", errno, strerror(errno));
+            c->broken = 1;
+        }
+        return;
+    }
+
+    c->input_len += ret;
+
+    if (ALME_CONNECTION_MODE_UNKNOWN == c->mode)
+    {
+        c->mode = ALME_FRAME_MARKER == c->input[0] ? ALME_CONNECTION_MODE_FRAMED : ALME_CONNECTION_MODE_ONE_SHOT;
+    }
+
+    if (ALME_CONNECTION_MODE_ONE_SHOT == c->mode && c->input_len > ALME_TCP_SERVER_MAX_MESSAGE_SIZE)
+    {
+        // This message is too big. If this is not an error from the client,
+        // then "ALME_TCP_SERVER_MAX_MESSAGE_SIZE" needs to be increased.
+        //
+        PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] *ALME server thread* Received message is too big.\n");
+        c->broken = 1;
+    }
+}
+
+// Send as much of the queued replies of connection 'c' as the socket accepts
+//
+static void _writeToConnection(struct _almeConnection *c)
+{
+    struct _almeOutput *o;
+    ssize_t             ret;
+
+    // Only this thread removes the first message of the list (the AL main
+    // thread only appends new ones, or discards events that come after it),
+    // thus it can be used without the mutex
     //
-    alme_message = &queue_message[4];
+    pthread_mutex_lock(&alme_server_mutex);
+    o = c->output_first;
+    pthread_mutex_unlock(&alme_server_mutex);
+
+    while (NULL != o)
+    {
+        ret = send(c->fd, o->bytes + o->sent, o->len - o->sent, MSG_NOSIGNAL);
+        if (-1 == ret)
+        {
+            if (EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno)
+            {
+                PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *ALME server thread* send() failed with errno=%d (%s)\n", errno, strerror(errno));
+                c->broken = 1;
+            }
+            return;
+        }
+
+        o->sent += ret;
+        if (o->sent < o->len)
+        {
+            return;
+        }
+
+        pthread_mutex_lock(&alme_server_mutex);
+        c->output_first = o->next;
+        if (NULL == c->output_first)
+        {
+            c->output_last = NULL;
+        }
+        c->output_len -= o->len;
+        if (1 == o->event && 1 == alme_requests[o->client_id].in_use && o->order == alme_requests[o->client_id].order)
+        {
+            alme_requests[o->client_id].events_nr--;
+        }
+        pthread_mutex_unlock(&alme_server_mutex);
+
+        free(o->bytes);
+        free(o);
+
+        pthread_mutex_lock(&alme_server_mutex);
+        o = c->output_first;
+        pthread_mutex_unlock(&alme_server_mutex);
+    }
+}
+
+// Close connection 'c' (which must have already been removed from the list)
+// and free it. Replies to its requests still in flight will be discarded.
+//
+static void _closeConnection(struct _almeConnection *c)
+{
+    struct _almeOutput *o;
+    INT32U              i;
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *ALME server thread* Closing connection (%d requests in flight)\n", c->requests_nr);
+
+    pthread_mutex_lock(&alme_server_mutex);
+    for (i=ALME_CLIENT_ID_FIRST_TCP_REQUEST; i<ALME_CLIENT_IDS_NR; i++)
+    {
+        if (c == alme_requests[i].connection)
+        {
+            alme_requests[i].connection = NULL;
+        }
+    }
+    while (NULL != (o = c->output_first))
+    {
+        c->output_first = o->next;
+        free(o->bytes);
+        free(o);
+    }
+    pthread_mutex_unlock(&alme_server_mutex);
+
+    close(c->fd);
+    free(c);
+}
+
+// Accept all pending connections on 'socketfd' (up to the limit)
+//
+static void _acceptConnections(int socketfd)
+{
+    struct _almeConnection *c;
+    int                     fd;
+
+    while (alme_connections_nr < ALME_SERVER_MAX_CONNECTIONS)
+    {
+        fd = accept(socketfd, NULL, NULL);
+        if (-1 == fd)
+        {
+            if (EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno)
+            {
+                PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] *ALME server thread* accept() failed with errno=%d (%s)\n", errno, strerror(errno));
+            }
+            return;
+        }
+
+        if (NULL == (c = (struct _almeConnection *)calloc(1, sizeof(struct _almeConnection))))
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *ALME server thread* Cannot allocate memory for a new connection\n");
+            close(fd);
+            return;
+        }
+
+        // Replies are made of several small messages, which must not wait for
+        // the ACK of the previous ones
+        //
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &(int){ 1 }, sizeof(int));
+
+        // Find out when the client goes away, even if nothing is being sent
+        // to it
+        //
+        setsockopt(fd, SOL_SOCKET,  SO_KEEPALIVE,  &(int){ 1 },                    sizeof(int));
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE,  &(int){ ALME_SERVER_KEEPALIVE }, sizeof(int));
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &(int){ 1 },                    sizeof(int));
+        setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT,   &(int){ 3 },                    sizeof(int));
+
+        c->fd   = fd;
+        c->next = alme_connections;
+
+        alme_connections = c;
+        alme_connections_nr++;
+
+        PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *ALME server thread* New connection established from HLE (%d open).\n", alme_connections_nr);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal API: to be used by other platform-specific files (functions
+// declaration is found in "./platform_alme_server_priv.h")
+////////////////////////////////////////////////////////////////////////////////
+
+void *almeServerThread(void *p)
+{
+    int    socketfd;
+    INT8U  queue_id;
+
+    struct sockaddr_in server_addr;
+
+    struct pollfd           fds[2 + ALME_SERVER_MAX_CONNECTIONS];
+    struct _almeConnection *polled[ALME_SERVER_MAX_CONNECTIONS];
+
+    queue_id = ((struct almeServerThreadData *)p)->queue_id;
 
     // Create socket and configure it with "SO_REUSEADDR" (this is needed so
     // that every time we exit the program we don't have to wait for the OS to
@@ -184,141 +900,126 @@ void *almeServerThread(void *p)
      
     // Listen
     //
-    if (-1 == listen(socketfd, 3))
+    if (-1 == listen(socketfd, SOMAXCONN))
     {
         PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *ALME server thread* listen() failed with errno=%d (%s)\n", errno, strerror(errno));
         return NULL;
     }
-     
-    // Accept connections from an incoming clients
+
+    // Nothing this thread waits for can block it: all sockets (and the pipe
+    // used by the AL main thread to tell it that there are new replies to
+    // send) are non-blocking and only used when "poll()" says they are ready
     //
-    while (1)
+    if (-1 == pipe(alme_server_wakeup))
     {
-        struct sockaddr_in client_addr;
-        int addrlen;
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *ALME server thread* pipe() failed with errno=%d (%s)\n", errno, strerror(errno));
+        return NULL;
+    }
+    fcntl(socketfd,              F_SETFL, fcntl(socketfd,              F_GETFL) | O_NONBLOCK);
+    fcntl(alme_server_wakeup[0], F_SETFL, fcntl(alme_server_wakeup[0], F_GETFL) | O_NONBLOCK);
+    fcntl(alme_server_wakeup[1], F_SETFL, fcntl(alme_server_wakeup[1], F_GETFL) | O_NONBLOCK);
 
-        int new_socketfd;
-        int read_size;
-        int total_size;
+    while (1)
+    {
+        struct _almeConnection  *c;
+        struct _almeConnection **pc;
+        INT32U                   fds_nr;
+        INT32U                   i;
 
-        memset(&client_addr, 0, sizeof(client_addr));
-        addrlen = sizeof(client_addr);
-        
-        // Accept an incoming connection
+        // Forward the requests that are already complete (some of them might
+        // have been waiting for the requests in flight to be answered) and get
+        // rid of the connections which are done
         //
-        PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *ALME server thread* Waiting for incoming connections...\n");
-     
-        new_socketfd = accept(socketfd, (struct sockaddr *)&client_addr, (socklen_t*)&addrlen);
-        if (new_socketfd < 0)
+        pc = &alme_connections;
+        while (NULL != (c = *pc))
         {
-            PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] *ALME server thread* accept() failed with errno=%d (%s)\n", errno, strerror(errno));
-            continue;
+            INT8U done;
+
+            _processInput(c, queue_id);
+
+            pthread_mutex_lock(&alme_server_mutex);
+            done = 1 == c->broken || (1 == c->eof && 0 == c->requests_nr && NULL == c->output_first && 0 == _requestReceived(c));
+            pthread_mutex_unlock(&alme_server_mutex);
+
+            if (1 == done)
+            {
+                *pc = c->next;
+                alme_connections_nr--;
+                _closeConnection(c);
+                continue;
+            }
+
+            pc = &c->next;
         }
-        PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *ALME server thread* New connection established from HLE.\n");
-         
-        // Receive a message from client
+
+        // Wait for new connections, requests, room to send replies or new
+        // replies to send
         //
-        total_size = 0;
-        while( (read_size = recv(new_socketfd, alme_message + total_size, ALME_TCP_SERVER_MAX_MESSAGE_SIZE - total_size, 0)) > 0 )
+        fds[0].fd      = socketfd;
+        fds[0].events  = alme_connections_nr < ALME_SERVER_MAX_CONNECTIONS ? POLLIN : 0;
+        fds[1].fd      = alme_server_wakeup[0];
+        fds[1].events  = POLLIN;
+        fds_nr         = 2;
+
+        pthread_mutex_lock(&alme_server_mutex);
+        for (c = alme_connections; NULL != c; c = c->next)
         {
-            // Keep reading until the client closes the connection
-            //
-            total_size += read_size;
+            fds[fds_nr].fd     = c->fd;
+            fds[fds_nr].events = 0;
 
-            if (total_size >= ALME_TCP_SERVER_MAX_MESSAGE_SIZE)
+            if (0 == c->eof && c->requests_nr < ALME_SERVER_MAX_REQUESTS && c->output_len < ALME_SERVER_MAX_OUTPUT)
+            {
+                fds[fds_nr].events |= POLLIN;
+            }
+            if (NULL != c->output_first)
             {
-                // This message is too big. If this is not an error from the
-                // client, then "ALME_TCP_SERVER_MAX_MESSAGE_SIZE" needs to be
-                // increased.
-                //
-                PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] *ALME server thread* Received message is too big.\n");
+                fds[fds_nr].events |= POLLOUT;
+            }
 
-                read_size = -1;
-                break;
+            polled[fds_nr - 2] = c;
+            fds_nr++;
+        }
+        pthread_mutex_unlock(&alme_server_mutex);
+
+        if (-1 == poll(fds, fds_nr, -1))
+        {
+            if (EINTR != errno)
+            {
+                PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *ALME server thread* poll() failed with errno=%d (%s)\n", errno, strerror(errno));
+                return NULL;
             }
+            continue;
         }
-         
-        if(0 == read_size)
+
+        if (0 != (fds[1].revents & POLLIN))
         {
-            // Connection closed, forward ALME message to the AL entity
-            //
-            INT16U  message_len = total_size + 1;
-            INT8U   message_len_msb;
-            INT8U   message_len_lsb;
-
-#if _HOST_IS_LITTLE_ENDIAN_ == 1
-            message_len_msb = *(((INT8U *)&message_len)+1);
-            message_len_lsb = *(((INT8U *)&message_len)+0);
-#else
-            message_len_msb = *(((INT8U *)&message_len)+0);
-            message_len_lsb = *(((INT8U *)&message_len)+1);
-#endif
-
-            queue_message[0] = PLATFORM_QUEUE_EVENT_NEW_ALME_MESSAGE;
-            queue_message[1] = message_len_msb;
-            queue_message[2] = message_len_lsb;
-            queue_message[3] = ALME_CLIENT_ID_TCP_SOCKET;
-
-            PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *ALME server thread* Sending %d bytes to queue (%02x, %02x, %02x, ...)\n", 3+message_len, queue_message[0], queue_message[1], queue_message[2]);
-
-            pthread_mutex_lock(&tcp_server_mutex);
-            tcp_server_flag = 0;
-            pthread_mutex_unlock(&tcp_server_mutex);
-
-            if (0 == sendMessageToAlQueue(((struct almeServerThreadData *)p)->queue_id, queue_message, 3+message_len))
+            INT8U aux[64];
+
+            while (read(alme_server_wakeup[0], aux, sizeof(aux)) > 0);
+        }
+
+        for (i=2; i<fds_nr; i++)
+        {
+            c = polled[i - 2];
+
+            if (0 != (fds[i].revents & POLLIN))
             {
-                PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *ALME server thread* Error sending message to queue from _alme_server_thread()\n");
+                _readFromConnection(c);
             }
-            else
+            else if (0 != (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)))
+            {
+                c->broken = 1;
+            }
+
+            if (0 != (fds[i].revents & POLLOUT))
             {
-                INT32U total_sent;
-
-                // Wait for response
-                //
-                PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *ALME server thread* Waiting for the AL response...\n");
-
-                pthread_mutex_lock(&tcp_server_mutex);
-                while (0 == tcp_server_flag)
-                {
-                    pthread_cond_wait(&tcp_server_cond, &tcp_server_mutex);
-                }
-                pthread_mutex_unlock(&tcp_server_mutex);
-
-                // Once the mutex is unlocked it means the ALME response is
-                // contained in global var "alme_response" (which is
-                // "alme_response_len" bytes long)
-                //
-                PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *ALME server thread* Sending ALME reply to HLE...\n");
-
-                total_sent = 0;
-                if (NULL != alme_response && 0 != alme_response_len)
-                {
-                    do
-                    {
-                        ssize_t sent;
-
-                        sent = send(new_socketfd, alme_response, alme_response_len, MSG_NOSIGNAL);
-
-                        if (-1 == sent)
-                        {
-                            PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *ALME server thread* send() failed with errno=%d (%s)\n", errno, strerror(errno));
-                            break;
-                        }
-
-                        total_sent += sent;
-                    } while (total_sent < alme_response_len);
-
-                    free(alme_response);
-                    alme_response     = NULL;
-                    alme_response_len = 0;
-                }
-                PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *ALME server thread* ALME reply sent (total %d bytes)\n", total_sent);
+                _writeToConnection(c);
             }
-            close(new_socketfd);
         }
-        else if(-1 == read_size)
+
+        if (0 != (fds[0].revents & POLLIN))
         {
-            PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] *ALME server thread* recv() failed.\n");
+            _acceptConnections(socketfd);
         }
     }
      
@@ -376,42 +1077,46 @@ INT8U PLATFORM_SEND_ALME_REPLY(INT8U alme_client_id, INT8U *alme_message, INT16U
 
     switch (alme_client_id)
     {
-        case ALME_CLIENT_ID_TCP_SOCKET:
+        case ALME_CLIENT_ID_1905_VENDOR_SPECIFIC_TUNNEL:
         {
-            // Send the ALME RESPONSE/CONFIRMATION through the same socket where
-            // the REQUEST was originally received
+            // Tunnel the response in a ALME vendor specific message
             //
+            break;
+        }
+
+        default:
+        {
+            // Send the ALME RESPONSE/CONFIRMATION through the same connection
+            // where the REQUEST was originally received
+            //
+            if (alme_client_id < ALME_CLIENT_ID_FIRST_TCP_REQUEST)
+            {
+                break;
+            }
+
             if (0 == alme_message_len || NULL == alme_message)
             {
                 PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Refuse to send an *invalid* ALME reply\n");
-                alme_response     = NULL;
-                alme_response_len = 0;
+                _queueAlmeResponse(alme_client_id, NULL, 0, 1);
             }
             else
             {
-                alme_response = (INT8U *)malloc(alme_message_len);
-                if (NULL == alme_response)
-                {
-                    PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Cannot allocate memory for the ALME RESPONSE/CONFIRMATION message\n");
-
-                    alme_response     = NULL;
-                    alme_response_len = 0;
-                }
-                else
-                {
-                    PLATFORM_MEMCPY(alme_response, alme_message, alme_message_len);
-                    alme_response_len = alme_message_len;
-                }
+                _queueAlmeResponse(alme_client_id, alme_message, alme_message_len, 1);
             }
 
-            pthread_mutex_lock(&tcp_server_mutex);
-            tcp_server_flag = 1;
-            pthread_cond_signal(&tcp_server_cond);
-            pthread_mutex_unlock(&tcp_server_mutex);
-
             break;
         }
+    }
+
+    return 1;
+}
+
+INT8U PLATFORM_SEND_ALME_PARTIAL_REPLY(INT8U alme_client_id, INT8U *alme_message, INT16U alme_message_len)
+{
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Partial ALME reply (%d bytes)\n", alme_message_len);
 
+    switch (alme_client_id)
+    {
         case ALME_CLIENT_ID_1905_VENDOR_SPECIFIC_TUNNEL:
         {
             // Tunnel the response in a ALME vendor specific message
@@ -421,9 +1126,49 @@ INT8U PLATFORM_SEND_ALME_REPLY(INT8U alme_client_id, INT8U *alme_message, INT16U
 
         default:
         {
+            // The message is sent right away through the same connection where
+            // the REQUEST was originally received (but the reply is not
+            // terminated until "PLATFORM_SEND_ALME_REPLY()" is called)
+            //
+            if (alme_client_id < ALME_CLIENT_ID_FIRST_TCP_REQUEST)
+            {
+                break;
+            }
+
+            if (0 == alme_message_len || NULL == alme_message)
+            {
+                PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Refuse to send an *invalid* ALME reply\n");
+                return 0;
+            }
+
+            _queueAlmeResponse(alme_client_id, alme_message, alme_message_len, 0);
+
             break;
         }
     }
 
     return 1;
 }
+
+INT8U PLATFORM_SEND_ALME_EVENT(INT8U alme_client_id, INT8U *alme_message, INT16U alme_message_len)
+{
+    switch (alme_client_id)
+    {
+        case ALME_CLIENT_ID_1905_VENDOR_SPECIFIC_TUNNEL:
+        {
+            // Events are not tunneled
+            //
+            return 0;
+        }
+
+        default:
+        {
+            if (alme_client_id < ALME_CLIENT_ID_FIRST_TCP_REQUEST)
+            {
+                return 0;
+            }
+
+            return _queueAlmeEvent(alme_client_id, alme_message, alme_message_len);
+        }
+    }
+}
@@ -55,6 +55,8 @@
  *  DAMAGE.
  */
 
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_WSC
+
 #include "platform.h"
 
 #include "openssl/dh.h"   // Diffie Hellman stuff
@@ -166,11 +168,11 @@ INT8U PLATFORM_GENERATE_DH_KEY_PAIR(INT8U **priv, INT16U *priv_len, INT8U **pub,
     }
 
     *priv_len = BN_num_bytes(dh->priv_key);
-    *priv     = (INT8U *)malloc(*priv_len);
+    *priv     = (INT8U *)PLATFORM_MALLOC(*priv_len);
     BN_bn2bin(dh->priv_key, *priv);
 
     *pub_len = BN_num_bytes(dh->pub_key);
-    *pub     = (INT8U *)malloc(*pub_len);
+    *pub     = (INT8U *)PLATFORM_MALLOC(*pub_len);
     BN_bn2bin(dh->pub_key, *pub);
 
     DH_free(dh);
@@ -231,7 +233,7 @@ INT8U PLATFORM_COMPUTE_DH_SHARED_SECRET(INT8U **shared_secret, INT16U *shared_se
     // Allocate output buffer
     //
     rlen            = DH_size(dh);
-    *shared_secret  = (INT8U*)malloc(rlen);
+    *shared_secret  = (INT8U*)PLATFORM_MALLOC(rlen);
 
     // Compute the shared secret and save it in the output buffer
     //
@@ -239,7 +241,7 @@ INT8U PLATFORM_COMPUTE_DH_SHARED_SECRET(INT8U **shared_secret, INT16U *shared_se
     if (keylen < 0)
     {
         *shared_secret_len = 0;
-        free(*shared_secret);
+        PLATFORM_FREE(*shared_secret);
         *shared_secret = NULL;
         BN_clear_free(pub_key);
         DH_free(dh);
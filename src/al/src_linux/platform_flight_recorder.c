@@ -0,0 +1,569 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#include "platform.h"
+#include "platform_os.h"                        // PLATFORM_RECORD_FRAME()
+#include "platform_flight_recorder_priv.h"
+
+#include <stdio.h>       // snprintf()
+#include <stdlib.h>      // malloc()
+#include <string.h>      // memcpy(), strcmp()
+#include <errno.h>       // errno
+#include <fcntl.h>       // open()
+#include <unistd.h>      // write(), close()
+#include <signal.h>      // sigaction(), sigaltstack(), raise()
+#include <time.h>        // clock_gettime()
+#include <pthread.h>     // mutexes
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Private data and functions
+////////////////////////////////////////////////////////////////////////////////
+
+// Number of frames kept when "flightRecorderStart()" is called with
+// 'frames_nr' set to "0"
+//
+#define FLIGHT_RECORDER_DEFAULT_FRAMES  (1024)
+
+// Frames longer than this are truncated (1905 and LLDP frames never are)
+//
+#define FLIGHT_RECORDER_SNAPLEN         (MAX_NETWORK_SEGMENT_SIZE)
+
+// Maximum number of different interface names. Frames from interfaces that
+// don't fit are attributed to the last one.
+//
+#define FLIGHT_RECORDER_MAX_INTERFACES  (32)
+#define FLIGHT_RECORDER_MAX_NAME_LEN    (64)
+
+// Longest annotation written to the pcapng file
+//
+#define FLIGHT_RECORDER_MAX_ANNOTATION  (128)
+
+// Each frame is copied into one of these slots, which are all allocated (and
+// touched) when the flight recorder is started so that recording a frame
+// never allocates memory nor page faults.
+//
+struct _recordedFrame
+{
+    volatile INT32U  sequence;         // Number of the frame stored in this
+                                       // slot plus one, or "0" while it is
+                                       // being written
+
+    INT32U           ts_sec;
+    INT32U           ts_usec;
+
+    INT8U            direction;        // PLATFORM_FRAME_RECEIVED or
+                                       // PLATFORM_FRAME_TRANSMITTED
+    INT8U            interface_index;  // Position in 'recorder_interfaces'
+    INT16U           frame_len;        // Bytes stored in 'frame'...
+    INT32U           original_len;     // ...out of these
+
+    char            *annotation;
+
+    INT8U            frame[FLIGHT_RECORDER_SNAPLEN];
+};
+
+// The ring itself. Its size is a power of two so that the slot of frame 'n' is
+// always "n & (recorder_slots_nr-1)", even when 'recorder_next' wraps around.
+//
+// Writers claim a frame number with an atomic increment (frames are recorded
+// from several threads) and readers (which can be signal handlers) skip any
+// slot whose 'sequence' does not match the frame they expect, instead of
+// waiting for it: nothing here ever blocks.
+//
+static struct _recordedFrame *recorder_slots    = NULL;
+static INT32U                 recorder_slots_nr = 0;
+static INT32U                 recorder_next     = 0;
+
+// Names of the interfaces seen so far (the pcapng "interface description"
+// blocks). New names are appended (under the mutex) and only then made visible
+// by incrementing the counter, thus they can be read without taking it.
+//
+static pthread_mutex_t  recorder_interfaces_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char             recorder_interfaces[FLIGHT_RECORDER_MAX_INTERFACES][FLIGHT_RECORDER_MAX_NAME_LEN];
+static volatile INT32U  recorder_interfaces_nr    = 0;
+
+// Where dumps are saved. They are first written to the "tmp" file and then
+// renamed, so that a previous dump is only replaced by a complete one.
+//
+static char            *recorder_filename         = NULL;
+static char            *recorder_tmp_filename     = NULL;
+
+// Set while a dump is in progress, so that a signal arriving in the middle of
+// one does not start another one on top of it.
+//
+static INT32U           recorder_dumping          = 0;
+
+// Return the position of 'interface_name' in 'recorder_interfaces', adding it
+// if needed.
+//
+static INT8U _interfaceIndex(char *interface_name)
+{
+    INT32U i;
+
+    if (NULL == interface_name)
+    {
+        interface_name = "unknown";
+    }
+
+    for (i=0; i<recorder_interfaces_nr; i++)
+    {
+        if (0 == strcmp(recorder_interfaces[i], interface_name))
+        {
+            return i;
+        }
+    }
+
+    // First frame on this interface
+    //
+    pthread_mutex_lock(&recorder_interfaces_mutex);
+    for (i=0; i<recorder_interfaces_nr; i++)
+    {
+        if (0 == strcmp(recorder_interfaces[i], interface_name))
+        {
+            break;
+        }
+    }
+    if (i == recorder_interfaces_nr)
+    {
+        if (FLIGHT_RECORDER_MAX_INTERFACES == i)
+        {
+            i--;
+        }
+        else
+        {
+            snprintf(recorder_interfaces[i], FLIGHT_RECORDER_MAX_NAME_LEN, "%s", interface_name);
+            __sync_synchronize();
+            recorder_interfaces_nr = i + 1;
+        }
+    }
+    pthread_mutex_unlock(&recorder_interfaces_mutex);
+
+    return i;
+}
+
+// Helpers to build pcapng blocks (in host byte order, which is allowed by the
+// format: readers look at the "byte order magic" of the section header)
+//
+static void _put16(INT8U *buffer, INT32U *i, INT16U value)
+{
+    memcpy(&buffer[*i], &value, 2);
+    *i += 2;
+}
+static void _put32(INT8U *buffer, INT32U *i, INT32U value)
+{
+    memcpy(&buffer[*i], &value, 4);
+    *i += 4;
+}
+static void _putBytes(INT8U *buffer, INT32U *i, void *bytes, INT32U len)
+{
+    memcpy(&buffer[*i], bytes, len);
+    *i += len;
+
+    while (0 != (*i % 4))
+    {
+        buffer[(*i)++] = 0x0;
+    }
+}
+static void _putOption(INT8U *buffer, INT32U *i, INT16U code, void *value, INT16U len)
+{
+    _put16(buffer, i, code);
+    _put16(buffer, i, len);
+    _putBytes(buffer, i, value, len);
+}
+
+// Finish the block that starts at 'buffer' ('*i' bytes long so far, its
+// options included), filling its "total length" fields, and write it to 'fd'.
+//
+// Only async-signal-safe functions are used, as this can be called from a
+// signal handler.
+//
+static INT8U _writeBlock(int fd, INT8U *buffer, INT32U *i)
+{
+    INT32U  written;
+    ssize_t ret;
+
+    _put16(buffer, i, 0);   // opt_endofopt
+    _put16(buffer, i, 0);
+    _put32(buffer, i, *i + 4);
+    memcpy(&buffer[4], i, 4);
+
+    written = 0;
+    while (written < *i)
+    {
+        ret = write(fd, buffer + written, *i - written);
+        if (ret <= 0)
+        {
+            if (-1 == ret && EINTR == errno)
+            {
+                continue;
+            }
+            return 0;
+        }
+        written += ret;
+    }
+
+    return 1;
+}
+
+// Write the contents of the ring to 'recorder_filename' and return the number
+// of frames in 'frames_nr'.
+//
+// Only async-signal-safe functions are used, as this is also called from
+// signal handlers (in particular, nothing is allocated and nothing is
+// logged).
+//
+// If there is a problem this function returns "0", otherwise it returns "1"
+//
+static INT8U _dump(INT32U *frames_nr)
+{
+    INT8U                  block[64 + FLIGHT_RECORDER_SNAPLEN + FLIGHT_RECORDER_MAX_NAME_LEN + FLIGHT_RECORDER_MAX_ANNOTATION];
+    struct _recordedFrame  copy;
+    struct _recordedFrame *s;
+    INT32U                 interfaces_nr;
+    INT32U                 first, last, n;
+    INT32U                 i, len;
+    int                    fd;
+
+    static char user_application[] = "IEEE1905 AL entity flight recorder";
+
+    *frames_nr = 0;
+
+    if (0 == recorder_slots_nr || 0 != __sync_lock_test_and_set(&recorder_dumping, 1))
+    {
+        return 0;
+    }
+
+    if (-1 == (fd = open(recorder_tmp_filename, O_WRONLY | O_CREAT | O_TRUNC, 0600)))
+    {
+        __sync_lock_release(&recorder_dumping);
+        return 0;
+    }
+
+    // Section header block
+    //
+    i = 0;
+    _put32(block, &i, 0x0A0D0D0A);
+    _put32(block, &i, 0);           // Total length (filled later)
+    _put32(block, &i, 0x1A2B3C4D);  // Byte order magic
+    _put16(block, &i, 1);           // Version 1.0
+    _put16(block, &i, 0);
+    _put32(block, &i, 0xFFFFFFFF);  // Section length: unknown
+    _put32(block, &i, 0xFFFFFFFF);
+    _putOption(block, &i, 4, user_application, sizeof(user_application) - 1);  // shb_userappl
+    if (0 == _writeBlock(fd, block, &i))
+    {
+        goto error;
+    }
+
+    // One interface description block per interface name. Frames from
+    // interfaces added after this point are not written (they reference an
+    // interface which does not exist in the file).
+    //
+    interfaces_nr = recorder_interfaces_nr;
+    for (n=0; n<interfaces_nr; n++)
+    {
+        i = 0;
+        _put32(block, &i, 0x00000001);
+        _put32(block, &i, 0);
+        _put16(block, &i, 1);       // LINKTYPE_ETHERNET
+        _put16(block, &i, 0);
+        _put32(block, &i, FLIGHT_RECORDER_SNAPLEN);
+        _putOption(block, &i, 2, recorder_interfaces[n], strlen(recorder_interfaces[n]));  // if_name
+        if (0 == _writeBlock(fd, block, &i))
+        {
+            goto error;
+        }
+    }
+
+    // One enhanced packet block per frame, oldest first
+    //
+    last  = recorder_next;
+    first = last < recorder_slots_nr ? 0 : last - recorder_slots_nr;
+
+    for (n=first; n!=last; n++)
+    {
+        unsigned long long timestamp;
+        INT32U             flags;
+
+        s = &recorder_slots[n & (recorder_slots_nr - 1)];
+
+        // Take a copy, and make sure the slot was not being written (or
+        // overwritten by a newer frame) while doing so
+        //
+        if (n + 1 != s->sequence)
+        {
+            continue;
+        }
+        memcpy(&copy, (void *)s, sizeof(copy));
+        __sync_synchronize();
+        if (n + 1 != s->sequence || copy.interface_index >= interfaces_nr)
+        {
+            continue;
+        }
+
+        timestamp = (unsigned long long)copy.ts_sec * 1000000 + copy.ts_usec;
+        flags     = PLATFORM_FRAME_RECEIVED == copy.direction ? 0x1 : 0x2;  // Inbound/outbound
+
+        i = 0;
+        _put32(block, &i, 0x00000006);
+        _put32(block, &i, 0);
+        _put32(block, &i, copy.interface_index);
+        _put32(block, &i, (INT32U)(timestamp >> 32));
+        _put32(block, &i, (INT32U)(timestamp & 0xFFFFFFFF));
+        _put32(block, &i, copy.frame_len);
+        _put32(block, &i, copy.original_len);
+        _putBytes(block, &i, copy.frame, copy.frame_len);
+        _putOption(block, &i, 2, &flags, 4);  // epb_flags
+        if (NULL != copy.annotation)
+        {
+            len = strlen(copy.annotation);
+            _putOption(block, &i, 1, copy.annotation, len > FLIGHT_RECORDER_MAX_ANNOTATION ? FLIGHT_RECORDER_MAX_ANNOTATION : len);  // opt_comment
+        }
+        if (0 == _writeBlock(fd, block, &i))
+        {
+            goto error;
+        }
+
+        (*frames_nr)++;
+    }
+
+    close(fd);
+
+    if (0 != rename(recorder_tmp_filename, recorder_filename))
+    {
+        __sync_lock_release(&recorder_dumping);
+        return 0;
+    }
+
+    __sync_lock_release(&recorder_dumping);
+    return 1;
+
+error:
+    close(fd);
+    __sync_lock_release(&recorder_dumping);
+    return 0;
+}
+
+// SIGUSR1 saves the flight recorder contents without disturbing the AL entity
+//
+static void _dumpSignalHandler(int signum)
+{
+    INT32U frames_nr;
+    int    saved_errno;
+
+    saved_errno = errno;
+    _dump(&frames_nr);
+    errno = saved_errno;
+}
+
+// Fatal signals save the flight recorder contents and then let the process
+// die as it would have done without this handler (which is installed with
+// SA_RESETHAND, thus the signal raised again here is delivered with its
+// default action as soon as the handler returns).
+//
+static void _crashSignalHandler(int signum)
+{
+    INT32U frames_nr;
+
+    _dump(&frames_nr);
+    raise(signum);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal API: to be used by other platform-specific files (functions
+// declaration is found in "./platform_flight_recorder_priv.h")
+////////////////////////////////////////////////////////////////////////////////
+
+void flightRecorderStart(char *filename, INT32U frames_nr)
+{
+    static int fatal_signals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+
+    struct sigaction  sa;
+    stack_t           ss;
+    INT32U            slots_nr;
+    INT32U            i;
+
+    if (NULL == filename)
+    {
+        return;
+    }
+
+    if (0 == frames_nr)
+    {
+        frames_nr = FLIGHT_RECORDER_DEFAULT_FRAMES;
+    }
+
+    slots_nr = 1;
+    while (slots_nr < frames_nr && slots_nr < 0x80000000)
+    {
+        slots_nr <<= 1;
+    }
+
+    // "memset()" (instead of "calloc()") so that all pages are really mapped
+    // now and not the first time a frame is copied into them
+    //
+    if (NULL == (recorder_slots = (struct _recordedFrame *)malloc(sizeof(struct _recordedFrame) * slots_nr)))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Not enough memory for a flight recorder of %d frames\n", slots_nr);
+        return;
+    }
+    memset(recorder_slots, 0, sizeof(struct _recordedFrame) * slots_nr);
+
+    recorder_filename     = filename;
+    recorder_tmp_filename = (char *)malloc(strlen(filename) + 5);
+    sprintf(recorder_tmp_filename, "%s.tmp", filename);
+
+    // Signal handlers run on their own stack, so that the contents of the
+    // ring can be saved even when the crash is a stack overflow (of the main
+    // thread, which is the one that installs it)
+    //
+    ss.ss_size  = 64 * 1024;
+    ss.ss_flags = 0;
+    ss.ss_sp    = malloc(ss.ss_size);
+    if (NULL == ss.ss_sp || 0 != sigaltstack(&ss, NULL))
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] Could not set an alternate signal stack. Stack overflows won't be recorded\n");
+    }
+
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_handler = _dumpSignalHandler;
+    sa.sa_flags   = SA_RESTART | SA_ONSTACK;
+    if (0 != sigaction(SIGUSR1, &sa, NULL))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] sigaction(SIGUSR1) returned with errno=%d (%s)\n", errno, strerror(errno));
+    }
+
+    sa.sa_handler = _crashSignalHandler;
+    sa.sa_flags   = SA_RESETHAND | SA_ONSTACK;
+    for (i=0; i<sizeof(fatal_signals)/sizeof(fatal_signals[0]); i++)
+    {
+        if (0 != sigaction(fatal_signals[i], &sa, NULL))
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] sigaction(%d) returned with errno=%d (%s)\n", fatal_signals[i], errno, strerror(errno));
+        }
+    }
+
+    // Publish the ring only once everything else is ready
+    //
+    recorder_slots_nr = slots_nr;
+    __sync_synchronize();
+
+    PLATFORM_PRINTF_DEBUG_INFO("[PLATFORM] Flight recorder enabled: last %d frames (%d KB), saved to '%s'\n", slots_nr, (int)((sizeof(struct _recordedFrame) * slots_nr) / 1024), filename);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Platform API: interface related functions to be used by platform-independent
+// files (functions declarations are  found in "../interfaces/platform_os.h)
+////////////////////////////////////////////////////////////////////////////////
+
+void PLATFORM_RECORD_FRAME(INT8U direction, char *interface_name, INT8U *header, INT8U *payload, INT16U payload_len, char *annotation)
+{
+    struct _recordedFrame *s;
+    struct timespec        now;
+    INT32U                 n;
+    INT32U                 len;
+
+    if (0 == recorder_slots_nr)
+    {
+        return;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    len = payload_len;
+    if (len > FLIGHT_RECORDER_SNAPLEN - 14)
+    {
+        len = FLIGHT_RECORDER_SNAPLEN - 14;
+    }
+
+    n = __sync_fetch_and_add(&recorder_next, 1);
+    s = &recorder_slots[n & (recorder_slots_nr - 1)];
+
+    s->sequence = 0;
+    __sync_synchronize();
+
+    s->ts_sec          = now.tv_sec;
+    s->ts_usec         = now.tv_nsec / 1000;
+    s->direction       = direction;
+    s->interface_index = _interfaceIndex(interface_name);
+    s->frame_len       = 14 + len;
+    s->original_len    = 14 + payload_len;
+    s->annotation      = annotation;
+
+    memcpy(s->frame,      header,  14);
+    memcpy(s->frame + 14, payload, len);
+
+    __sync_synchronize();
+    s->sequence = n + 1;
+}
+
+INT8U PLATFORM_DUMP_FLIGHT_RECORDER(char **destination, INT32U *frames_nr)
+{
+    *destination = recorder_filename;
+    *frames_nr   = 0;
+
+    if (NULL == recorder_filename)
+    {
+        return 0;
+    }
+
+    return _dump(frames_nr);
+}
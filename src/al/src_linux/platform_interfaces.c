@@ -60,6 +60,8 @@
 #include "platform_interfaces_priv.h"
 #include "platform_os.h"
 #include "platform_os_priv.h"
+#include "platform_netlink_priv.h"
+#include "platform_nl80211_priv.h"
 
 #ifdef _FLAVOUR_ARM_WRT1900ACX_
 #include "platform_interfaces_wrt1900acx_priv.h"
@@ -79,6 +81,7 @@
 #include <netinet/ether.h>    // ETH_P_ALL, ETH_A_LEN 
 #include <unistd.h>           // close()
 #include <pthread.h>          // pthread_create(), mutex functions
+#include <sys/socket.h>       // sendmmsg()
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -132,14 +135,94 @@ struct _stubTable
 
 } stub_table[STUB_TYPE_MAX+1] = {[0 ... STUB_TYPE_MAX] = {0, NULL}};
 
+// Cache used by "PLATFORM_GET_1905_INTERFACE_INFO_CACHED()".
+//
+// There is one entry for each interface in "interfaces_list" (same index).
+// Each entry keeps the last retrieved info and, in order for borrowed pointers
+// to survive one refresh, the info it replaced (which is freed on the next
+// refresh).
+//
+// Entries are refreshed when they have been invalidated or when they are older
+// than "INTERFACE_INFO_CACHE_TTL" milliseconds (a value of "0" disables the
+// cache).
+//
+// Only the AL main thread accesses this cache, thus no mutex is needed.
+//
+#ifndef INTERFACE_INFO_CACHE_TTL
+#  define INTERFACE_INFO_CACHE_TTL  (10000)
+#endif
+
+struct _interfaceInfoCacheEntry
+{
+    INT8U                  initialized;  // Set once 'info' has been retrieved
+    INT8U                  valid;
+    INT32U                 timestamp;
+    struct interfaceInfo  *info;
+    struct interfaceInfo  *previous;
+};
+
+static int                              interface_info_cache_nr = 0;
+static struct _interfaceInfoCacheEntry *interface_info_cache    = NULL;
+
+// Incremented each time a refreshed entry turns out to be different from the
+// one it replaces (see "PLATFORM_GET_1905_INTERFACE_INFO_GENERATION()")
+//
+static INT32U                           interface_info_generation = 0;
+
+// Link metrics are not obtained on demand (which, depending on the interface
+// type and on the number of neighbors, can take a long time) but periodically
+// refreshed, every "LINK_METRICS_SAMPLING_PERIOD" milliseconds, by a sampler
+// thread into a double buffered cache: the sampler fills the "back" buffer and
+// then swaps it with the "front" one, which is the only one readers look at.
+//
+// The set of sampled links is made of those that have been asked for at least
+// once in the last "LINK_METRICS_SAMPLER_MAX_IDLE" milliseconds (the first
+// request of a link is served synchronously).
+// Neighbors typically ask for metrics once per discovery cycle (every 60
+// seconds), thus the default value covers two and a half of them: a link is
+// only dropped after nobody has asked for it during two whole cycles.
+//
+// A "LINK_METRICS_SAMPLING_PERIOD" of "0" disables the sampler (metrics are
+// then always obtained on demand).
+//
+#ifndef LINK_METRICS_SAMPLING_PERIOD
+#  define LINK_METRICS_SAMPLING_PERIOD  (1000)
+#endif
+
+#ifndef LINK_METRICS_SAMPLER_MAX_IDLE
+#  define LINK_METRICS_SAMPLER_MAX_IDLE  (150000)
+#endif
+
+struct _sampledLink
+{
+    char                *interface_name;
+    INT32U               last_request;
+    struct linkMetrics   metrics;
+};
+
+struct _sampledLinks
+{
+    int                   nr;
+    struct _sampledLink  *links;
+};
+
+static pthread_mutex_t       link_metrics_mutex   = PTHREAD_MUTEX_INITIALIZER;
+static INT8U                 link_metrics_sampler = 0;
+static struct _sampledLinks  link_metrics_buffers[2];
+static INT8U                 link_metrics_front   = 0;
+
 // Given an 'interface_name' and a context ('stub_type') this function executes
 // the pre-registered handler associated to that 'interface_name' and 'context'.
 //
 // Return '1' if the handler was executed correctly, '0' otherwise
 //
-INT8U _executeInterfaceStub(char *interface_name, INT8U stub_type, ...)
+// Return the handler registered for stub type 'stub_type' of the type of
+// interface 'interface_name' (and, in 'extended_params', the "extended
+// parameters" string of that interface) or NULL if there is none (which is
+// always the case for "regular" interfaces)
+//
+static void *_findInterfaceStub(char *interface_name, INT8U stub_type, char **extended_params)
 {
-    va_list   args;
     void     *f;
     INT8U     i, j;
 
@@ -148,7 +231,7 @@ INT8U _executeInterfaceStub(char *interface_name, INT8U stub_type, ...)
     if (stub_type > STUB_TYPE_MAX)
     {
         PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Invalid stub type %d\n", stub_type);
-        return 0;
+        return NULL;
     }
 
     // Search for the "extended parameters" string associated to this interface
@@ -164,6 +247,7 @@ INT8U _executeInterfaceStub(char *interface_name, INT8U stub_type, ...)
     if (i == interfaces_nr)
     {
         PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] Non existing interface %s\n", interface_name);
+        return NULL;
     }
     if (NULL == interfaces_list_extended_params[i])
     {
@@ -172,7 +256,7 @@ INT8U _executeInterfaceStub(char *interface_name, INT8U stub_type, ...)
         // one.
         //
         PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] This is a 'regular' interface. Skipping stubs...\n");
-        return 0;
+        return NULL;
     }
 
     // The "beginning" of the "extended parameters" string contains the
@@ -194,9 +278,30 @@ INT8U _executeInterfaceStub(char *interface_name, INT8U stub_type, ...)
     }
     if (NULL == f)
     {
-        // No interface handler found
+        // No interface handler found (which is fine for the optional stub
+        // types)
         //
-        PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] No stub handler found!\n");
+        if (stub_type <= STUB_TYPE_PUSH_BUTTON_START)
+        {
+            PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] No stub handler found!\n");
+        }
+        return NULL;
+    }
+
+    *extended_params = interfaces_list_extended_params[i];
+
+    return f;
+}
+
+INT8U _executeInterfaceStub(char *interface_name, INT8U stub_type, ...)
+{
+    va_list   args;
+    void     *f;
+    char     *extended_params;
+
+    f = _findInterfaceStub(interface_name, stub_type, &extended_params);
+    if (NULL == f)
+    {
         return 0;
     }
 
@@ -213,7 +318,7 @@ INT8U _executeInterfaceStub(char *interface_name, INT8U stub_type, ...)
 
             m = va_arg(args, struct interfaceInfo *);
             
-            ((void (*)(char *, char*, struct interfaceInfo *))f)(interface_name, interfaces_list_extended_params[i], m);
+            ((void (*)(char *, char*, struct interfaceInfo *))f)(interface_name, extended_params, m);
 
             break;
         }
@@ -223,13 +328,43 @@ INT8U _executeInterfaceStub(char *interface_name, INT8U stub_type, ...)
 
             m = va_arg(args, struct linkMetrics *);
             
-            ((void (*)(char *, char*, struct linkMetrics *))f)(interface_name, interfaces_list_extended_params[i], m);
+            ((void (*)(char *, char*, struct linkMetrics *))f)(interface_name, extended_params, m);
 
             break;
         }
         case STUB_TYPE_PUSH_BUTTON_START:
         {
-            ((void (*)(char *, char*))f)(interface_name, interfaces_list_extended_params[i]);
+            ((void (*)(char *, char*))f)(interface_name, extended_params);
+            break;
+        }
+        case STUB_TYPE_SEND_FRAME:
+        {
+            INT8U  *frame;
+            INT16U  frame_len;
+            INT8U  *result;
+
+            frame     = va_arg(args, INT8U *);
+            frame_len = (INT16U)va_arg(args, int);
+            result    = va_arg(args, INT8U *);
+
+            *result = ((INT8U (*)(char *, char*, INT8U *, INT16U))f)(interface_name, extended_params, frame, frame_len);
+
+            break;
+        }
+        case STUB_TYPE_CAPTURE_START:
+        {
+            INT8U   queue_id;
+            INT8U  *interface_mac_address;
+            INT8U  *al_mac_address;
+            INT8U  *result;
+
+            queue_id              = (INT8U)va_arg(args, int);
+            interface_mac_address = va_arg(args, INT8U *);
+            al_mac_address        = va_arg(args, INT8U *);
+            result                = va_arg(args, INT8U *);
+
+            *result = ((INT8U (*)(char *, char*, INT8U, INT8U *, INT8U *))f)(interface_name, extended_params, queue_id, interface_mac_address, al_mac_address);
+
             break;
         }
     }
@@ -568,76 +703,233 @@ static INT32S _readInterfaceParameter(char *interface_name, char *parameter_name
     return ret;
 }
 
-// Returns an INT32S obtained by reading the output of
-// "iw dev $INTERFACE station get $MAC | grep $PARAMETER_NAME"
+// Return '1' if the contents of 'a' and 'b' differ (any of them can be NULL),
+// '0' otherwise. The 'name' field is not compared.
 //
-static INT32S _readWifiNeighborParameter(char *interface_name, INT8U *neighbor_interface_address, char *parameter_name)
+static INT8U _interfaceInfoChanged(struct interfaceInfo *a, struct interfaceInfo *b)
 {
-    INT32S   ret;
-    FILE    *pipe;
-    char    *line;
-    size_t   len;
-
-    char     command[200];
+    INT8U i;
 
-    ret = 0;
+    if (NULL == a || NULL == b)
+    {
+        return a != b;
+    }
 
-    if ((NULL == interface_name) || (NULL == neighbor_interface_address) || (NULL == parameter_name))
+    if (
+         0 != memcmp(a->mac_address,       b->mac_address,       6)                       ||
+         0 != strncmp(a->manufacturer_name, b->manufacturer_name, sizeof(a->manufacturer_name)) ||
+         0 != strncmp(a->model_name,        b->model_name,        sizeof(a->model_name))        ||
+         0 != strncmp(a->model_number,      b->model_number,      sizeof(a->model_number))      ||
+         0 != strncmp(a->serial_number,     b->serial_number,     sizeof(a->serial_number))     ||
+         0 != strncmp(a->device_name,       b->device_name,       sizeof(a->device_name))       ||
+         0 != strncmp(a->uuid,              b->uuid,              sizeof(a->uuid))              ||
+         a->interface_type       != b->interface_type                                     ||
+         a->is_secured           != b->is_secured                                         ||
+         a->push_button_on_going != b->push_button_on_going                               ||
+         0 != memcmp(a->push_button_new_mac_address, b->push_button_new_mac_address, 6)   ||
+         a->power_state          != b->power_state                                        ||
+         a->neighbor_mac_addresses_nr   != b->neighbor_mac_addresses_nr                   ||
+         a->ipv4_nr                     != b->ipv4_nr                                     ||
+         a->ipv6_nr                     != b->ipv6_nr                                     ||
+         a->vendor_specific_elements_nr != b->vendor_specific_elements_nr
+       )
     {
-        return 0;
+        return 1;
     }
 
-    sprintf(command, "iw dev %s station get %02x:%02x:%02x:%02x:%02x:%02x | grep %s",
-            interface_name,
-            neighbor_interface_address[0], neighbor_interface_address[1], neighbor_interface_address[2],
-            neighbor_interface_address[3], neighbor_interface_address[4], neighbor_interface_address[5],
-            parameter_name);
+    if (INTERFACE_TYPE_IEEE_802_11B_2_4_GHZ == a->interface_type ||
+        INTERFACE_TYPE_IEEE_802_11G_2_4_GHZ == a->interface_type ||
+        INTERFACE_TYPE_IEEE_802_11A_5_GHZ   == a->interface_type ||
+        INTERFACE_TYPE_IEEE_802_11N_2_4_GHZ == a->interface_type ||
+        INTERFACE_TYPE_IEEE_802_11N_5_GHZ   == a->interface_type ||
+        INTERFACE_TYPE_IEEE_802_11AC_5_GHZ  == a->interface_type ||
+        INTERFACE_TYPE_IEEE_802_11AD_60_GHZ == a->interface_type ||
+        INTERFACE_TYPE_IEEE_802_11AF_GHZ    == a->interface_type)
+    {
+        struct _ieee80211Data *x, *y;
 
-    // Execute the IW query command
-    //
-    pipe = popen(command, "r");
+        x = &a->interface_type_data.ieee80211;
+        y = &b->interface_type_data.ieee80211;
 
-    if (!pipe)
+        if (
+             0 != memcmp(x->bssid, y->bssid, 6)                              ||
+             0 != strncmp(x->ssid, y->ssid, sizeof(x->ssid))                 ||
+             x->role                                != y->role                                ||
+             x->ap_channel_band                     != y->ap_channel_band                     ||
+             x->ap_channel_center_frequency_index_1 != y->ap_channel_center_frequency_index_1 ||
+             x->ap_channel_center_frequency_index_2 != y->ap_channel_center_frequency_index_2 ||
+             x->authentication_mode                 != y->authentication_mode                 ||
+             x->encryption_mode                     != y->encryption_mode                     ||
+             0 != strncmp(x->network_key, y->network_key, sizeof(x->network_key))
+           )
+        {
+            return 1;
+        }
+    }
+    else if (INTERFACE_TYPE_IEEE_1901_WAVELET == a->interface_type ||
+             INTERFACE_TYPE_IEEE_1901_FFT     == a->interface_type)
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] popen() returned with errno=%d (%s)\n", errno, strerror(errno));
-        return 0;
+        if (0 != memcmp(a->interface_type_data.ieee1901.network_identifier, b->interface_type_data.ieee1901.network_identifier, sizeof(a->interface_type_data.ieee1901.network_identifier)))
+        {
+            return 1;
+        }
     }
-
-    // Next read the parameter
-    //
-    line = NULL;
-    if (-1 != getline(&line, &len, pipe))
+    else if (INTERFACE_TYPE_UNKNOWN == a->interface_type)
     {
-        char    *value;
+        struct genericInterfaceType *x, *y;
 
-        // Remove the last "\n"
-        //
-        line[strlen(line)-1] = 0x00;
+        x = &a->interface_type_data.other;
+        y = &b->interface_type_data.other;
+
+        if (
+             0 != memcmp(x->oui, y->oui, 3)  ||
+             x->variant_index != y->variant_index ||
+             (NULL == x->generic_phy_description_xml_url) != (NULL == y->generic_phy_description_xml_url) ||
+             (NULL != x->generic_phy_description_xml_url && 0 != strcmp(x->generic_phy_description_xml_url, y->generic_phy_description_xml_url)) ||
+             (NULL == x->variant_name) != (NULL == y->variant_name) ||
+             (NULL != x->variant_name && 0 != strcmp(x->variant_name, y->variant_name))
+           )
+        {
+            return 1;
+        }
 
-        value = strstr(line, ":");
-        if ((NULL != value) && (1 == sscanf(value+1, "%d", &ret)))
+        // The media specific data is either an ITU G.hn blob or an array of
+        // bytes (see "PLATFORM_FREE_1905_INTERFACE_INFO()")
+        //
+        if (
+             x->oui[0] == 0x00  &&
+             x->oui[1] == 0x19  &&
+             x->oui[2] == 0xA7  &&
+             NULL != x->generic_phy_description_xml_url &&
+             0 == strcmp("http://handle.itu.int/11.1002/3000/1706", x->generic_phy_description_xml_url) &&
+             (x->variant_index == 1 || x->variant_index == 2 || x->variant_index == 3 || x->variant_index == 4)
+           )
         {
-             PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Neighbor %02x:%02x:%02x:%02x:%02x:%02x (%s) %d = %d\n",
-                 neighbor_interface_address[0], neighbor_interface_address[1], neighbor_interface_address[2],
-                 neighbor_interface_address[3], neighbor_interface_address[4], neighbor_interface_address[5],
-                 interface_name, parameter_name, ret);
+            if (0 != memcmp(x->media_specific.ituGhn.dni, y->media_specific.ituGhn.dni, 2))
+            {
+                return 1;
+            }
         }
         else
         {
-             PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Parameter not found\n");
+            if (
+                 x->media_specific.unsupported.bytes_nr != y->media_specific.unsupported.bytes_nr ||
+                 (
+                   0    != x->media_specific.unsupported.bytes_nr &&
+                   NULL != x->media_specific.unsupported.bytes    &&
+                   NULL != y->media_specific.unsupported.bytes    &&
+                   0    != memcmp(x->media_specific.unsupported.bytes, y->media_specific.unsupported.bytes, x->media_specific.unsupported.bytes_nr)
+                 )
+               )
+            {
+                return 1;
+            }
+        }
+    }
+
+    if (
+         INTERFACE_NEIGHBORS_UNKNOWN != a->neighbor_mac_addresses_nr &&
+         0 != a->neighbor_mac_addresses_nr                           &&
+         0 != memcmp(a->neighbor_mac_addresses, b->neighbor_mac_addresses, sizeof(INT8U[6]) * a->neighbor_mac_addresses_nr)
+       )
+    {
+        return 1;
+    }
+
+    for (i=0; i<a->ipv4_nr; i++)
+    {
+        if (
+             a->ipv4[i].type != b->ipv4[i].type                  ||
+             0 != memcmp(a->ipv4[i].address,     b->ipv4[i].address,     4) ||
+             0 != memcmp(a->ipv4[i].dhcp_server, b->ipv4[i].dhcp_server, 4)
+           )
+        {
+            return 1;
+        }
+    }
+
+    for (i=0; i<a->ipv6_nr; i++)
+    {
+        if (
+             a->ipv6[i].type != b->ipv6[i].type                   ||
+             0 != memcmp(a->ipv6[i].address, b->ipv6[i].address, 16) ||
+             0 != memcmp(a->ipv6[i].origin,  b->ipv6[i].origin,  16)
+           )
+        {
+            return 1;
         }
     }
 
-    free(line);
-    pclose(pipe);
+    for (i=0; i<a->vendor_specific_elements_nr; i++)
+    {
+        if (
+             0 != memcmp(a->vendor_specific_elements[i].oui, b->vendor_specific_elements[i].oui, 3)    ||
+             a->vendor_specific_elements[i].vendor_data_len != b->vendor_specific_elements[i].vendor_data_len ||
+             (
+               a->vendor_specific_elements[i].vendor_data_len > 0 &&
+               0 != memcmp(a->vendor_specific_elements[i].vendor_data, b->vendor_specific_elements[i].vendor_data, a->vendor_specific_elements[i].vendor_data_len)
+             )
+           )
+        {
+            return 1;
+        }
+    }
 
-    return ret;
+    return 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // Internal API: to be used by other platform-specific files (functions
 // declaration is found in "./platform_interfaces_priv.h")
 ////////////////////////////////////////////////////////////////////////////////
+void fillDefaultInterfaceInfo(struct interfaceInfo *m)
+{
+    m->mac_address[0] = 0x00;
+    m->mac_address[1] = 0x00;
+    m->mac_address[2] = 0x00;
+    m->mac_address[3] = 0x00;
+    m->mac_address[4] = 0x00;
+    m->mac_address[5] = 0x00;
+
+    memcpy(m->manufacturer_name, "Unknown",          strlen("Unknown")+1);
+    memcpy(m->model_name,        "Unknown",          strlen("Unknown")+1);
+    memcpy(m->model_number,      "00000000",         strlen("00000000")+1);
+    memcpy(m->serial_number,     "00000000",         strlen("00000000")+1);
+    memcpy(m->device_name,       "Unknown",          strlen("Unknown")+1);
+    memcpy(m->uuid,              "0000000000000000", strlen("0000000000000000")+1);
+
+    m->interface_type                                                = INTERFACE_TYPE_UNKNOWN;
+    m->interface_type_data.other.oui[0]                              = 0x00;
+    m->interface_type_data.other.oui[1]                              = 0x00;
+    m->interface_type_data.other.oui[2]                              = 0x00;
+    m->interface_type_data.other.generic_phy_description_xml_url     = NULL;
+    m->interface_type_data.other.variant_index                       = 0;
+    m->interface_type_data.other.variant_name                        = 0;
+    m->interface_type_data.other.media_specific.unsupported.bytes_nr = 0;
+    m->interface_type_data.other.media_specific.unsupported.bytes    = NULL;
+
+    m->is_secured                     = 0;
+    m->push_button_on_going           = 2;    // "2" means "unsupported"
+    m->push_button_new_mac_address[0] = 0x00;
+    m->push_button_new_mac_address[1] = 0x00;
+    m->push_button_new_mac_address[2] = 0x00;
+    m->push_button_new_mac_address[3] = 0x00;
+    m->push_button_new_mac_address[4] = 0x00;
+    m->push_button_new_mac_address[5] = 0x00;
+
+    m->power_state                    = INTERFACE_POWER_STATE_OFF;
+    m->neighbor_mac_addresses_nr      = INTERFACE_NEIGHBORS_UNKNOWN;
+    m->neighbor_mac_addresses         = NULL;
+
+    m->ipv4_nr                        = 0;
+    m->ipv4                           = NULL;
+    m->ipv6_nr                        = 0;
+    m->ipv6                           = NULL;
+
+    m->vendor_specific_elements_nr    = 0;
+    m->vendor_specific_elements       = NULL;
+}
+
 INT8U registerInterfaceStub(char *interface_type, INT8U stub_type, void *f)
 {
     INT8U                i;
@@ -734,6 +1026,18 @@ void addInterface(char *long_interface_name)
     return;
 }
 
+INT8U startSpecialInterfaceCapture(char *interface_name, INT8U queue_id, INT8U *interface_mac_address, INT8U *al_mac_address)
+{
+    INT8U result;
+
+    if (0 == _executeInterfaceStub(interface_name, STUB_TYPE_CAPTURE_START, queue_id, interface_mac_address, al_mac_address, &result))
+    {
+        return 0;
+    }
+
+    return 1 == result ? 1 : 2;
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Platform API: Interface related functions to be used by platform-independent
@@ -776,56 +1080,10 @@ struct interfaceInfo *PLATFORM_GET_1905_INTERFACE_INFO(char *interface_name)
     //
     m->name = strdup(interface_name);
 
-    // Obtain the 'mac_address'
-    //
-
     // Give "sane" values in case any of the following parameters can not be
     // filled later
     //
-    m->mac_address[0] = 0x00;
-    m->mac_address[1] = 0x00;
-    m->mac_address[2] = 0x00;
-    m->mac_address[3] = 0x00;
-    m->mac_address[4] = 0x00;
-    m->mac_address[5] = 0x00;
-
-    memcpy(m->manufacturer_name, "Unknown",          strlen("Unknown")+1);
-    memcpy(m->model_name,        "Unknown",          strlen("Unknown")+1);
-    memcpy(m->model_number,      "00000000",         strlen("00000000")+1);
-    memcpy(m->serial_number,     "00000000",         strlen("00000000")+1);
-    memcpy(m->device_name,       "Unknown",          strlen("Unknown")+1);
-    memcpy(m->uuid,              "0000000000000000", strlen("0000000000000000")+1);
-
-    m->interface_type                                                = INTERFACE_TYPE_UNKNOWN;
-    m->interface_type_data.other.oui[0]                              = 0x00;
-    m->interface_type_data.other.oui[1]                              = 0x00;
-    m->interface_type_data.other.oui[2]                              = 0x00;
-    m->interface_type_data.other.generic_phy_description_xml_url     = NULL;
-    m->interface_type_data.other.variant_index                       = 0;
-    m->interface_type_data.other.variant_name                        = 0;
-    m->interface_type_data.other.media_specific.unsupported.bytes_nr = 0;
-    m->interface_type_data.other.media_specific.unsupported.bytes    = NULL;
-
-    m->is_secured                     = 0;
-    m->push_button_on_going           = 2;    // "2" means "unsupported"
-    m->push_button_new_mac_address[0] = 0x00;
-    m->push_button_new_mac_address[1] = 0x00;
-    m->push_button_new_mac_address[2] = 0x00;
-    m->push_button_new_mac_address[3] = 0x00;
-    m->push_button_new_mac_address[4] = 0x00;
-    m->push_button_new_mac_address[5] = 0x00;
-
-    m->power_state                    = INTERFACE_POWER_STATE_OFF;
-    m->neighbor_mac_addresses_nr      = INTERFACE_NEIGHBORS_UNKNOWN;
-    m->neighbor_mac_addresses         = NULL;
-
-    m->ipv4_nr                        = 0;
-    m->ipv4                           = NULL;
-    m->ipv6_nr                        = 0;
-    m->ipv6                           = NULL;
-
-    m->vendor_specific_elements_nr    = 0;
-    m->vendor_specific_elements       = NULL;
+    fillDefaultInterfaceInfo(m);
 
     // Next, fill all the parameters we can depending on the type of interface
     // we are dealing with:
@@ -847,21 +1105,34 @@ struct interfaceInfo *PLATFORM_GET_1905_INTERFACE_INFO(char *interface_name)
         // *********************************************************************
         
         // This is a "regular" interface. Query the Linux kernel for data
+        // (or, better, the NETLINK table that mirrors it, if available)
+
+        struct netlinkLinkInfo link;
+        INT8U                  link_known;
 
-        int fd;
+        link_known = netlinkGetLink(interface_name, &link);
 
-        strcpy(s.ifr_name, m->name);
-        fd = socket(PF_INET, SOCK_DGRAM, IPPROTO_IP);
-        if (0 != ioctl(fd, SIOCGIFHWADDR, &s))
+        if (link_known)
         {
-            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Could not obtain MAC address of interface %s\n", m->name);
-            free(m->name);
-            free(m);
+            memcpy(m->mac_address, link.mac_address, 6);
+        }
+        else
+        {
+            int fd;
+
+            strcpy(s.ifr_name, m->name);
+            fd = socket(PF_INET, SOCK_DGRAM, IPPROTO_IP);
+            if (0 != ioctl(fd, SIOCGIFHWADDR, &s))
+            {
+                PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Could not obtain MAC address of interface %s\n", m->name);
+                free(m->name);
+                free(m);
+                close(fd);
+                return NULL;
+            }
             close(fd);
-            return NULL;
+            memcpy(m->mac_address, s.ifr_addr.sa_data, 6);
         }
-        close(fd);
-        memcpy(m->mac_address, s.ifr_addr.sa_data, 6);
 
 #ifdef _FLAVOUR_ARM_WRT1900ACX_
         // The "linksys wrt1900ac" platform flavour uses the following flavour
@@ -934,22 +1205,29 @@ struct interfaceInfo *PLATFORM_GET_1905_INTERFACE_INFO(char *interface_name)
 
         // Check the 'power_state'
         //
-        m->power_state = INTERFACE_POWER_STATE_ON;
+        if (link_known && 0 == link.is_up)
+        {
+            m->power_state = INTERFACE_POWER_STATE_OFF;
+        }
+        else
+        {
+            m->power_state = INTERFACE_POWER_STATE_ON;
+        }
         
         // Add neighbor MAC addresses
         //
         m->neighbor_mac_addresses_nr = INTERFACE_NEIGHBORS_UNKNOWN;
         m->neighbor_mac_addresses    = NULL;
 
-        // Add IPv4 info
+        // Add IPv4 and IPv6 info
         //
-        m->ipv4_nr = 0;
-        m->ipv4    = NULL;
-
-        // Add IPv6 info
-        //
-        m->ipv6_nr = 0;
-        m->ipv6    = NULL;
+        if (0 == netlinkGetAddresses(interface_name, &m->ipv4_nr, &m->ipv4, &m->ipv6_nr, &m->ipv6))
+        {
+            m->ipv4_nr = 0;
+            m->ipv4    = NULL;
+            m->ipv6_nr = 0;
+            m->ipv6    = NULL;
+        }
 
         // Add vendor specific data
         //
@@ -1123,34 +1401,97 @@ void PLATFORM_FREE_1905_INTERFACE_INFO(struct interfaceInfo *x)
     free(x);
 }
 
-struct linkMetrics *PLATFORM_GET_LINK_METRICS(char *local_interface_name, INT8U *neighbor_interface_address)
+struct interfaceInfo *PLATFORM_GET_1905_INTERFACE_INFO_CACHED(char *interface_name)
 {
-    struct linkMetrics    *ret;
-    struct interfaceInfo  *x;
-
-    INT32S tmp;
-    INT8U  executed;
+    struct _interfaceInfoCacheEntry *e;
+    INT32U                           now;
+    int                              i;
 
-    ret = (struct linkMetrics *)malloc(sizeof(struct linkMetrics));
-    if (NULL == ret)
+    for (i=0; i<interfaces_nr; i++)
+    {
+        if (0 == strcmp(interfaces_list[i], interface_name))
+        {
+            break;
+        }
+    }
+    if (i == interfaces_nr)
     {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Interface %s is not a 1905 interface. Its info cannot be cached\n", interface_name);
         return NULL;
     }
 
-    // Obtain the MAC address of the local interface
-    //
-    x = PLATFORM_GET_1905_INTERFACE_INFO(local_interface_name);
-    if (NULL == x)
+    if (interface_info_cache_nr < interfaces_nr)
     {
-        free(ret);
-        return NULL;
+        // New interfaces were added since the last time
+        //
+        interface_info_cache = (struct _interfaceInfoCacheEntry *)realloc(interface_info_cache, sizeof(struct _interfaceInfoCacheEntry) * interfaces_nr);
+        memset(&interface_info_cache[interface_info_cache_nr], 0x0, sizeof(struct _interfaceInfoCacheEntry) * (interfaces_nr - interface_info_cache_nr));
+
+        interface_info_cache_nr = interfaces_nr;
     }
-    memcpy(ret->local_interface_address, x->mac_address, 6);
-    PLATFORM_FREE_1905_INTERFACE_INFO(x);
 
-    // Copy the remote interface MAC address
-    //
-    memcpy(ret->neighbor_interface_address, neighbor_interface_address, 6);
+    e   = &interface_info_cache[i];
+    now = PLATFORM_GET_TIMESTAMP();
+
+    if (0 == e->valid || now - e->timestamp >= INTERFACE_INFO_CACHE_TTL)
+    {
+        if (NULL != e->previous)
+        {
+            PLATFORM_FREE_1905_INTERFACE_INFO(e->previous);
+        }
+        e->previous  = e->info;
+        e->info      = PLATFORM_GET_1905_INTERFACE_INFO(interface_name);
+        e->timestamp = now;
+
+        // The very first retrieval (when there is nothing to compare with)
+        // also counts as a change
+        //
+        if (0 == e->initialized || 1 == _interfaceInfoChanged(e->previous, e->info))
+        {
+            interface_info_generation++;
+        }
+        e->initialized = 1;
+
+        // Note that a NULL result is also cached, so that an interface that
+        // cannot be queried does not cost a new query on each call.
+        //
+        e->valid     = 1;
+    }
+
+    return e->info;
+}
+
+void PLATFORM_INVALIDATE_1905_INTERFACE_INFO(char *interface_name)
+{
+    int i;
+
+    for (i=0; i<interface_info_cache_nr; i++)
+    {
+        if (NULL == interface_name || 0 == strcmp(interfaces_list[i], interface_name))
+        {
+            interface_info_cache[i].valid = 0;
+        }
+    }
+}
+
+INT32U PLATFORM_GET_1905_INTERFACE_INFO_GENERATION(void)
+{
+    return interface_info_generation;
+}
+
+// Fill 'ret' with the current metrics of the link between local interface
+// 'local_interface_name' and the neighbor interface whose MAC address is
+// 'ret->neighbor_interface_address' (both addresses must have already been set
+// by the caller).
+//
+// This is what actually queries the kernel (or the interface stubs) and thus
+// it can be slow. It does not touch any AL main thread state, so that it can
+// also be called from the metrics sampler thread.
+//
+static void _sampleLinkMetrics(char *local_interface_name, struct linkMetrics *ret)
+{
+    INT32S tmp;
+    INT8U  executed;
 
     // Next, fill all the parameters we can depending on the type of interface
     // we are dealing with:
@@ -1190,27 +1531,34 @@ struct linkMetrics *PLATFORM_GET_LINK_METRICS(char *local_interface_name, INT8U
         //
         if (strstr(local_interface_name, "wlan") != NULL)
         {
+            struct nl80211StationInfo station;
+
+            // All the statistics the driver keeps for the neighbor are
+            // obtained at once with a (cached) nl80211 dump of the stations
+            // associated to the local interface.
+            //
+            if (0 == nl80211GetStation(local_interface_name, ret->neighbor_interface_address, &station))
+            {
+                PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Neighbor %02x:%02x:%02x:%02x:%02x:%02x not found in %s stations\n",
+                    ret->neighbor_interface_address[0], ret->neighbor_interface_address[1], ret->neighbor_interface_address[2],
+                    ret->neighbor_interface_address[3], ret->neighbor_interface_address[4], ret->neighbor_interface_address[5],
+                    local_interface_name);
+
+                memset(&station, 0x0, sizeof(station));
+            }
+
             // Obtain the amount of (correct and incorrect) packets transmitted
             // to 'neighbor_interface_address' in the last
             // 'ret->measures_window' seconds.
             //
-            // This is done by reading the response of the command
-            //
-            //   "iw dev $INTERFACE station get $NEIGHBOR_MAC | grep "tx packets"" and
-            //   "iw dev $INTERFACE station get $NEIGHBOR_MAC | grep "tx failed""
-            //
-            ret->tx_packet_ok     = (INT32U)_readWifiNeighborParameter(local_interface_name, ret->neighbor_interface_address, "\"tx packets\"");
-            ret->tx_packet_errors = (INT32U)_readWifiNeighborParameter(local_interface_name, ret->neighbor_interface_address, "\"tx failed\"");
+            ret->tx_packet_ok     = station.tx_packets;
+            ret->tx_packet_errors = station.tx_failed;
 
             // Obtain the estimated max MAC xput and PHY rate when transmitting
             // data from "A" to "B".
             //
-            // This is done by reading the response of the command
-            //
-            //   "iw dev $INTERFACE station get $NEIGHBOR_MAC | grep speed"
-            //
-            ret->tx_max_xput = (INT16U)_readWifiNeighborParameter(local_interface_name, ret->neighbor_interface_address, "\"tx bitrate\"");
-            ret->tx_phy_rate = (INT16U)_readWifiNeighborParameter(local_interface_name, ret->neighbor_interface_address, "\"tx bitrate\"");
+            ret->tx_max_xput = station.tx_bitrate;
+            ret->tx_phy_rate = station.tx_bitrate;
 
             // Obtain the estimated average percentage of time that the link is
             // available for transmission.
@@ -1223,15 +1571,10 @@ struct linkMetrics *PLATFORM_GET_LINK_METRICS(char *local_interface_name, INT8U
             // from 'neighbor_interface_address' in the last
             // 'ret->measures_window' seconds.
             //
-            // This is done by reading the response of the command
-            //
-            //   "iw dev $INTERFACE station get $NEIGHBOR_MAC | grep "rx packets""
+            //   TODO: rx errors are not reported by nl80211. Right now it's
+            //   assigned a zero value. Investigate how to obtain this value.
             //
-            //   TODO: rx errors can't be obtained from this console command.
-            //   Right now it's assigned a zero value. Investigate how to
-            //   obtain this value.
-            //
-            ret->rx_packet_ok     = (INT32U)_readWifiNeighborParameter(local_interface_name, ret->neighbor_interface_address, "\"rx packets\"");
+            ret->rx_packet_ok     = station.rx_packets;
             ret->rx_packet_errors = 0;
 
 
@@ -1252,7 +1595,7 @@ struct linkMetrics *PLATFORM_GET_LINK_METRICS(char *local_interface_name, INT8U
             // Feel free to redefine this conversion formula. Maybe to a
             // logarithmical one.
             //
-            tmp = _readWifiNeighborParameter(local_interface_name, ret->neighbor_interface_address, "\"signal:\"");
+            tmp = station.signal;
 
             #define  SIGNAL_MAX  (-40)   // dBm
             #define  SIGNAL_MIN  (-70)
@@ -1341,6 +1684,222 @@ struct linkMetrics *PLATFORM_GET_LINK_METRICS(char *local_interface_name, INT8U
         }
     }
 
+    return;
+}
+
+// Search for the link between local interface 'interface_name' and neighbor
+// interface 'neighbor_interface_address' in 'l'.
+// Return its index or "-1" if not found.
+//
+static int _findSampledLink(struct _sampledLinks *l, char *interface_name, INT8U *neighbor_interface_address)
+{
+    int i;
+
+    for (i=0; i<l->nr; i++)
+    {
+        if (
+             0 == strcmp(l->links[i].interface_name, interface_name)                                 &&
+             0 == memcmp(l->links[i].metrics.neighbor_interface_address, neighbor_interface_address, 6)
+           )
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+// Append a copy of 'link' to 'l'
+//
+static void _appendSampledLink(struct _sampledLinks *l, struct _sampledLink *link)
+{
+    struct _sampledLink *p;
+
+    p = (struct _sampledLink *)realloc(l->links, sizeof(struct _sampledLink) * (l->nr + 1));
+    if (NULL == p)
+    {
+        return;
+    }
+    l->links = p;
+
+    memcpy(&l->links[l->nr], link, sizeof(struct _sampledLink));
+    l->links[l->nr].interface_name = strdup(link->interface_name);
+    l->nr++;
+}
+
+static void _emptySampledLinks(struct _sampledLinks *l)
+{
+    int i;
+
+    for (i=0; i<l->nr; i++)
+    {
+        free(l->links[i].interface_name);
+    }
+    free(l->links);
+
+    l->nr    = 0;
+    l->links = NULL;
+}
+
+// Thread that keeps the "front" buffer of the link metrics cache up to date
+//
+static void *_linkMetricsSamplerThread(void *p)
+{
+    struct _sampledLinks *front;
+    struct _sampledLinks *back;
+    INT32U                now;
+    int                   i, j;
+
+    while (1)
+    {
+        // Take the list of links to sample from the "front" buffer, leaving
+        // out those nobody has asked for in a while
+        //
+        pthread_mutex_lock(&link_metrics_mutex);
+
+        now   = PLATFORM_GET_TIMESTAMP();
+        front = &link_metrics_buffers[link_metrics_front];
+        back  = &link_metrics_buffers[1 - link_metrics_front];
+
+        _emptySampledLinks(back);
+        for (i=0; i<front->nr; i++)
+        {
+            if (now - front->links[i].last_request <= LINK_METRICS_SAMPLER_MAX_IDLE)
+            {
+                _appendSampledLink(back, &front->links[i]);
+            }
+        }
+
+        pthread_mutex_unlock(&link_metrics_mutex);
+
+        // Sample them. This is the slow part and it is done without holding
+        // the mutex, as nobody else touches the "back" buffer.
+        //
+        for (i=0; i<back->nr; i++)
+        {
+            _sampleLinkMetrics(back->links[i].interface_name, &back->links[i].metrics);
+        }
+
+        // Publish the new samples. Links that were registered (or asked for)
+        // while sampling are carried over from the "front" buffer.
+        //
+        pthread_mutex_lock(&link_metrics_mutex);
+
+        front = &link_metrics_buffers[link_metrics_front];
+        for (i=0; i<front->nr; i++)
+        {
+            j = _findSampledLink(back, front->links[i].interface_name, front->links[i].metrics.neighbor_interface_address);
+            if (-1 != j)
+            {
+                back->links[j].last_request = front->links[i].last_request;
+            }
+            else if (now - front->links[i].last_request <= LINK_METRICS_SAMPLER_MAX_IDLE)
+            {
+                _appendSampledLink(back, &front->links[i]);
+            }
+        }
+        link_metrics_front = 1 - link_metrics_front;
+
+        pthread_mutex_unlock(&link_metrics_mutex);
+
+        usleep(LINK_METRICS_SAMPLING_PERIOD * 1000);
+    }
+
+    return NULL;
+}
+
+struct linkMetrics *PLATFORM_GET_LINK_METRICS(char *local_interface_name, INT8U *neighbor_interface_address)
+{
+    struct linkMetrics    *ret;
+    struct interfaceInfo  *x;
+
+    struct _sampledLinks  *front;
+    struct _sampledLink    link;
+    int                    i;
+
+    ret = (struct linkMetrics *)malloc(sizeof(struct linkMetrics));
+    if (NULL == ret)
+    {
+        return NULL;
+    }
+
+    // Obtain the MAC address of the local interface
+    //
+    x = PLATFORM_GET_1905_INTERFACE_INFO_CACHED(local_interface_name);
+    if (NULL == x)
+    {
+        free(ret);
+        return NULL;
+    }
+    memcpy(ret->local_interface_address, x->mac_address, 6);
+
+    // Copy the remote interface MAC address
+    //
+    memcpy(ret->neighbor_interface_address, neighbor_interface_address, 6);
+
+    if (0 == LINK_METRICS_SAMPLING_PERIOD)
+    {
+        _sampleLinkMetrics(local_interface_name, ret);
+        return ret;
+    }
+
+    // Serve the request from the latest snapshot, if there is one
+    //
+    pthread_mutex_lock(&link_metrics_mutex);
+
+    if (0 == link_metrics_sampler)
+    {
+        pthread_t thread;
+
+        if (0 != pthread_create(&thread, NULL, _linkMetricsSamplerThread, NULL))
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Could not start the link metrics sampler thread\n");
+        }
+        else
+        {
+            pthread_detach(thread);
+        }
+
+        // Do not try again: if the thread could not be created, links are
+        // sampled synchronously the first time they are asked for and their
+        // snapshot is never refreshed (better than failing)
+        //
+        link_metrics_sampler = 1;
+    }
+
+    front = &link_metrics_buffers[link_metrics_front];
+    i     = _findSampledLink(front, local_interface_name, neighbor_interface_address);
+    if (-1 != i)
+    {
+        front->links[i].last_request = PLATFORM_GET_TIMESTAMP();
+        memcpy(ret, &front->links[i].metrics, sizeof(struct linkMetrics));
+        memcpy(ret->local_interface_address, x->mac_address, 6);
+
+        pthread_mutex_unlock(&link_metrics_mutex);
+        return ret;
+    }
+
+    pthread_mutex_unlock(&link_metrics_mutex);
+
+    // First time this link is asked for: sample it now and register it so
+    // that, from now on, the sampler keeps it up to date
+    //
+    _sampleLinkMetrics(local_interface_name, ret);
+
+    link.interface_name = local_interface_name;
+    link.last_request   = PLATFORM_GET_TIMESTAMP();
+    memcpy(&link.metrics, ret, sizeof(struct linkMetrics));
+
+    pthread_mutex_lock(&link_metrics_mutex);
+
+    front = &link_metrics_buffers[link_metrics_front];
+    if (-1 == _findSampledLink(front, local_interface_name, neighbor_interface_address))
+    {
+        _appendSampledLink(front, &link);
+    }
+
+    pthread_mutex_unlock(&link_metrics_mutex);
+
     return ret;
 }
 
@@ -1359,21 +1918,72 @@ void PLATFORM_FREE_LINK_METRICS(struct linkMetrics *l)
 
 struct bridge *PLATFORM_GET_LIST_OF_BRIDGES(INT8U *nr)
 {
-    // TODO
+    struct bridge *ret;
+    int            i;
+    INT8U          j;
 
+    // Bridges are built from the NETLINK table, grouping the 1905 interfaces
+    // by the bridge they belong to (other interfaces are not reported, as the
+    // AL knows nothing about them)
+    //
+    ret = NULL;
     *nr = 0;
-    return NULL;
+
+    for (i=0; i<interfaces_nr; i++)
+    {
+        struct netlinkLinkInfo link;
+
+        if (0 == netlinkGetLink(interfaces_list[i], &link) || 0x0 == link.master[0])
+        {
+            continue;
+        }
+
+        for (j=0; j<*nr; j++)
+        {
+            if (0 == strcmp(ret[j].name, link.master))
+            {
+                break;
+            }
+        }
+        if (j == *nr)
+        {
+            ret = (struct bridge *)realloc(ret, sizeof(struct bridge) * (*nr + 1));
+
+            ret[j].name                  = strdup(link.master);
+            ret[j].bridged_interfaces_nr = 0;
+            ret[j].forwarding_rules_nr   = 0;
+
+            (*nr)++;
+        }
+
+        if (ret[j].bridged_interfaces_nr < sizeof(ret[j].bridged_interfaces)/sizeof(ret[j].bridged_interfaces[0]))
+        {
+            ret[j].bridged_interfaces[ret[j].bridged_interfaces_nr++] = strdup(interfaces_list[i]);
+        }
+    }
+
+    return ret;
 }
 
 void PLATFORM_FREE_LIST_OF_BRIDGES(struct bridge *x, INT8U nr)
 {
-    // TODO
-    //
+    INT8U i, j;
+
     if (0 == nr || NULL == x)
     {
         return;
     }
 
+    for (i=0; i<nr; i++)
+    {
+        free(x[i].name);
+        for (j=0; j<x[i].bridged_interfaces_nr; j++)
+        {
+            free(x[i].bridged_interfaces[j]);
+        }
+    }
+    free(x);
+
     return;
 }
     
@@ -1391,6 +2001,8 @@ INT8U PLATFORM_SEND_RAW_PACKET(char *interface_name, INT8U *dst_mac, INT8U *src_
     INT8U buffer[MAX_NETWORK_SEGMENT_SIZE];
     struct ether_header *eh;
 
+    INT8U sent;
+
     // Print packet (used for debug purposes)
     //
     PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Preparing to send RAW packet:\n");
@@ -1431,29 +2043,6 @@ INT8U PLATFORM_SEND_RAW_PACKET(char *interface_name, INT8U *dst_mac, INT8U *src_
         PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM]                      %s\n", aux1);
     }
 
-    // Open RAW socket
-    //
-    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Opening RAW socket\n");
-    s = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
-    if (-1 == s)
-    {
-        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] socket('%s') returned with errno=%d (%s) while opening a RAW socket\n", interface_name, errno, strerror(errno));
-        return 0;
-    }
-  
-    // Retrieve ethernet interface index
-    // 
-    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Retrieving interface index\n");
-    strncpy(ifr.ifr_name, interface_name, IFNAMSIZ);
-    if (ioctl(s, SIOCGIFINDEX, &ifr) == -1)
-    {
-          PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] ioctl('%s',SIOCGIFINDEX) returned with errno=%d (%s) while opening a RAW socket\n", interface_name, errno, strerror(errno));
-          close(s);
-          return 0;
-    }
-    ifindex = ifr.ifr_ifindex;
-    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Successfully got interface index %d\n", ifindex);
-
     // Empy buffer
     //
     memset(buffer, 0, MAX_NETWORK_SEGMENT_SIZE);
@@ -1479,6 +2068,39 @@ INT8U PLATFORM_SEND_RAW_PACKET(char *interface_name, INT8U *dst_mac, INT8U *src_
     //
     memcpy(buffer + sizeof(*eh), payload, payload_len);
 
+    PLATFORM_RECORD_FRAME(PLATFORM_FRAME_TRANSMITTED, interface_name, buffer, payload, payload_len, NULL);
+
+    // Some "special" interfaces are not connected to a real network and have
+    // their own way of sending frames
+    //
+    if (1 == _executeInterfaceStub(interface_name, STUB_TYPE_SEND_FRAME, buffer, sizeof(*eh) + payload_len, &sent))
+    {
+        return sent;
+    }
+
+    // Open RAW socket
+    //
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Opening RAW socket\n");
+    s = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+    if (-1 == s)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] socket('%s') returned with errno=%d (%s) while opening a RAW socket\n", interface_name, errno, strerror(errno));
+        return 0;
+    }
+  
+    // Retrieve ethernet interface index
+    // 
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Retrieving interface index\n");
+    strncpy(ifr.ifr_name, interface_name, IFNAMSIZ);
+    if (ioctl(s, SIOCGIFINDEX, &ifr) == -1)
+    {
+          PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] ioctl('%s',SIOCGIFINDEX) returned with errno=%d (%s) while opening a RAW socket\n", interface_name, errno, strerror(errno));
+          close(s);
+          return 0;
+    }
+    ifindex = ifr.ifr_ifindex;
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Successfully got interface index %d\n", ifindex);
+
     // Prepare sockaddr_ll
     //
     memset(&socket_address, 0, sizeof(socket_address));
@@ -1512,6 +2134,151 @@ INT8U PLATFORM_SEND_RAW_PACKET(char *interface_name, INT8U *dst_mac, INT8U *src_
     return 1;
 }
 
+INT16U PLATFORM_SEND_RAW_PACKETS(struct rawPacket *packets, INT16U nr)
+{
+    // All frames share the same RAW socket and are handed to the kernel with
+    // a single "sendmmsg()" call.
+    // Each frame is made of three chunks (ethernet header, payload and, for
+    // frames shorter than the minimum ethernet frame length, padding) so that
+    // payloads don't need to be copied.
+    // Frames of "special" interfaces that have their own way of sending them
+    // (see STUB_TYPE_SEND_FRAME) are not part of the batch: they are sent one
+    // by one (and the RAW socket is only opened if there are other frames).
+    //
+    static INT8U padding[60];
+
+    int                 s;
+    struct ifreq        ifr;
+
+    struct ether_header *headers;
+    struct sockaddr_ll  *addresses;
+    struct iovec        *iovs;
+    struct mmsghdr      *msgs;
+
+    INT16U i, j;
+    INT16U msgs_nr;
+    INT16U sent;
+    int    ret;
+    char  *extended_params;
+
+    if (0 == nr)
+    {
+        return 0;
+    }
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Preparing to send %d RAW packets\n", nr);
+
+    headers   = (struct ether_header *)PLATFORM_MALLOC(sizeof(struct ether_header) * nr);
+    addresses = (struct sockaddr_ll  *)PLATFORM_MALLOC(sizeof(struct sockaddr_ll)  * nr);
+    iovs      = (struct iovec        *)PLATFORM_MALLOC(sizeof(struct iovec)        * nr * 3);
+    msgs      = (struct mmsghdr      *)PLATFORM_MALLOC(sizeof(struct mmsghdr)      * nr);
+
+    s       = -1;
+    sent    = 0;
+    msgs_nr = 0;
+    for (i=0; i<nr; i++)
+    {
+        struct rawPacket *p;
+        INT32U            frame_len;
+
+        p = &packets[i];
+
+        // The header goes into the next free slot of 'headers' (it is
+        // overwritten by the next frame if this one does not end up in the
+        // batch)
+        //
+        PLATFORM_MEMCPY(headers[msgs_nr].ether_dhost, p->dst_mac, 6);
+        PLATFORM_MEMCPY(headers[msgs_nr].ether_shost, p->src_mac, 6);
+        headers[msgs_nr].ether_type = htons(p->eth_type);
+
+        PLATFORM_RECORD_FRAME(PLATFORM_FRAME_TRANSMITTED, p->interface_name, (INT8U *)&headers[msgs_nr], p->payload, p->payload_len, NULL);
+
+        if (NULL != _findInterfaceStub(p->interface_name, STUB_TYPE_SEND_FRAME, &extended_params) && sizeof(struct ether_header) + p->payload_len <= MAX_NETWORK_SEGMENT_SIZE)
+        {
+            INT8U frame[MAX_NETWORK_SEGMENT_SIZE];
+            INT8U result;
+
+            PLATFORM_MEMCPY(frame, &headers[msgs_nr], sizeof(struct ether_header));
+            PLATFORM_MEMCPY(frame + sizeof(struct ether_header), p->payload, p->payload_len);
+
+            if (1 == _executeInterfaceStub(p->interface_name, STUB_TYPE_SEND_FRAME, frame, sizeof(struct ether_header) + p->payload_len, &result))
+            {
+                sent += result;
+                continue;
+            }
+        }
+
+        if (-1 == s)
+        {
+            s = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+            if (-1 == s)
+            {
+                PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] socket() returned with errno=%d (%s) while opening a RAW socket\n", errno, strerror(errno));
+                break;
+            }
+        }
+
+        strncpy(ifr.ifr_name, p->interface_name, IFNAMSIZ);
+        if (-1 == ioctl(s, SIOCGIFINDEX, &ifr))
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] ioctl('%s',SIOCGIFINDEX) returned with errno=%d (%s) while opening a RAW socket\n", p->interface_name, errno, strerror(errno));
+            continue;
+        }
+
+        memset(&addresses[msgs_nr], 0, sizeof(struct sockaddr_ll));
+        addresses[msgs_nr].sll_ifindex = ifr.ifr_ifindex;
+        addresses[msgs_nr].sll_halen   = ETH_ALEN;
+        PLATFORM_MEMCPY(addresses[msgs_nr].sll_addr, p->dst_mac, 6);
+
+        frame_len = sizeof(struct ether_header) + p->payload_len;
+
+        iovs[msgs_nr*3+0].iov_base = &headers[msgs_nr];
+        iovs[msgs_nr*3+0].iov_len  = sizeof(struct ether_header);
+        iovs[msgs_nr*3+1].iov_base = p->payload;
+        iovs[msgs_nr*3+1].iov_len  = p->payload_len;
+        iovs[msgs_nr*3+2].iov_base = padding;
+        iovs[msgs_nr*3+2].iov_len  = frame_len >= 60 ? 0 : 60 - frame_len;  // 60 is the minimum ethernet frame length
+
+        memset(&msgs[msgs_nr], 0, sizeof(struct mmsghdr));
+        msgs[msgs_nr].msg_hdr.msg_name    = &addresses[msgs_nr];
+        msgs[msgs_nr].msg_hdr.msg_namelen = sizeof(struct sockaddr_ll);
+        msgs[msgs_nr].msg_hdr.msg_iov     = &iovs[msgs_nr*3];
+        msgs[msgs_nr].msg_hdr.msg_iovlen  = 3;
+
+        msgs_nr++;
+    }
+
+    // "sendmmsg()" stops at the first frame that cannot be sent. When that
+    // happens, skip it and carry on with the rest.
+    //
+    j = 0;
+    while (j < msgs_nr)
+    {
+        ret = sendmmsg(s, &msgs[j], msgs_nr - j, 0);
+        if (-1 == ret)
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] sendmmsg() returned with errno=%d (%s)\n", errno, strerror(errno));
+            j++;
+            continue;
+        }
+
+        sent += ret;
+        j    += ret;
+    }
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] %d/%d packets sent!\n", sent, nr);
+
+    PLATFORM_FREE(headers);
+    PLATFORM_FREE(addresses);
+    PLATFORM_FREE(iovs);
+    PLATFORM_FREE(msgs);
+
+    if (-1 != s)
+    {
+        close(s);
+    }
+    return sent;
+}
+
 INT8U PLATFORM_START_PUSH_BUTTON_CONFIGURATION(char *interface_name, INT8U queue_id, INT8U *al_mac_address, INT16U mid)
 {
     pthread_t                     thread;
@@ -1555,6 +2322,10 @@ INT8U PLATFORM_START_PUSH_BUTTON_CONFIGURATION(char *interface_name, INT8U queue
 
     pthread_create(&thread, NULL, _pushButtonConfigurationThread, (void *)p);
 
+    // "push_button_on_going" is about to change
+    //
+    PLATFORM_INVALIDATE_1905_INTERFACE_INFO(interface_name);
+
     return 1;
 }
 
@@ -1586,6 +2357,8 @@ INT8U PLATFORM_SET_INTERFACE_POWER_MODE(char *interface_name, INT8U power_mode)
         }
     }
 
+    PLATFORM_INVALIDATE_1905_INTERFACE_INFO(interface_name);
+
     return INTERFACE_POWER_RESULT_EXPECTED;
 }
 
@@ -1604,5 +2377,7 @@ INT8U PLATFORM_CONFIGURE_80211_AP(char *interface_name, INT8U *ssid, INT8U *bssi
     PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] Configuration has no effect on flavour-neutral platform\n");
 #endif
 
+    PLATFORM_INVALIDATE_1905_INTERFACE_INFO(interface_name);
+
     return 1;
 }
@@ -59,21 +59,131 @@
 #include "platform_interfaces_priv.h"           // registerInterfaceStub
 #include "platform_interfaces_ghnspirit_priv.h"
 
-#include <stdio.h>   // popen()
-#include <stdlib.h>  // ssize_t
-#include <string.h>  // strdup()
-#include <errno.h>   // errno
-#include <pthread.h> // mutex functions
-#include <unistd.h>  // sleep()
+#include <stdio.h>      // popen(), fmemopen()
+#include <stdlib.h>     // ssize_t
+#include <string.h>     // strdup()
+#include <errno.h>      // errno
+#include <pthread.h>    // mutex functions
+#include <unistd.h>     // sleep(), fork()
+#include <signal.h>     // kill()
+#include <sys/socket.h> // socketpair()
+#include <sys/time.h>   // struct timeval
+#include <sys/wait.h>   // waitpid()
 
 
 ////////////////////////////////////////////////////////////////////////////////
 // Private data and functions
 ////////////////////////////////////////////////////////////////////////////////
 
-// Mutex to avoid concurrent modem LCMP access
+// G.hn devices are queried using the "configlayer" LCMP tool. All the
+// parameters each AL function needs are obtained with one single request
+// (which is just the list of "configlayer" arguments that follow the device
+// selection ones):
 //
-pthread_mutex_t lcmp_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define LCMP_CONFIGLAYER_COMMAND  "configlayer -i %s -m %s %s -w %s"
+#define MAX_COMMAND_SIZE          1024
+
+#define LCMP_REQUEST_GET_INFO       (0)
+#define LCMP_REQUEST_GET_METRICS    (1)
+#define LCMP_REQUEST_START_PAIRING  (2)
+#define LCMP_REQUESTS_NR            (3)
+
+static char *lcmp_requests[LCMP_REQUESTS_NR] =
+{
+    // LCMP_REQUEST_GET_INFO
+    //
+    // NOTE: The order of parameters matters (see the comments in
+    // "_getInterfaceInfoFromGhnSpiritDevice()")
+    //
+    "-o GET "
+    "-p SYSTEM.PRODUCTION.MAC_ADDR "
+    "-p SYSTEM.PRODUCTION.DEVICE_MANUFACTURER "
+    "-p SYSTEM.PRODUCTION.HW_PRODUCT "
+    "-p SYSTEM.PRODUCTION.HW_REVISION "
+    "-p SYSTEM.PRODUCTION.SERIAL_NUMBER "
+    "-p SYSTEM.PRODUCTION.DEVICE_NAME "
+    "-p NODE.GENERAL.DNI "
+    "-p PAIRING.GENERAL.SECURED "
+    "-p PAIRING.GENERAL.PROCESS_START "
+    "-p POWERSAVING.GENERAL.STATUS "
+    "-p DHCP.GENERAL.ENABLED_IPV4 "
+    "-p DHCP.GENERAL.SERVER_IPV4 "
+    "-p DHCP.GENERAL.ENABLED_IPV6 "
+    "-p TCPIP.IPV4.IP_ADDRESS "
+    "-p TCPIP.IPV6.IP_ADDRESS "
+    "-p DIDMNG.GENERAL.MACS",
+
+    // LCMP_REQUEST_GET_METRICS
+    //
+    // NOTE: The order of parameters also matters (see the comments in
+    // "_getMetricsFromGhnSpiritDevice()")
+    //
+    "-o GET "
+    "-p QOS.STATS.G9962 "
+    "-p BFT.GENERAL.MACS_INFO_DESC "
+    "-p BFT.GENERAL.MACS_INFO "
+    "-p DIDMNG.GENERAL.DIDS "
+    "-p DIDMNG.GENERAL.TX_BPS",
+
+    // LCMP_REQUEST_START_PAIRING
+    //
+    "-o SET "
+    "-p PAIRING.GENERAL.PROCESS_START=1",
+};
+
+// The response to a GET request does not depend on who asks for it (for
+// example, the metrics of all the neighbors of a G.hn device are obtained from
+// the same response), thus responses are reused during
+// "GHNSPIRIT_LCMP_CACHE_TTL" milliseconds (a value of "0" disables this).
+// A SET request drops all the cached responses of the device.
+//
+#ifndef GHNSPIRIT_LCMP_CACHE_TTL
+#  define GHNSPIRIT_LCMP_CACHE_TTL  (1000)
+#endif
+
+// When "GHNSPIRIT_LCMP_SESSION" is defined, instead of running the LCMP tool
+// once per request, it is started once per G.hn device (without the "-o"
+// and "-p" arguments) and kept running. Requests are then written to its
+// standard input (one per line) and it must answer each of them with the same
+// output it would have produced if run with those arguments, followed by an
+// empty line.
+//
+// Responses must arrive in less than "LCMP_SESSION_TIMEOUT" seconds or else
+// the co-process is killed (it will be started again on the next request).
+//
+#define LCMP_SESSION_TIMEOUT  (5)
+
+// There is one "session" for each G.hn device. Accesses to the same device are
+// serialized (using the session mutex), but different devices can be queried
+// at the same time.
+//
+struct _lcmpSession
+{
+    char            *interface_name;
+    char            *ghn_mac_address;
+
+    pthread_mutex_t  mutex;
+
+    // Co-process (only used when "GHNSPIRIT_LCMP_SESSION" is defined). 'fd'
+    // is "-1" when it is not running.
+    //
+    pid_t            pid;
+    int              fd;
+    FILE            *fp;
+
+    // Last response to each GET request (NULL if there is none)
+    //
+    struct
+    {
+        INT32U       timestamp;
+        char        *response;
+
+    }                cache[LCMP_REQUESTS_NR];
+};
+
+static pthread_mutex_t       lcmp_sessions_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct _lcmpSession **lcmp_sessions       = NULL;
+static int                   lcmp_sessions_nr    = 0;
 
 // These are static values to fill the "interface_type_data" field
 //
@@ -144,6 +254,427 @@ int _extractMacAndPassword(char *ghnspirit_extended_params, char **ghn_mac_addre
     return 1;
 }
 
+// Return the session associated to the G.hn device 'ghn_mac_address' connected
+// to interface 'interface_name' (creating it if this is the first time it is
+// needed).
+//
+// Sessions are never destroyed, thus the returned pointer can be used without
+// holding any mutex.
+//
+static struct _lcmpSession *_lcmpSessionGet(char *interface_name, char *ghn_mac_address)
+{
+    struct _lcmpSession  *s;
+    struct _lcmpSession **aux;
+    int                   i;
+
+    pthread_mutex_lock(&lcmp_sessions_mutex);
+
+    for (i=0; i<lcmp_sessions_nr; i++)
+    {
+        if (
+             0 == strcmp(lcmp_sessions[i]->interface_name,  interface_name)  &&
+             0 == strcmp(lcmp_sessions[i]->ghn_mac_address, ghn_mac_address)
+           )
+        {
+            s = lcmp_sessions[i];
+            pthread_mutex_unlock(&lcmp_sessions_mutex);
+
+            return s;
+        }
+    }
+
+    s   = (struct _lcmpSession *)calloc(1, sizeof(struct _lcmpSession));
+    aux = (struct _lcmpSession **)realloc(lcmp_sessions, sizeof(struct _lcmpSession *) * (lcmp_sessions_nr + 1));
+    if (NULL == s || NULL == aux)
+    {
+        free(s);
+        if (NULL != aux)
+        {
+            lcmp_sessions = aux;
+        }
+        pthread_mutex_unlock(&lcmp_sessions_mutex);
+
+        return NULL;
+    }
+
+    s->interface_name  = strdup(interface_name);
+    s->ghn_mac_address = strdup(ghn_mac_address);
+    s->fd              = -1;
+    pthread_mutex_init(&s->mutex, NULL);
+
+    lcmp_sessions                     = aux;
+    lcmp_sessions[lcmp_sessions_nr++] = s;
+
+    pthread_mutex_unlock(&lcmp_sessions_mutex);
+
+    return s;
+}
+
+#ifdef GHNSPIRIT_LCMP_SESSION
+// Kill the co-process of session 's' (if running)
+//
+static void _lcmpSessionStop(struct _lcmpSession *s)
+{
+    if (-1 == s->fd)
+    {
+        return;
+    }
+
+    fclose(s->fp); // This also closes 's->fd'
+    kill(s->pid, SIGTERM);
+    waitpid(s->pid, NULL, 0);
+
+    s->fd = -1;
+    s->fp = NULL;
+}
+
+// Start the co-process of session 's'.
+// Return '1' on success, '0' otherwise.
+//
+static INT8U _lcmpSessionStart(struct _lcmpSession *s, char *lcmp_password)
+{
+    char           command[MAX_COMMAND_SIZE];
+    int            sv[2];
+    struct timeval timeout;
+
+    // The co-process is the LCMP tool with the device selection arguments
+    // only (ie. with an empty request). "exec" makes the shell be replaced by
+    // it, so that 's->pid' is the tool itself.
+    //
+    snprintf(command, sizeof(command), "exec " LCMP_CONFIGLAYER_COMMAND, s->interface_name, s->ghn_mac_address, "", lcmp_password);
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Starting LCMP session:\n");
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM]   > %s\n", command);
+
+    // A (bidirectional) socket is used instead of two pipes so that writing to
+    // a dead co-process does not raise SIGPIPE (see "MSG_NOSIGNAL")
+    //
+    if (-1 == socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] socketpair() returned with errno=%d (%s)\n", errno, strerror(errno));
+        return 0;
+    }
+
+    s->pid = fork();
+    if (-1 == s->pid)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] fork() returned with errno=%d (%s)\n", errno, strerror(errno));
+        close(sv[0]);
+        close(sv[1]);
+        return 0;
+    }
+    if (0 == s->pid)
+    {
+        dup2(sv[1], STDIN_FILENO);
+        dup2(sv[1], STDOUT_FILENO);
+        execl("/bin/sh", "sh", "-c", command, (char *)NULL);
+        _exit(127);
+    }
+    close(sv[1]);
+
+    timeout.tv_sec  = LCMP_SESSION_TIMEOUT;
+    timeout.tv_usec = 0;
+    setsockopt(sv[0], SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    s->fd = sv[0];
+    s->fp = fdopen(sv[0], "r");
+
+    return 1;
+}
+
+// Read one response (all lines until an empty one) from the co-process of
+// session 's'.
+// Return it (the caller must "free()" it) or NULL if the co-process died or
+// timed out.
+//
+static char *_lcmpSessionReadResponse(struct _lcmpSession *s)
+{
+    char    *line;
+    size_t   len;
+    ssize_t  read;
+
+    char    *response;
+    size_t   response_len;
+
+    line         = NULL;
+    response     = strdup("");
+    response_len = 0;
+
+    while (-1 != (read = getline(&line, &len, s->fp)))
+    {
+        char *aux;
+
+        if (0 == strcmp(line, "\n"))
+        {
+            free(line);
+            return response;
+        }
+
+        aux = (char *)realloc(response, response_len + read + 1);
+        if (NULL == aux)
+        {
+            break;
+        }
+        response = aux;
+
+        memcpy(response + response_len, line, read + 1);
+        response_len += read;
+    }
+
+    PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] LCMP session on %s (%s) did not answer\n", s->interface_name, s->ghn_mac_address);
+
+    free(line);
+    free(response);
+
+    return NULL;
+}
+
+// Send all 'nr' requests in 'requests' at once to the co-process of session
+// 's' (starting it if needed) and then read their responses into
+// 'responses'.
+// Return '1' on success, '0' otherwise (in which case the co-process is
+// stopped and 'responses' are left untouched)
+//
+static INT8U _lcmpSessionExchange(struct _lcmpSession *s, char *lcmp_password, INT8U *requests, INT8U nr, char **responses)
+{
+    char    line[MAX_COMMAND_SIZE];
+    int     len;
+    INT8U   i, j;
+
+    if (-1 == s->fd && 0 == _lcmpSessionStart(s, lcmp_password))
+    {
+        return 0;
+    }
+
+    for (i=0; i<nr; i++)
+    {
+        PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Querying G.hn device using the LCMP session:\n");
+        PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM]   > %s\n", lcmp_requests[requests[i]]);
+
+        len = snprintf(line, sizeof(line), "%s\n", lcmp_requests[requests[i]]);
+        if (len != send(s->fd, line, len, MSG_NOSIGNAL))
+        {
+            PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] send() to LCMP session returned with errno=%d (%s)\n", errno, strerror(errno));
+            _lcmpSessionStop(s);
+            return 0;
+        }
+    }
+
+    for (i=0; i<nr; i++)
+    {
+        responses[i] = _lcmpSessionReadResponse(s);
+
+        if (NULL == responses[i])
+        {
+            for (j=0; j<i; j++)
+            {
+                free(responses[j]);
+            }
+            _lcmpSessionStop(s);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+#else
+// Run the LCMP tool once for request 'request' on the G.hn device of session
+// 's' and return its output (the caller must "free()" it) or NULL if it could
+// not be run.
+//
+static char *_lcmpRunTool(struct _lcmpSession *s, char *lcmp_password, INT8U request)
+{
+    char     command[MAX_COMMAND_SIZE];
+    FILE    *pipe;
+
+    char    *response;
+    size_t   response_len;
+    char     buffer[512];
+    size_t   read;
+
+    snprintf(command, sizeof(command), LCMP_CONFIGLAYER_COMMAND, s->interface_name, s->ghn_mac_address, lcmp_requests[request], lcmp_password);
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Querying G.hn device using the LCMP tool:\n");
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM]   > %s\n", command);
+
+    pipe = popen(command, "r");
+
+    if (!pipe)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] popen() returned with errno=%d (%s)\n", errno, strerror(errno));
+        return NULL;
+    }
+
+    response     = strdup("");
+    response_len = 0;
+
+    while (NULL != response && 0 != (read = fread(buffer, 1, sizeof(buffer), pipe)))
+    {
+        char *aux;
+
+        aux = (char *)realloc(response, response_len + read + 1);
+        if (NULL == aux)
+        {
+            free(response);
+            response = NULL;
+            break;
+        }
+        response = aux;
+
+        memcpy(response + response_len, buffer, read);
+        response_len += read;
+        response[response_len] = 0x00;
+    }
+
+    pclose(pipe);
+
+    return response;
+}
+#endif
+
+// Return the LCMP tool output to request 'request' (one of the
+// "LCMP_REQUEST_*" values) for the G.hn device identified by
+// 'ghnspirit_extended_params' (see "_getInterfaceInfoFromGhnSpiritDevice()")
+// connected to interface 'interface_name'.
+//
+// The returned string (a "\n" separated list of "<PARAM_NAME>=<PARAM_VALUE>"
+// lines) must be "free()"d by the caller. NULL is returned if there was a
+// problem.
+//
+static char *_lcmpRequest(char *interface_name, char *ghnspirit_extended_params, INT8U request)
+{
+    struct _lcmpSession *s;
+
+    char   *ghn_mac_address;
+    char   *lcmp_password;
+
+    INT8U   requests[LCMP_REQUESTS_NR];
+    char   *responses[LCMP_REQUESTS_NR];
+    INT8U   requests_nr;
+
+    char   *ret;
+    INT32U  now;
+    INT8U   i;
+
+    // Obtain G.hn/Spirit MAC address and LCMP password
+    //
+    if (0 == _extractMacAndPassword(ghnspirit_extended_params, &ghn_mac_address, &lcmp_password))
+    {
+        return NULL;
+    }
+
+    s = _lcmpSessionGet(interface_name, ghn_mac_address);
+    free(ghn_mac_address);
+
+    if (NULL == s)
+    {
+        free(lcmp_password);
+        return NULL;
+    }
+
+    pthread_mutex_lock(&s->mutex);
+
+    // Reuse the last response, if recent enough
+    //
+    now = PLATFORM_GET_TIMESTAMP();
+
+    if (
+         LCMP_REQUEST_START_PAIRING != request                          &&
+         NULL                       != s->cache[request].response       &&
+         now - s->cache[request].timestamp < GHNSPIRIT_LCMP_CACHE_TTL
+       )
+    {
+        ret = strdup(s->cache[request].response);
+
+        pthread_mutex_unlock(&s->mutex);
+        free(lcmp_password);
+
+        return ret;
+    }
+
+    // Build the list of requests to send: the one we were asked for and...
+    //
+    requests_nr             = 0;
+    requests[requests_nr++] = request;
+
+#ifdef GHNSPIRIT_LCMP_SESSION
+    // ...(when the answer is going to be cached) every other GET request whose
+    // cached response has expired. They are pipelined in the same round trip
+    // (the info and metrics of a device are usually asked for in the same
+    // cycle).
+    //
+    if (LCMP_REQUEST_START_PAIRING != request && 0 != GHNSPIRIT_LCMP_CACHE_TTL)
+    {
+        for (i=0; i<LCMP_REQUESTS_NR; i++)
+        {
+            if (
+                 i != request && LCMP_REQUEST_START_PAIRING != i              &&
+                 (
+                   NULL == s->cache[i].response                              ||
+                   now - s->cache[i].timestamp >= GHNSPIRIT_LCMP_CACHE_TTL
+                 )
+               )
+            {
+                requests[requests_nr++] = i;
+            }
+        }
+    }
+
+    // If the co-process died since the last time it was used, the first
+    // attempt fails and the second one starts a new one.
+    //
+    if (
+         0 == _lcmpSessionExchange(s, lcmp_password, requests, requests_nr, responses) &&
+         0 == _lcmpSessionExchange(s, lcmp_password, requests, requests_nr, responses)
+       )
+    {
+        pthread_mutex_unlock(&s->mutex);
+        free(lcmp_password);
+
+        return NULL;
+    }
+#else
+    // ...nothing else (each request means a new process)
+    //
+    if (NULL == (responses[0] = _lcmpRunTool(s, lcmp_password, request)))
+    {
+        pthread_mutex_unlock(&s->mutex);
+        free(lcmp_password);
+
+        return NULL;
+    }
+#endif
+
+    free(lcmp_password);
+
+    ret = strdup(responses[0]);
+
+    if (LCMP_REQUEST_START_PAIRING == request)
+    {
+        // Whatever was cached is no longer valid
+        //
+        for (i=0; i<LCMP_REQUESTS_NR; i++)
+        {
+            free(s->cache[i].response);
+            s->cache[i].response = NULL;
+        }
+        free(responses[0]);
+    }
+    else
+    {
+        for (i=0; i<requests_nr; i++)
+        {
+            free(s->cache[requests[i]].response);
+            s->cache[requests[i]].response  = responses[i];
+            s->cache[requests[i]].timestamp = now;
+        }
+    }
+
+    pthread_mutex_unlock(&s->mutex);
+
+    return ret;
+}
+
 // Obtain information from the G.hn/Spirit device connected to interface
 // 'interface_name' and fill the 'm' structure.
 //
@@ -161,32 +692,9 @@ int _extractMacAndPassword(char *ghnspirit_extended_params, char **ghn_mac_addre
 //
 void _getInterfaceInfoFromGhnSpiritDevice(char *interface_name, char *ghnspirit_extended_params, struct interfaceInfo *m)
 {
-    #define MAX_COMMAND_SIZE 1024
-    #define LCMP_CONFIGLAYER_GETINFO_COMMAND "configlayer -i %s -m %s -o GET "          \
-                                             "-p SYSTEM.PRODUCTION.MAC_ADDR "           \
-                                             "-p SYSTEM.PRODUCTION.DEVICE_MANUFACTURER "\
-                                             "-p SYSTEM.PRODUCTION.HW_PRODUCT "         \
-                                             "-p SYSTEM.PRODUCTION.HW_REVISION "        \
-                                             "-p SYSTEM.PRODUCTION.SERIAL_NUMBER "      \
-                                             "-p SYSTEM.PRODUCTION.DEVICE_NAME "        \
-                                             "-p NODE.GENERAL.DNI "                     \
-                                             "-p PAIRING.GENERAL.SECURED "              \
-                                             "-p PAIRING.GENERAL.PROCESS_START "        \
-                                             "-p POWERSAVING.GENERAL.STATUS "           \
-                                             "-p DHCP.GENERAL.ENABLED_IPV4 "            \
-                                             "-p DHCP.GENERAL.SERVER_IPV4 "             \
-                                             "-p DHCP.GENERAL.ENABLED_IPV6 "            \
-                                             "-p TCPIP.IPV4.IP_ADDRESS "                \
-                                             "-p TCPIP.IPV6.IP_ADDRESS "                \
-                                             "-p DIDMNG.GENERAL.MACS "                  \
-                                             "-w %s"
-
-    FILE* pipe ;
-
-    char command[MAX_COMMAND_SIZE];
-
-    char *ghn_mac_address;
-    char *lcmp_password;
+
+    FILE *fp;
+    char *response;
 
     char    *line;
     size_t   len;
@@ -220,41 +728,22 @@ void _getInterfaceInfoFromGhnSpiritDevice(char *interface_name, char *ghnspirit_
         m->interface_type_data.other.variant_name  = strdup(variant_names[variant]);
     }
 
-    // Obtain G.hn/Spirit MAC address and LCMP password
+    // Query the G.hn device
     //
-    if (0 == _extractMacAndPassword(ghnspirit_extended_params, &ghn_mac_address, &lcmp_password))
+    if (NULL == (response = _lcmpRequest(interface_name, ghnspirit_extended_params, LCMP_REQUEST_GET_INFO)))
     {
         return;
     }
-
-    // "ghn_mac_address" contains the G.hn device MAC address and
-    // "lcmp_password" contains the password to query for G.hn parameters using
-    // the LCMP tool.
-    // Let's build the "command" that inccorporates this information:
-    //
-    snprintf(command, MAX_COMMAND_SIZE, LCMP_CONFIGLAYER_GETINFO_COMMAND, interface_name, ghn_mac_address, lcmp_password);
-    free(ghn_mac_address);
-    free(lcmp_password);
-
-    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Querying G.hn device using the LCMP tool:\n");
-    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM]   > %s\n", command);
-
-    // Execute the LCMP query tool.
-    //
-    pthread_mutex_lock(&lcmp_mutex);
-    pipe = popen(command, "r");
-
-    if (!pipe)
+    if (0 == strlen(response) || NULL == (fp = fmemopen(response, strlen(response), "r")))
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] popen() returned with errno=%d (%s)\n", errno, strerror(errno));
-        pthread_mutex_unlock(&lcmp_mutex);
+        free(response);
         return;
     }
 
     // Next read/fill the rest of parameters
     //
     line = NULL;
-    while (-1 != (read = getline(&line, &len, pipe)))
+    while (-1 != (read = getline(&line, &len, fp)))
     {
         char *value;
 
@@ -621,8 +1110,8 @@ void _getInterfaceInfoFromGhnSpiritDevice(char *interface_name, char *ghnspirit_
         free(dhcp_server);
     }
 
-    pclose(pipe);
-    pthread_mutex_unlock(&lcmp_mutex);
+    fclose(fp);
+    free(response);
 
     return;
 }
@@ -633,14 +1122,8 @@ void _getInterfaceInfoFromGhnSpiritDevice(char *interface_name, char *ghnspirit_
 //
 void _getMetricsFromGhnSpiritDevice(char *interface_name, char *ghnspirit_extended_params, struct linkMetrics *m)
 {
-    #define LCMP_CONFIGLAYER_GETMETRICS_COMMAND "configlayer -i %s -m %s -o GET -p QOS.STATS.G9962 -p BFT.GENERAL.MACS_INFO_DESC -p BFT.GENERAL.MACS_INFO -p DIDMNG.GENERAL.DIDS -p DIDMNG.GENERAL.TX_BPS -w %s"
-
-    FILE* pipe ;
-
-    char command[200];
-
-    char *ghn_mac_address;
-    char *lcmp_password;
+    FILE *fp;
+    char *response;
 
     char    *line;
     size_t   len;
@@ -652,41 +1135,22 @@ void _getMetricsFromGhnSpiritDevice(char *interface_name, char *ghnspirit_extend
     ssize_t  bft_did_index = -1; // not found
 
 
-    // Obtain G.hn/Spirit MAC address and LCMP password
+    // Query the G.hn device
     //
-    if (0 == _extractMacAndPassword(ghnspirit_extended_params, &ghn_mac_address, &lcmp_password))
+    if (NULL == (response = _lcmpRequest(interface_name, ghnspirit_extended_params, LCMP_REQUEST_GET_METRICS)))
     {
         return;
     }
-
-    // "ghn_mac_address" contains the G.hn device MAC address and
-    // "lcmp_password" contains the password to query for G.hn parameters using
-    // the LCMP tool.
-    // Let's build the "command" that incorporates this information:
-    //
-    sprintf(command, LCMP_CONFIGLAYER_GETMETRICS_COMMAND, interface_name, ghn_mac_address, lcmp_password);
-    free(ghn_mac_address);
-    free(lcmp_password);
-
-    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Querying G.hn device using the LCMP tool:\n");
-    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM]   > %s\n", command);
-
-    // Execute the LCMP query tool.
-    //
-    pthread_mutex_lock(&lcmp_mutex);
-    pipe = popen(command, "r");
-
-    if (!pipe)
+    if (0 == strlen(response) || NULL == (fp = fmemopen(response, strlen(response), "r")))
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] popen() returned with errno=%d (%s)\n", errno, strerror(errno));
-        pthread_mutex_unlock(&lcmp_mutex);
+        free(response);
         return;
     }
 
     // Next read/fill the rest of parameters
     //
     line = NULL;
-    while (-1 != (read = getline(&line, &len, pipe)))
+    while (-1 != (read = getline(&line, &len, fp)))
     {
         char *value;
 
@@ -971,59 +1435,26 @@ void _getMetricsFromGhnSpiritDevice(char *interface_name, char *ghnspirit_extend
         free(line);
     }
 
-    pclose(pipe);
-    pthread_mutex_unlock(&lcmp_mutex);
+    fclose(fp);
+    free(response);
 
     return;
 }
 
 void _startPushButtonOnGhnSpiritDevice(char *interface_name, char *ghnspirit_extended_params)
 {
-    #define LCMP_CONFIGLAYER_START_PAIRING_COMMAND "configlayer -i %s -m %s -o SET -p PAIRING.GENERAL.PROCESS_START=1 -w %s"
-
-    FILE* pipe ;
-
-    char command[100];
-
-    char *ghn_mac_address;
-    char *lcmp_password;
-   
-    // Obtain G.hn/Spirit MAC address and LCMP password
-    //
-    if (0 == _extractMacAndPassword(ghnspirit_extended_params, &ghn_mac_address, &lcmp_password))
-    {
-        return;
-    }
-
-    // "ghn_mac_address" contains the G.hn device MAC address and
-    // "lcmp_password" contains the password to query for G.hn parameters using
-    // the LCMP tool.
-    // Let's build the "command" that inccorporates this information:
-    //
-    sprintf(command, LCMP_CONFIGLAYER_START_PAIRING_COMMAND, interface_name, ghn_mac_address, lcmp_password);
-    free(ghn_mac_address);
-    free(lcmp_password);
+    char *response;
 
     PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Using the LCMP tool to instruct the G.hn device to start its pairing process\n");
-    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM]   > %s\n", command);
 
-    // Execute the LCMP tool.
+    // TODO: Maybe we should parse the tool output here to find out if the
+    // command executed OK
     //
-    pthread_mutex_lock(&lcmp_mutex);
-    pipe = popen(command, "r");
-
-    if (!pipe)
+    if (NULL == (response = _lcmpRequest(interface_name, ghnspirit_extended_params, LCMP_REQUEST_START_PAIRING)))
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] popen() returned with errno=%d (%s)\n", errno, strerror(errno));
-        pthread_mutex_unlock(&lcmp_mutex);
         return;
     }
-
-    // TODO: Maybe we should parse the tool output here to find out if the
-    // command executed OK
-
-    pclose(pipe);
-    pthread_mutex_unlock(&lcmp_mutex);
+    free(response);
 
     // The G.hn modem might need a few seconds to actually start the pairing
     // process. In order to be sure that the process has started before this
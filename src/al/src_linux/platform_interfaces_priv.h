@@ -58,6 +58,8 @@
 #ifndef _PLATFORM_INTERFACES_PRIV_H_
 #define _PLATFORM_INTERFACES_PRIV_H_
 
+#include "platform_interfaces.h" // struct interfaceInfo
+
 // This function must be called at the very beginning of your program to
 // register new types of "special" interfaces.
 //
@@ -80,6 +82,8 @@
 //   - STUB_TYPE_GET_INFO          --> void (*f)(char *interface_name, char *extended_params, struct interfaceInfo *m)
 //   - STUB_TYPE_GET_METRICS       --> void (*f)(char *interface_name, char *extended_params, struct linkMetrics   *m)
 //   - STUB_TYPE_PUSH_BUTTON_START --> void (*f)(char *interface_name, char *extended_params)
+//   - STUB_TYPE_SEND_FRAME        --> INT8U (*f)(char *interface_name, char *extended_params, INT8U *frame, INT16U frame_len)
+//   - STUB_TYPE_CAPTURE_START     --> INT8U (*f)(char *interface_name, char *extended_params, INT8U queue_id, INT8U *interface_mac_address, INT8U *al_mac_address)
 //
 // Once registered, the 'f' function will be called from the associated context
 // and this is its expected behaviour:
@@ -102,18 +106,46 @@
 //        'f' is expected to start the "push button configuration process" on
 //        the given local interface.
 //
-// Note that for each "interface_type" you must call this function STUB_TYPE_MAX
-// times (one for each stub type) with (obviously) different handlers (one for
-// each context)
+//    - STUB_TYPE_SEND_FRAME:
+//        'f' is expected to send 'frame' (a whole ethernet frame, header
+//        included) on the given local interface and return '1' (or '0' if it
+//        could not be sent).
+//
+//    - STUB_TYPE_CAPTURE_START:
+//        'f' is expected to start receiving frames on the given local
+//        interface and to deliver those addressed to this AL entity (see the
+//        filter used in "_pcapLoopThread()") to queue 'queue_id' (with
+//        "sendPacketToAlQueue()"). It must return '1' (or '0' if frames could
+//        not be captured).
+//
+// Note that for each "interface_type" you must call this function once for each
+// of the first three stub types (STUB_TYPE_GET_INFO, STUB_TYPE_GET_METRICS and
+// STUB_TYPE_PUSH_BUTTON_START) with (obviously) different handlers (one for
+// each context).
+// The last two ones are optional: interfaces of a type that does not register
+// them send and capture frames as regular Linux interfaces do (with RAW sockets
+// and libpcap)
 //
 // This function returns '1' if there was a problem, '0' otherwise.
 //
 #define STUB_TYPE_GET_INFO            (0)
 #define STUB_TYPE_GET_METRICS         (1)
 #define STUB_TYPE_PUSH_BUTTON_START   (2)
-#define STUB_TYPE_MAX                 (2)
+#define STUB_TYPE_SEND_FRAME          (3)
+#define STUB_TYPE_CAPTURE_START       (4)
+#define STUB_TYPE_MAX                 (4)
 INT8U registerInterfaceStub(char *interface_type, INT8U stub_type, void *f);
 
+// Fill all the fields of 'm' (except for 'name') with the "sane" default values
+// every "struct interfaceInfo" starts with, before being (maybe only partially)
+// filled with the actual interface information.
+//
+// This is what "PLATFORM_GET_1905_INTERFACE_INFO()" does before calling the
+// STUB_TYPE_GET_INFO handler. Handlers that prepare their data in advance can
+// use it to start from the same values.
+//
+void fillDefaultInterfaceInfo(struct interfaceInfo *m);
+
 // This function is used to initialize the "interfaces list database" from the
 // arguments obtained from the command line.
 //
@@ -133,5 +165,16 @@ INT8U registerInterfaceStub(char *interface_type, INT8U stub_type, void *f);
 //
 void addInterface(char *long_interface_name);
 
+// Start capturing frames on interface 'interface_name' when it is a "special"
+// interface whose type registered a STUB_TYPE_CAPTURE_START handler (see
+// "registerInterfaceStub()"), which is then called with the rest of the
+// arguments.
+//
+// Returns '0' if that is not the case (and thus the interface must be captured
+// as a regular one, with libpcap), '1' if the capture was started and '2' if it
+// could not be started.
+//
+INT8U startSpecialInterfaceCapture(char *interface_name, INT8U queue_id, INT8U *interface_mac_address, INT8U *al_mac_address);
+
 #endif
 
@@ -0,0 +1,496 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#include "platform.h"
+#include "platform_interfaces.h"                // struct interfaceInfo
+#include "platform_interfaces_priv.h"           // registerInterfaceStub
+#include "platform_interfaces_replay_priv.h"
+#include "platform_os_priv.h"                   // sendPacketToAlQueue(), frameIsForAlEntity()
+
+#include <stdio.h>       // snprintf()
+#include <stdlib.h>      // malloc()
+#include <string.h>      // strtok_r()
+#include <errno.h>       // errno
+#include <time.h>        // clock_gettime(), clock_nanosleep()
+#include <sys/time.h>    // gettimeofday()
+#include <pthread.h>     // threads and mutexes
+#include <pcap/pcap.h>   // pcap_*() functions
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Private data and functions
+////////////////////////////////////////////////////////////////////////////////
+
+// A "replay" interface receives the frames contained in a capture file (pcap
+// or pcapng) instead of those of a real network device, and (optionally)
+// writes the frames the AL entity sends on it to another capture file.
+//
+// This makes it possible to reproduce (and benchmark, see the 'drs' ALME
+// custom command) how the AL entity processes some traffic recorded in the
+// field, without the devices that generated it.
+//
+struct _replayInterface
+{
+    char           *interface_name;
+
+    INT8U           mac_address[6];
+    char           *input_filename;
+    char           *output_filename;  // NULL if transmitted frames are not
+                                      // saved
+    INT8U           timed;            // '1' to keep the original timing, '0'
+                                      // to inject frames as fast as possible
+
+    pcap_t         *output;           // Opened the first time a frame is sent
+    pcap_dumper_t  *dumper;
+
+    INT32U          tx_frames;
+};
+
+// All the above structures are protected by this mutex: the AL main thread
+// sends frames while replay threads flush the output files.
+//
+static pthread_mutex_t           replay_mutex         = PTHREAD_MUTEX_INITIALIZER;
+static struct _replayInterface **replay_interfaces    = NULL;
+static int                       replay_interfaces_nr = 0;
+
+// Return the replay interface 'interface_name', creating it (from the contents
+// of 'replay_extended_params') if this is the first time it is needed.
+//
+// 'replay_extended_params' has the following format:
+//
+//   replay:<mac>:<input_file>[:<output_file>[:timed]]
+//
+// ...where 'mac' is the MAC address reported for the interface (12 hex digits,
+// without separators, just like "ghnspirit" interfaces), 'input_file' is the
+// capture whose frames are received on it and 'output_file' (which can be
+// empty) the one where sent frames are written. When "timed" is present,
+// received frames are spaced as in the original capture (otherwise they are
+// injected as fast as the AL entity can process them).
+//
+// Examples:
+//
+//   replay:00160301851f:eth0.pcapng
+//   replay:00160301851f:eth0.pcapng:eth0_tx.pcap
+//   replay:00160301851f:eth0.pcapng::timed
+//
+// The mutex must be held when calling this function.
+//
+static struct _replayInterface *_getReplayInterface(char *interface_name, char *replay_extended_params)
+{
+    struct _replayInterface *x;
+    char                    *aux;
+    char                    *save_ptr;
+    char                    *mac;
+    char                    *input;
+    char                    *output;
+    char                    *mode;
+    int                      i;
+
+    for (i=0; i<replay_interfaces_nr; i++)
+    {
+        if (0 == strcmp(replay_interfaces[i]->interface_name, interface_name))
+        {
+            return replay_interfaces[i];
+        }
+    }
+
+    // Skip the "replay:" prefix and split the rest (empty fields are allowed,
+    // thus "strtok_r()" can not be used for them)
+    //
+    aux = strdup(replay_extended_params);
+
+    strtok_r(aux, ":", &save_ptr);
+    mac    = strsep(&save_ptr, ":");
+    input  = strsep(&save_ptr, ":");
+    output = strsep(&save_ptr, ":");
+    mode   = strsep(&save_ptr, ":");
+
+    x = (struct _replayInterface *)calloc(1, sizeof(struct _replayInterface));
+
+    if (
+         NULL == mac || 12 != strlen(mac) ||
+         6 != sscanf(mac, "%02hhx%02hhx%02hhx%02hhx%02hhx%02hhx", &x->mac_address[0], &x->mac_address[1], &x->mac_address[2], &x->mac_address[3], &x->mac_address[4], &x->mac_address[5])
+       )
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Missing (or invalid) MAC address in extended params string (%s)\n", replay_extended_params);
+        free(x);
+        free(aux);
+        return NULL;
+    }
+    if (NULL == input || 0x0 == input[0])
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Missing capture file name in extended params string (%s)\n", replay_extended_params);
+        free(x);
+        free(aux);
+        return NULL;
+    }
+    if (NULL != mode && 0 != strcmp(mode, "timed"))
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] Unknown replay mode '%s'. Frames will be injected as fast as possible\n", mode);
+    }
+
+    x->interface_name  = strdup(interface_name);
+    x->input_filename  = strdup(input);
+    x->output_filename = NULL == output || 0x0 == output[0] ? NULL : strdup(output);
+    x->timed           = NULL != mode && 0 == strcmp(mode, "timed") ? 1 : 0;
+
+    free(aux);
+
+    replay_interfaces = (struct _replayInterface **)realloc(replay_interfaces, sizeof(struct _replayInterface *) * (replay_interfaces_nr + 1));
+    replay_interfaces[replay_interfaces_nr++] = x;
+
+    return x;
+}
+
+struct _replayThreadData
+{
+    struct _replayInterface *x;
+    pcap_t                  *input;
+    INT8U                    queue_id;
+    INT8U                    interface_mac_address[6];
+    INT8U                    al_mac_address[6];
+};
+
+static void *_replayThread(void *p)
+{
+    struct _replayThreadData *aux;
+    struct pcap_pkthdr       *header;
+    const u_char             *frame;
+    struct timeval            first;
+    struct timespec           start;
+    struct timespec           end;
+    INT32U                    frames_nr;
+    INT32U                    injected_nr;
+    INT32U                    elapsed;
+    int                       res;
+
+    aux = (struct _replayThreadData *)p;
+
+    frames_nr   = 0;
+    injected_nr = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    while (1 == (res = pcap_next_ex(aux->input, &header, &frame)))
+    {
+        if (0 == frames_nr)
+        {
+            first = header->ts;
+        }
+        frames_nr++;
+
+        if (aux->x->timed)
+        {
+            struct timespec due;
+            long long       offset_us;
+
+            offset_us = (long long)(header->ts.tv_sec - first.tv_sec) * 1000000 + (header->ts.tv_usec - first.tv_usec);
+            if (offset_us < 0)
+            {
+                offset_us = 0;
+            }
+
+            due          = start;
+            due.tv_sec  += offset_us / 1000000;
+            due.tv_nsec += (offset_us % 1000000) * 1000;
+            if (due.tv_nsec >= 1000000000)
+            {
+                due.tv_sec++;
+                due.tv_nsec -= 1000000000;
+            }
+
+            while (EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL));
+        }
+
+        if (header->caplen != header->len || header->caplen > MAX_NETWORK_SEGMENT_SIZE)
+        {
+            // Truncated (or too big) frame
+            //
+            continue;
+        }
+
+        if (!frameIsForAlEntity((INT8U *)frame, (INT16U)header->caplen, aux->interface_mac_address, aux->al_mac_address))
+        {
+            continue;
+        }
+
+        // When the queue is full this call blocks, thus frames are injected
+        // as fast as the AL entity is able to process them
+        //
+        if (0 == sendPacketToAlQueue(aux->queue_id, aux->interface_mac_address, (INT8U *)frame, (INT16U)header->caplen))
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *Replay thread* Error sending message to queue from _replayThread()\n");
+            continue;
+        }
+        injected_nr++;
+    }
+
+    if (-1 == res)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *Replay thread* Error reading %s: %s\n", aux->x->input_filename, pcap_geterr(aux->input));
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed = (INT32U)((end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000);
+
+    PLATFORM_PRINTF_DEBUG_INFO("[PLATFORM] Replay of %s on interface %s finished: %d frames read, %d injected in %d ms (%d frames/s)\n",
+                               aux->x->input_filename, aux->x->interface_name, frames_nr, injected_nr, elapsed,
+                               0 == elapsed ? 0 : (INT32U)(((unsigned long long)injected_nr * 1000) / elapsed));
+
+    // Let whoever is waiting for the output file see all frames sent so far
+    //
+    pthread_mutex_lock(&replay_mutex);
+    if (NULL != aux->x->dumper)
+    {
+        pcap_dump_flush(aux->x->dumper);
+    }
+    pthread_mutex_unlock(&replay_mutex);
+
+    pcap_close(aux->input);
+    free(aux);
+
+    return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Stub handlers (see "registerInterfaceStub()")
+////////////////////////////////////////////////////////////////////////////////
+
+void _getInterfaceInfoFromReplay(char *interface_name, char *replay_extended_params, struct interfaceInfo *m)
+{
+    struct _replayInterface *x;
+
+    pthread_mutex_lock(&replay_mutex);
+
+    if (NULL == (x = _getReplayInterface(interface_name, replay_extended_params)))
+    {
+        pthread_mutex_unlock(&replay_mutex);
+        return;
+    }
+
+    memcpy(m->mac_address, x->mac_address, 6);
+
+    snprintf(m->device_name, sizeof(m->device_name), "replay %s", x->input_filename);
+
+    m->interface_type = INTERFACE_TYPE_IEEE_802_3AB_GIGABIT_ETHERNET;
+    m->is_secured     = 1;
+    m->power_state    = INTERFACE_POWER_STATE_ON;
+
+    pthread_mutex_unlock(&replay_mutex);
+
+    return;
+}
+
+// There is no real link behind a replay interface, thus these are arbitrary
+// (but constant) values, except for the number of transmitted frames
+//
+void _getMetricsFromReplay(char *interface_name, char *replay_extended_params, struct linkMetrics *m)
+{
+    struct _replayInterface *x;
+
+    pthread_mutex_lock(&replay_mutex);
+
+    x = _getReplayInterface(interface_name, replay_extended_params);
+
+    m->measures_window      = 0;
+
+    m->tx_packet_ok         = NULL == x ? 0 : x->tx_frames;
+    m->tx_packet_errors     = 0;
+    m->tx_max_xput          = 1000;
+    m->tx_phy_rate          = 1000;
+    m->tx_link_availability = 100;
+
+    m->rx_packet_ok         = 0;
+    m->rx_packet_errors     = 0;
+    m->rx_rssi              = 0xff;
+
+    pthread_mutex_unlock(&replay_mutex);
+
+    return;
+}
+
+void _startPushButtonOnReplay(char *interface_name, __attribute__((unused)) char *replay_extended_params)
+{
+    PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] Push button configuration is not supported on replay interface %s\n", interface_name);
+
+    return;
+}
+
+INT8U _sendFrameOnReplay(char *interface_name, char *replay_extended_params, INT8U *frame, INT16U frame_len)
+{
+    struct _replayInterface *x;
+    struct pcap_pkthdr       header;
+
+    pthread_mutex_lock(&replay_mutex);
+
+    if (NULL == (x = _getReplayInterface(interface_name, replay_extended_params)))
+    {
+        pthread_mutex_unlock(&replay_mutex);
+        return 0;
+    }
+
+    x->tx_frames++;
+
+    if (NULL == x->output_filename)
+    {
+        pthread_mutex_unlock(&replay_mutex);
+        return 1;
+    }
+
+    if (NULL == x->dumper)
+    {
+        x->output = pcap_open_dead(DLT_EN10MB, 65535);
+        x->dumper = NULL == x->output ? NULL : pcap_dump_open(x->output, x->output_filename);
+
+        if (NULL == x->dumper)
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Could not open %s: %s. Sent frames will not be saved\n", x->output_filename, NULL == x->output ? "" : pcap_geterr(x->output));
+
+            if (NULL != x->output)
+            {
+                pcap_close(x->output);
+                x->output = NULL;
+            }
+            free(x->output_filename);
+            x->output_filename = NULL;
+
+            pthread_mutex_unlock(&replay_mutex);
+            return 1;
+        }
+    }
+
+    gettimeofday(&header.ts, NULL);
+    header.caplen = frame_len;
+    header.len    = frame_len;
+
+    pcap_dump((u_char *)x->dumper, &header, frame);
+
+    pthread_mutex_unlock(&replay_mutex);
+
+    return 1;
+}
+
+INT8U _startCaptureOnReplay(char *interface_name, char *replay_extended_params, INT8U queue_id, INT8U *interface_mac_address, INT8U *al_mac_address)
+{
+    struct _replayThreadData *p;
+    struct _replayInterface  *x;
+    pcap_t                   *input;
+    pthread_t                 thread;
+    char                      errbuf[PCAP_ERRBUF_SIZE];
+
+    pthread_mutex_lock(&replay_mutex);
+    x = _getReplayInterface(interface_name, replay_extended_params);
+    pthread_mutex_unlock(&replay_mutex);
+
+    if (NULL == x)
+    {
+        return 0;
+    }
+
+    if (NULL == (input = pcap_open_offline(x->input_filename, errbuf)))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Could not open %s: %s\n", x->input_filename, errbuf);
+        return 0;
+    }
+    if (DLT_EN10MB != pcap_datalink(input))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] %s does not contain ethernet frames\n", x->input_filename);
+        pcap_close(input);
+        return 0;
+    }
+
+    p = (struct _replayThreadData *)malloc(sizeof(struct _replayThreadData));
+    if (NULL == p)
+    {
+        pcap_close(input);
+        return 0;
+    }
+
+    p->x        = x;
+    p->input    = input;
+    p->queue_id = queue_id;
+    memcpy(p->interface_mac_address, interface_mac_address, 6);
+    memcpy(p->al_mac_address,        al_mac_address,        6);
+
+    if (0 != pthread_create(&thread, NULL, _replayThread, (void *)p))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Could not start the replay thread for interface %s\n", interface_name);
+        pcap_close(input);
+        free(p);
+        return 0;
+    }
+    pthread_detach(thread);
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Replaying %s on interface %s\n", x->input_filename, interface_name);
+
+    return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal API: to be used by other platform-specific files (functions
+// declaration is found in "./platform_interfaces_replay_priv.h")
+////////////////////////////////////////////////////////////////////////////////
+
+void registerReplayInterfaceType(void)
+{
+    registerInterfaceStub("replay", STUB_TYPE_GET_INFO,          _getInterfaceInfoFromReplay);
+    registerInterfaceStub("replay", STUB_TYPE_GET_METRICS,       _getMetricsFromReplay);
+    registerInterfaceStub("replay", STUB_TYPE_PUSH_BUTTON_START, _startPushButtonOnReplay);
+    registerInterfaceStub("replay", STUB_TYPE_SEND_FRAME,        _sendFrameOnReplay);
+    registerInterfaceStub("replay", STUB_TYPE_CAPTURE_START,     _startCaptureOnReplay);
+}
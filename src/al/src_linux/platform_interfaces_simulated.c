@@ -60,29 +60,182 @@
 #include "platform_interfaces_priv.h"           // registerInterfaceStub
 #include "platform_interfaces_simulated_priv.h"
 
-#include <stdio.h>    // fopen()
-#include <stdlib.h>   // malloc()
-#include <string.h>   // index()
-#include <errno.h>    // errno
+#include <stdio.h>       // fopen()
+#include <stdlib.h>      // malloc(), bsearch()
+#include <string.h>      // index()
+#include <errno.h>       // errno
+#include <pthread.h>     // mutex functions
+#include <unistd.h>      // read()
+#include <sys/inotify.h> // inotify_*()
 
 
 ////////////////////////////////////////////////////////////////////////////////
 // Private data and functions
 ////////////////////////////////////////////////////////////////////////////////
 
-// Obtain information from the simulated device associated to interface
-// 'interface_name' and fill the 'm' structure.
+// Simulation files are parsed only once (the first time they are needed) into
+// a "description" that is kept in memory. Files are then watched (using
+// inotify) and, when one of them changes, it is parsed again and its
+// description replaced by the new one.
 //
-// The 'simulated_extended_params' is a string with the following format:
+struct _metricsProfile
+{
+    char                 name[32];
+    struct linkMetrics   metrics;
+};
+
+struct _neighborProfile
+{
+    INT8U                mac_address[6];
+    int                  profile;          // Index in 'profiles' or "-1"
+};
+
+struct _simulatedDescription
+{
+    // Contents of a "struct interfaceInfo" filled with the values of the file
+    // (on top of the default ones)
+    //
+    struct interfaceInfo      *info;
+
+    int                        profiles_nr;
+    struct _metricsProfile    *profiles;
+    int                        default_profile; // Index in 'profiles' or "-1"
+
+    // Neighbors with a metrics profile, sorted by MAC address (for
+    // "bsearch()")
+    //
+    int                        neighbors_nr;
+    struct _neighborProfile   *neighbors;
+};
+
+struct _simulationFile
+{
+    char                          *filename;
+    char                          *basename;    // Last component of 'filename'
+    int                            wd;          // inotify watch of its folder
+
+    char                         **interfaces;  // Interfaces using this file
+    int                            interfaces_nr;
+
+    struct _simulatedDescription  *description; // NULL if it could not be
+                                                // parsed (yet)
+};
+
+// All the above structures are protected by this mutex: the AL main thread
+// copies data from the descriptions while the topology monitor thread might
+// be replacing them.
+//
+static pthread_mutex_t          simulation_mutex    = PTHREAD_MUTEX_INITIALIZER;
+static struct _simulationFile **simulation_files    = NULL;
+static int                      simulation_files_nr = 0;
+
+// inotify file descriptor used to watch all simulation files. If someone else
+// polls it (see "simulatedWatchOpen()"), changes are processed as soon as they
+// happen. Otherwise they are processed on the next access to any simulated
+// interface.
+//
+static int   simulation_watch_fd     = -1;
+static INT8U simulation_watch_polled = 0;
+
+static void _freeSimulatedDescription(struct _simulatedDescription *d)
+{
+    if (NULL == d)
+    {
+        return;
+    }
+
+    if (NULL != d->info)
+    {
+        d->info->name = NULL;
+        PLATFORM_FREE_1905_INTERFACE_INFO(d->info);
+    }
+    free(d->profiles);
+    free(d->neighbors);
+    free(d);
+}
+
+// Return the index of the metrics profile called 'name' in 'd' (or "-1" if
+// there is no such profile)
+//
+static int _findMetricsProfile(struct _simulatedDescription *d, char *name)
+{
+    int i;
+
+    for (i=0; i<d->profiles_nr; i++)
+    {
+        if (0 == strcmp(d->profiles[i].name, name))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static int _compareNeighborProfiles(const void *a, const void *b)
+{
+    return memcmp(((struct _neighborProfile *)a)->mac_address, ((struct _neighborProfile *)b)->mac_address, 6);
+}
+
+// Add 'mac_address' to the list of neighbors of 'd' and, if 'profile' is not
+// empty, associate it to that (already defined) metrics profile.
+//
+// Return '0' if the neighbor could not be added (no more neighbors fit in a
+// "struct interfaceInfo"), '1' otherwise.
+//
+static INT8U _addSimulatedNeighbor(struct _simulatedDescription *d, INT8U *mac_address, char *profile)
+{
+    struct interfaceInfo *m;
+
+    m = d->info;
+
+    if (NULL == m->neighbor_mac_addresses)
+    {
+        m->neighbor_mac_addresses_nr = 0;
+    }
+    else if (INTERFACE_NEIGHBORS_UNKNOWN - 1 == m->neighbor_mac_addresses_nr)
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] Too many simulated neighbors. Ignoring the rest of them\n");
+        return 0;
+    }
+    m->neighbor_mac_addresses = (INT8U (*)[6])realloc(m->neighbor_mac_addresses, sizeof(INT8U[6]) * (m->neighbor_mac_addresses_nr + 1));
+
+    memcpy(m->neighbor_mac_addresses[m->neighbor_mac_addresses_nr], mac_address, 6);
+    m->neighbor_mac_addresses_nr++;
+
+    if (0 != profile[0])
+    {
+        int i;
+
+        if (-1 == (i = _findMetricsProfile(d, profile)))
+        {
+            PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] Unknown metrics profile '%s' (profiles must be defined before being used)\n", profile);
+        }
+        else
+        {
+            d->neighbors = (struct _neighborProfile *)realloc(d->neighbors, sizeof(struct _neighborProfile) * (d->neighbors_nr + 1));
+
+            memcpy(d->neighbors[d->neighbors_nr].mac_address, mac_address, 6);
+            d->neighbors[d->neighbors_nr].profile = i;
+            d->neighbors_nr++;
+        }
+    }
+
+    return 1;
+}
+
+// Parse the simulation file 'simulation_filename' and return its description
+// (or NULL if it could not be parsed). The returned structure must be freed
+// with "_freeSimulatedDescription()".
+//
+// Simulation files are given in the 'simulated_extended_params' string of an
+// interface, which has the following format:
 //
 //   simulated:<filename>
 //
 // Example:
 //
-//   ghn_spirit:interface_parameters.txt
-//
-// This function will then open the given file, parse it, and fill the 'm'
-// structure with the data contained in that file.
+//   simulated:interface_parameters.txt
 //
 // Some sample files (to understand the expected syntax) are given next:
 //
@@ -162,10 +315,31 @@
 //   push_button_new_mac_address                   = 00:00:00:00:00:00
 //   power_state                                   = INTERFACE_POWER_STATE_ON
 //
-void _getInterfaceInfoFromSimulatedDevice(__attribute__((unused)) char *interface_name, char *simulated_extended_params, struct interfaceInfo *m)
+// Large or heterogeneous segments can be described with these other keys:
+//
+//   # A metrics profile has a name followed by the values reported for links
+//   # using it, in this order: tx_packet_ok, tx_packet_errors, tx_max_xput,
+//   # tx_phy_rate, tx_link_availability, rx_packet_ok, rx_packet_errors and
+//   # rx_rssi. The one called "default" is used by neighbors without a
+//   # profile.
+//   # Profiles must be defined before the neighbors using them.
+//
+//   metrics_profile                 = default 10 1 120 140 80 1350 9 7
+//   metrics_profile                 = lossy   10 5  20  54 30  200 90 2
+//
+//   # Neighbors (one at a time or, in the case of ranges, 'count' of them
+//   # starting at the given MAC address) can optionally be given a profile
+//
+//   neighbor_mac_address            = 00:10:1a:b3:e4:01 lossy
+//   neighbor_mac_address_range      = 00:10:1a:00:00:00 200
+//   neighbor_mac_address_range      = 00:10:1b:00:00:00 50 lossy
+//
+// NOTE: A single interface cannot report more than 254 neighbors (that is the
+// limit of "struct interfaceInfo"). Extra neighbors are ignored.
+//
+static struct _simulatedDescription *_parseSimulationFile(char *simulation_filename)
 {
     FILE  *fp;
-    char  *simulation_filename;
 
     char   aux1[200];
     char   aux2[200];
@@ -173,20 +347,30 @@ void _getInterfaceInfoFromSimulatedDevice(__attribute__((unused)) char *interfac
     char  *save_ptr1;
     char  *save_ptr2;
 
-    if (NULL == (simulation_filename = index(simulated_extended_params, ':')))
-    {
-        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Missing simulation file name in extended params string (%s)\n", simulated_extended_params);
-        return;
-    }
-    simulation_filename++;
+    struct _simulatedDescription *d;
+    struct interfaceInfo         *m;
 
     if(NULL == (fp = fopen(simulation_filename, "r")))
     {
         PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] fopen('%s') failed with errno=%d (%s)\n", simulation_filename, errno, strerror(errno));
-        return;
+        return NULL;
+    }
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Parsing simulated parameters from file %s\n", simulation_filename);
+
+    d = (struct _simulatedDescription *)calloc(1, sizeof(struct _simulatedDescription));
+    m = (struct interfaceInfo *)calloc(1, sizeof(struct interfaceInfo));
+    if (NULL == d || NULL == m)
+    {
+        free(d);
+        free(m);
+        fclose(fp);
+        return NULL;
     }
+    fillDefaultInterfaceInfo(m);
 
-    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Using simulated parameters from file %s\n", simulation_filename);
+    d->info            = m;
+    d->default_profile = -1;
 
     while (NULL != fgets(aux1, sizeof(aux1), fp))
     {
@@ -559,32 +743,105 @@ void _getInterfaceInfoFromSimulatedDevice(__attribute__((unused)) char *interfac
                     }
                     else
                     {
-                        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] _getInterfaceInfoFromSimulatedDevice(): Invalid format (neighbor_mac_addresses)");
+                        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] _parseSimulationFile(): Invalid format (neighbor_mac_addresses)");
                         fclose(fp);
-                        return;
+                        _freeSimulatedDescription(d);
+                        return NULL;
                     }
                 }
                 else
                 {
-                    if (NULL == m->neighbor_mac_addresses)
+                    INT8U mac_address[6];
+                    char  profile[32];
+
+                    profile[0] = 0x00;
+                    sscanf(value, "%02hhx:%02hhx:%02hhx:%02hhx:%02hhx:%02hhx %31s",
+                            &(mac_address[0]),
+                            &(mac_address[1]),
+                            &(mac_address[2]),
+                            &(mac_address[3]),
+                            &(mac_address[4]),
+                            &(mac_address[5]),
+                            profile);
+
+                    _addSimulatedNeighbor(d, mac_address, profile);
+                }
+            }
+            else if (0 == strcmp(param, "neighbor_mac_address_range"))
+            {
+                INT8U  mac_address[6];
+                int    count;
+                char   profile[32];
+                INT8U  j;
+
+                count      = 0;
+                profile[0] = 0x00;
+                sscanf(value, "%02hhx:%02hhx:%02hhx:%02hhx:%02hhx:%02hhx %d %31s",
+                        &(mac_address[0]),
+                        &(mac_address[1]),
+                        &(mac_address[2]),
+                        &(mac_address[3]),
+                        &(mac_address[4]),
+                        &(mac_address[5]),
+                        &count,
+                        profile);
+
+                while (count-- > 0)
+                {
+                    if (0 == _addSimulatedNeighbor(d, mac_address, profile))
                     {
-                        m->neighbor_mac_addresses_nr = 0;
-                        m->neighbor_mac_addresses    = (INT8U (*)[6])malloc(sizeof(INT8U[6]) * 1);
+                        break;
                     }
-                    else
+
+                    // Next MAC address (the last three bytes are treated as
+                    // a 24 bits counter)
+                    //
+                    for (j=5; j>2; j--)
                     {
-                        m->neighbor_mac_addresses = (INT8U (*)[6])realloc(m->neighbor_mac_addresses, sizeof(INT8U[6]) * (m->neighbor_mac_addresses_nr + 1));
+                        if (0 != ++mac_address[j])
+                        {
+                            break;
+                        }
                     }
+                }
+            }
+            else if (0 == strcmp(param, "metrics_profile"))
+            {
+                struct _metricsProfile  p;
+                struct _metricsProfile *aux;
+                int                     i;
+
+                memset(&p, 0x0, sizeof(p));
+                sscanf(value, "%31s %u %u %hu %hu %hu %u %u %hhu",
+                        p.name,
+                        &p.metrics.tx_packet_ok,
+                        &p.metrics.tx_packet_errors,
+                        &p.metrics.tx_max_xput,
+                        &p.metrics.tx_phy_rate,
+                        &p.metrics.tx_link_availability,
+                        &p.metrics.rx_packet_ok,
+                        &p.metrics.rx_packet_errors,
+                        &p.metrics.rx_rssi);
+
+                p.metrics.measures_window = 120;
+
+                // A profile with the same name as a previous one replaces it
+                //
+                if (-1 == (i = _findMetricsProfile(d, p.name)))
+                {
+                    aux = (struct _metricsProfile *)realloc(d->profiles, sizeof(struct _metricsProfile) * (d->profiles_nr + 1));
+                    if (NULL == aux)
+                    {
+                        continue;
+                    }
+                    d->profiles = aux;
+                    i           = d->profiles_nr++;
+                }
+                memcpy(&d->profiles[i], &p, sizeof(p));
 
-                    sscanf(value, "%02hhx:%02hhx:%02hhx:%02hhx:%02hhx:%02hhx",
-                            &(m->neighbor_mac_addresses[m->neighbor_mac_addresses_nr][0]),
-                            &(m->neighbor_mac_addresses[m->neighbor_mac_addresses_nr][1]),
-                            &(m->neighbor_mac_addresses[m->neighbor_mac_addresses_nr][2]),
-                            &(m->neighbor_mac_addresses[m->neighbor_mac_addresses_nr][3]),
-                            &(m->neighbor_mac_addresses[m->neighbor_mac_addresses_nr][4]),
-                            &(m->neighbor_mac_addresses[m->neighbor_mac_addresses_nr][5]));
-
-                    m->neighbor_mac_addresses_nr++;
+                if (0 == strcmp(p.name, "default"))
+                {
+                    d->default_profile = i;
                 }
             }
             else if (0 == strcmp(param, "ipv4"))
@@ -751,47 +1008,415 @@ void _getInterfaceInfoFromSimulatedDevice(__attribute__((unused)) char *interfac
 
     fclose(fp);
 
-    return;
+    qsort(d->neighbors, d->neighbors_nr, sizeof(struct _neighborProfile), _compareNeighborProfiles);
+
+    return d;
 }
 
-// Fill the metrics structure with simulation data
+// Copy all fields (except for 'name') from 'src' to 'dst', duplicating all the
+// memory they point to, so that 'dst' can later be freed with
+// "PLATFORM_FREE_1905_INTERFACE_INFO()" independently of 'src'
 //
-void _getMetricsFromSimulatedDevice(__attribute__((unused)) char *interface_name, char *simulated_extended_params, struct linkMetrics *m)
+static void _copyInterfaceInfo(struct interfaceInfo *dst, struct interfaceInfo *src)
 {
-    FILE  *fp;
-    char  *simulation_filename;
-   
+    char  *name;
+    INT8U  i;
+
+    name = dst->name;
+    memcpy(dst, src, sizeof(struct interfaceInfo));
+    dst->name = name;
+
+    // NOTE: The conditions used to decide which fields must be duplicated are
+    // the same ones "PLATFORM_FREE_1905_INTERFACE_INFO()" uses to decide which
+    // fields must be freed.
+    //
+    if (INTERFACE_TYPE_UNKNOWN == src->interface_type)
+    {
+        if (
+             !(
+               src->interface_type_data.other.oui[0] == 0x00  &&
+               src->interface_type_data.other.oui[1] == 0x19  &&
+               src->interface_type_data.other.oui[2] == 0xA7  &&
+               NULL != src->interface_type_data.other.generic_phy_description_xml_url &&
+               0 == strcmp("http://handle.itu.int/11.1002/3000/1706", src->interface_type_data.other.generic_phy_description_xml_url) &&
+               (src->interface_type_data.other.variant_index == 1 || src->interface_type_data.other.variant_index == 2 || src->interface_type_data.other.variant_index == 3 || src->interface_type_data.other.variant_index == 4)
+              )
+           )
+        {
+            if (0 != src->interface_type_data.other.media_specific.unsupported.bytes_nr && NULL != src->interface_type_data.other.media_specific.unsupported.bytes)
+            {
+                dst->interface_type_data.other.media_specific.unsupported.bytes = (INT8U *)malloc(src->interface_type_data.other.media_specific.unsupported.bytes_nr);
+                memcpy(dst->interface_type_data.other.media_specific.unsupported.bytes, src->interface_type_data.other.media_specific.unsupported.bytes, src->interface_type_data.other.media_specific.unsupported.bytes_nr);
+            }
+        }
+
+        if (NULL != src->interface_type_data.other.generic_phy_description_xml_url)
+        {
+            dst->interface_type_data.other.generic_phy_description_xml_url = strdup(src->interface_type_data.other.generic_phy_description_xml_url);
+        }
+        if (NULL != src->interface_type_data.other.variant_name)
+        {
+            dst->interface_type_data.other.variant_name = strdup(src->interface_type_data.other.variant_name);
+        }
+    }
+
+    if (src->neighbor_mac_addresses_nr > 0  && INTERFACE_NEIGHBORS_UNKNOWN != src->neighbor_mac_addresses_nr && NULL != src->neighbor_mac_addresses)
+    {
+        dst->neighbor_mac_addresses = (INT8U (*)[6])malloc(sizeof(INT8U[6]) * src->neighbor_mac_addresses_nr);
+        memcpy(dst->neighbor_mac_addresses, src->neighbor_mac_addresses, sizeof(INT8U[6]) * src->neighbor_mac_addresses_nr);
+    }
+
+    if (src->ipv4_nr > 0 && NULL != src->ipv4)
+    {
+        dst->ipv4 = (struct _ipv4 *)malloc(sizeof(struct _ipv4) * src->ipv4_nr);
+        memcpy(dst->ipv4, src->ipv4, sizeof(struct _ipv4) * src->ipv4_nr);
+    }
+
+    if (src->ipv6_nr > 0 && NULL != src->ipv6)
+    {
+        dst->ipv6 = (struct _ipv6 *)malloc(sizeof(struct _ipv6) * src->ipv6_nr);
+        memcpy(dst->ipv6, src->ipv6, sizeof(struct _ipv6) * src->ipv6_nr);
+    }
+
+    if (src->vendor_specific_elements_nr > 0)
+    {
+        dst->vendor_specific_elements = (struct _vendorSpecificInfoElement *)malloc(sizeof(struct _vendorSpecificInfoElement) * src->vendor_specific_elements_nr);
+        memcpy(dst->vendor_specific_elements, src->vendor_specific_elements, sizeof(struct _vendorSpecificInfoElement) * src->vendor_specific_elements_nr);
+
+        for (i=0; i<src->vendor_specific_elements_nr; i++)
+        {
+            if (src->vendor_specific_elements[i].vendor_data_len > 0 && NULL != src->vendor_specific_elements[i].vendor_data)
+            {
+                dst->vendor_specific_elements[i].vendor_data = (INT8U *)malloc(src->vendor_specific_elements[i].vendor_data_len);
+                memcpy(dst->vendor_specific_elements[i].vendor_data, src->vendor_specific_elements[i].vendor_data, src->vendor_specific_elements[i].vendor_data_len);
+            }
+        }
+    }
+}
+
+// Create the inotify file descriptor used to watch all simulation files (if
+// it has not been created yet).
+//
+// The mutex must be held when calling this function.
+//
+static void _openSimulationWatch(void)
+{
+    if (-1 == simulation_watch_fd)
+    {
+        if (-1 == (simulation_watch_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC)))
+        {
+            PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] inotify_init1() failed with errno=%d (%s). Changes in simulation files will be ignored\n", errno, strerror(errno));
+        }
+    }
+}
+
+// Parse again every simulation file that has changed since the last call (as
+// reported by the inotify watch) and replace its description.
+//
+// 'callback' (if not NULL) is then called once for each interface using one
+// of these files.
+//
+static void _processSimulationWatchEvents(void (*callback)(char *interface_name, void *context), void *context)
+{
+    char     buffer[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+    ssize_t  len;
+    char    *ptr;
+
+    if (-1 == simulation_watch_fd)
+    {
+        return;
+    }
+
+    while (0 < (len = read(simulation_watch_fd, buffer, sizeof(buffer))))
+    {
+        for (ptr = buffer; ptr < buffer + len; ptr += sizeof(struct inotify_event) + ((struct inotify_event *)ptr)->len)
+        {
+            struct inotify_event         *event;
+            struct _simulationFile       *f;
+            struct _simulatedDescription *new_description;
+            struct _simulatedDescription *old_description;
+            char                        **interfaces;
+            int                           interfaces_nr;
+            int                           i, j;
+
+            event = (struct inotify_event *)ptr;
+
+            if (0 == event->len)
+            {
+                continue;
+            }
+
+            // Look for the file this event refers to. Entries are never
+            // removed and their 'filename', 'basename' and 'wd' never change,
+            // so they can be used once found even without holding the mutex.
+            //
+            f = NULL;
+            pthread_mutex_lock(&simulation_mutex);
+            for (i=0; i<simulation_files_nr; i++)
+            {
+                if (simulation_files[i]->wd == event->wd && 0 == strcmp(simulation_files[i]->basename, event->name))
+                {
+                    f = simulation_files[i];
+                    break;
+                }
+            }
+            pthread_mutex_unlock(&simulation_mutex);
+
+            if (NULL == f)
+            {
+                continue;
+            }
+
+            PLATFORM_PRINTF_DEBUG_INFO("[PLATFORM] Simulation file %s has changed\n", f->filename);
+
+            // The (slow) parsing is done without holding the mutex...
+            //
+            if (NULL == (new_description = _parseSimulationFile(f->filename)))
+            {
+                PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] Keeping the previous contents of simulation file %s\n", f->filename);
+                continue;
+            }
+
+            // ...and only the swap needs it
+            //
+            pthread_mutex_lock(&simulation_mutex);
+            old_description = f->description;
+            f->description  = new_description;
+            interfaces_nr   = f->interfaces_nr;
+            interfaces      = NULL;
+            if (NULL != callback && interfaces_nr > 0)
+            {
+                interfaces = (char **)malloc(sizeof(char *) * interfaces_nr);
+                memcpy(interfaces, f->interfaces, sizeof(char *) * interfaces_nr);
+            }
+            pthread_mutex_unlock(&simulation_mutex);
+
+            _freeSimulatedDescription(old_description);
+
+            if (NULL != interfaces)
+            {
+                for (j=0; j<interfaces_nr; j++)
+                {
+                    callback(interfaces[j], context);
+                }
+                free(interfaces);
+            }
+        }
+    }
+}
+
+// Call "_processSimulationWatchEvents()" unless someone else is already
+// polling the watch (see "simulatedWatchOpen()")
+//
+static void _processSimulationWatchEventsIfNotPolled(void)
+{
+    INT8U polled;
+
+    pthread_mutex_lock(&simulation_mutex);
+    polled = simulation_watch_polled;
+    pthread_mutex_unlock(&simulation_mutex);
+
+    if (0 == polled)
+    {
+        _processSimulationWatchEvents(NULL, NULL);
+    }
+}
+
+// Return the entry associated to the simulation file given in
+// 'simulated_extended_params' (creating it and parsing the file if this is the
+// first time it is needed) and register 'interface_name' as one of its users.
+//
+// The mutex must be held when calling this function.
+//
+static struct _simulationFile *_getSimulationFile(char *interface_name, char *simulated_extended_params)
+{
+    char                    *simulation_filename;
+    struct _simulationFile  *f;
+    struct _simulationFile **aux;
+    int                      i;
+
     if (NULL == (simulation_filename = index(simulated_extended_params, ':')))
     {
         PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Missing simulation file name in extended params string (%s)\n", simulated_extended_params);
-        return;
+        return NULL;
     }
     simulation_filename++;
 
-    if(NULL == (fp = fopen(simulation_filename, "r")))
+    f = NULL;
+    for (i=0; i<simulation_files_nr; i++)
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] fopen('%s') failed with errno=%d (%s)\n", simulation_filename, errno, strerror(errno));
+        if (0 == strcmp(simulation_files[i]->filename, simulation_filename))
+        {
+            f = simulation_files[i];
+            break;
+        }
+    }
+
+    if (NULL == f)
+    {
+        char *slash;
+
+        f   = (struct _simulationFile *)calloc(1, sizeof(struct _simulationFile));
+        aux = (struct _simulationFile **)realloc(simulation_files, sizeof(struct _simulationFile *) * (simulation_files_nr + 1));
+        if (NULL == f || NULL == aux)
+        {
+            free(f);
+            if (NULL != aux)
+            {
+                simulation_files = aux;
+            }
+            return NULL;
+        }
+        simulation_files = aux;
+
+        f->filename = strdup(simulation_filename);
+        f->wd       = -1;
+
+        // Watch the folder that contains the file (and not the file itself)
+        // so that files which are replaced (instead of modified), as editors
+        // and "_startPushButtonOnSimulatedDevice()" do, keep being watched.
+        //
+        if (NULL == (slash = rindex(f->filename, '/')))
+        {
+            f->basename = strdup(f->filename);
+            if (-1 != simulation_watch_fd)
+            {
+                f->wd = inotify_add_watch(simulation_watch_fd, ".", IN_CLOSE_WRITE | IN_MOVED_TO);
+            }
+        }
+        else
+        {
+            char *folder;
+
+            f->basename = strdup(slash + 1);
+            folder      = strndup(f->filename, slash == f->filename ? 1 : (size_t)(slash - f->filename));
+            if (-1 != simulation_watch_fd)
+            {
+                f->wd = inotify_add_watch(simulation_watch_fd, folder, IN_CLOSE_WRITE | IN_MOVED_TO);
+            }
+            free(folder);
+        }
+
+        simulation_files[simulation_files_nr++] = f;
+    }
+
+    // Files that could not be parsed are retried each time they are needed
+    //
+    if (NULL == f->description)
+    {
+        f->description = _parseSimulationFile(f->filename);
+    }
+
+    for (i=0; i<f->interfaces_nr; i++)
+    {
+        if (0 == strcmp(f->interfaces[i], interface_name))
+        {
+            break;
+        }
+    }
+    if (i == f->interfaces_nr)
+    {
+        char **names;
+
+        names = (char **)realloc(f->interfaces, sizeof(char *) * (f->interfaces_nr + 1));
+        if (NULL != names)
+        {
+            f->interfaces                     = names;
+            f->interfaces[f->interfaces_nr++] = strdup(interface_name);
+        }
+    }
+
+    return f;
+}
+
+// Fill 'm' with the contents of the simulation file associated to interface
+// 'interface_name' (see "_parseSimulationFile()" for its format).
+//
+void _getInterfaceInfoFromSimulatedDevice(char *interface_name, char *simulated_extended_params, struct interfaceInfo *m)
+{
+    struct _simulationFile *f;
+
+    _processSimulationWatchEventsIfNotPolled();
+
+    pthread_mutex_lock(&simulation_mutex);
+
+    _openSimulationWatch();
+
+    f = _getSimulationFile(interface_name, simulated_extended_params);
+    if (NULL != f && NULL != f->description)
+    {
+        _copyInterfaceInfo(m, f->description->info);
+    }
+
+    pthread_mutex_unlock(&simulation_mutex);
+
+    return;
+}
+
+// Fill the metrics structure with simulation data: the values of the metrics
+// profile associated to the neighbor (see "neighbor_mac_address" and
+// "metrics_profile" in "_parseSimulationFile()") or, if there is none, those
+// of the "default" profile or, if there is no such profile either, some
+// arbitrary (but constant) values.
+//
+// NOTE: The caller has already set 'm->neighbor_interface_address'
+//
+void _getMetricsFromSimulatedDevice(char *interface_name, char *simulated_extended_params, struct linkMetrics *m)
+{
+    struct _simulationFile       *f;
+    struct _simulatedDescription *d;
+    struct _neighborProfile       key;
+    struct _neighborProfile      *neighbor;
+    int                           profile;
+
+    _processSimulationWatchEventsIfNotPolled();
+
+    pthread_mutex_lock(&simulation_mutex);
+
+    _openSimulationWatch();
+
+    f = _getSimulationFile(interface_name, simulated_extended_params);
+    if (NULL == f || NULL == (d = f->description))
+    {
+        pthread_mutex_unlock(&simulation_mutex);
         return;
     }
 
-    // TODO: Read these values from the "simulation file" too (instead of just
-    // assigning them some arbitrary value). This way we open the gates to
-    // complex testing scenarios.
+    memcpy(key.mac_address, m->neighbor_interface_address, 6);
 
-    m->measures_window      = 120;
+    neighbor = (struct _neighborProfile *)bsearch(&key, d->neighbors, d->neighbors_nr, sizeof(struct _neighborProfile), _compareNeighborProfiles);
+    profile  = NULL != neighbor ? neighbor->profile : d->default_profile;
 
-    m->tx_packet_ok         = 10;
-    m->tx_packet_errors     = 1;
-    m->tx_max_xput          = 120;
-    m->tx_phy_rate          = 140;
-    m->tx_link_availability = 80;
+    if (-1 != profile)
+    {
+        m->measures_window      = d->profiles[profile].metrics.measures_window;
 
-    m->rx_packet_ok         = 1350;
-    m->rx_packet_errors     = 9;
-    m->rx_rssi              = 7;
+        m->tx_packet_ok         = d->profiles[profile].metrics.tx_packet_ok;
+        m->tx_packet_errors     = d->profiles[profile].metrics.tx_packet_errors;
+        m->tx_max_xput          = d->profiles[profile].metrics.tx_max_xput;
+        m->tx_phy_rate          = d->profiles[profile].metrics.tx_phy_rate;
+        m->tx_link_availability = d->profiles[profile].metrics.tx_link_availability;
 
+        m->rx_packet_ok         = d->profiles[profile].metrics.rx_packet_ok;
+        m->rx_packet_errors     = d->profiles[profile].metrics.rx_packet_errors;
+        m->rx_rssi              = d->profiles[profile].metrics.rx_rssi;
+    }
+    else
+    {
+        m->measures_window      = 120;
 
-    fclose(fp);
+        m->tx_packet_ok         = 10;
+        m->tx_packet_errors     = 1;
+        m->tx_max_xput          = 120;
+        m->tx_phy_rate          = 140;
+        m->tx_link_availability = 80;
+
+        m->rx_packet_ok         = 1350;
+        m->rx_packet_errors     = 9;
+        m->rx_rssi              = 7;
+    }
+
+    pthread_mutex_unlock(&simulation_mutex);
 
     return;
 }
@@ -875,3 +1500,24 @@ void registerSimulatedInterfaceType(void)
 }
 
 
+int simulatedWatchOpen(void)
+{
+    int fd;
+
+    pthread_mutex_lock(&simulation_mutex);
+
+    _openSimulationWatch();
+
+    fd                      = simulation_watch_fd;
+    simulation_watch_polled = -1 == fd ? 0 : 1;
+
+    pthread_mutex_unlock(&simulation_mutex);
+
+    return fd;
+}
+
+void simulatedWatchProcess(void (*callback)(char *interface_name, void *context), void *context)
+{
+    _processSimulationWatchEvents(callback, context);
+}
+
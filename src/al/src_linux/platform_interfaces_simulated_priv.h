@@ -65,4 +65,20 @@
 // 
 void registerSimulatedInterfaceType(void);
 
+// Return the (non blocking) file descriptor that becomes readable when any of
+// the simulation files changes, or "-1" if changes cannot be watched.
+//
+// Once this function has been called, the caller is responsible for calling
+// "simulatedWatchProcess()" each time the file descriptor becomes readable.
+// Otherwise changes are only processed the next time a simulated interface is
+// queried.
+//
+int simulatedWatchOpen(void);
+
+// Parse again all simulation files that have changed and then call 'callback'
+// once for each interface affected by the changes (with 'context' as its
+// second argument)
+//
+void simulatedWatchProcess(void (*callback)(char *interface_name, void *context), void *context);
+
 #endif
@@ -0,0 +1,1171 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#include "platform.h"
+#include "platform_interfaces.h"                // struct interfaceInfo
+#include "platform_interfaces_priv.h"           // registerInterfaceStub
+#include "platform_interfaces_vwire_priv.h"
+#include "platform_os_priv.h"                   // sendPacketToAlQueue(), frameIsForAlEntity()
+
+#include <stdio.h>       // fopen(), getline()
+#include <stdlib.h>      // malloc(), qsort(), bsearch(), realpath()
+#include <string.h>      // strtok_r()
+#include <errno.h>       // errno
+#include <limits.h>      // PATH_MAX
+#include <stddef.h>      // offsetof()
+#include <time.h>        // clock_gettime()
+#include <pthread.h>     // threads, mutexes and conditions
+#include <unistd.h>      // getpid(), ftruncate()
+#include <fcntl.h>       // O_RDWR, O_CREAT
+#include <sys/mman.h>    // shm_open(), mmap()
+#include <sys/socket.h>  // socket(), sendto(), recv()
+#include <sys/un.h>      // struct sockaddr_un
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Private data and functions
+////////////////////////////////////////////////////////////////////////////////
+
+// A "vwire" interface is not backed by any real network device: its frames
+// travel over AF_UNIX datagram sockets to the interfaces of other AL entities
+// (typically other processes on the same host) that share a "link" with it in
+// a topology file.
+//
+// This makes it possible to run hundreds of AL entities (one per process) on a
+// single machine, without root privileges, pcap or "veth" pairs, and with
+// configurable latency, loss and bandwidth on each link.
+//
+// Each link endpoint "<node>/<interface>" is bound to an abstract socket whose
+// name is derived from the (absolute) path of the topology file, so that
+// several simulations can run at the same time as long as they use different
+// files.
+//
+#define VWIRE_SOCKET_PREFIX        "1905vwire"
+#define VWIRE_SOCKET_RCVBUF        (1024*1024)
+
+// Frames that would have to wait more than this time (in milliseconds) for a
+// bandwidth limited link to become free are dropped (as a real interface with
+// a full transmit queue would do)
+//
+#define VWIRE_MAX_QUEUE_DELAY      (1000)
+
+struct _vwireEndpoint
+{
+    char                  *name;            // "<node>/<interface>"
+    INT8U                  mac_address[6];
+};
+
+struct _vwireLink
+{
+    int                   *endpoints;       // Indexes in 'endpoints'
+    int                    endpoints_nr;
+
+    INT32U                 latency;         // Milliseconds
+    INT32U                 loss;            // Lost frames per million
+    INT32U                 bandwidth;       // kbit/s ("0" means "unlimited")
+};
+
+struct _vwireTopology
+{
+    char                  *filename;        // Absolute path
+    INT32U                 hash;            // Used in socket names
+
+    struct _vwireEndpoint *endpoints;       // Sorted by name (for "bsearch()")
+    int                    endpoints_nr;
+
+    struct _vwireLink     *links;
+    int                    links_nr;
+
+    unsigned long long    *busy_until;      // One per link: when the last frame
+                                            // sent on it (from any endpoint, by
+                                            // any process) leaves the wire, in
+                                            // CLOCK_MONOTONIC nanoseconds (see
+                                            // "_mapLinkState()")
+};
+
+struct _vwirePeer
+{
+    int                    link;            // Index in the topology 'links'
+    int                    endpoint;        // Index in the topology 'endpoints'
+};
+
+struct _vwireInterface
+{
+    char                  *interface_name;
+    struct _vwireTopology *topology;
+    int                    endpoint;        // Index in the topology 'endpoints'
+
+    struct _vwirePeer     *peers;           // All endpoints sharing a link with
+    int                    peers_nr;        // this one
+
+    int                    fd;              // Bound to this endpoint
+
+    struct timespec        start;           // For the metrics 'measures_window'
+    INT32U                 tx_ok;
+    INT32U                 tx_lost;
+    INT32U                 rx_ok;
+};
+
+// Frames waiting for their link latency/bandwidth to "elapse" before being
+// delivered, sorted by delivery time
+//
+struct _vwireDelayedFrame
+{
+    struct timespec             due;
+    int                         fd;
+    struct sockaddr_un          to;
+    socklen_t                   to_len;
+    INT16U                      frame_len;
+    struct _vwireDelayedFrame  *next;
+    INT8U                       frame[];
+};
+
+// All the above structures are protected by this mutex: the AL main thread
+// sends frames and queries interfaces while capture threads update counters
+// and the delivery thread consumes the delayed frames list.
+//
+static pthread_mutex_t             vwire_mutex         = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t              vwire_cond;
+static INT8U                       vwire_thread_started = 0;
+
+static struct _vwireTopology     **vwire_topologies    = NULL;
+static int                         vwire_topologies_nr = 0;
+
+static struct _vwireInterface    **vwire_interfaces    = NULL;
+static int                         vwire_interfaces_nr = 0;
+
+static struct _vwireDelayedFrame  *vwire_delayed       = NULL;
+
+static unsigned int                vwire_seed;
+
+static void _timespecAddMicroseconds(struct timespec *t, INT32U us)
+{
+    t->tv_sec  += us / 1000000;
+    t->tv_nsec += (us % 1000000) * 1000;
+    if (t->tv_nsec >= 1000000000)
+    {
+        t->tv_sec++;
+        t->tv_nsec -= 1000000000;
+    }
+}
+
+static int _timespecCompare(struct timespec *a, struct timespec *b)
+{
+    if (a->tv_sec != b->tv_sec)
+    {
+        return a->tv_sec < b->tv_sec ? -1 : 1;
+    }
+    if (a->tv_nsec != b->tv_nsec)
+    {
+        return a->tv_nsec < b->tv_nsec ? -1 : 1;
+    }
+    return 0;
+}
+
+static int _compareEndpoints(const void *a, const void *b)
+{
+    return strcmp(((struct _vwireEndpoint *)a)->name, ((struct _vwireEndpoint *)b)->name);
+}
+
+// Return the index of endpoint 'name' in 't' (or "-1" if there is no such
+// endpoint)
+//
+static int _findEndpoint(struct _vwireTopology *t, char *name)
+{
+    struct _vwireEndpoint  key;
+    struct _vwireEndpoint *e;
+
+    key.name = name;
+
+    e = (struct _vwireEndpoint *)bsearch(&key, t->endpoints, t->endpoints_nr, sizeof(struct _vwireEndpoint), _compareEndpoints);
+
+    return NULL == e ? -1 : (int)(e - t->endpoints);
+}
+
+static void _freeTopology(struct _vwireTopology *t)
+{
+    int i;
+
+    for (i=0; i<t->endpoints_nr; i++)
+    {
+        free(t->endpoints[i].name);
+    }
+    for (i=0; i<t->links_nr; i++)
+    {
+        free(t->links[i].endpoints);
+    }
+    free(t->endpoints);
+    free(t->links);
+    free(t->filename);
+    free(t);
+}
+
+// Parse the "link" line whose tokens (after the "link" keyword) are retrieved
+// with 'save_ptr' and append it to 't'.
+//
+// Return '0' if there was a problem, '1' otherwise.
+//
+static INT8U _parseLink(struct _vwireTopology *t, char **save_ptr)
+{
+    struct _vwireLink *l;
+    char              *token;
+    int                i;
+
+    t->links = (struct _vwireLink *)realloc(t->links, sizeof(struct _vwireLink) * (t->links_nr + 1));
+    l        = &t->links[t->links_nr];
+
+    memset(l, 0, sizeof(struct _vwireLink));
+
+    while (NULL != (token = strtok_r(NULL, " \t\n", save_ptr)))
+    {
+        if (0 == strncmp(token, "latency=", strlen("latency=")))
+        {
+            l->latency = strtoul(token + strlen("latency="), NULL, 10);
+        }
+        else if (0 == strncmp(token, "loss=", strlen("loss=")))
+        {
+            l->loss = (INT32U)(strtod(token + strlen("loss="), NULL) * 10000);
+        }
+        else if (0 == strncmp(token, "bandwidth=", strlen("bandwidth=")))
+        {
+            l->bandwidth = strtoul(token + strlen("bandwidth="), NULL, 10);
+        }
+        else if (-1 == (i = _findEndpoint(t, token)))
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Unknown virtual wire endpoint '%s' (endpoints must be declared with the 'endpoint' keyword)\n", token);
+            free(l->endpoints);
+            return 0;
+        }
+        else
+        {
+            l->endpoints = (int *)realloc(l->endpoints, sizeof(int) * (l->endpoints_nr + 1));
+            l->endpoints[l->endpoints_nr++] = i;
+        }
+    }
+
+    if (l->endpoints_nr < 2)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Virtual wire links need at least two endpoints\n");
+        free(l->endpoints);
+        return 0;
+    }
+    if (l->loss > 1000000)
+    {
+        l->loss = 1000000;
+    }
+
+    t->links_nr++;
+
+    return 1;
+}
+
+// Parse the topology file 'filename' and return its description (or NULL if it
+// could not be parsed). The returned structure must be freed with
+// "_freeTopology()".
+//
+// Topology files are given in the 'vwire_extended_params' string of an
+// interface, which has the following format:
+//
+//   vwire:<filename>:<node>
+//
+// ...where 'node' is the name given to the AL entity (all the interfaces of
+// one AL entity use the same one). Interface "eth0" of that AL entity is
+// then endpoint "<node>/eth0" of the topology file.
+//
+// Example:
+//
+//   vwire:mesh.txt:n17
+//
+// The file contains one declaration per line ('#' starts a comment). First,
+// all endpoints with the MAC address reported for them:
+//
+//   endpoint n1/eth0  00:16:03:00:01:00
+//   endpoint n1/eth1  00:16:03:00:01:01
+//   endpoint n2/eth0  00:16:03:00:02:00
+//   endpoint n3/eth0  00:16:03:00:03:00
+//
+// ...then the links connecting them. A link with more than two endpoints
+// behaves like a hub (frames sent by one endpoint reach all the others).
+// Optionally, each link can be given a latency (in milliseconds), a loss
+// rate (percentage of frames that never arrive) and a bandwidth (in kbit/s,
+// "0" meaning unlimited):
+//
+//   link n1/eth0 n2/eth0
+//   link n1/eth1 n3/eth0  latency=20 loss=2.5 bandwidth=10000
+//
+// The bandwidth of a link is shared by all its endpoints, even when they
+// belong to different processes (see "_mapLinkState()").
+//
+static struct _vwireTopology *_parseTopologyFile(char *filename)
+{
+    FILE   *fp;
+    char   *line;
+    size_t  line_size;
+    char   *save_ptr;
+    char   *token;
+    INT8U   pass;
+    INT8U   ok;
+
+    struct _vwireTopology *t;
+
+    if (NULL == (fp = fopen(filename, "r")))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] fopen('%s') failed with errno=%d (%s)\n", filename, errno, strerror(errno));
+        return NULL;
+    }
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Parsing virtual wire topology from file %s\n", filename);
+
+    t = (struct _vwireTopology *)calloc(1, sizeof(struct _vwireTopology));
+    if (NULL == t)
+    {
+        fclose(fp);
+        return NULL;
+    }
+
+    line      = NULL;
+    line_size = 0;
+    ok        = 1;
+
+    // Endpoints are collected (and sorted) in a first pass, so that links can
+    // then be resolved in the second one with a binary search.
+    //
+    for (pass=0; pass<2 && ok; pass++)
+    {
+        rewind(fp);
+
+        while (ok && -1 != getline(&line, &line_size, fp))
+        {
+            if (NULL != (token = strchr(line, '#')))
+            {
+                *token = 0x0;
+            }
+
+            if (NULL == (token = strtok_r(line, " \t\n", &save_ptr)))
+            {
+                continue;
+            }
+
+            if (0 == strcmp(token, "endpoint"))
+            {
+                char  *name;
+                char  *mac;
+                INT8U  mac_address[6];
+
+                if (1 == pass)
+                {
+                    continue;
+                }
+
+                name = strtok_r(NULL, " \t\n", &save_ptr);
+                mac  = strtok_r(NULL, " \t\n", &save_ptr);
+
+                if (NULL == name || NULL == mac || 6 != sscanf(mac, "%02hhx:%02hhx:%02hhx:%02hhx:%02hhx:%02hhx", &mac_address[0], &mac_address[1], &mac_address[2], &mac_address[3], &mac_address[4], &mac_address[5]))
+                {
+                    PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Invalid virtual wire endpoint declaration in file %s\n", filename);
+                    ok = 0;
+                    break;
+                }
+
+                t->endpoints = (struct _vwireEndpoint *)realloc(t->endpoints, sizeof(struct _vwireEndpoint) * (t->endpoints_nr + 1));
+
+                t->endpoints[t->endpoints_nr].name = strdup(name);
+                memcpy(t->endpoints[t->endpoints_nr].mac_address, mac_address, 6);
+                t->endpoints_nr++;
+            }
+            else if (0 == strcmp(token, "link"))
+            {
+                if (0 == pass)
+                {
+                    continue;
+                }
+
+                ok = _parseLink(t, &save_ptr);
+            }
+            else
+            {
+                PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Unknown keyword '%s' in file %s\n", token, filename);
+                ok = 0;
+            }
+        }
+
+        if (0 == pass)
+        {
+            qsort(t->endpoints, t->endpoints_nr, sizeof(struct _vwireEndpoint), _compareEndpoints);
+        }
+    }
+
+    free(line);
+    fclose(fp);
+
+    if (!ok)
+    {
+        _freeTopology(t);
+        return NULL;
+    }
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] %d virtual wire endpoints and %d links found in file %s\n", t->endpoints_nr, t->links_nr, filename);
+
+    return t;
+}
+
+// Set 't->busy_until' to the per link state shared by all the processes using
+// topology 't', so that the frames sent from all the endpoints of a link
+// (which usually belong to different AL entities) compete for the same
+// bandwidth.
+//
+// The state lives in a POSIX shared memory object named after the topology
+// hash, created by the first process that needs it. It is not removed when the
+// processes exit (it is tiny, and "busy until" instants in the past are
+// harmless), thus later runs with the same topology file reuse it.
+//
+// If it cannot be shared, each process keeps its own copy (and links are only
+// limited by what each process sends on them).
+//
+static void _mapLinkState(struct _vwireTopology *t)
+{
+    char    name[32];
+    size_t  size;
+    int     fd;
+    void   *p;
+
+    size = sizeof(unsigned long long) * (0 == t->links_nr ? 1 : t->links_nr);
+    p    = MAP_FAILED;
+
+    snprintf(name, sizeof(name), "/" VWIRE_SOCKET_PREFIX "-%08x", t->hash);
+
+    if (-1 == (fd = shm_open(name, O_RDWR | O_CREAT | O_CLOEXEC, 0600)))
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] shm_open('%s') failed with errno=%d (%s)\n", name, errno, strerror(errno));
+    }
+    else
+    {
+        if (-1 == ftruncate(fd, size))
+        {
+            PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] ftruncate('%s') failed with errno=%d (%s)\n", name, errno, strerror(errno));
+        }
+        else if (MAP_FAILED == (p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)))
+        {
+            PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] mmap('%s') failed with errno=%d (%s)\n", name, errno, strerror(errno));
+        }
+        close(fd);
+    }
+
+    if (MAP_FAILED == p)
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] Links bandwidth will not be shared with other processes\n");
+        p = calloc(1, size);
+    }
+
+    t->busy_until = (unsigned long long *)p;
+}
+
+// Reserve a link (whose "busy until" instant is '*busy_until') for as long as
+// it takes to transmit a frame ('duration' nanoseconds), starting when all the
+// frames already reserved have been transmitted (or 'now', if there are
+// none). Other processes might be doing the same at the same time.
+//
+// Return '0' if the link is busy for more than VWIRE_MAX_QUEUE_DELAY (the
+// frame must be dropped), '1' otherwise, in which case the instant at which
+// the frame leaves the wire is returned in '*end'.
+//
+static INT8U _reserveLink(unsigned long long *busy_until, unsigned long long now, unsigned long long duration, unsigned long long *end)
+{
+    unsigned long long old;
+    unsigned long long start;
+
+    old = __atomic_load_n(busy_until, __ATOMIC_RELAXED);
+    do
+    {
+        start = old > now ? old : now;
+
+        if (start - now > (unsigned long long)VWIRE_MAX_QUEUE_DELAY * 1000000)
+        {
+            return 0;
+        }
+
+        *end = start + duration;
+    }
+    while (!__atomic_compare_exchange_n(busy_until, &old, *end, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    return 1;
+}
+
+// Return the (already parsed) topology contained in file 'filename', parsing
+// it if this is the first time it is needed.
+//
+// The mutex must be held when calling this function.
+//
+static struct _vwireTopology *_getTopology(char *filename)
+{
+    char                   path[PATH_MAX];
+    struct _vwireTopology *t;
+    INT8U                 *p;
+    int                    i;
+
+    if (NULL == realpath(filename, path))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] realpath('%s') failed with errno=%d (%s)\n", filename, errno, strerror(errno));
+        return NULL;
+    }
+
+    for (i=0; i<vwire_topologies_nr; i++)
+    {
+        if (0 == strcmp(vwire_topologies[i]->filename, path))
+        {
+            return vwire_topologies[i];
+        }
+    }
+
+    if (NULL == (t = _parseTopologyFile(path)))
+    {
+        return NULL;
+    }
+
+    // FNV-1a hash of the absolute path
+    //
+    t->filename = strdup(path);
+    t->hash     = 2166136261U;
+    for (p = (INT8U *)path; 0x0 != *p; p++)
+    {
+        t->hash = (t->hash ^ *p) * 16777619U;
+    }
+
+    _mapLinkState(t);
+
+    vwire_topologies = (struct _vwireTopology **)realloc(vwire_topologies, sizeof(struct _vwireTopology *) * (vwire_topologies_nr + 1));
+    vwire_topologies[vwire_topologies_nr++] = t;
+
+    return t;
+}
+
+// Fill 'addr' with the (abstract) address of the socket of 'endpoint'
+//
+// Return the length of the address or "0" if the endpoint name is too long.
+//
+static socklen_t _endpointAddress(struct _vwireTopology *t, int endpoint, struct sockaddr_un *addr)
+{
+    int len;
+
+    memset(addr, 0, sizeof(struct sockaddr_un));
+    addr->sun_family = AF_UNIX;
+
+    len = snprintf(addr->sun_path + 1, sizeof(addr->sun_path) - 1, VWIRE_SOCKET_PREFIX ":%08x:%s", t->hash, t->endpoints[endpoint].name);
+    if (len < 0 || len >= (int)sizeof(addr->sun_path) - 1)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Virtual wire endpoint name too long (%s)\n", t->endpoints[endpoint].name);
+        return 0;
+    }
+
+    return (socklen_t)(offsetof(struct sockaddr_un, sun_path) + 1 + len);
+}
+
+// Return the virtual wire interface 'interface_name', creating it (and binding
+// its socket) if this is the first time it is needed.
+//
+// The mutex must be held when calling this function.
+//
+static struct _vwireInterface *_getVirtualWireInterface(char *interface_name, char *vwire_extended_params)
+{
+    struct _vwireInterface *x;
+    struct _vwireTopology  *t;
+    struct sockaddr_un      addr;
+    socklen_t               addr_len;
+    char                   *filename;
+    char                   *node;
+    char                   *endpoint_name;
+    int                     endpoint;
+    int                     rcvbuf;
+    int                     i, j;
+
+    for (i=0; i<vwire_interfaces_nr; i++)
+    {
+        if (0 == strcmp(vwire_interfaces[i]->interface_name, interface_name))
+        {
+            return vwire_interfaces[i];
+        }
+    }
+
+    // 'vwire_extended_params' is "vwire:<filename>:<node>"
+    //
+    if (
+         NULL == (filename = strchr(vwire_extended_params, ':'))                           ||
+         NULL == (node     = strrchr(vwire_extended_params, ':'))                          ||
+         filename == node
+       )
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Missing topology file name or node name in extended params string (%s)\n", vwire_extended_params);
+        return NULL;
+    }
+
+    filename = strndup(filename + 1, node - filename - 1);
+    node++;
+
+    t = _getTopology(filename);
+    free(filename);
+
+    if (NULL == t)
+    {
+        return NULL;
+    }
+
+    endpoint_name = (char *)malloc(strlen(node) + 1 + strlen(interface_name) + 1);
+    sprintf(endpoint_name, "%s/%s", node, interface_name);
+
+    endpoint = _findEndpoint(t, endpoint_name);
+    if (-1 == endpoint)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Virtual wire endpoint '%s' not found in file %s\n", endpoint_name, t->filename);
+        free(endpoint_name);
+        return NULL;
+    }
+    free(endpoint_name);
+
+    if (0 == (addr_len = _endpointAddress(t, endpoint, &addr)))
+    {
+        return NULL;
+    }
+
+    x = (struct _vwireInterface *)calloc(1, sizeof(struct _vwireInterface));
+    if (NULL == x)
+    {
+        return NULL;
+    }
+
+    x->interface_name = strdup(interface_name);
+    x->topology       = t;
+    x->endpoint       = endpoint;
+
+    for (i=0; i<t->links_nr; i++)
+    {
+        for (j=0; j<t->links[i].endpoints_nr; j++)
+        {
+            if (endpoint == t->links[i].endpoints[j])
+            {
+                break;
+            }
+        }
+        if (j == t->links[i].endpoints_nr)
+        {
+            continue;
+        }
+
+        for (j=0; j<t->links[i].endpoints_nr; j++)
+        {
+            if (endpoint == t->links[i].endpoints[j])
+            {
+                continue;
+            }
+            x->peers = (struct _vwirePeer *)realloc(x->peers, sizeof(struct _vwirePeer) * (x->peers_nr + 1));
+            x->peers[x->peers_nr].link     = i;
+            x->peers[x->peers_nr].endpoint = t->links[i].endpoints[j];
+            x->peers_nr++;
+        }
+    }
+
+    if (-1 == (x->fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0)))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] socket() failed with errno=%d (%s)\n", errno, strerror(errno));
+    }
+    else if (-1 == bind(x->fd, (struct sockaddr *)&addr, addr_len))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] bind('%s') failed with errno=%d (%s). Is another AL entity using the same endpoint?\n", t->endpoints[endpoint].name, errno, strerror(errno));
+        close(x->fd);
+        x->fd = -1;
+    }
+    else
+    {
+        rcvbuf = VWIRE_SOCKET_RCVBUF;
+        setsockopt(x->fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    }
+
+    if (-1 == x->fd)
+    {
+        free(x->peers);
+        free(x->interface_name);
+        free(x);
+        return NULL;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &x->start);
+
+    vwire_interfaces = (struct _vwireInterface **)realloc(vwire_interfaces, sizeof(struct _vwireInterface *) * (vwire_interfaces_nr + 1));
+    vwire_interfaces[vwire_interfaces_nr++] = x;
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Interface %s is virtual wire endpoint %s (%d peers)\n", interface_name, t->endpoints[endpoint].name, x->peers_nr);
+
+    return x;
+}
+
+// Thread that delivers the frames of the delayed list once their time comes
+//
+static void *_vwireDeliveryThread(__attribute__((unused)) void *p)
+{
+    struct _vwireDelayedFrame *d;
+    struct timespec            now;
+
+    pthread_mutex_lock(&vwire_mutex);
+
+    while (1)
+    {
+        if (NULL == vwire_delayed)
+        {
+            pthread_cond_wait(&vwire_cond, &vwire_mutex);
+            continue;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+
+        if (_timespecCompare(&vwire_delayed->due, &now) > 0)
+        {
+            pthread_cond_timedwait(&vwire_cond, &vwire_mutex, &vwire_delayed->due);
+            continue;
+        }
+
+        d             = vwire_delayed;
+        vwire_delayed = d->next;
+
+        pthread_mutex_unlock(&vwire_mutex);
+
+        // Receivers that are not running (or too busy) simply lose the frame
+        //
+        sendto(d->fd, d->frame, d->frame_len, MSG_DONTWAIT, (struct sockaddr *)&d->to, d->to_len);
+        free(d);
+
+        pthread_mutex_lock(&vwire_mutex);
+    }
+
+    return NULL;
+}
+
+// Insert a copy of 'frame' in the delayed list, to be sent to 'to' (from 'fd')
+// at 'due' time.
+//
+// The mutex must be held when calling this function.
+//
+static INT8U _queueDelayedFrame(int fd, struct sockaddr_un *to, socklen_t to_len, struct timespec *due, INT8U *frame, INT16U frame_len)
+{
+    struct _vwireDelayedFrame  *d;
+    struct _vwireDelayedFrame **p;
+
+    if (!vwire_thread_started)
+    {
+        pthread_condattr_t  attr;
+        pthread_t           thread;
+
+        pthread_condattr_init(&attr);
+        pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+        pthread_cond_init(&vwire_cond, &attr);
+        pthread_condattr_destroy(&attr);
+
+        if (0 != pthread_create(&thread, NULL, _vwireDeliveryThread, NULL))
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Could not start the virtual wire delivery thread\n");
+            return 0;
+        }
+        pthread_detach(thread);
+
+        vwire_thread_started = 1;
+    }
+
+    d = (struct _vwireDelayedFrame *)malloc(sizeof(struct _vwireDelayedFrame) + frame_len);
+    if (NULL == d)
+    {
+        return 0;
+    }
+
+    d->due       = *due;
+    d->fd        = fd;
+    d->to        = *to;
+    d->to_len    = to_len;
+    d->frame_len = frame_len;
+    memcpy(d->frame, frame, frame_len);
+
+    // Frames with the same due time keep their sending order
+    //
+    for (p = &vwire_delayed; NULL != *p && _timespecCompare(&(*p)->due, due) <= 0; p = &(*p)->next);
+
+    d->next = *p;
+    *p      = d;
+
+    if (vwire_delayed == d)
+    {
+        pthread_cond_signal(&vwire_cond);
+    }
+
+    return 1;
+}
+
+struct _vwireCaptureThreadData
+{
+    struct _vwireInterface *x;
+    INT8U                   queue_id;
+    INT8U                   interface_mac_address[6];
+    INT8U                   al_mac_address[6];
+};
+
+static void *_vwireCaptureThread(void *p)
+{
+    struct _vwireCaptureThreadData *aux;
+    INT8U                           frame[MAX_NETWORK_SEGMENT_SIZE];
+    ssize_t                         len;
+
+    aux = (struct _vwireCaptureThreadData *)p;
+
+    while (1)
+    {
+        if (-1 == (len = recv(aux->x->fd, frame, sizeof(frame), 0)))
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *Virtual wire thread* recv() failed with errno=%d (%s)\n", errno, strerror(errno));
+            break;
+        }
+
+        if (!frameIsForAlEntity(frame, (INT16U)len, aux->interface_mac_address, aux->al_mac_address))
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&vwire_mutex);
+        aux->x->rx_ok++;
+        pthread_mutex_unlock(&vwire_mutex);
+
+        if (0 == sendPacketToAlQueue(aux->queue_id, aux->interface_mac_address, frame, (INT16U)len))
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *Virtual wire thread* Error sending message to queue from _vwireCaptureThread()\n");
+        }
+    }
+
+    free(aux);
+
+    return NULL;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// Stub handlers (see "registerInterfaceStub()")
+////////////////////////////////////////////////////////////////////////////////
+
+void _getInterfaceInfoFromVirtualWire(char *interface_name, char *vwire_extended_params, struct interfaceInfo *m)
+{
+    struct _vwireInterface *x;
+    struct _vwireTopology  *t;
+    int                     i;
+
+    pthread_mutex_lock(&vwire_mutex);
+
+    if (NULL == (x = _getVirtualWireInterface(interface_name, vwire_extended_params)))
+    {
+        pthread_mutex_unlock(&vwire_mutex);
+        return;
+    }
+    t = x->topology;
+
+    memcpy(m->mac_address, t->endpoints[x->endpoint].mac_address, 6);
+
+    snprintf(m->device_name, sizeof(m->device_name), "vwire %s", t->endpoints[x->endpoint].name);
+
+    m->interface_type = INTERFACE_TYPE_IEEE_802_3AB_GIGABIT_ETHERNET;
+    m->is_secured     = 1;
+    m->power_state    = INTERFACE_POWER_STATE_ON;
+
+    // Neighbors are all the other endpoints of the links this one belongs to
+    // (which can't be more than what fits in a "struct interfaceInfo")
+    //
+    m->neighbor_mac_addresses_nr = x->peers_nr < INTERFACE_NEIGHBORS_UNKNOWN ? x->peers_nr : INTERFACE_NEIGHBORS_UNKNOWN - 1;
+    m->neighbor_mac_addresses    = NULL;
+    if (m->neighbor_mac_addresses_nr > 0)
+    {
+        m->neighbor_mac_addresses = (INT8U (*)[6])malloc(sizeof(INT8U[6]) * m->neighbor_mac_addresses_nr);
+        for (i=0; i<m->neighbor_mac_addresses_nr; i++)
+        {
+            memcpy(m->neighbor_mac_addresses[i], t->endpoints[x->peers[i].endpoint].mac_address, 6);
+        }
+    }
+
+    pthread_mutex_unlock(&vwire_mutex);
+
+    return;
+}
+
+// Fill the metrics structure with the configured link parameters and the
+// frame counters of the interface (which are not kept per neighbor)
+//
+// NOTE: The caller has already set 'm->neighbor_interface_address'
+//
+void _getMetricsFromVirtualWire(char *interface_name, char *vwire_extended_params, struct linkMetrics *m)
+{
+    struct _vwireInterface *x;
+    struct _vwireTopology  *t;
+    struct _vwireLink      *l;
+    struct timespec         now;
+    INT32U                  mbps;
+    int                     i;
+
+    pthread_mutex_lock(&vwire_mutex);
+
+    if (NULL == (x = _getVirtualWireInterface(interface_name, vwire_extended_params)))
+    {
+        pthread_mutex_unlock(&vwire_mutex);
+        return;
+    }
+    t = x->topology;
+    l = NULL;
+
+    for (i=0; i<x->peers_nr; i++)
+    {
+        if (0 == memcmp(t->endpoints[x->peers[i].endpoint].mac_address, m->neighbor_interface_address, 6))
+        {
+            l = &t->links[x->peers[i].link];
+            break;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    m->measures_window      = now.tv_sec - x->start.tv_sec;
+
+    m->tx_packet_ok         = x->tx_ok;
+    m->tx_packet_errors     = x->tx_lost;
+    m->rx_packet_ok         = x->rx_ok;
+    m->rx_packet_errors     = 0;
+    m->rx_rssi              = 0xff;
+
+    mbps                    = NULL == l || 0 == l->bandwidth ? 1000 : l->bandwidth / 1000;
+    mbps                    = mbps > 0xffff ? 0xffff : mbps;
+
+    m->tx_max_xput          = mbps;
+    m->tx_phy_rate          = mbps;
+    m->tx_link_availability = NULL == l ? 100 : 100 - l->loss / 10000;
+
+    pthread_mutex_unlock(&vwire_mutex);
+
+    return;
+}
+
+void _startPushButtonOnVirtualWire(char *interface_name, __attribute__((unused)) char *vwire_extended_params)
+{
+    // Virtual wires are always "secured" (see
+    // "_getInterfaceInfoFromVirtualWire()"), thus there is nothing to do
+    //
+    PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] Push button configuration is not supported on virtual wire interface %s\n", interface_name);
+
+    return;
+}
+
+INT8U _sendFrameOnVirtualWire(char *interface_name, char *vwire_extended_params, INT8U *frame, INT16U frame_len)
+{
+    struct _vwireInterface *x;
+    struct _vwireTopology  *t;
+    struct _vwireLink      *l;
+    struct sockaddr_un      to;
+    socklen_t               to_len;
+    struct timespec         now;
+    struct timespec         due;
+    unsigned long long      now_ns;
+    unsigned long long      sent_ns;
+    INT8U                   sent;
+    int                     link;
+    int                     i;
+
+    pthread_mutex_lock(&vwire_mutex);
+
+    if (NULL == (x = _getVirtualWireInterface(interface_name, vwire_extended_params)))
+    {
+        pthread_mutex_unlock(&vwire_mutex);
+        return 0;
+    }
+    t = x->topology;
+
+    if (0 == vwire_seed)
+    {
+        vwire_seed = (unsigned int)getpid() ^ (unsigned int)time(NULL);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    now_ns = (unsigned long long)now.tv_sec * 1000000000 + now.tv_nsec;
+
+    // Like a hub, every peer gets a copy of the frame (it is up to them to
+    // discard the ones which are not addressed to them)
+    //
+    link    = -1;
+    sent    = 0;
+    sent_ns = now_ns;
+    for (i=0; i<x->peers_nr; i++)
+    {
+        l = &t->links[x->peers[i].link];
+
+        // The frame leaves the wire once all previous frames sent on the link
+        // (by any of its endpoints) and itself have been transmitted at the
+        // link bandwidth. It is transmitted once per link: the peers of the
+        // same link are contiguous and all of them share that instant.
+        //
+        if (link != x->peers[i].link)
+        {
+            link    = x->peers[i].link;
+            sent    = 1;
+            sent_ns = now_ns;
+
+            if (0 != l->bandwidth)
+            {
+                sent = _reserveLink(&t->busy_until[link], now_ns, ((unsigned long long)frame_len * 8 * 1000000) / l->bandwidth, &sent_ns);
+            }
+        }
+        if (0 == sent)
+        {
+            x->tx_lost++;
+            continue;
+        }
+
+        if (0 == (to_len = _endpointAddress(t, x->peers[i].endpoint, &to)))
+        {
+            x->tx_lost++;
+            continue;
+        }
+
+        if (0 != l->loss && (INT32U)(rand_r(&vwire_seed) % 1000000) < l->loss)
+        {
+            x->tx_lost++;
+            continue;
+        }
+
+        // ...and arrives after the link latency
+        //
+        due.tv_sec  = sent_ns / 1000000000;
+        due.tv_nsec = sent_ns % 1000000000;
+        _timespecAddMicroseconds(&due, l->latency * 1000);
+
+        if (_timespecCompare(&due, &now) <= 0)
+        {
+            if (-1 == sendto(x->fd, frame, frame_len, MSG_DONTWAIT, (struct sockaddr *)&to, to_len))
+            {
+                // The peer is not running (ECONNREFUSED) or it is not keeping
+                // up (EAGAIN): the frame is lost
+                //
+                x->tx_lost++;
+                continue;
+            }
+        }
+        else if (0 == _queueDelayedFrame(x->fd, &to, to_len, &due, frame, frame_len))
+        {
+            x->tx_lost++;
+            continue;
+        }
+
+        x->tx_ok++;
+    }
+
+    pthread_mutex_unlock(&vwire_mutex);
+
+    return 1;
+}
+
+INT8U _startCaptureOnVirtualWire(char *interface_name, char *vwire_extended_params, INT8U queue_id, INT8U *interface_mac_address, INT8U *al_mac_address)
+{
+    struct _vwireCaptureThreadData *p;
+    struct _vwireInterface         *x;
+    pthread_t                       thread;
+
+    pthread_mutex_lock(&vwire_mutex);
+    x = _getVirtualWireInterface(interface_name, vwire_extended_params);
+    pthread_mutex_unlock(&vwire_mutex);
+
+    if (NULL == x)
+    {
+        return 0;
+    }
+
+    p = (struct _vwireCaptureThreadData *)malloc(sizeof(struct _vwireCaptureThreadData));
+    if (NULL == p)
+    {
+        return 0;
+    }
+
+    p->x        = x;
+    p->queue_id = queue_id;
+    memcpy(p->interface_mac_address, interface_mac_address, 6);
+    memcpy(p->al_mac_address,        al_mac_address,        6);
+
+    if (0 != pthread_create(&thread, NULL, _vwireCaptureThread, (void *)p))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Could not start the virtual wire capture thread for interface %s\n", interface_name);
+        free(p);
+        return 0;
+    }
+    pthread_detach(thread);
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Capturing frames on virtual wire interface %s\n", interface_name);
+
+    return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal API: to be used by other platform-specific files (functions
+// declaration is found in "./platform_interfaces_vwire_priv.h")
+////////////////////////////////////////////////////////////////////////////////
+
+void registerVirtualWireInterfaceType(void)
+{
+    registerInterfaceStub("vwire", STUB_TYPE_GET_INFO,          _getInterfaceInfoFromVirtualWire);
+    registerInterfaceStub("vwire", STUB_TYPE_GET_METRICS,       _getMetricsFromVirtualWire);
+    registerInterfaceStub("vwire", STUB_TYPE_PUSH_BUTTON_START, _startPushButtonOnVirtualWire);
+    registerInterfaceStub("vwire", STUB_TYPE_SEND_FRAME,        _sendFrameOnVirtualWire);
+    registerInterfaceStub("vwire", STUB_TYPE_CAPTURE_START,     _startCaptureOnVirtualWire);
+}
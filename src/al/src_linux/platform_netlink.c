@@ -0,0 +1,773 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#include "platform.h"
+#include "platform_interfaces.h"
+#include "platform_netlink_priv.h"
+
+#include <stdlib.h>               // malloc(), realloc(), free()
+#include <string.h>               // memcpy(), memcmp(), strncpy()
+#include <errno.h>                // errno
+#include <unistd.h>               // close()
+#include <pthread.h>              // mutex functions
+#include <sys/socket.h>           // socket(), bind(), send(), recv()
+#include <linux/netlink.h>        // NLMSG_*, sockaddr_nl
+#include <linux/rtnetlink.h>      // RTM_*, RTMGRP_*, ifinfomsg, ifaddrmsg
+#include <arpa/inet.h>            // AF_INET, AF_INET6
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Private data and functions
+////////////////////////////////////////////////////////////////////////////////
+
+// One entry for each link reported by the kernel (not only the 1905 ones, as
+// the bridges they belong to must also be tracked)
+//
+struct _netlinkLink
+{
+    int            ifindex;
+    char           name[IFNAMSIZ];
+    INT32U         flags;            // IFF_* flags
+    INT8U          mac_address[6];
+    INT32U         mtu;
+    int            master;           // 'ifindex' of the bridge this link
+                                     // belongs to (0 if none)
+    INT8U          is_bridge;
+
+    INT8U          ipv4_nr;
+    struct _ipv4  *ipv4;
+    INT8U          ipv6_nr;
+    struct _ipv6  *ipv6;
+};
+
+static pthread_mutex_t      netlink_mutex    = PTHREAD_MUTEX_INITIALIZER;
+static INT8U                netlink_loaded   = 0;
+static int                  netlink_links_nr = 0;
+static struct _netlinkLink *netlink_links    = NULL;
+static INT32U               netlink_seq      = 0;
+
+// Names of the links that have changed while processing a batch of messages
+// (duplicates are not added)
+//
+struct _netlinkChanges
+{
+    int    names_nr;
+    char (*names)[IFNAMSIZ];
+};
+
+#define NETLINK_BUFFER_SIZE  (32*1024)
+
+static void _netlinkAddChange(struct _netlinkChanges *c, char *name)
+{
+    int i;
+
+    if (NULL == c)
+    {
+        return;
+    }
+
+    for (i=0; i<c->names_nr; i++)
+    {
+        if (0 == strncmp(c->names[i], name, IFNAMSIZ))
+        {
+            return;
+        }
+    }
+
+    c->names = realloc(c->names, sizeof(*c->names) * (c->names_nr + 1));
+    strncpy(c->names[c->names_nr], name, IFNAMSIZ-1);
+    c->names[c->names_nr][IFNAMSIZ-1] = 0x0;
+    c->names_nr++;
+}
+
+// Add 'l' and (if it is a bridge) all the links that belong to it
+//
+static void _netlinkAddChangeWithMembers(struct _netlinkChanges *c, struct _netlinkLink *l)
+{
+    int i;
+
+    _netlinkAddChange(c, l->name);
+
+    if (l->is_bridge)
+    {
+        for (i=0; i<netlink_links_nr; i++)
+        {
+            if (netlink_links[i].master == l->ifindex)
+            {
+                _netlinkAddChange(c, netlink_links[i].name);
+            }
+        }
+    }
+}
+
+static struct _netlinkLink *_netlinkFindByIndex(int ifindex)
+{
+    int i;
+
+    for (i=0; i<netlink_links_nr; i++)
+    {
+        if (netlink_links[i].ifindex == ifindex)
+        {
+            return &netlink_links[i];
+        }
+    }
+    return NULL;
+}
+
+static struct _netlinkLink *_netlinkFindByName(char *name)
+{
+    int i;
+
+    for (i=0; i<netlink_links_nr; i++)
+    {
+        if (0 == strncmp(netlink_links[i].name, name, IFNAMSIZ))
+        {
+            return &netlink_links[i];
+        }
+    }
+    return NULL;
+}
+
+static void _netlinkFreeTable(void)
+{
+    int i;
+
+    for (i=0; i<netlink_links_nr; i++)
+    {
+        free(netlink_links[i].ipv4);
+        free(netlink_links[i].ipv6);
+    }
+    free(netlink_links);
+
+    netlink_links    = NULL;
+    netlink_links_nr = 0;
+}
+
+// Process a RTM_NEWLINK or RTM_DELLINK message
+//
+static void _netlinkProcessLink(struct nlmsghdr *h, struct _netlinkChanges *c)
+{
+    struct ifinfomsg    *ifi;
+    struct rtattr       *rta;
+    int                  len;
+    struct _netlinkLink  new_link;
+    struct _netlinkLink *l;
+
+    ifi = (struct ifinfomsg *)NLMSG_DATA(h);
+    l   = _netlinkFindByIndex(ifi->ifi_index);
+
+    if (RTM_DELLINK == h->nlmsg_type)
+    {
+        if (NULL != l)
+        {
+            _netlinkAddChange(c, l->name);
+
+            free(l->ipv4);
+            free(l->ipv6);
+
+            *l = netlink_links[netlink_links_nr-1];
+            netlink_links_nr--;
+        }
+        return;
+    }
+
+    memset(&new_link, 0x0, sizeof(new_link));
+    new_link.ifindex = ifi->ifi_index;
+    new_link.flags   = ifi->ifi_flags;
+
+    len = IFLA_PAYLOAD(h);
+    for (rta = IFLA_RTA(ifi); RTA_OK(rta, len); rta = RTA_NEXT(rta, len))
+    {
+        switch (rta->rta_type)
+        {
+            case IFLA_IFNAME:
+            {
+                strncpy(new_link.name, (char *)RTA_DATA(rta), IFNAMSIZ-1);
+                break;
+            }
+            case IFLA_ADDRESS:
+            {
+                if (6 == RTA_PAYLOAD(rta))
+                {
+                    memcpy(new_link.mac_address, RTA_DATA(rta), 6);
+                }
+                break;
+            }
+            case IFLA_MTU:
+            {
+                new_link.mtu = *(INT32U *)RTA_DATA(rta);
+                break;
+            }
+            case IFLA_MASTER:
+            {
+                new_link.master = *(int *)RTA_DATA(rta);
+                break;
+            }
+            case IFLA_LINKINFO:
+            {
+                struct rtattr *nested;
+                int            nested_len;
+
+                nested_len = RTA_PAYLOAD(rta);
+                for (nested = (struct rtattr *)RTA_DATA(rta); RTA_OK(nested, nested_len); nested = RTA_NEXT(nested, nested_len))
+                {
+                    if (IFLA_INFO_KIND == nested->rta_type && 0 == strncmp((char *)RTA_DATA(nested), "bridge", RTA_PAYLOAD(nested)))
+                    {
+                        new_link.is_bridge = 1;
+                    }
+                }
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    if (NULL == l)
+    {
+        netlink_links = realloc(netlink_links, sizeof(struct _netlinkLink) * (netlink_links_nr + 1));
+        l             = &netlink_links[netlink_links_nr++];
+
+        *l = new_link;
+        _netlinkAddChange(c, l->name);
+        return;
+    }
+
+    // The kernel sends RTM_NEWLINK messages for many reasons (statistics,
+    // queue changes, ...). Only report those that change something we keep.
+    //
+    if (
+         0 != strncmp(l->name, new_link.name, IFNAMSIZ)                                    ||
+         (l->flags & (IFF_UP | IFF_RUNNING)) != (new_link.flags & (IFF_UP | IFF_RUNNING))  ||
+         0 != memcmp(l->mac_address, new_link.mac_address, 6)                              ||
+         l->mtu       != new_link.mtu                                                      ||
+         l->master    != new_link.master                                                   ||
+         l->is_bridge != new_link.is_bridge
+       )
+    {
+        _netlinkAddChange(c, l->name);
+        _netlinkAddChange(c, new_link.name);
+    }
+
+    new_link.ipv4_nr = l->ipv4_nr;
+    new_link.ipv4    = l->ipv4;
+    new_link.ipv6_nr = l->ipv6_nr;
+    new_link.ipv6    = l->ipv6;
+
+    *l = new_link;
+}
+
+// Process a RTM_NEWADDR or RTM_DELADDR message
+//
+static void _netlinkProcessAddress(struct nlmsghdr *h, struct _netlinkChanges *c)
+{
+    struct ifaddrmsg    *ifa;
+    struct rtattr       *rta;
+    int                  len;
+    struct _netlinkLink *l;
+
+    INT8U   *address;
+    INT8U   *local;
+    INT32U   flags;
+    INT8U    i;
+
+    ifa = (struct ifaddrmsg *)NLMSG_DATA(h);
+    l   = _netlinkFindByIndex(ifa->ifa_index);
+
+    if (NULL == l || (AF_INET != ifa->ifa_family && AF_INET6 != ifa->ifa_family))
+    {
+        return;
+    }
+    if (AF_INET6 == ifa->ifa_family && RT_SCOPE_LINK == ifa->ifa_scope)
+    {
+        return;
+    }
+
+    address = NULL;
+    local   = NULL;
+    flags   = ifa->ifa_flags;
+
+    len = IFA_PAYLOAD(h);
+    for (rta = IFA_RTA(ifa); RTA_OK(rta, len); rta = RTA_NEXT(rta, len))
+    {
+        switch (rta->rta_type)
+        {
+            case IFA_ADDRESS:
+            {
+                address = (INT8U *)RTA_DATA(rta);
+                break;
+            }
+            case IFA_LOCAL:
+            {
+                local = (INT8U *)RTA_DATA(rta);
+                break;
+            }
+            case IFA_FLAGS:
+            {
+                flags = *(INT32U *)RTA_DATA(rta);
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+
+    // In point to point links 'IFA_ADDRESS' is the address of the other end
+    //
+    if (NULL != local)
+    {
+        address = local;
+    }
+    if (NULL == address)
+    {
+        return;
+    }
+
+    if (AF_INET == ifa->ifa_family)
+    {
+        INT8U type;
+
+        if (169 == address[0] && 254 == address[1])
+        {
+            type = IPV4_AUTOIP;
+        }
+        else if (flags & IFA_F_PERMANENT)
+        {
+            type = IPV4_STATIC;
+        }
+        else
+        {
+            // Addresses with a limited lifetime are set by DHCP clients
+            //
+            type = IPV4_DHCP;
+        }
+
+        for (i=0; i<l->ipv4_nr; i++)
+        {
+            if (0 == memcmp(l->ipv4[i].address, address, 4))
+            {
+                break;
+            }
+        }
+
+        if (RTM_DELADDR == h->nlmsg_type)
+        {
+            if (i < l->ipv4_nr)
+            {
+                l->ipv4[i] = l->ipv4[l->ipv4_nr-1];
+                l->ipv4_nr--;
+                _netlinkAddChangeWithMembers(c, l);
+            }
+        }
+        else if (i < l->ipv4_nr)
+        {
+            // Lifetime refreshes also generate RTM_NEWADDR messages
+            //
+            if (l->ipv4[i].type != type)
+            {
+                l->ipv4[i].type = type;
+                _netlinkAddChangeWithMembers(c, l);
+            }
+        }
+        else if (l->ipv4_nr < 0xFF)
+        {
+            l->ipv4 = realloc(l->ipv4, sizeof(struct _ipv4) * (l->ipv4_nr + 1));
+
+            memset(&l->ipv4[l->ipv4_nr], 0x0, sizeof(struct _ipv4));
+            memcpy(l->ipv4[l->ipv4_nr].address, address, 4);
+            l->ipv4[l->ipv4_nr].type = type;
+            l->ipv4_nr++;
+
+            _netlinkAddChangeWithMembers(c, l);
+        }
+    }
+    else
+    {
+        INT8U type;
+
+        // There is no way to know whether a non permanent address was
+        // obtained by SLAAC or DHCPv6
+        //
+        type = (flags & IFA_F_PERMANENT) ? IPV6_STATIC : IPV6_UNKNOWN;
+
+        for (i=0; i<l->ipv6_nr; i++)
+        {
+            if (0 == memcmp(l->ipv6[i].address, address, 16))
+            {
+                break;
+            }
+        }
+
+        if (RTM_DELADDR == h->nlmsg_type)
+        {
+            if (i < l->ipv6_nr)
+            {
+                l->ipv6[i] = l->ipv6[l->ipv6_nr-1];
+                l->ipv6_nr--;
+                _netlinkAddChangeWithMembers(c, l);
+            }
+        }
+        else if (i < l->ipv6_nr)
+        {
+            if (l->ipv6[i].type != type)
+            {
+                l->ipv6[i].type = type;
+                _netlinkAddChangeWithMembers(c, l);
+            }
+        }
+        else if (l->ipv6_nr < 0xFF)
+        {
+            l->ipv6 = realloc(l->ipv6, sizeof(struct _ipv6) * (l->ipv6_nr + 1));
+
+            memset(&l->ipv6[l->ipv6_nr], 0x0, sizeof(struct _ipv6));
+            memcpy(l->ipv6[l->ipv6_nr].address, address, 16);
+            l->ipv6[l->ipv6_nr].type = type;
+            l->ipv6_nr++;
+
+            _netlinkAddChangeWithMembers(c, l);
+        }
+    }
+}
+
+// Process all messages contained in 'buffer'.
+//
+// Return "1" if a "NLMSG_DONE" (or "NLMSG_ERROR") message was found (ie. the
+// end of a dump), "0" otherwise.
+//
+static INT8U _netlinkProcessBuffer(INT8U *buffer, int len, struct _netlinkChanges *c)
+{
+    struct nlmsghdr *h;
+    INT8U            done;
+
+    done = 0;
+
+    pthread_mutex_lock(&netlink_mutex);
+    for (h = (struct nlmsghdr *)buffer; NLMSG_OK(h, (unsigned int)len); h = NLMSG_NEXT(h, len))
+    {
+        switch (h->nlmsg_type)
+        {
+            case NLMSG_DONE:
+            case NLMSG_ERROR:
+            {
+                done = 1;
+                break;
+            }
+            case RTM_NEWLINK:
+            case RTM_DELLINK:
+            {
+                _netlinkProcessLink(h, c);
+                break;
+            }
+            case RTM_NEWADDR:
+            case RTM_DELADDR:
+            {
+                _netlinkProcessAddress(h, c);
+                break;
+            }
+            default:
+            {
+                break;
+            }
+        }
+    }
+    pthread_mutex_unlock(&netlink_mutex);
+
+    return done;
+}
+
+// Ask the kernel for a dump of all links ('type' = RTM_GETLINK) or addresses
+// ('type' = RTM_GETADDR) and process the answer.
+//
+// Return "0" if there was a problem, "1" otherwise
+//
+static INT8U _netlinkDump(int fd, INT16U type)
+{
+    struct
+    {
+        struct nlmsghdr   h;
+        struct ifinfomsg  payload;  // Also big enough for "struct ifaddrmsg"
+    } request;
+
+    static INT8U buffer[NETLINK_BUFFER_SIZE];
+
+    memset(&request, 0x0, sizeof(request));
+    request.h.nlmsg_len   = NLMSG_LENGTH(RTM_GETLINK == type ? sizeof(struct ifinfomsg) : sizeof(struct ifaddrmsg));
+    request.h.nlmsg_type  = type;
+    request.h.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.h.nlmsg_seq   = ++netlink_seq;
+
+    if (0 > send(fd, &request, request.h.nlmsg_len, 0))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] netlink send() returned with errno=%d (%s)\n", errno, strerror(errno));
+        return 0;
+    }
+
+    while (1)
+    {
+        int len;
+
+        len = recv(fd, buffer, sizeof(buffer), 0);
+        if (len < 0)
+        {
+            if (EINTR == errno || ENOBUFS == errno)
+            {
+                // Notifications received while dumping are processed as part
+                // of the dump itself, thus losing some of them is not a
+                // problem here.
+                //
+                continue;
+            }
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] netlink recv() returned with errno=%d (%s)\n", errno, strerror(errno));
+            return 0;
+        }
+
+        if (_netlinkProcessBuffer(buffer, len, NULL))
+        {
+            return 1;
+        }
+    }
+}
+
+// Discard the table and build it again from scratch
+//
+static INT8U _netlinkReload(int fd)
+{
+    pthread_mutex_lock(&netlink_mutex);
+    _netlinkFreeTable();
+    netlink_loaded = 0;
+    pthread_mutex_unlock(&netlink_mutex);
+
+    if (0 == _netlinkDump(fd, RTM_GETLINK) || 0 == _netlinkDump(fd, RTM_GETADDR))
+    {
+        return 0;
+    }
+
+    pthread_mutex_lock(&netlink_mutex);
+    netlink_loaded = 1;
+    pthread_mutex_unlock(&netlink_mutex);
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] netlink table loaded (%d links)\n", netlink_links_nr);
+
+    return 1;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal API: to be used by other platform-specific files (functions
+// declarations can be found in "./platform_netlink_priv.h")
+////////////////////////////////////////////////////////////////////////////////
+
+int netlinkOpen(void)
+{
+    int                 fd;
+    struct sockaddr_nl  addr;
+
+    if (-1 == (fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE)))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] netlink socket() returned with errno=%d (%s)\n", errno, strerror(errno));
+        return -1;
+    }
+
+    memset(&addr, 0x0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+
+    if (-1 == bind(fd, (struct sockaddr *)&addr, sizeof(addr)))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] netlink bind() returned with errno=%d (%s)\n", errno, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    if (0 == _netlinkReload(fd))
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+void netlinkProcess(int fd, void (*callback)(char *interface_name, void *context), void *context)
+{
+    static INT8U buffer[NETLINK_BUFFER_SIZE];
+
+    struct _netlinkChanges changes;
+    int                    i;
+
+    changes.names_nr = 0;
+    changes.names    = NULL;
+
+    while (1)
+    {
+        int len;
+
+        len = recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (len < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            if (ENOBUFS == errno)
+            {
+                // The socket buffer overflowed and some notifications were
+                // lost. The only way to know the current state is to ask for
+                // everything again.
+                //
+                PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] netlink notifications lost. Reloading...\n");
+
+                free(changes.names);
+
+                _netlinkReload(fd);
+                callback(NULL, context);
+                return;
+            }
+
+            // EAGAIN (nothing else to read) or a real error
+            //
+            break;
+        }
+
+        _netlinkProcessBuffer(buffer, len, &changes);
+    }
+
+    for (i=0; i<changes.names_nr; i++)
+    {
+        callback(changes.names[i], context);
+    }
+    free(changes.names);
+}
+
+INT8U netlinkGetLink(char *interface_name, struct netlinkLinkInfo *info)
+{
+    struct _netlinkLink *l;
+    struct _netlinkLink *master;
+
+    pthread_mutex_lock(&netlink_mutex);
+
+    if (0 == netlink_loaded || NULL == (l = _netlinkFindByName(interface_name)))
+    {
+        pthread_mutex_unlock(&netlink_mutex);
+        return 0;
+    }
+
+    info->ifindex    = l->ifindex;
+    info->is_up      = (l->flags & IFF_UP)      ? 1 : 0;
+    info->is_running = (l->flags & IFF_RUNNING) ? 1 : 0;
+    info->mtu        = l->mtu;
+    info->is_bridge  = l->is_bridge;
+    memcpy(info->mac_address, l->mac_address, 6);
+
+    info->master[0] = 0x0;
+    if (0 != l->master && NULL != (master = _netlinkFindByIndex(l->master)))
+    {
+        memcpy(info->master, master->name, IFNAMSIZ);
+    }
+
+    pthread_mutex_unlock(&netlink_mutex);
+
+    return 1;
+}
+
+INT8U netlinkGetAddresses(char *interface_name, INT8U *ipv4_nr, struct _ipv4 **ipv4, INT8U *ipv6_nr, struct _ipv6 **ipv6)
+{
+    struct _netlinkLink *links[2];
+    INT8U                links_nr;
+    INT8U                i, j;
+
+    *ipv4_nr = 0;
+    *ipv4    = NULL;
+    *ipv6_nr = 0;
+    *ipv6    = NULL;
+
+    pthread_mutex_lock(&netlink_mutex);
+
+    if (0 == netlink_loaded || NULL == (links[0] = _netlinkFindByName(interface_name)))
+    {
+        pthread_mutex_unlock(&netlink_mutex);
+        return 0;
+    }
+    links_nr = 1;
+
+    if (0 != links[0]->master && NULL != (links[1] = _netlinkFindByIndex(links[0]->master)))
+    {
+        links_nr = 2;
+    }
+
+    for (i=0; i<links_nr; i++)
+    {
+        for (j=0; j<links[i]->ipv4_nr && *ipv4_nr < 0xFF; j++)
+        {
+            *ipv4 = realloc(*ipv4, sizeof(struct _ipv4) * (*ipv4_nr + 1));
+            (*ipv4)[(*ipv4_nr)++] = links[i]->ipv4[j];
+        }
+        for (j=0; j<links[i]->ipv6_nr && *ipv6_nr < 0xFF; j++)
+        {
+            *ipv6 = realloc(*ipv6, sizeof(struct _ipv6) * (*ipv6_nr + 1));
+            (*ipv6)[(*ipv6_nr)++] = links[i]->ipv6[j];
+        }
+    }
+
+    pthread_mutex_unlock(&netlink_mutex);
+
+    return 1;
+}
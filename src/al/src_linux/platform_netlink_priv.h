@@ -0,0 +1,137 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#ifndef _PLATFORM_NETLINK_PRIV_H_
+#define _PLATFORM_NETLINK_PRIV_H_
+
+#include "platform.h"
+#include "platform_interfaces.h"
+
+#include <net/if.h>           // IFNAMSIZ
+
+// The Linux kernel reports (through a NETLINK_ROUTE socket) every change in
+// the state, MAC address, MTU and bridge membership of each network link, and
+// every address that is added to or removed from it.
+//
+// The functions in this file keep an in-memory table with all that information
+// (for *all* the links in the system, not only the 1905 ones), so that link and
+// address queries can be answered without any system call, and report which
+// links have actually changed so that precise events can be generated.
+//
+// The table is updated from the topology monitor thread (see "platform_os.c")
+// and read from any other thread (an internal mutex protects it).
+
+// Information about one link, as returned by "netlinkGetLink()"
+//
+struct netlinkLinkInfo
+{
+    int     ifindex;
+    INT8U   is_up;               // '1' if the link is administratively up
+    INT8U   is_running;          // '1' if the link has carrier
+    INT8U   mac_address[6];
+    INT32U  mtu;
+    INT8U   is_bridge;           // '1' if the link is itself a bridge
+    char    master[IFNAMSIZ];    // Name of the bridge this link belongs to
+                                 // (empty string if none)
+};
+
+// Open a NETLINK_ROUTE socket subscribed to link, IPv4 address and IPv6
+// address changes and fill the in-memory table with the current state of the
+// system.
+//
+// Return the socket file descriptor (which must then be polled for POLLIN and
+// passed to "netlinkProcess()" each time it is readable) or "-1" if there was
+// a problem (in that case, all queries will keep failing).
+//
+int netlinkOpen(void);
+
+// Read all pending messages from 'fd' (obtained from "netlinkOpen()") and
+// update the in-memory table accordingly.
+//
+// 'callback' is then called (without the table lock held) once for each link
+// whose state, MAC address, MTU, bridge membership or list of addresses has
+// changed. When the addresses of a bridge change, it is also called for each of
+// the links that belong to that bridge (as they also "respond" to those
+// addresses).
+// If the kernel reports that some notifications were lost, the whole table is
+// reloaded and 'callback' is called only once, with 'interface_name' set to
+// NULL (meaning "anything might have changed").
+//
+void netlinkProcess(int fd, void (*callback)(char *interface_name, void *context), void *context);
+
+// Fill 'info' with the current information of link 'interface_name'.
+//
+// Return "0" if the link is not known (or the table could not be loaded), "1"
+// otherwise.
+//
+INT8U netlinkGetLink(char *interface_name, struct netlinkLinkInfo *info);
+
+// Return (in the format used by "struct interfaceInfo") the addresses of link
+// 'interface_name' plus, if it belongs to a bridge, those of the bridge.
+//
+// '*ipv4' and '*ipv6' are allocated with "malloc()" (they are set to NULL when
+// the corresponding '*ipv4_nr' or '*ipv6_nr' is zero) and must be freed by the
+// caller.
+//
+// IPv6 link-local addresses are not reported.
+//
+// Return "0" if the link is not known (or the table could not be loaded), "1"
+// otherwise.
+//
+INT8U netlinkGetAddresses(char *interface_name, INT8U *ipv4_nr, struct _ipv4 **ipv4, INT8U *ipv6_nr, struct _ipv6 **ipv6);
+
+#endif
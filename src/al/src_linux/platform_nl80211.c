@@ -0,0 +1,446 @@
+/*
+ *  Broadband Forum IEEE 1905.1/1a stack
+ *  
+ *  Copyright (c) 2017, Broadband Forum
+ *  
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are
+ *  met:
+ *  
+ *  1. Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *  
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *  
+ *  Subject to the terms and conditions of this license, each copyright
+ *  holder and contributor hereby grants to those receiving rights under
+ *  this license a perpetual, worldwide, non-exclusive, no-charge,
+ *  royalty-free, irrevocable (except for failure to satisfy the
+ *  conditions of this license) patent license to make, have made, use,
+ *  offer to sell, sell, import, and otherwise transfer this software,
+ *  where such license applies only to those patent claims, already
+ *  acquired or hereafter acquired, licensable by such copyright holder or
+ *  contributor that are necessarily infringed by:
+ *  
+ *  (a) their Contribution(s) (the licensed copyrights of copyright holders
+ *      and non-copyrightable additions of contributors, in source or binary
+ *      form) alone; or
+ *  
+ *  (b) combination of their Contribution(s) with the work of authorship to
+ *      which such Contribution(s) was added by such copyright holder or
+ *      contributor, if, at the time the Contribution is added, such addition
+ *      causes such combination to be necessarily infringed. The patent
+ *      license shall not apply to any other combinations which include the
+ *      Contribution.
+ *  
+ *  Except as expressly stated above, no rights or licenses from any
+ *  copyright holder or contributor is granted under this license, whether
+ *  expressly, by implication, estoppel or otherwise.
+ *  
+ *  DISCLAIMER
+ *  
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ *  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ *  TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ *  PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *  HOLDERS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ *  OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ *  ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR
+ *  TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE
+ *  USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+ *  DAMAGE.
+ */
+
+#include "platform.h"
+#include "platform_nl80211_priv.h"
+#include "platform_netlink_priv.h"
+
+#include <stdlib.h>               // malloc(), realloc(), free()
+#include <string.h>               // memcpy(), memcmp(), strncpy()
+#include <errno.h>                // errno
+#include <unistd.h>               // close()
+#include <pthread.h>              // mutex functions
+#include <sys/socket.h>           // socket(), bind(), send(), recv()
+#include <sys/time.h>             // struct timeval
+#include <linux/netlink.h>        // NLMSG_*, sockaddr_nl, nlattr
+#include <linux/genetlink.h>      // genlmsghdr, CTRL_*
+#include <linux/nl80211.h>        // NL80211_*
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Private data and functions
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef WIFI_STATIONS_CACHE_TTL
+#  define WIFI_STATIONS_CACHE_TTL  (1000)
+#endif
+
+#define NL80211_BUFFER_SIZE  (32*1024)
+
+// Last dump of stations of each Wi-Fi interface
+//
+struct _nl80211Interface
+{
+    char     name[IFNAMSIZ];
+    INT8U    valid;
+    INT32U   timestamp;
+
+    int      stations_nr;
+    struct _nl80211Station
+    {
+        INT8U                      mac_address[6];
+        struct nl80211StationInfo  info;
+
+    } *stations;
+};
+
+static pthread_mutex_t           nl80211_mutex         = PTHREAD_MUTEX_INITIALIZER;
+static int                       nl80211_fd            = -1;
+static int                       nl80211_family        = -1;
+static INT32U                    nl80211_seq           = 0;
+static int                       nl80211_interfaces_nr = 0;
+static struct _nl80211Interface *nl80211_interfaces    = NULL;
+
+// Fill 'tb' (an array of 'max'+1 elements) with pointers to the attributes
+// found in 'data' (indexed by attribute type). Unknown attributes are ignored.
+//
+static void _nl80211ParseAttributes(void *data, int len, struct nlattr **tb, int max)
+{
+    struct nlattr *a;
+
+    memset(tb, 0x0, sizeof(struct nlattr *) * (max + 1));
+
+    a = (struct nlattr *)data;
+    while (len >= NLA_HDRLEN && a->nla_len >= NLA_HDRLEN && a->nla_len <= len)
+    {
+        int type;
+
+        type = a->nla_type & NLA_TYPE_MASK;
+        if (type <= max)
+        {
+            tb[type] = a;
+        }
+
+        len -= NLA_ALIGN(a->nla_len);
+        a    = (struct nlattr *)((INT8U *)a + NLA_ALIGN(a->nla_len));
+    }
+}
+
+#define NLA_DATA(a)     ((void *)((INT8U *)(a) + NLA_HDRLEN))
+#define NLA_PAYLOAD(a)  ((a)->nla_len - NLA_HDRLEN)
+
+// Append an attribute to the message in 'h' (which must be big enough)
+//
+static void _nl80211AddAttribute(struct nlmsghdr *h, INT16U type, void *data, INT16U len)
+{
+    struct nlattr *a;
+
+    a           = (struct nlattr *)((INT8U *)h + NLMSG_ALIGN(h->nlmsg_len));
+    a->nla_type = type;
+    a->nla_len  = NLA_HDRLEN + len;
+    memcpy(NLA_DATA(a), data, len);
+
+    h->nlmsg_len = NLMSG_ALIGN(h->nlmsg_len) + NLA_ALIGN(a->nla_len);
+}
+
+// Send a generic NETLINK request and call 'callback' for each message of the
+// answer (which can be a multipart dump).
+//
+// Return "0" if there was a problem (or the kernel returned an error), "1"
+// otherwise
+//
+static INT8U _nl80211Request(INT16U family, INT8U cmd, INT16U flags, INT16U attr_type, void *attr_data, INT16U attr_len, void (*callback)(struct nlmsghdr *h, void *context), void *context)
+{
+    static INT8U buffer[NL80211_BUFFER_SIZE];
+
+    struct
+    {
+        struct nlmsghdr     h;
+        struct genlmsghdr   g;
+        INT8U               attributes[64];
+    } request;
+
+    INT32U seq;
+
+    memset(&request, 0x0, sizeof(request));
+    request.h.nlmsg_len   = NLMSG_LENGTH(GENL_HDRLEN);
+    request.h.nlmsg_type  = family;
+    request.h.nlmsg_flags = NLM_F_REQUEST | flags;
+    request.h.nlmsg_seq   = seq = ++nl80211_seq;
+    request.g.cmd         = cmd;
+    request.g.version     = 1;
+
+    _nl80211AddAttribute(&request.h, attr_type, attr_data, attr_len);
+
+    if (0 > send(nl80211_fd, &request, request.h.nlmsg_len, 0))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] nl80211 send() returned with errno=%d (%s)\n", errno, strerror(errno));
+        return 0;
+    }
+
+    while (1)
+    {
+        struct nlmsghdr *h;
+        int              len;
+
+        len = recv(nl80211_fd, buffer, sizeof(buffer), 0);
+        if (len < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] nl80211 recv() returned with errno=%d (%s)\n", errno, strerror(errno));
+            return 0;
+        }
+
+        for (h = (struct nlmsghdr *)buffer; NLMSG_OK(h, (unsigned int)len); h = NLMSG_NEXT(h, len))
+        {
+            if (h->nlmsg_seq != seq)
+            {
+                // Late answer to a previous (timed out) request
+                //
+                continue;
+            }
+
+            if (NLMSG_DONE == h->nlmsg_type)
+            {
+                return 1;
+            }
+            if (NLMSG_ERROR == h->nlmsg_type)
+            {
+                struct nlmsgerr *e;
+
+                e = (struct nlmsgerr *)NLMSG_DATA(h);
+                if (0 != e->error)
+                {
+                    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] nl80211 request %d failed with error %d\n", cmd, e->error);
+                    return 0;
+                }
+                return 1;
+            }
+
+            callback(h, context);
+
+            if (0 == (h->nlmsg_flags & NLM_F_MULTI))
+            {
+                return 1;
+            }
+        }
+    }
+}
+
+static void _nl80211FamilyCallback(struct nlmsghdr *h, void *context)
+{
+    struct nlattr *tb[CTRL_ATTR_MAX+1];
+
+    _nl80211ParseAttributes((INT8U *)NLMSG_DATA(h) + GENL_HDRLEN, h->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN), tb, CTRL_ATTR_MAX);
+
+    if (NULL != tb[CTRL_ATTR_FAMILY_ID])
+    {
+        *(int *)context = *(INT16U *)NLA_DATA(tb[CTRL_ATTR_FAMILY_ID]);
+    }
+}
+
+// Open the generic NETLINK socket and resolve the "nl80211" family (only the
+// first time)
+//
+// Return "0" if nl80211 is not available, "1" otherwise
+//
+static INT8U _nl80211Open(void)
+{
+    struct sockaddr_nl addr;
+    struct timeval     timeout;
+
+    if (-1 != nl80211_fd)
+    {
+        return -1 != nl80211_family;
+    }
+
+    if (-1 == (nl80211_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC)))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] nl80211 socket() returned with errno=%d (%s)\n", errno, strerror(errno));
+        return 0;
+    }
+
+    memset(&addr, 0x0, sizeof(addr));
+    addr.nl_family = AF_NETLINK;
+    bind(nl80211_fd, (struct sockaddr *)&addr, sizeof(addr));
+
+    // Never block the caller for too long if the driver does not answer
+    //
+    timeout.tv_sec  = 1;
+    timeout.tv_usec = 0;
+    setsockopt(nl80211_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    _nl80211Request(GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 0, CTRL_ATTR_FAMILY_NAME, NL80211_GENL_NAME, strlen(NL80211_GENL_NAME)+1, _nl80211FamilyCallback, &nl80211_family);
+
+    if (-1 == nl80211_family)
+    {
+        PLATFORM_PRINTF_DEBUG_WARNING("[PLATFORM] nl80211 is not available. Wi-Fi stations statistics will not be reported\n");
+        return 0;
+    }
+
+    return 1;
+}
+
+static void _nl80211StationCallback(struct nlmsghdr *h, void *context)
+{
+    struct _nl80211Interface *x;
+    struct _nl80211Station   *s;
+
+    struct nlattr *tb[NL80211_ATTR_MAX+1];
+    struct nlattr *sinfo[NL80211_STA_INFO_MAX+1];
+    struct nlattr *rinfo[NL80211_RATE_INFO_MAX+1];
+
+    x = (struct _nl80211Interface *)context;
+
+    _nl80211ParseAttributes((INT8U *)NLMSG_DATA(h) + GENL_HDRLEN, h->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN), tb, NL80211_ATTR_MAX);
+
+    if (NULL == tb[NL80211_ATTR_MAC] || 6 != NLA_PAYLOAD(tb[NL80211_ATTR_MAC]) || NULL == tb[NL80211_ATTR_STA_INFO])
+    {
+        return;
+    }
+    _nl80211ParseAttributes(NLA_DATA(tb[NL80211_ATTR_STA_INFO]), NLA_PAYLOAD(tb[NL80211_ATTR_STA_INFO]), sinfo, NL80211_STA_INFO_MAX);
+
+    x->stations = realloc(x->stations, sizeof(struct _nl80211Station) * (x->stations_nr + 1));
+    s           = &x->stations[x->stations_nr++];
+
+    memset(s, 0x0, sizeof(struct _nl80211Station));
+    memcpy(s->mac_address, NLA_DATA(tb[NL80211_ATTR_MAC]), 6);
+
+    if (NULL != sinfo[NL80211_STA_INFO_TX_PACKETS])
+    {
+        s->info.tx_packets = *(INT32U *)NLA_DATA(sinfo[NL80211_STA_INFO_TX_PACKETS]);
+    }
+    if (NULL != sinfo[NL80211_STA_INFO_TX_FAILED])
+    {
+        s->info.tx_failed = *(INT32U *)NLA_DATA(sinfo[NL80211_STA_INFO_TX_FAILED]);
+    }
+    if (NULL != sinfo[NL80211_STA_INFO_RX_PACKETS])
+    {
+        s->info.rx_packets = *(INT32U *)NLA_DATA(sinfo[NL80211_STA_INFO_RX_PACKETS]);
+    }
+    if (NULL != sinfo[NL80211_STA_INFO_SIGNAL])
+    {
+        s->info.signal = *(INT8S *)NLA_DATA(sinfo[NL80211_STA_INFO_SIGNAL]);
+    }
+    if (NULL != sinfo[NL80211_STA_INFO_TX_BITRATE])
+    {
+        _nl80211ParseAttributes(NLA_DATA(sinfo[NL80211_STA_INFO_TX_BITRATE]), NLA_PAYLOAD(sinfo[NL80211_STA_INFO_TX_BITRATE]), rinfo, NL80211_RATE_INFO_MAX);
+
+        // Both attributes are expressed in units of 100 kbit/s
+        //
+        if (NULL != rinfo[NL80211_RATE_INFO_BITRATE32])
+        {
+            s->info.tx_bitrate = *(INT32U *)NLA_DATA(rinfo[NL80211_RATE_INFO_BITRATE32]) / 10;
+        }
+        else if (NULL != rinfo[NL80211_RATE_INFO_BITRATE])
+        {
+            s->info.tx_bitrate = *(INT16U *)NLA_DATA(rinfo[NL80211_RATE_INFO_BITRATE]) / 10;
+        }
+    }
+}
+
+// Return the cache entry of 'interface_name', dumping its stations again if
+// the cached ones are too old (or NULL if they could not be retrieved)
+//
+static struct _nl80211Interface *_nl80211GetInterface(char *interface_name)
+{
+    struct _nl80211Interface *x;
+    struct netlinkLinkInfo    link;
+    INT32U                    ifindex;
+    INT32U                    now;
+    int                       i;
+
+    x = NULL;
+    for (i=0; i<nl80211_interfaces_nr; i++)
+    {
+        if (0 == strncmp(nl80211_interfaces[i].name, interface_name, IFNAMSIZ))
+        {
+            x = &nl80211_interfaces[i];
+            break;
+        }
+    }
+    if (NULL == x)
+    {
+        nl80211_interfaces = realloc(nl80211_interfaces, sizeof(struct _nl80211Interface) * (nl80211_interfaces_nr + 1));
+        x                  = &nl80211_interfaces[nl80211_interfaces_nr++];
+
+        memset(x, 0x0, sizeof(struct _nl80211Interface));
+        strncpy(x->name, interface_name, IFNAMSIZ-1);
+    }
+
+    now = PLATFORM_GET_TIMESTAMP();
+    if (x->valid && now - x->timestamp < WIFI_STATIONS_CACHE_TTL)
+    {
+        return x;
+    }
+
+    // The interface index is taken from the NETLINK table (if available) to
+    // avoid one more system call
+    //
+    if (netlinkGetLink(interface_name, &link))
+    {
+        ifindex = link.ifindex;
+    }
+    else if (0 == (ifindex = if_nametoindex(interface_name)))
+    {
+        return NULL;
+    }
+
+    free(x->stations);
+    x->stations    = NULL;
+    x->stations_nr = 0;
+    x->valid       = 0;
+
+    if (0 == _nl80211Request(nl80211_family, NL80211_CMD_GET_STATION, NLM_F_DUMP, NL80211_ATTR_IFINDEX, &ifindex, sizeof(ifindex), _nl80211StationCallback, x))
+    {
+        return NULL;
+    }
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] nl80211: %d stations associated to %s\n", x->stations_nr, interface_name);
+
+    x->valid     = 1;
+    x->timestamp = now;
+
+    return x;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Internal API: to be used by other platform-specific files (functions
+// declarations can be found in "./platform_nl80211_priv.h")
+////////////////////////////////////////////////////////////////////////////////
+
+INT8U nl80211GetStation(char *interface_name, INT8U *station_mac, struct nl80211StationInfo *info)
+{
+    struct _nl80211Interface *x;
+    int                       i;
+
+    pthread_mutex_lock(&nl80211_mutex);
+
+    if (0 == _nl80211Open() || NULL == (x = _nl80211GetInterface(interface_name)))
+    {
+        pthread_mutex_unlock(&nl80211_mutex);
+        return 0;
+    }
+
+    for (i=0; i<x->stations_nr; i++)
+    {
+        if (0 == memcmp(x->stations[i].mac_address, station_mac, 6))
+        {
+            *info = x->stations[i].info;
+
+            pthread_mutex_unlock(&nl80211_mutex);
+            return 1;
+        }
+    }
+
+    pthread_mutex_unlock(&nl80211_mutex);
+    return 0;
+}
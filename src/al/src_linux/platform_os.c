@@ -58,7 +58,10 @@
 #include "platform.h"
 #include "platform_os.h"
 #include "platform_os_priv.h"
+#include "platform_interfaces_priv.h"
 #include "platform_alme_server_priv.h"
+#include "platform_netlink_priv.h"
+#include "platform_interfaces_simulated_priv.h"
 #include "1905_l2.h"
 
 #include <stdlib.h>      // free(), malloc(), ...
@@ -70,6 +73,11 @@
 #include <poll.h>        // poll()
 #include <sys/inotify.h> // inotify_*()
 #include <unistd.h>      // read(), sleep()
+#include <signal.h>      // sigaction()
+#include <fcntl.h>       // open()
+#include <sys/mman.h>    // mmap(), munmap(), msync()
+#include <sys/stat.h>    // fstat()
+#include <stdio.h>       // rename(), snprintf()
 
 ////////////////////////////////////////////////////////////////////////////////
 // Private functions, structures and macros
@@ -125,11 +133,6 @@ static void _pcapProcessPacket(u_char *arg, const struct pcap_pkthdr *pkthdr, co
   
     struct _pcapCaptureThreadData *aux;
 
-    INT8U   message[3+MAX_NETWORK_SEGMENT_SIZE];
-    INT16U  message_len;
-    INT8U   message_len_msb;
-    INT8U   message_len_lsb;
-    
     if (NULL == arg)
     {
         // Invalid argument
@@ -148,36 +151,7 @@ static void _pcapProcessPacket(u_char *arg, const struct pcap_pkthdr *pkthdr, co
         return;
     }
 
-    // In order to build the message that will be inserted into the queue, we
-    // need to follow the "message format" defines in the documentation of
-    // function 'PLATFORM_REGISTER_QUEUE_EVENT()'
-    //
-    message_len = (INT16U)pkthdr->len + 6;
-#if _HOST_IS_LITTLE_ENDIAN_ == 1
-    message_len_msb = *(((INT8U *)&message_len)+1);
-    message_len_lsb = *(((INT8U *)&message_len)+0);
-#else
-    message_len_msb = *(((INT8U *)&message_len)+0);
-    message_len_lsb = *(((INT8U *)&message_len)+1);
-#endif
-
-    message[0] = PLATFORM_QUEUE_EVENT_NEW_1905_PACKET;
-    message[1] = message_len_msb;
-    message[2] = message_len_lsb;
-    message[3] = aux->interface_mac_address[0];
-    message[4] = aux->interface_mac_address[1];
-    message[5] = aux->interface_mac_address[2];
-    message[6] = aux->interface_mac_address[3];
-    message[7] = aux->interface_mac_address[4];
-    message[8] = aux->interface_mac_address[5];
-
-    memcpy(&message[9], packet, pkthdr->len);
-
-    // Now simply send the message.
-    //
-    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *Pcap thread* Sending %d bytes to queue (0x%02x, 0x%02x, 0x%02x, ...)\n", 3+message_len, message[0], message[1], message[2]);
-
-    if (0 == sendMessageToAlQueue(aux->queue_id, message, 3 + message_len))
+    if (0 == sendPacketToAlQueue(aux->queue_id, aux->interface_mac_address, (INT8U *)packet, (INT16U)pkthdr->len))
     {
         PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *Pcap thread* Error sending message to queue from _pcapProcessPacket()\n");
         return;
@@ -678,25 +652,93 @@ static void *_pushButtonThread(void *p)
 //
 #define TOPOLOGY_CHANGE_NOTIFICATION_FILENAME  "/tmp/topology_change"
 
-// The only information that needs to be sent to the new thread is the "queue
-// id" to later post messages to the queue.
+// In addition, the Linux kernel notifies (through a NETLINK socket) every
+// change in the state, addresses and bridge membership of each interface (see
+// "platform_netlink.c"). Those that affect a 1905 interface generate an event
+// that contains the name of that interface.
+
+// The information that needs to be sent to the new thread is the "queue id"
+// to later post messages to the queue, the (already opened) NETLINK socket
+// and the file descriptor that watches simulation files (each of them "-1" if
+// it could not be opened).
 //
 struct _topologyMonitorThreadData
 {
     INT8U     queue_id;
+    int       netlink_fd;
+    int       simulated_fd;
 };
 
+// Post a "topology change" event related to interface 'interface_name' (or to
+// all of them if it is NULL)
+//
+static void _sendTopologyChangeNotification(INT8U queue_id, char *interface_name)
+{
+    INT8U   message[3+IFNAMSIZ];
+    INT16U  len;
+
+    len = NULL == interface_name ? 0 : strlen(interface_name) + 1;
+
+    message[0] = PLATFORM_QUEUE_EVENT_TOPOLOGY_CHANGE_NOTIFICATION;
+    message[1] = (len >> 8) & 0xff;
+    message[2] = len        & 0xff;
+
+    if (0 != len)
+    {
+        memcpy(&message[3], interface_name, len);
+    }
+
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *Topology change monitor thread* Sending %d bytes to queue (0x%02x, 0x%02x, 0x%02x, %s)\n", 3+len, message[0], message[1], message[2], NULL == interface_name ? "<all>" : interface_name);
+
+    if (0 == sendMessageToAlQueue(queue_id, message, 3+len))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *Topology change monitor thread* Error sending message to queue from _topologyMonitorThread()\n");
+    }
+}
+
+// Callback for "netlinkProcess()" and "simulatedWatchProcess()": only changes
+// in 1905 interfaces are forwarded to the AL
+//
+static void _interfaceChangeCallback(char *interface_name, void *context)
+{
+    char  **ifs_names;
+    INT8U   ifs_nr;
+    INT8U   i;
+
+    if (NULL == interface_name)
+    {
+        _sendTopologyChangeNotification(*(INT8U *)context, NULL);
+        return;
+    }
+
+    ifs_names = PLATFORM_GET_LIST_OF_1905_INTERFACES(&ifs_nr);
+    for (i=0; i<ifs_nr; i++)
+    {
+        if (0 == strcmp(ifs_names[i], interface_name))
+        {
+            PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *Topology change monitor thread* Interface %s has changed\n", interface_name);
+            _sendTopologyChangeNotification(*(INT8U *)context, interface_name);
+            break;
+        }
+    }
+    PLATFORM_FREE_LIST_OF_1905_INTERFACES(ifs_names, ifs_nr);
+}
+
 static void *_topologyMonitorThread(void *p)
 {
     FILE  *fd_tmp;
 
     int  fdraw_tmp;
 
-    struct pollfd fdset[2];
+    struct pollfd fdset[3];
 
     INT8U  queue_id;
+    int    netlink_fd;
+    int    simulated_fd;
 
-    queue_id = ((struct _topologyMonitorThreadData *)p)->queue_id;
+    queue_id     = ((struct _topologyMonitorThreadData *)p)->queue_id;
+    netlink_fd   = ((struct _topologyMonitorThreadData *)p)->netlink_fd;
+    simulated_fd = ((struct _topologyMonitorThreadData *)p)->simulated_fd;
 
     // Regarding the "virtual" notification system, first create the "tmp" file
     // in case it does not already exist...
@@ -725,6 +767,8 @@ static void *_topologyMonitorThread(void *p)
     while (1)
     {
         int   nfds;
+        int   netlink_index;
+        int   simulated_index;
         INT8U notification_activated;
 
         memset((void*)fdset, 0, sizeof(fdset));
@@ -733,13 +777,22 @@ static void *_topologyMonitorThread(void *p)
         fdset[0].events = POLLIN;
         nfds            = 1;
 
-        // TODO: Other fd's to detect topoly changes would be initialized here.
-        // One good idea would be to use a NETLINK socket that is notified by
-        // the Linux kernel when network "stuff" (routes, IPs, ...) change.
-        //
-        //fdset[0].fd     = ...;
-        //fdset[0].events = POLLIN;
-        //nfds            = 2;
+        netlink_index   = -1;
+        simulated_index = -1;
+
+        if (-1 != netlink_fd)
+        {
+            fdset[nfds].fd     = netlink_fd;
+            fdset[nfds].events = POLLIN;
+            netlink_index      = nfds++;
+        }
+
+        if (-1 != simulated_fd)
+        {
+            fdset[nfds].fd     = simulated_fd;
+            fdset[nfds].events = POLLIN;
+            simulated_index    = nfds++;
+        }
 
         // The thread will block here (forever, timeout = -1), until there is
         // a change in one of the previous file descriptors .
@@ -765,35 +818,114 @@ static void *_topologyMonitorThread(void *p)
             read(fdraw_tmp, &event, sizeof(event));
         }
 
-        if (1 == notification_activated)
+        if (-1 != netlink_index && (fdset[netlink_index].revents & POLLIN))
         {
-            INT8U  message[3];
-
-            message[0] = PLATFORM_QUEUE_EVENT_TOPOLOGY_CHANGE_NOTIFICATION;
-            message[1] = 0x0;
-            message[2] = 0x0;
+            // The NETLINK socket generates its own (per interface) events
+            //
+            netlinkProcess(netlink_fd, _interfaceChangeCallback, &queue_id);
+        }
 
-            PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] *Topology change monitor thread* Sending 3 bytes to queue (0x%02x, 0x%02x, 0x%02x)\n", message[0], message[1], message[2]);
+        if (-1 != simulated_index && (fdset[simulated_index].revents & POLLIN))
+        {
+            // ...and so do changes in the files that describe "simulated"
+            // interfaces
+            //
+            simulatedWatchProcess(_interfaceChangeCallback, &queue_id);
+        }
 
-            if (0 == sendMessageToAlQueue(queue_id, message, 3))
-            {
-                PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] *Topology change monitor thread* Error sending message to queue from _pushButtonThread()\n");
-            }
+        if (1 == notification_activated)
+        {
+            _sendTopologyChangeNotification(queue_id, NULL);
         }
     }
 
     PLATFORM_PRINTF_DEBUG_INFO("[PLATFORM] *Topology change monitor thread* Exiting...\n");
 
+    if (-1 != netlink_fd)
+    {
+        close(netlink_fd);
+    }
     free(p);
     return NULL;
 }
 
 
+// *********** Shutdown stuff **************************************************
+
+// When SIGINT or SIGTERM are received, a "shutdown" message is posted to the
+// queue registered for this event.
+//
+// Note that "mq_send()" is async-signal-safe, thus it can be called directly
+// from the signal handler. However the signal can be delivered to the thread
+// that reads the queue while it is full, thus the message is sent with
+// "mq_timedsend()" and a timeout that has already expired, so that it never
+// blocks (if the queue is full the message is lost, but the user can always
+// send the signal again).
+// The queue is not opened again by name (with a non blocking descriptor)
+// because all AL entities running on the same host use the same name: it
+// could belong to another one by then.
+//
+static mqd_t shutdown_queue = (mqd_t) -1;
+
+static void _shutdownSignalHandler(int signum)
+{
+    char            message[3];
+    int             saved_errno;
+    struct timespec expired;
+
+    saved_errno = errno;
+
+    expired.tv_sec  = 0;
+    expired.tv_nsec = 0;
+
+    message[0] = PLATFORM_QUEUE_EVENT_SHUTDOWN;
+    message[1] = 0x0;
+    message[2] = 0x0;
+
+    if ((mqd_t) -1 != shutdown_queue)
+    {
+        mq_timedsend(shutdown_queue, message, 3, 0, &expired);
+    }
+
+    errno = saved_errno;
+}
+
+
+// *********** Data model snapshot stuff ***************************************
+
+// Path to the file where the data model snapshot is stored. If NULL, snapshots
+// are disabled.
+//
+static char *datamodel_snapshot_filename = NULL;
+
+
+// *********** Topology image stuff ********************************************
+
+// Name of the POSIX shared memory object where the topology image is
+// published. If NULL, publishing is disabled.
+//
+static char   *topology_image_name = NULL;
+
+static int     topology_image_fd   = -1;
+static INT8U  *topology_image      = NULL;
+static INT32U  topology_image_size = 0;
+
+
 ////////////////////////////////////////////////////////////////////////////////
 // Internal API: to be used by other platform-specific files (functions
 // declaration is found in "./platform_os_priv.h")
 ////////////////////////////////////////////////////////////////////////////////
 
+void datamodelSnapshotFileSet(char *filename)
+{
+    datamodel_snapshot_filename = filename;
+}
+
+void topologyImageNameSet(char *name)
+{
+    topology_image_name = name;
+}
+
 INT8U sendMessageToAlQueue(INT8U queue_id, INT8U *message, INT16U message_len)
 {
     mqd_t   mqdes;
@@ -820,6 +952,81 @@ INT8U sendMessageToAlQueue(INT8U queue_id, INT8U *message, INT16U message_len)
     return 1;
 }
 
+INT8U frameIsForAlEntity(INT8U *frame, INT16U frame_len, INT8U *interface_mac_address, INT8U *al_mac_address)
+{
+    INT8U   mcast_1905[] = MCAST_1905;
+    INT8U   mcast_lldp[] = MCAST_LLDP;
+    INT16U  ether_type;
+
+    if (frame_len < 14)
+    {
+        return 0;
+    }
+
+    if (0 == memcmp(frame + 6, interface_mac_address, 6) || 0 == memcmp(frame + 6, al_mac_address, 6))
+    {
+        return 0;
+    }
+
+    ether_type = (frame[12] << 8) | frame[13];
+
+    if (ETHERTYPE_1905 == ether_type)
+    {
+        return 0 == memcmp(frame, interface_mac_address, 6) || 0 == memcmp(frame, mcast_1905, 6) || 0 == memcmp(frame, al_mac_address, 6);
+    }
+    if (ETHERTYPE_LLDP == ether_type)
+    {
+        return 0 == memcmp(frame, mcast_lldp, 6);
+    }
+
+    return 0;
+}
+
+INT8U sendPacketToAlQueue(INT8U queue_id, INT8U *interface_mac_address, INT8U *packet, INT16U packet_len)
+{
+    INT8U   message[3+6+MAX_NETWORK_SEGMENT_SIZE];
+    INT16U  message_len;
+    INT8U   message_len_msb;
+    INT8U   message_len_lsb;
+
+    if (packet_len > MAX_NETWORK_SEGMENT_SIZE)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] Packet too big\n");
+        return 0;
+    }
+
+    // In order to build the message that will be inserted into the queue, we
+    // need to follow the "message format" defines in the documentation of
+    // function 'PLATFORM_REGISTER_QUEUE_EVENT()'
+    //
+    message_len = packet_len + 6;
+#if _HOST_IS_LITTLE_ENDIAN_ == 1
+    message_len_msb = *(((INT8U *)&message_len)+1);
+    message_len_lsb = *(((INT8U *)&message_len)+0);
+#else
+    message_len_msb = *(((INT8U *)&message_len)+0);
+    message_len_lsb = *(((INT8U *)&message_len)+1);
+#endif
+
+    message[0] = PLATFORM_QUEUE_EVENT_NEW_1905_PACKET;
+    message[1] = message_len_msb;
+    message[2] = message_len_lsb;
+    message[3] = interface_mac_address[0];
+    message[4] = interface_mac_address[1];
+    message[5] = interface_mac_address[2];
+    message[6] = interface_mac_address[3];
+    message[7] = interface_mac_address[4];
+    message[8] = interface_mac_address[5];
+
+    memcpy(&message[9], packet, packet_len);
+
+    // Now simply send the message.
+    //
+    PLATFORM_PRINTF_DEBUG_DETAIL("[PLATFORM] Sending %d bytes to queue (0x%02x, 0x%02x, 0x%02x, ...)\n", 3+message_len, message[0], message[1], message[2]);
+
+    return sendMessageToAlQueue(queue_id, message, 3 + message_len);
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Platform API: Device information functions to be used by platform-independent
@@ -934,6 +1141,21 @@ INT8U PLATFORM_REGISTER_QUEUE_EVENT(INT8U queue_id, INT8U event_type, void *data
 
             p1 = (struct event1905Packet *)data;
 
+            // "Special" interfaces might have their own way of receiving
+            // frames
+            //
+            switch (startSpecialInterfaceCapture(p1->interface_name, queue_id, p1->interface_mac_address, p1->al_mac_address))
+            {
+                case 1:
+                {
+                    return 1;
+                }
+                case 2:
+                {
+                    return 0;
+                }
+            }
+
             p2 = (struct _pcapCaptureThreadData *)malloc(sizeof(struct _pcapCaptureThreadData));
             if (NULL == p2)
             {
@@ -1128,13 +1350,52 @@ INT8U PLATFORM_REGISTER_QUEUE_EVENT(INT8U queue_id, INT8U event_type, void *data
                 return 0;
             }
 
-            p->queue_id = queue_id;
+            p->queue_id   = queue_id;
+
+            // The NETLINK table is loaded right now (and not from the new
+            // thread) so that it is already available when the AL starts
+            // asking for interfaces information.
+            //
+            p->netlink_fd = netlinkOpen();
+
+            // From now on, changes in simulation files are detected by this
+            // thread (and not on the next query of a simulated interface)
+            //
+            p->simulated_fd = simulatedWatchOpen();
 
             pthread_create(&thread, NULL, _topologyMonitorThread, (void *)p);
 
             break;
         }
 
+        case PLATFORM_QUEUE_EVENT_SHUTDOWN:
+        {
+            // The AL entity is telling us that it is capable of processing
+            // "shutdown" events.
+            //
+            // Install a handler for the signals that are typically used to
+            // ask a process to terminate.
+            //
+            struct sigaction sa;
+
+            if ((mqd_t) -1 == (shutdown_queue = queues_id[queue_id]))
+            {
+                return 0;
+            }
+
+            memset(&sa, 0, sizeof(sa));
+            sa.sa_handler = _shutdownSignalHandler;
+            sigemptyset(&sa.sa_mask);
+
+            if (0 != sigaction(SIGINT, &sa, NULL) || 0 != sigaction(SIGTERM, &sa, NULL))
+            {
+                PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] sigaction() returned with errno=%d (%s)\n", errno, strerror(errno));
+                return 0;
+            }
+
+            break;
+        }
+
         default:
         {
             // Unknown event type!!
@@ -1193,3 +1454,185 @@ INT8U PLATFORM_READ_QUEUE(INT8U queue_id, INT8U *message_buffer)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+// Platform API: Persistent storage functions to be used by platform-independent
+// files (functions declarations are  found in "../interfaces/platform_os.h)
+////////////////////////////////////////////////////////////////////////////////
+
+INT8U PLATFORM_SAVE_DATAMODEL_SNAPSHOT(INT8U *buffer, INT32U len)
+{
+    char   tmp_filename[256];
+    int    fd;
+    void  *p;
+
+    if (NULL == datamodel_snapshot_filename)
+    {
+        // Snapshots are disabled
+        //
+        return 0;
+    }
+
+    if (NULL == buffer)
+    {
+        // The caller only wants to know whether snapshots are enabled
+        //
+        return 1;
+    }
+
+    // The new snapshot is first written to a temporary file which is then
+    // renamed (atomically) over the old one
+    //
+    snprintf(tmp_filename, sizeof(tmp_filename), "%s.tmp", datamodel_snapshot_filename);
+
+    if (-1 == (fd = open(tmp_filename, O_RDWR | O_CREAT | O_TRUNC, 0600)))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] open('%s') returned with errno=%d (%s)\n", tmp_filename, errno, strerror(errno));
+        return 0;
+    }
+
+    if (0 != ftruncate(fd, len))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] ftruncate('%s') returned with errno=%d (%s)\n", tmp_filename, errno, strerror(errno));
+        close(fd);
+        return 0;
+    }
+
+    if (MAP_FAILED == (p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] mmap('%s') returned with errno=%d (%s)\n", tmp_filename, errno, strerror(errno));
+        close(fd);
+        return 0;
+    }
+
+    memcpy(p, buffer, len);
+
+    msync(p, len, MS_SYNC);
+    munmap(p, len);
+    close(fd);
+
+    if (0 != rename(tmp_filename, datamodel_snapshot_filename))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] rename('%s') returned with errno=%d (%s)\n", tmp_filename, errno, strerror(errno));
+        return 0;
+    }
+
+    return 1;
+}
+
+INT8U *PLATFORM_MAP_DATAMODEL_SNAPSHOT(INT32U *len)
+{
+    int          fd;
+    void        *p;
+    struct stat  st;
+
+    if (NULL == datamodel_snapshot_filename)
+    {
+        // Snapshots are disabled
+        //
+        return NULL;
+    }
+
+    if (-1 == (fd = open(datamodel_snapshot_filename, O_RDONLY)))
+    {
+        // No snapshot has been saved yet
+        //
+        return NULL;
+    }
+
+    if (0 != fstat(fd, &st) || 0 == st.st_size)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping remains valid after the file descriptor is closed
+    //
+    close(fd);
+
+    if (MAP_FAILED == p)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] mmap('%s') returned with errno=%d (%s)\n", datamodel_snapshot_filename, errno, strerror(errno));
+        return NULL;
+    }
+
+    *len = st.st_size;
+
+    return (INT8U *)p;
+}
+
+void PLATFORM_UNMAP_DATAMODEL_SNAPSHOT(INT8U *buffer, INT32U len)
+{
+    if (NULL != buffer)
+    {
+        munmap(buffer, len);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Platform API: Shared memory functions to be used by platform-independent
+// files (functions declarations are  found in "../interfaces/platform_os.h)
+////////////////////////////////////////////////////////////////////////////////
+
+INT8U *PLATFORM_MAP_TOPOLOGY_IMAGE(INT32U size, INT32U *mapped_size)
+{
+    void *p;
+
+    if (NULL == topology_image_name)
+    {
+        // Publishing is disabled
+        //
+        return NULL;
+    }
+
+    if (size <= topology_image_size)
+    {
+        *mapped_size = topology_image_size;
+        return topology_image;
+    }
+
+    if (-1 == topology_image_fd)
+    {
+        if (-1 == (topology_image_fd = shm_open(topology_image_name, O_RDWR | O_CREAT, 0644)))
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] shm_open('%s') returned with errno=%d (%s)\n", topology_image_name, errno, strerror(errno));
+            return NULL;
+        }
+    }
+
+    // Grow in big steps (pages which are never written do not use any memory)
+    // so that this does not happen very often, as readers must map the region
+    // again each time
+    //
+    size = (size + 0xfffff) & ~0xfffff;
+
+    if (0 != ftruncate(topology_image_fd, size))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] ftruncate('%s') returned with errno=%d (%s)\n", topology_image_name, errno, strerror(errno));
+        return NULL;
+    }
+
+    if (MAP_FAILED == (p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, topology_image_fd, 0)))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("[PLATFORM] mmap('%s') returned with errno=%d (%s)\n", topology_image_name, errno, strerror(errno));
+        return NULL;
+    }
+
+    if (NULL != topology_image)
+    {
+        munmap(topology_image, topology_image_size);
+    }
+
+    topology_image      = (INT8U *)p;
+    topology_image_size = size;
+
+    *mapped_size = topology_image_size;
+    return topology_image;
+}
+
+void PLATFORM_MEMORY_BARRIER(void)
+{
+    __sync_synchronize();
+}
@@ -66,6 +66,36 @@
 //
 INT8U sendMessageToAlQueue(INT8U queue_id, INT8U *message, INT16U message_len);
 
+// Send a PLATFORM_QUEUE_EVENT_NEW_1905_PACKET message containing 'packet' (a
+// whole ethernet frame, 'packet_len' bytes long, received on the interface
+// whose MAC address is 'interface_mac_address') to the AL queue whose id is
+// 'queue_id'
+//
+// Return "0" if there was a problem, "1" otherwise
+//
+INT8U sendPacketToAlQueue(INT8U queue_id, INT8U *interface_mac_address, INT8U *packet, INT16U packet_len);
+
+// Return '1' if 'frame' (a whole ethernet frame, 'frame_len' bytes long,
+// received on the interface whose MAC address is 'interface_mac_address') must
+// be delivered to the AL entity whose AL MAC address is 'al_mac_address'.
+//
+// This is the same filter the pcap capture threads install on regular
+// interfaces, for those capture paths that don't use pcap.
+//
+INT8U frameIsForAlEntity(INT8U *frame, INT16U frame_len, INT8U *interface_mac_address, INT8U *al_mac_address);
+
+// Set the path to the file where the data model snapshot will be stored (see
+// "PLATFORM_SAVE_DATAMODEL_SNAPSHOT()"). Until this function is called (or if
+// it is called with NULL), snapshots are disabled.
+//
+void datamodelSnapshotFileSet(char *filename);
+
+// Set the name of the POSIX shared memory object where the topology image will
+// be published (see "PLATFORM_MAP_TOPOLOGY_IMAGE()"). Until this function is
+// called (or if it is called with NULL), publishing is disabled.
+//
+void topologyImageNameSet(char *name);
+
 #endif
 
 
@@ -175,7 +175,10 @@ void PLATFORM_SNPRINTF(char *dest, INT32U n, const char *format, ...);
 
 // Output to a string ("va" version, see 'man 3 vsnprintf' on any Linux box)
 //
-void PLATFORM_VSNPRINTF(char *dest, INT32U n, const char *format, va_list ap);
+// Returns the length of the whole formatted string (even if it was truncated
+// because it did not fit in 'n' bytes)
+//
+INT32U PLATFORM_VSNPRINTF(char *dest, INT32U n, const char *format, va_list ap);
 
 // Output the provided format string (see 'man 3 printf' on any Linux box)
 //
@@ -202,6 +205,73 @@ void PLATFORM_PRINTF_DEBUG_SET_VERBOSITY_LEVEL(int level);
 //
 INT32U PLATFORM_GET_TIMESTAMP(void);
 
+// Same as "PLATFORM_GET_TIMESTAMP()", but in microseconds. It wraps around
+// every ~71 minutes, thus it is only meant to measure short intervals (ex: how
+// long it takes to process a message).
+//
+INT32U PLATFORM_GET_TIMESTAMP_US(void);
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Memory accounting
+////////////////////////////////////////////////////////////////////////////////
+
+// When the "MEMORY_ACCOUNTING" flag is defined at compile time, every block
+// obtained with "PLATFORM_MALLOC()", "PLATFORM_REALLOC()" or
+// "PLATFORM_STRDUP()" is tagged with the subsystem that allocated it, so that
+// the number of live bytes, peaks and allocation rates of each subsystem can
+// be reported with "PLATFORM_MEMORY_ACCOUNTING_DUMP()".
+//
+// The subsystem is taken from the "MEMORY_ACCOUNTING_TAG" macro, which source
+// files can define (*before* including this header) to one of the following
+// values. Files that don't define it are accounted as "other".
+//
+// Blocks given to "PLATFORM_FREE()" and "PLATFORM_REALLOC()" must have been
+// obtained with one of these functions. Blocks obtained directly from libc
+// (ex: by a third party library) are detected and given back to it without
+// being accounted, but this is only a safety net.
+//
+#define PLATFORM_MEMORY_TAG_OTHER       (0)
+#define PLATFORM_MEMORY_TAG_FACTORY     (1)  // TLV/CMDU/ALME parse and forge
+#define PLATFORM_MEMORY_TAG_DATAMODEL   (2)  // Data model (and its history)
+#define PLATFORM_MEMORY_TAG_SEND        (3)  // Messages being built to be sent
+#define PLATFORM_MEMORY_TAG_WSC         (4)  // WSC (M1/M2) and crypto
+#define PLATFORM_MEMORY_TAG_EXTENSIONS  (5)  // Protocol extensions
+#define PLATFORM_MEMORY_TAGS_NR         (6)
+
+// Same as "PLATFORM_MALLOC()", "PLATFORM_REALLOC()" and "PLATFORM_STRDUP()",
+// but the block is accounted to subsystem 'tag' (one of the
+// "PLATFORM_MEMORY_TAG_*" values).
+// You should not need to call these functions directly: when
+// "MEMORY_ACCOUNTING" is defined the regular ones are redirected to them.
+//
+void *PLATFORM_MALLOC_TAGGED(INT32U size, INT8U tag);
+void *PLATFORM_REALLOC_TAGGED(void *ptr, INT32U size, INT8U tag);
+char *PLATFORM_STRDUP_TAGGED(const char *s, INT8U tag);
+
+// Report (using the provided 'write_function()' callback) the live bytes,
+// live blocks, peak bytes and allocation counters of each subsystem, as well
+// as the allocation rate since the previous call.
+//
+// If "MEMORY_ACCOUNTING" is not defined a single line saying so is written.
+//
+void PLATFORM_MEMORY_ACCOUNTING_DUMP(void (*write_function)(const char *fmt, ...));
+
+// Return the number of allocations made so far by all subsystems (or "0" if
+// "MEMORY_ACCOUNTING" is not defined). The difference between two calls is
+// the number of allocations made in between.
+//
+INT32U PLATFORM_MEMORY_ALLOCATIONS_NR(void);
+
+#ifdef MEMORY_ACCOUNTING
+#  ifndef MEMORY_ACCOUNTING_TAG
+#    define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_OTHER
+#  endif
+#  define PLATFORM_MALLOC(size)       PLATFORM_MALLOC_TAGGED((size), MEMORY_ACCOUNTING_TAG)
+#  define PLATFORM_REALLOC(ptr, size) PLATFORM_REALLOC_TAGGED((ptr), (size), MEMORY_ACCOUNTING_TAG)
+#  define PLATFORM_STRDUP(s)          PLATFORM_STRDUP_TAGGED((s), MEMORY_ACCOUNTING_TAG)
+#endif
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Misc stuff
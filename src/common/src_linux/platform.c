@@ -67,6 +67,15 @@
 #    include <pthread.h> // mutexes, pthread_self()
 #endif
 
+#ifdef MEMORY_ACCOUNTING
+     // "platform.h" redirects these to their "*_TAGGED()" versions. This is
+     // the file where the real ones are implemented.
+     //
+#    undef PLATFORM_MALLOC
+#    undef PLATFORM_REALLOC
+#    undef PLATFORM_STRDUP
+#endif
+
 
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -148,46 +157,216 @@ char *_disableColor(void)
 #endif
 }
 
+// *********** Memory accounting stuff *****************************************
 
-////////////////////////////////////////////////////////////////////////////////
-// Platform API: libc stuff
-////////////////////////////////////////////////////////////////////////////////
+#ifdef MEMORY_ACCOUNTING
 
-void *PLATFORM_MALLOC(INT32U size)
+// Every accounted block is preceded by a header containing its size and tag.
+// The header is padded to 32 bytes so that the pointer returned to the caller
+// keeps the alignment guaranteed by "malloc()".
+//
+// Blocks obtained directly from libc (which should not, but might, be given to
+// "PLATFORM_FREE()") are told apart by two fields: a full-width magic number
+// and a check value that depends on the block address, size and magic. Random
+// data practically never matches both, thus such blocks are not mistaken for
+// ours (which would end up freeing a pointer that libc never returned).
+//
+// When one of our blocks is freed its magic becomes MEMORY_HEADER_FREED, so
+// that freeing it again is detected (instead of being taken for a libc block
+// and handing libc a pointer to the middle of a chunk). The first 16 bytes are
+// left unused because that is where libc keeps its free list pointers once
+// the block has been released.
+//
+#define MEMORY_HEADER_SIZE  (32)
+#define MEMORY_HEADER_MAGIC (0x4D454D41)  // "MEMA"
+#define MEMORY_HEADER_FREED (0x46524545)  // "FREE"
+
+struct _memoryHeader
 {
-    void *p;
+    INT8U   libc[16]; // Overwritten by libc once the block is freed
+    INT32U  size;     // Bytes requested by the caller (header not included)
+    INT32U  magic;    // MEMORY_HEADER_MAGIC (or MEMORY_HEADER_FREED)
+    INT32U  check;    // "_memoryHeaderCheck()" of this header
+    INT8U   tag;      // One of "PLATFORM_MEMORY_TAG_*"
+};
+
+struct _memoryCounters
+{
+    INT32U  live_bytes;
+    INT32U  live_blocks;
+    INT32U  peak_bytes;
+    INT32U  allocs;         // Calls to malloc/realloc/strdup since start
+    INT32U  frees;          // Calls to free since start
+    INT32U  last_allocs;    // Value of 'allocs' at the time of the last dump
+};
+
+static char *memory_tag_names[PLATFORM_MEMORY_TAGS_NR] =
+{
+    "other",
+    "factory",
+    "datamodel",
+    "send",
+    "wsc",
+    "extensions",
+};
+
+static struct _memoryCounters memory_counters[PLATFORM_MEMORY_TAGS_NR];
+
+// Peak of the sum of all live bytes (which is not the same as the sum of the
+// peaks of each subsystem)
+//
+static INT32U memory_total_live_bytes;
+static INT32U memory_total_peak_bytes;
 
-    p = malloc(size);
+// Instant of the last call to "PLATFORM_MEMORY_ACCOUNTING_DUMP()", used to
+// obtain allocation rates
+//
+static INT32U memory_last_dump_timestamp;
 
-    if (NULL == p)
+// Raise '*peak' to 'value' (if it is bigger). Other threads might be doing
+// the same at the same time.
+//
+static void _memoryRaisePeak(INT32U *peak, INT32U value)
+{
+    INT32U old;
+
+    old = __atomic_load_n(peak, __ATOMIC_RELAXED);
+    while (value > old && !__atomic_compare_exchange_n(peak, &old, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
     {
-        printf("ERROR: Out of memory!\n");
-        exit(1);
+        // 'old' has been updated with the current value. Try again.
     }
+}
 
-    return p;
+// Update the counters of subsystem 'tag' after a block of 'old_size' bytes
+// has become a block of 'new_size' bytes (a new block has 'old_size' == 0, a
+// freed one has 'new_size' == 0)
+//
+// Counters are updated with atomic operations (and not under a lock), so that
+// threads allocating memory at the same time do not wait for each other. As
+// a consequence, peaks might be slightly off when that happens.
+//
+static void _memoryAccount(INT8U tag, INT32U old_size, INT32U new_size, INT8U is_free)
+{
+    struct _memoryCounters *c;
+    INT32U                  live_bytes;
+    INT32U                  total_live_bytes;
+
+    c = &memory_counters[tag];
+
+    live_bytes       = __atomic_add_fetch(&c->live_bytes,           new_size - old_size, __ATOMIC_RELAXED);
+    total_live_bytes = __atomic_add_fetch(&memory_total_live_bytes, new_size - old_size, __ATOMIC_RELAXED);
+
+    if (1 == is_free)
+    {
+        __atomic_sub_fetch(&c->live_blocks, 1, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&c->frees,       1, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        if (0 == old_size)
+        {
+            __atomic_add_fetch(&c->live_blocks, 1, __ATOMIC_RELAXED);
+        }
+        __atomic_add_fetch(&c->allocs, 1, __ATOMIC_RELAXED);
+    }
+
+    _memoryRaisePeak(&c->peak_bytes,           live_bytes);
+    _memoryRaisePeak(&memory_total_peak_bytes, total_live_bytes);
 }
 
+// Value of the "check" field of header 'h'
+//
+static INT32U _memoryHeaderCheck(struct _memoryHeader *h)
+{
+    unsigned long address;
 
-void PLATFORM_FREE(void *ptr)
+    // Fold the upper half of 64 bits addresses into the lower one (shifting
+    // twice, because shifting 32 bits at once is undefined when 'long' is 32
+    // bits wide)
+    //
+    address = (unsigned long)h;
+    address = address ^ ((address >> 16) >> 16);
+
+    return (INT32U)address ^ h->size ^ ~h->magic;
+}
+
+// Given a pointer returned to a caller, return its header, or NULL if the
+// pointer was not obtained from this allocator (ex: it was obtained directly
+// from libc)
+//
+// Aborts if the pointer belongs to one of our blocks that was already freed.
+//
+static struct _memoryHeader *_memoryHeader(void *ptr)
 {
-    return free(ptr);
+    struct _memoryHeader *h;
+
+    h = (struct _memoryHeader *)((char *)ptr - MEMORY_HEADER_SIZE);
+
+    if (_memoryHeaderCheck(h) != h->check || h->tag >= PLATFORM_MEMORY_TAGS_NR)
+    {
+        printf("ERROR: Memory block %p was not obtained with PLATFORM_MALLOC()\n", ptr);
+        return NULL;
+    }
+
+    if (MEMORY_HEADER_FREED == h->magic)
+    {
+        printf("ERROR: Memory block %p was already freed\n", ptr);
+        abort();
+    }
+
+    if (MEMORY_HEADER_MAGIC != h->magic)
+    {
+        printf("ERROR: Memory block %p was not obtained with PLATFORM_MALLOC()\n", ptr);
+        return NULL;
+    }
+
+    return h;
 }
 
+#endif
 
-void *PLATFORM_REALLOC(void *ptr, INT32U size)
+
+////////////////////////////////////////////////////////////////////////////////
+// Platform API: libc stuff
+////////////////////////////////////////////////////////////////////////////////
+
+void *PLATFORM_MALLOC(INT32U size)
 {
-    void *p;
+    return PLATFORM_MALLOC_TAGGED(size, PLATFORM_MEMORY_TAG_OTHER);
+}
 
-    p = realloc(ptr, size);
 
-    if (NULL == p)
+void PLATFORM_FREE(void *ptr)
+{
+#ifdef MEMORY_ACCOUNTING
+    struct _memoryHeader *h;
+
+    if (NULL == ptr)
     {
-        printf("ERROR: Out of memory!\n");
-        exit(1);
+        return;
     }
 
-    return p;
+    if (NULL == (h = _memoryHeader(ptr)))
+    {
+        // Not ours. Give it back to libc without accounting it.
+        //
+        return free(ptr);
+    }
+
+    _memoryAccount(h->tag, h->size, 0, 1);
+    h->magic = MEMORY_HEADER_FREED;
+    h->check = _memoryHeaderCheck(h);
+
+    return free(h);
+#else
+    return free(ptr);
+#endif
+}
+
+
+void *PLATFORM_REALLOC(void *ptr, INT32U size)
+{
+    return PLATFORM_REALLOC_TAGGED(ptr, size, PLATFORM_MEMORY_TAG_OTHER);
 }
 
 void *PLATFORM_MEMSET(void *dest, INT8U c, INT32U n)
@@ -223,7 +402,7 @@ INT32U PLATFORM_STRLEN(const char *s)
 
 char *PLATFORM_STRDUP(const char *s)
 {
-    return strdup(s);
+    return PLATFORM_STRDUP_TAGGED(s, PLATFORM_MEMORY_TAG_OTHER);
 }
 
 char *PLATFORM_STRNCAT(char *dest, const char *src, INT32U n)
@@ -242,11 +421,13 @@ void PLATFORM_SNPRINTF(char *dest, INT32U n, const char *format, ...)
     return;
 }
 
-void PLATFORM_VSNPRINTF(char *dest, INT32U n, const char *format, va_list ap)
+INT32U PLATFORM_VSNPRINTF(char *dest, INT32U n, const char *format, va_list ap)
 {
-    vsnprintf( dest, n, format, ap);
+    int len;
 
-    return;
+    len = vsnprintf( dest, n, format, ap);
+
+    return len < 0 ? 0 : (INT32U)len;
 }
 
 void PLATFORM_PRINTF(const char *format, ...)
@@ -409,6 +590,208 @@ INT32U PLATFORM_GET_TIMESTAMP(void)
     return diff;
 }
 
+INT32U PLATFORM_GET_TIMESTAMP_US(void)
+{
+    struct timeval tv_end;
+    INT32U diff;
+
+    gettimeofday(&tv_end, NULL);
+
+    diff = (tv_end.tv_usec - tv_begin.tv_usec) + (tv_end.tv_sec - tv_begin.tv_sec) * 1000000;
+
+    return diff;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// Platform API: Memory accounting
+////////////////////////////////////////////////////////////////////////////////
+
+void *PLATFORM_MALLOC_TAGGED(INT32U size, INT8U tag)
+{
+    void *p;
+
+#ifdef MEMORY_ACCOUNTING
+    struct _memoryHeader *h;
+
+    if (tag >= PLATFORM_MEMORY_TAGS_NR)
+    {
+        tag = PLATFORM_MEMORY_TAG_OTHER;
+    }
+
+    h = (struct _memoryHeader *)malloc(MEMORY_HEADER_SIZE + size);
+
+    if (NULL == h)
+    {
+        printf("ERROR: Out of memory!\n");
+        exit(1);
+    }
+
+    h->size  = size;
+    h->tag   = tag;
+    h->magic = MEMORY_HEADER_MAGIC;
+    h->check = _memoryHeaderCheck(h);
+
+    _memoryAccount(tag, 0, size, 0);
+
+    p = (char *)h + MEMORY_HEADER_SIZE;
+#else
+    p = malloc(size);
+
+    if (NULL == p)
+    {
+        printf("ERROR: Out of memory!\n");
+        exit(1);
+    }
+#endif
+
+    return p;
+}
+
+void *PLATFORM_REALLOC_TAGGED(void *ptr, INT32U size, INT8U tag)
+{
+    void *p;
+
+#ifdef MEMORY_ACCOUNTING
+    struct _memoryHeader *h;
+    INT32U                old_size;
+
+    if (NULL == ptr)
+    {
+        return PLATFORM_MALLOC_TAGGED(size, tag);
+    }
+
+    if (NULL == (h = _memoryHeader(ptr)))
+    {
+        // Not ours. Let libc take care of it without accounting it.
+        //
+        p = realloc(ptr, size);
+
+        if (NULL == p)
+        {
+            printf("ERROR: Out of memory!\n");
+            exit(1);
+        }
+
+        return p;
+    }
+
+    // The block remains accounted to the subsystem that first allocated it
+    //
+    old_size = h->size;
+
+    h = (struct _memoryHeader *)realloc(h, MEMORY_HEADER_SIZE + size);
+
+    if (NULL == h)
+    {
+        printf("ERROR: Out of memory!\n");
+        exit(1);
+    }
+
+    h->size  = size;
+    h->check = _memoryHeaderCheck(h);
+
+    _memoryAccount(h->tag, old_size, size, 0);
+
+    p = (char *)h + MEMORY_HEADER_SIZE;
+#else
+    p = realloc(ptr, size);
+
+    if (NULL == p)
+    {
+        printf("ERROR: Out of memory!\n");
+        exit(1);
+    }
+#endif
+
+    return p;
+}
+
+char *PLATFORM_STRDUP_TAGGED(const char *s, INT8U tag)
+{
+#ifdef MEMORY_ACCOUNTING
+    char   *p;
+    INT32U  len;
+
+    len = strlen(s) + 1;
+    p   = (char *)PLATFORM_MALLOC_TAGGED(len, tag);
+
+    memcpy(p, s, len);
+
+    return p;
+#else
+    return strdup(s);
+#endif
+}
+
+void PLATFORM_MEMORY_ACCOUNTING_DUMP(void (*write_function)(const char *fmt, ...))
+{
+#ifdef MEMORY_ACCOUNTING
+    struct _memoryCounters c[PLATFORM_MEMORY_TAGS_NR];
+    INT32U                 total_live_bytes;
+    INT32U                 total_peak_bytes;
+    INT32U                 now;
+    INT32U                 elapsed;
+    INT8U                  i;
+
+    // Take a copy of the counters before calling 'write_function()' (which
+    // might allocate memory itself). Other threads can be updating them at
+    // the same time, thus the copy is not necessarily consistent, but each
+    // counter is.
+    //
+    now = PLATFORM_GET_TIMESTAMP();
+
+    for (i=0; i<PLATFORM_MEMORY_TAGS_NR; i++)
+    {
+        c[i].live_bytes  = __atomic_load_n(&memory_counters[i].live_bytes,  __ATOMIC_RELAXED);
+        c[i].live_blocks = __atomic_load_n(&memory_counters[i].live_blocks, __ATOMIC_RELAXED);
+        c[i].peak_bytes  = __atomic_load_n(&memory_counters[i].peak_bytes,  __ATOMIC_RELAXED);
+        c[i].allocs      = __atomic_load_n(&memory_counters[i].allocs,      __ATOMIC_RELAXED);
+        c[i].frees       = __atomic_load_n(&memory_counters[i].frees,       __ATOMIC_RELAXED);
+        c[i].last_allocs = __atomic_exchange_n(&memory_counters[i].last_allocs, c[i].allocs, __ATOMIC_RELAXED);
+    }
+    total_live_bytes = __atomic_load_n(&memory_total_live_bytes, __ATOMIC_RELAXED);
+    total_peak_bytes = __atomic_load_n(&memory_total_peak_bytes, __ATOMIC_RELAXED);
+
+    elapsed                    = now - __atomic_exchange_n(&memory_last_dump_timestamp, now, __ATOMIC_RELAXED);
+
+    write_function("Memory accounting (%d bytes of overhead per block, rates over the last %d ms):\n", MEMORY_HEADER_SIZE, elapsed);
+    write_function("  %-10s %12s %12s %12s %12s %12s %10s\n", "subsystem", "live bytes", "live blocks", "peak bytes", "allocs", "frees", "allocs/s");
+
+    for (i=0; i<PLATFORM_MEMORY_TAGS_NR; i++)
+    {
+        INT32U rate;
+
+        rate = 0 == elapsed ? 0 : (INT32U)(((unsigned long long)(c[i].allocs - c[i].last_allocs) * 1000) / elapsed);
+
+        write_function("  %-10s %12u %12u %12u %12u %12u %10u\n", memory_tag_names[i], c[i].live_bytes, c[i].live_blocks, c[i].peak_bytes, c[i].allocs, c[i].frees, rate);
+    }
+
+    write_function("  %-10s %12u %12s %12u\n", "total", total_live_bytes, "", total_peak_bytes);
+#else
+    write_function("Memory accounting is disabled (rebuild with MEMORY_ACCOUNTING defined)\n");
+#endif
+}
+
+INT32U PLATFORM_MEMORY_ALLOCATIONS_NR(void)
+{
+#ifdef MEMORY_ACCOUNTING
+    INT32U allocs;
+    INT8U  i;
+
+    allocs = 0;
+
+    for (i=0; i<PLATFORM_MEMORY_TAGS_NR; i++)
+    {
+        allocs += __atomic_load_n(&memory_counters[i].allocs, __ATOMIC_RELAXED);
+    }
+
+    return allocs;
+#else
+    return 0;
+#endif
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Platform API: Initialization functions
@@ -424,8 +807,3 @@ INT8U PLATFORM_INIT(void)
 
     return 1;
 }
-
-
-
-
-
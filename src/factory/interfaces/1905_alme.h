@@ -485,11 +485,82 @@ struct customCommandRequestALME
     INT8U  alme_type;              // Must always be set to
                                    // ALME_TYPE_CUSTOM_COMMAND_REQUEST
 
-    #define CUSTOM_COMMAND_DUMP_NETWORK_DEVICES   (0x01)
+    #define CUSTOM_COMMAND_DUMP_NETWORK_DEVICES        (0x01)
+    #define CUSTOM_COMMAND_DUMP_METRICS_HISTORY        (0x02)
+    #define CUSTOM_COMMAND_DUMP_MEMORY_USAGE           (0x03)
+    #define CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE  (0x04)
+    #define CUSTOM_COMMAND_QUERY_NETWORK_DEVICES       (0x05)
+    #define CUSTOM_COMMAND_EXPORT_NETWORK_DEVICES      (0x06)
+    #define CUSTOM_COMMAND_DUMP_PENDING_QUERIES        (0x07)
+    #define CUSTOM_COMMAND_DUMP_NOTIFICATIONS          (0x08)
+    #define CUSTOM_COMMAND_DUMP_RECEIVE_STATS          (0x09)
+    #define CUSTOM_COMMAND_DUMP_FLIGHT_RECORDER        (0x0A)
+    #define CUSTOM_COMMAND_SUBSCRIBE_EVENTS            (0x0B)
     INT8U   command;               // One of the values from above. To see what
                                    // each of these commands is asking for, read
                                    // the comments inside the
                                    // "customCommandResponseALME" structure.
+
+    INT32U  epoch;                 // Only present (in the packet stream) when
+    INT32U  generation;            // 'command' is
+                                   // CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE.
+                                   // They are the "epoch" and "generation"
+                                   // values returned in the previous response.
+                                   // The epoch is a random number chosen each
+                                   // time the AL entity starts, thus
+                                   // generations from a previous run are never
+                                   // mistaken for current ones.
+
+    // The following fields are only present (in the packet stream) when
+    // 'command' is CUSTOM_COMMAND_QUERY_NETWORK_DEVICES. Only the devices that
+    // match *all* of these filters are reported:
+    //
+    INT8U     al_mac_addresses_nr; // Only report the devices whose AL MAC
+    INT8U   (*al_mac_addresses)[6];// address is one of these ('0' means "any
+                                   // device")
+
+    INT16U    media_type;          // Only report the devices with at least one
+                                   // local interface of this MEDIA_TYPE_*
+                                   // type (MEDIA_TYPE_UNKNOWN means "any")
+
+    INT16U    max_phy_rate;        // When not '0', only report the links
+                                   // (ie. the metrics entries) with at least
+                                   // one interface pair whose PHY rate (in
+                                   // Mb/s) is below this value, and only the
+                                   // devices with at least one of such links
+
+    #define CUSTOM_COMMAND_QUERY_SECTION_GENERAL_INFO        (1<<0)
+    #define CUSTOM_COMMAND_QUERY_SECTION_BRIDGES             (1<<1)
+    #define CUSTOM_COMMAND_QUERY_SECTION_NON_1905_NEIGHBORS  (1<<2)
+    #define CUSTOM_COMMAND_QUERY_SECTION_X1905_NEIGHBORS     (1<<3)
+    #define CUSTOM_COMMAND_QUERY_SECTION_POWER_OFF           (1<<4)
+    #define CUSTOM_COMMAND_QUERY_SECTION_L2_NEIGHBORS        (1<<5)
+    #define CUSTOM_COMMAND_QUERY_SECTION_GENERIC_PHY         (1<<6)
+    #define CUSTOM_COMMAND_QUERY_SECTION_PROFILE             (1<<7)
+    #define CUSTOM_COMMAND_QUERY_SECTION_IDENTIFICATION      (1<<8)
+    #define CUSTOM_COMMAND_QUERY_SECTION_CONTROL_URL         (1<<9)
+    #define CUSTOM_COMMAND_QUERY_SECTION_IPS                 (1<<10)
+    #define CUSTOM_COMMAND_QUERY_SECTION_METRICS             (1<<11)
+    #define CUSTOM_COMMAND_QUERY_SECTION_EXTENSIONS          (1<<12)
+    #define CUSTOM_COMMAND_QUERY_SECTION_ALL                 (0x1fff)
+    INT16U    sections;            // Combination of the flags above. Only these
+                                   // parts of each matching device are
+                                   // reported.
+
+    // The following fields are only present (in the packet stream) when
+    // 'command' is CUSTOM_COMMAND_SUBSCRIBE_EVENTS (followed by
+    // 'al_mac_addresses_nr' and 'al_mac_addresses', which then mean "only
+    // report the events that refer to one of these devices"):
+    //
+    INT16U    events;              // Combination of "1 << CUSTOM_COMMAND_EVENT_*"
+                                   // flags (see below). Only these types of
+                                   // events are reported.
+
+    INT8U     metric_threshold;    // Link metric events are only reported when
+                                   // the new value differs from the last one
+                                   // reported (for the same link) by more than
+                                   // this percentage of it ('0' means "every
+                                   // change")
 };
 
 
@@ -506,7 +577,11 @@ struct customCommandResponseALME
     INT16U                         bytes_nr;
     char                          *bytes;
                                    // Custom payload. Its contents depend on the
-                                   // actual command:
+                                   // actual command (when they do not fit in a
+                                   // single message, the AL entity sends
+                                   // several consecutive responses, each of
+                                   // them containing a NULL terminated piece
+                                   // of the text):
                                    //
                                    //  - CUSTOM_COMMAND_DUMP_NETWORK_DEVICES:
                                    //      It contains text data that can be
@@ -515,8 +590,266 @@ struct customCommandResponseALME
                                    //      1905 node has gained so far of the
                                    //      environment (neighbors, their
                                    //      properties, their metrics, etc...)
+                                   //
+                                   //  - CUSTOM_COMMAND_DUMP_METRICS_HISTORY:
+                                   //      It contains text data that can be
+                                   //      directly printed to STDOUT.
+                                   //      It represents the evolution over
+                                   //      time (raw, per minute and per hour
+                                   //      samples) of the metrics of every
+                                   //      link known by the 1905 node.
+                                   //
+                                   //  - CUSTOM_COMMAND_DUMP_MEMORY_USAGE:
+                                   //      It contains text data that can be
+                                   //      directly printed to STDOUT.
+                                   //      It represents the memory currently
+                                   //      in use (and its peak) by each
+                                   //      subsystem of the 1905 node (only
+                                   //      available when it was built with
+                                   //      "MEMORY_ACCOUNTING")
+                                   //
+                                   //  - CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE:
+                                   //      Same as
+                                   //      CUSTOM_COMMAND_DUMP_NETWORK_DEVICES,
+                                   //      but only the devices and links that
+                                   //      were created, changed or removed
+                                   //      after the 'generation' contained in
+                                   //      the request are included (or the
+                                   //      whole database, when that is no
+                                   //      longer possible or when the 'epoch'
+                                   //      of the request is not the current
+                                   //      one)
+                                   //
+                                   //  - CUSTOM_COMMAND_QUERY_NETWORK_DEVICES:
+                                   //      Same as
+                                   //      CUSTOM_COMMAND_DUMP_NETWORK_DEVICES,
+                                   //      but only the devices (and the parts
+                                   //      of each of them) that match the
+                                   //      filters contained in the request are
+                                   //      included.
+                                   //
+                                   //  - CUSTOM_COMMAND_EXPORT_NETWORK_DEVICES:
+                                   //      Same information as
+                                   //      CUSTOM_COMMAND_DUMP_NETWORK_DEVICES,
+                                   //      but in the binary format described
+                                   //      below (the NULL byte at the end of
+                                   //      each piece is not part of it).
+                                   //
+                                   //  - CUSTOM_COMMAND_DUMP_PENDING_QUERIES:
+                                   //      It contains text data that can be
+                                   //      directly printed to STDOUT.
+                                   //      It represents the queries sent by
+                                   //      the 1905 node that are still waiting
+                                   //      for a response, together with some
+                                   //      statistics (number of queries sent,
+                                   //      coalesced, answered, ... and round
+                                   //      trip times) of each query type.
+                                   //
+                                   //  - CUSTOM_COMMAND_DUMP_NOTIFICATIONS:
+                                   //      It contains text data that can be
+                                   //      directly printed to STDOUT.
+                                   //      It represents the statistics of the
+                                   //      "topology notification" messages
+                                   //      sent by the 1905 node (number of
+                                   //      changes, number of messages sent on
+                                   //      each interface and how many changes
+                                   //      were folded into each of them).
+                                   //
+                                   //  - CUSTOM_COMMAND_DUMP_RECEIVE_STATS:
+                                   //      It contains text data that can be
+                                   //      directly printed to STDOUT.
+                                   //      It represents the statistics of the
+                                   //      receive pipeline (frames per
+                                   //      second, and the number of frames,
+                                   //      processing time and allocations of
+                                   //      each CMDU type).
+                                   //
+                                   //  - CUSTOM_COMMAND_DUMP_FLIGHT_RECORDER:
+                                   //      It contains text data that can be
+                                   //      directly printed to STDOUT.
+                                   //      It says where the frames kept by
+                                   //      the "flight recorder" (the last
+                                   //      frames received and transmitted by
+                                   //      the AL entity) have been saved and
+                                   //      how many of them there are.
+                                   //
+                                   //  - CUSTOM_COMMAND_SUBSCRIBE_EVENTS:
+                                   //      The reply never ends (unless the AL
+                                   //      entity cannot take more subscribers,
+                                   //      in which case it is empty). Each
+                                   //      response contains one event, in the
+                                   //      binary format described below (with
+                                   //      no NULL byte at the end), which is
+                                   //      sent as soon as it takes place.
+};
+
+// Binary export of the devices database (CUSTOM_COMMAND_EXPORT_NETWORK_DEVICES
+// response). Multi-byte fields are in network byte order:
+//
+//   "DMEX"                     (4 bytes, magic)
+//   version                    (1 byte, CUSTOM_COMMAND_EXPORT_VERSION)
+//   generation                 (4 bytes)
+//   devices_nr                 (1 byte)
+//     generation               (4 bytes)
+//     update timestamp         (4 bytes)
+//     length                   (4 bytes, of the rest of this device entry, so
+//                              that clients can skip it)
+//     tlvs_nr                  (2 bytes)
+//       TLV                    (as generated by "forge_1905_TLV_from_structure()"
+//                              and thus parseable with
+//                              "parse_1905_TLV_from_packet()". It can be any
+//                              of the TLVs the device reports, including link
+//                              metrics and vendor specific extensions. When
+//                              present, the "device information" TLV is always
+//                              the first one)
+//   links_nr                   (2 bytes)
+//     local interface name len (1 byte)
+//     local interface name     (n bytes, not NULL terminated)
+//     neighbor AL MAC address  (6 bytes)
+//     neighbor MAC address     (6 bytes)
+//     generation               (4 bytes)
+//
+#define CUSTOM_COMMAND_EXPORT_MAGIC    "DMEX"
+#define CUSTOM_COMMAND_EXPORT_VERSION  (1)
+
+// The AL entity can also (optionally) publish this same export in a shared
+// memory segment, so that local processes can read the topology without
+// sending any ALME request. The segment starts with the following header
+// (fields in host byte order), followed by 'len' bytes of export:
+//
+//   - Writers increment 'sequence' before and after each update (so it is odd
+//     while the update is in progress).
+//
+//   - Readers read 'sequence' (retrying while it is odd), copy the header and
+//     the export, and then read 'sequence' again. If it has changed, the copy
+//     is discarded and the whole process is repeated.
+//
+//   - If 'size' is bigger than what the reader has mapped, the segment has
+//     been enlarged and must be mapped again.
+//
+#define TOPOLOGY_IMAGE_MAGIC    "DMTI"
+#define TOPOLOGY_IMAGE_VERSION  (1)
+struct topologyImageHeader
+{
+    INT8U   magic[4];              // TOPOLOGY_IMAGE_MAGIC
+    INT32U  version;               // TOPOLOGY_IMAGE_VERSION
+    INT32U  sequence;              // Odd while an update is in progress
+    INT32U  size;                  // Size of the whole shared memory segment
+    INT32U  generation;            // Data model "generation" of the export
+    INT32U  len;                   // Length of the export that follows
 };
 
+// Events sent in reply to CUSTOM_COMMAND_SUBSCRIBE_EVENTS. Multi-byte fields
+// are in network byte order:
+//
+//   type                       (1 byte, CUSTOM_COMMAND_EVENT_*)
+//   sequence                   (4 bytes, '0' for the first event and increased
+//                              by one with each new one. A gap means that the
+//                              client was not reading them fast enough and the
+//                              oldest ones it had not read yet were discarded)
+//   timestamp                  (4 bytes, in milliseconds, as returned by
+//                              "PLATFORM_GET_TIMESTAMP()" in the AL entity)
+//   AL MAC address             (6 bytes, of the device the event refers to)
+//
+// ...followed by these other fields, which depend on the type:
+//
+//   - CUSTOM_COMMAND_EVENT_SUBSCRIBED: Always the first event (the AL MAC
+//     address is the one of the local AL entity)
+//       events                 (2 bytes, the ones that will be reported)
+//
+//   - CUSTOM_COMMAND_EVENT_NEIGHBOR_UP / CUSTOM_COMMAND_EVENT_NEIGHBOR_DOWN: A
+//     1905 neighbor (the AL MAC address) has been discovered on (or has been
+//     lost from) a local interface
+//       interface MAC address  (6 bytes, of the local interface)
+//
+//   - CUSTOM_COMMAND_EVENT_DEVICE_CHANGED: The information of a device has been
+//     received for the first time or has changed
+//       generation             (4 bytes, the new one of the device, see
+//                              CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE)
+//
+//   - CUSTOM_COMMAND_EVENT_DEVICE_REMOVED: A device has left the network (no
+//     other fields)
+//
+//   - CUSTOM_COMMAND_EVENT_LINK_METRIC: A link metric reported by a device (the
+//     AL MAC address) has changed beyond the subscriber threshold
+//       neighbor AL MAC        (6 bytes, the other end of the link)
+//       local interface MAC    (6 bytes, in the reporting device)
+//       neighbor interface MAC (6 bytes)
+//       metric                 (1 byte, CUSTOM_COMMAND_EVENT_METRIC_*)
+//       previous value         (2 bytes, the last one reported to this same
+//                              subscriber or '0' if this is the first time)
+//       value                  (2 bytes)
+//
+//   - CUSTOM_COMMAND_EVENT_PUSH_BUTTON: Progress of the "push button" and WSC
+//     configuration processes
+//       stage                  (1 byte, CUSTOM_COMMAND_EVENT_PUSH_BUTTON_*)
+//       interface MAC address  (6 bytes, all zeros when the stage does not
+//                              refer to any interface)
+//
+//     These are the stages (and the device and interface they refer to):
+//
+//       PRESSED          The local button was pressed (local AL entity)
+//       STARTED          The process started on a local interface (local AL
+//                        entity, that interface)
+//       REMOTE           A device notified that its button was pressed (that
+//                        device)
+//       AUTHENTICATED    A local interface was authenticated (local AL entity,
+//                        that interface)
+//       JOINED           A device notified that a new interface joined the
+//                        network (that device, the new interface)
+//       WSC_M1_SENT      A WSC M1 was sent for a local unconfigured AP (local
+//                        AL entity, that interface)
+//       WSC_M2_SENT      A WSC M2 was sent to an enrollee (that device)
+//       WSC_M2_RECEIVED  A WSC M2 was received and its settings applied (local
+//                        AL entity)
+//
+#define CUSTOM_COMMAND_EVENT_SUBSCRIBED      (0x00)
+#define CUSTOM_COMMAND_EVENT_NEIGHBOR_UP     (0x01)
+#define CUSTOM_COMMAND_EVENT_NEIGHBOR_DOWN   (0x02)
+#define CUSTOM_COMMAND_EVENT_DEVICE_CHANGED  (0x03)
+#define CUSTOM_COMMAND_EVENT_DEVICE_REMOVED  (0x04)
+#define CUSTOM_COMMAND_EVENT_LINK_METRIC     (0x05)
+#define CUSTOM_COMMAND_EVENT_PUSH_BUTTON     (0x06)
+#define CUSTOM_COMMAND_EVENTS_ALL            (0x007e)
+
+#define CUSTOM_COMMAND_EVENT_HEADER_LEN      (15)
+
+#define CUSTOM_COMMAND_EVENT_METRIC_MAC_THROUGHPUT  (0x00)  // Tx, in Mb/s
+#define CUSTOM_COMMAND_EVENT_METRIC_RSSI            (0x01)  // Rx, in dB
+
+#define CUSTOM_COMMAND_EVENT_PUSH_BUTTON_PRESSED          (0x00)
+#define CUSTOM_COMMAND_EVENT_PUSH_BUTTON_STARTED          (0x01)
+#define CUSTOM_COMMAND_EVENT_PUSH_BUTTON_REMOTE           (0x02)
+#define CUSTOM_COMMAND_EVENT_PUSH_BUTTON_AUTHENTICATED    (0x03)
+#define CUSTOM_COMMAND_EVENT_PUSH_BUTTON_JOINED           (0x04)
+#define CUSTOM_COMMAND_EVENT_PUSH_BUTTON_WSC_M1_SENT      (0x05)
+#define CUSTOM_COMMAND_EVENT_PUSH_BUTTON_WSC_M2_SENT      (0x06)
+#define CUSTOM_COMMAND_EVENT_PUSH_BUTTON_WSC_M2_RECEIVED  (0x07)
+
+// When ALME messages are exchanged over a stream (such as the TCP connection
+// to the AL entity ALME server) each of them is preceded by this 8 bytes
+// header (multi-byte fields in network byte order):
+//
+//   marker                     (1 byte, ALME_FRAME_MARKER)
+//   flags                      (1 byte, ALME_FRAME_FLAG_*)
+//   length                     (2 bytes, of the ALME message that follows)
+//   request id                 (4 bytes)
+//
+// The client chooses the request id of each REQUEST and can send new ones
+// without waiting for the previous ones to be answered. Every message of the
+// reply (see "PLATFORM_SEND_ALME_PARTIAL_REPLY()") carries the same request id
+// as the REQUEST it answers, and the last one has ALME_FRAME_FLAG_LAST set
+// (that message can be empty, if the AL entity has nothing else to say).
+//
+// The marker can never be the first byte of an ALME message, so that servers
+// can tell framed connections apart from "one shot" ones (where the client
+// sends a single ALME message without header, closes its writing end and
+// reads the reply until the server closes the connection).
+//
+#define ALME_FRAME_HEADER_LEN   (8)
+#define ALME_FRAME_MARKER       (0x00)
+#define ALME_FRAME_FLAG_LAST    (0x01)
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Main API functions
@@ -55,6 +55,8 @@
  *  DAMAGE.
  */
 
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_FACTORY
+
 #include "platform.h"
 
 #include "1905_alme.h"
@@ -814,6 +816,60 @@ INT8U *parse_1905_ALME_from_packet(INT8U *packet_stream)
             _E1B(&p, &ret->alme_type);
             _E1B(&p, &ret->command);
 
+            ret->epoch               = 0;
+            ret->generation          = 0;
+            ret->al_mac_addresses_nr = 0;
+            ret->al_mac_addresses    = NULL;
+            ret->media_type          = MEDIA_TYPE_UNKNOWN;
+            ret->max_phy_rate        = 0;
+            ret->sections            = CUSTOM_COMMAND_QUERY_SECTION_ALL;
+            ret->events              = 0;
+            ret->metric_threshold    = 0;
+
+            if (CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE == ret->command)
+            {
+                _E4B(&p, &ret->epoch);
+                _E4B(&p, &ret->generation);
+            }
+            else if (CUSTOM_COMMAND_SUBSCRIBE_EVENTS == ret->command)
+            {
+                INT8U i;
+
+                _E2B(&p, &ret->events);
+                _E1B(&p, &ret->metric_threshold);
+                _E1B(&p, &ret->al_mac_addresses_nr);
+
+                if (ret->al_mac_addresses_nr > 0)
+                {
+                    ret->al_mac_addresses = (INT8U (*)[6])PLATFORM_MALLOC(sizeof(INT8U[6]) * ret->al_mac_addresses_nr);
+
+                    for (i=0; i<ret->al_mac_addresses_nr; i++)
+                    {
+                        _EnB(&p, ret->al_mac_addresses[i], 6);
+                    }
+                }
+            }
+            else if (CUSTOM_COMMAND_QUERY_NETWORK_DEVICES == ret->command)
+            {
+                INT8U i;
+
+                _E1B(&p, &ret->al_mac_addresses_nr);
+
+                if (ret->al_mac_addresses_nr > 0)
+                {
+                    ret->al_mac_addresses = (INT8U (*)[6])PLATFORM_MALLOC(sizeof(INT8U[6]) * ret->al_mac_addresses_nr);
+
+                    for (i=0; i<ret->al_mac_addresses_nr; i++)
+                    {
+                        _EnB(&p, ret->al_mac_addresses[i], 6);
+                    }
+                }
+
+                _E2B(&p, &ret->media_type);
+                _E2B(&p, &ret->max_phy_rate);
+                _E2B(&p, &ret->sections);
+            }
+
             return (INT8U *)ret;
         }
 
@@ -1339,11 +1395,66 @@ INT8U *forge_1905_ALME_from_structure(INT8U *memory_structure, INT16U *len)
 
             *len  = 2;  // alme_type + command
 
+            if (CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE == m->command)
+            {
+                *len += 4;  // epoch
+                *len += 4;  // generation
+            }
+            else if (CUSTOM_COMMAND_QUERY_NETWORK_DEVICES == m->command)
+            {
+                *len += 1;                             // al_mac_addresses_nr
+                *len += 6 * m->al_mac_addresses_nr;    // al_mac_addresses
+                *len += 2;                             // media_type
+                *len += 2;                             // max_phy_rate
+                *len += 2;                             // sections
+            }
+            else if (CUSTOM_COMMAND_SUBSCRIBE_EVENTS == m->command)
+            {
+                *len += 2;                             // events
+                *len += 1;                             // metric_threshold
+                *len += 1;                             // al_mac_addresses_nr
+                *len += 6 * m->al_mac_addresses_nr;    // al_mac_addresses
+            }
+
             p = ret = (INT8U *)PLATFORM_MALLOC(*len);
 
             _I1B(&m->alme_type, &p);
             _I1B(&m->command,   &p);
 
+            if (CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE == m->command)
+            {
+                _I4B(&m->epoch,      &p);
+                _I4B(&m->generation, &p);
+            }
+            else if (CUSTOM_COMMAND_QUERY_NETWORK_DEVICES == m->command)
+            {
+                INT8U i;
+
+                _I1B(&m->al_mac_addresses_nr, &p);
+
+                for (i=0; i<m->al_mac_addresses_nr; i++)
+                {
+                    _InB(m->al_mac_addresses[i], &p, 6);
+                }
+
+                _I2B(&m->media_type,   &p);
+                _I2B(&m->max_phy_rate, &p);
+                _I2B(&m->sections,     &p);
+            }
+            else if (CUSTOM_COMMAND_SUBSCRIBE_EVENTS == m->command)
+            {
+                INT8U i;
+
+                _I2B(&m->events,              &p);
+                _I1B(&m->metric_threshold,    &p);
+                _I1B(&m->al_mac_addresses_nr, &p);
+
+                for (i=0; i<m->al_mac_addresses_nr; i++)
+                {
+                    _InB(m->al_mac_addresses[i], &p, 6);
+                }
+            }
+
             return ret;
         }
 
@@ -1408,13 +1519,27 @@ void free_1905_ALME_structure(INT8U *memory_structure)
         case ALME_TYPE_REMOVE_FWD_RULE_REQUEST:
         case ALME_TYPE_REMOVE_FWD_RULE_CONFIRM:
         case ALME_TYPE_GET_METRIC_REQUEST:
-        case ALME_TYPE_CUSTOM_COMMAND_REQUEST:
         {
             PLATFORM_FREE(memory_structure);
 
             return;
         }
 
+        case ALME_TYPE_CUSTOM_COMMAND_REQUEST:
+        {
+            struct customCommandRequestALME *m;
+
+            m = (struct customCommandRequestALME *)memory_structure;
+
+            if (m->al_mac_addresses_nr > 0 && NULL != m->al_mac_addresses)
+            {
+                PLATFORM_FREE(m->al_mac_addresses);
+            }
+            PLATFORM_FREE(m);
+
+            return;
+        }
+
         case ALME_TYPE_GET_INTF_LIST_RESPONSE:
         {
             struct getIntfListResponseALME *m;
@@ -1975,10 +2100,47 @@ INT8U compare_1905_ALME_structures(INT8U *memory_structure_1, INT8U *memory_stru
             p1 = (struct customCommandRequestALME *)memory_structure_1;
             p2 = (struct customCommandRequestALME *)memory_structure_2;
 
-            if (p1->command !=  p2->command)
+            if (
+                 p1->command !=  p2->command                                                                     ||
+                 (CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE == p1->command && (p1->epoch != p2->epoch || p1->generation != p2->generation))
+               )
             {
                 return 1;
             }
+
+            if (CUSTOM_COMMAND_QUERY_NETWORK_DEVICES == p1->command)
+            {
+                if (
+                     p1->al_mac_addresses_nr  !=  p2->al_mac_addresses_nr   ||
+                     p1->media_type           !=  p2->media_type            ||
+                     p1->max_phy_rate         !=  p2->max_phy_rate          ||
+                     p1->sections             !=  p2->sections
+                   )
+                {
+                    return 1;
+                }
+
+                if (p1->al_mac_addresses_nr > 0 && PLATFORM_MEMCMP(p1->al_mac_addresses, p2->al_mac_addresses, 6 * p1->al_mac_addresses_nr))
+                {
+                    return 1;
+                }
+            }
+            else if (CUSTOM_COMMAND_SUBSCRIBE_EVENTS == p1->command)
+            {
+                if (
+                     p1->events               !=  p2->events                ||
+                     p1->metric_threshold     !=  p2->metric_threshold      ||
+                     p1->al_mac_addresses_nr  !=  p2->al_mac_addresses_nr
+                   )
+                {
+                    return 1;
+                }
+
+                if (p1->al_mac_addresses_nr > 0 && PLATFORM_MEMCMP(p1->al_mac_addresses, p2->al_mac_addresses, 6 * p1->al_mac_addresses_nr))
+                {
+                    return 1;
+                }
+            }
                  
             return 0;
         }
@@ -2317,6 +2479,47 @@ void visit_1905_ALME_structure(INT8U *memory_structure, void (*callback)(void (*
 
             callback(write_function, prefix, sizeof(p->command),  "command", "%d", &p->command);
 
+            if (CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE == p->command)
+            {
+                callback(write_function, prefix, sizeof(p->epoch),       "epoch",      "%d", &p->epoch);
+                callback(write_function, prefix, sizeof(p->generation),  "generation", "%d", &p->generation);
+            }
+            else if (CUSTOM_COMMAND_QUERY_NETWORK_DEVICES == p->command)
+            {
+                INT8U i;
+
+                callback(write_function, prefix, sizeof(p->al_mac_addresses_nr), "al_mac_addresses_nr", "%d", &p->al_mac_addresses_nr);
+                for (i=0; i<p->al_mac_addresses_nr; i++)
+                {
+                    char new_prefix[MAX_PREFIX];
+
+                    PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "%sal_mac_addresses[%d]->", prefix, i);
+                    new_prefix[MAX_PREFIX-1] = 0x0;
+
+                    callback(write_function, new_prefix, 6, "al_mac_address", "0x%02x", p->al_mac_addresses[i]);
+                }
+                callback(write_function, prefix, sizeof(p->media_type),   "media_type",   "0x%04x", &p->media_type);
+                callback(write_function, prefix, sizeof(p->max_phy_rate), "max_phy_rate", "%d",     &p->max_phy_rate);
+                callback(write_function, prefix, sizeof(p->sections),     "sections",     "0x%04x", &p->sections);
+            }
+            else if (CUSTOM_COMMAND_SUBSCRIBE_EVENTS == p->command)
+            {
+                INT8U i;
+
+                callback(write_function, prefix, sizeof(p->events),              "events",              "0x%04x", &p->events);
+                callback(write_function, prefix, sizeof(p->metric_threshold),    "metric_threshold",    "%d",     &p->metric_threshold);
+                callback(write_function, prefix, sizeof(p->al_mac_addresses_nr), "al_mac_addresses_nr", "%d",     &p->al_mac_addresses_nr);
+                for (i=0; i<p->al_mac_addresses_nr; i++)
+                {
+                    char new_prefix[MAX_PREFIX];
+
+                    PLATFORM_SNPRINTF(new_prefix, MAX_PREFIX-1, "%sal_mac_addresses[%d]->", prefix, i);
+                    new_prefix[MAX_PREFIX-1] = 0x0;
+
+                    callback(write_function, new_prefix, 6, "al_mac_address", "0x%02x", p->al_mac_addresses[i]);
+                }
+            }
+
             return;
         }
 
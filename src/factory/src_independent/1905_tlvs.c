@@ -55,6 +55,8 @@
  *  DAMAGE.
  */
 
+#define MEMORY_ACCOUNTING_TAG PLATFORM_MEMORY_TAG_FACTORY
+
 #include "platform.h"
 
 #include "1905_tlvs.h"
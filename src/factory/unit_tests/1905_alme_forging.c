@@ -189,6 +189,15 @@ int main(void)
     #define x1905ALMEFORGE025 "x1905ALMEFORGE025 - Forge ALME-GET-METRIC.response (x1905_alme_structure_025)"
     result += _check(x1905ALMEFORGE025, (INT8U *)&x1905_alme_structure_025, x1905_alme_stream_025, x1905_alme_stream_len_025);
 
+    #define x1905ALMEFORGE026 "x1905ALMEFORGE026 - Forge ALME-CUSTOM-COMMAND.request (x1905_alme_structure_026)"
+    result += _check(x1905ALMEFORGE026, (INT8U *)&x1905_alme_structure_026, x1905_alme_stream_026, x1905_alme_stream_len_026);
+
+    #define x1905ALMEFORGE027 "x1905ALMEFORGE027 - Forge ALME-CUSTOM-COMMAND.request (x1905_alme_structure_027)"
+    result += _check(x1905ALMEFORGE027, (INT8U *)&x1905_alme_structure_027, x1905_alme_stream_027, x1905_alme_stream_len_027);
+
+    #define x1905ALMEFORGE028 "x1905ALMEFORGE028 - Forge ALME-CUSTOM-COMMAND.request (x1905_alme_structure_028)"
+    result += _check(x1905ALMEFORGE028, (INT8U *)&x1905_alme_structure_028, x1905_alme_stream_028, x1905_alme_stream_len_028);
+
     // Return the number of test cases that failed
     //
     return result;
@@ -172,6 +172,15 @@ int main(void)
     #define x1905ALMEPARSE025 "x1905ALMEPARSE025 - Parse ALME-GET-METRIC.response (x1905_alme_structure_025)"
     result += _check(x1905ALMEPARSE025, x1905_alme_stream_025, (INT8U *)&x1905_alme_structure_025);
 
+    #define x1905ALMEPARSE026 "x1905ALMEPARSE026 - Parse ALME-CUSTOM-COMMAND.request (x1905_alme_structure_026)"
+    result += _check(x1905ALMEPARSE026, x1905_alme_stream_026, (INT8U *)&x1905_alme_structure_026);
+
+    #define x1905ALMEPARSE027 "x1905ALMEPARSE027 - Parse ALME-CUSTOM-COMMAND.request (x1905_alme_structure_027)"
+    result += _check(x1905ALMEPARSE027, x1905_alme_stream_027, (INT8U *)&x1905_alme_structure_027);
+
+    #define x1905ALMEPARSE028 "x1905ALMEPARSE028 - Parse ALME-CUSTOM-COMMAND.request (x1905_alme_structure_028)"
+    result += _check(x1905ALMEPARSE028, x1905_alme_stream_028, (INT8U *)&x1905_alme_structure_028);
+
 
     // Return the number of test cases that failed
     //
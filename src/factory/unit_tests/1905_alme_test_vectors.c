@@ -921,3 +921,95 @@ INT8U x1905_alme_stream_025[] =
 INT16U x1905_alme_stream_len_025 = 3;
 
 
+////////////////////////////////////////////////////////////////////////////////
+//// Test vector 026 (TLV <--> packet)
+////////////////////////////////////////////////////////////////////////////////
+
+struct customCommandRequestALME x1905_alme_structure_026 =
+{
+    .alme_type                 = ALME_TYPE_CUSTOM_COMMAND_REQUEST,
+    .command                   = CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE,
+    .epoch                     = 0x5e11a7c3,
+    .generation                = 0x00012f0a,
+};
+
+INT8U x1905_alme_stream_026[] =
+{
+    0xf0,
+    0x04,
+    0x5e, 0x11, 0xa7, 0xc3,
+    0x00, 0x01, 0x2f, 0x0a,
+};
+
+INT16U x1905_alme_stream_len_026 = 10;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//// Test vector 027 (TLV <--> packet)
+////////////////////////////////////////////////////////////////////////////////
+
+INT8U x1905_alme_structure_027_al_mac_addresses[][6] =
+{
+    {0x00, 0x16, 0x03, 0x01, 0x85, 0x1f},
+    {0x00, 0x16, 0x03, 0x01, 0x85, 0x20},
+};
+
+struct customCommandRequestALME x1905_alme_structure_027 =
+{
+    .alme_type                 = ALME_TYPE_CUSTOM_COMMAND_REQUEST,
+    .command                   = CUSTOM_COMMAND_QUERY_NETWORK_DEVICES,
+    .generation                = 0,
+    .al_mac_addresses_nr       = 2,
+    .al_mac_addresses          = x1905_alme_structure_027_al_mac_addresses,
+    .media_type                = MEDIA_TYPE_IEEE_802_11N_5_GHZ,
+    .max_phy_rate              = 0x0064,
+    .sections                  = CUSTOM_COMMAND_QUERY_SECTION_GENERAL_INFO | CUSTOM_COMMAND_QUERY_SECTION_METRICS,
+};
+
+INT8U x1905_alme_stream_027[] =
+{
+    0xf0,
+    0x05,
+    0x02,
+    0x00, 0x16, 0x03, 0x01, 0x85, 0x1f,
+    0x00, 0x16, 0x03, 0x01, 0x85, 0x20,
+    0x01, 0x04,
+    0x00, 0x64,
+    0x08, 0x01,
+};
+
+INT16U x1905_alme_stream_len_027 = 21;
+
+
+////////////////////////////////////////////////////////////////////////////////
+//// Test vector 028 (TLV <--> packet)
+////////////////////////////////////////////////////////////////////////////////
+
+INT8U x1905_alme_structure_028_al_mac_addresses[][6] =
+{
+    {0x00, 0x16, 0x03, 0x01, 0x85, 0x1f},
+};
+
+struct customCommandRequestALME x1905_alme_structure_028 =
+{
+    .alme_type                 = ALME_TYPE_CUSTOM_COMMAND_REQUEST,
+    .command                   = CUSTOM_COMMAND_SUBSCRIBE_EVENTS,
+    .generation                = 0,
+    .al_mac_addresses_nr       = 1,
+    .al_mac_addresses          = x1905_alme_structure_028_al_mac_addresses,
+    .events                    = (1 << CUSTOM_COMMAND_EVENT_NEIGHBOR_UP) | (1 << CUSTOM_COMMAND_EVENT_NEIGHBOR_DOWN) | (1 << CUSTOM_COMMAND_EVENT_LINK_METRIC),
+    .metric_threshold          = 10,
+};
+
+INT8U x1905_alme_stream_028[] =
+{
+    0xf0,
+    0x0b,
+    0x00, 0x26,
+    0x0a,
+    0x01,
+    0x00, 0x16, 0x03, 0x01, 0x85, 0x1f,
+};
+
+INT16U x1905_alme_stream_len_028 = 12;
+
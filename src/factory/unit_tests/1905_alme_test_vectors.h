@@ -160,5 +160,17 @@ extern struct getMetricResponseALME          x1905_alme_structure_025;
 extern INT8U                                 x1905_alme_stream_025[];
 extern INT16U                                x1905_alme_stream_len_025;
 
+extern struct customCommandRequestALME       x1905_alme_structure_026;
+extern INT8U                                 x1905_alme_stream_026[];
+extern INT16U                                x1905_alme_stream_len_026;
+
+extern struct customCommandRequestALME       x1905_alme_structure_027;
+extern INT8U                                 x1905_alme_stream_027[];
+extern INT16U                                x1905_alme_stream_len_027;
+
+extern struct customCommandRequestALME       x1905_alme_structure_028;
+extern INT8U                                 x1905_alme_stream_028[];
+extern INT16U                                x1905_alme_stream_len_028;
+
 #endif
 
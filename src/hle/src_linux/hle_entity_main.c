@@ -57,15 +57,20 @@
 
 #include "platform.h"
 #include "utils.h"
+#include "packet_tools.h"
 #include "1905_alme.h"
+#include "1905_tlvs.h"
 
 #include <stdio.h>   // printf
 #include <unistd.h>  // getopt
-#include <stdlib.h>  // exit
+#include <stdlib.h>  // exit, strtoul
 #include <string.h>  // strtok
 
 #ifndef _FLAVOUR_X86_WINDOWS_MINGW_
 #    include <arpa/inet.h>  // socket(), AF_INET, htons(), ...
+#    include <sys/mman.h>   // shm_open(), mmap()
+#    include <sys/stat.h>   // fstat()
+#    include <fcntl.h>      // O_RDONLY
 #else
 #    include <winsock2.h>
 #endif
@@ -147,6 +152,58 @@ static void _asciiToMac (const char *str, INT8U *addr)
       }
 }
 
+// Names that can be used in the "show=" filter of the "dq" custom command to
+// select which parts of each device are returned
+//
+static struct
+{
+    const char *name;
+    INT16U      flag;
+
+} query_sections[] =
+{
+    {"info",     CUSTOM_COMMAND_QUERY_SECTION_GENERAL_INFO      },
+    {"bridges",  CUSTOM_COMMAND_QUERY_SECTION_BRIDGES           },
+    {"non1905",  CUSTOM_COMMAND_QUERY_SECTION_NON_1905_NEIGHBORS},
+    {"1905",     CUSTOM_COMMAND_QUERY_SECTION_X1905_NEIGHBORS   },
+    {"poweroff", CUSTOM_COMMAND_QUERY_SECTION_POWER_OFF         },
+    {"l2",       CUSTOM_COMMAND_QUERY_SECTION_L2_NEIGHBORS      },
+    {"phy",      CUSTOM_COMMAND_QUERY_SECTION_GENERIC_PHY       },
+    {"profile",  CUSTOM_COMMAND_QUERY_SECTION_PROFILE           },
+    {"id",       CUSTOM_COMMAND_QUERY_SECTION_IDENTIFICATION    },
+    {"url",      CUSTOM_COMMAND_QUERY_SECTION_CONTROL_URL       },
+    {"ips",      CUSTOM_COMMAND_QUERY_SECTION_IPS               },
+    {"metrics",  CUSTOM_COMMAND_QUERY_SECTION_METRICS           },
+    {"ext",      CUSTOM_COMMAND_QUERY_SECTION_EXTENSIONS        },
+};
+
+// Names of the events (indexed by their CUSTOM_COMMAND_EVENT_* type) that can
+// be used in the "events=" filter of the "ev" custom command
+//
+static const char *event_names[] =
+{
+    "subscribed",
+    "up",
+    "down",
+    "changed",
+    "removed",
+    "metric",
+    "pbc",
+};
+
+// Names of the CUSTOM_COMMAND_EVENT_PUSH_BUTTON_* stages
+//
+static const char *push_button_stage_names[] =
+{
+    "pressed",
+    "started",
+    "remote",
+    "authenticated",
+    "joined",
+    "wsc_m1_sent",
+    "wsc_m2_sent",
+    "wsc_m2_received",
+};
 
 // Return a properly filled structure representing the desired ALME REQUEST
 // Some types of ALME requests require arguments. These are taken from the
@@ -160,12 +217,7 @@ INT8U *_build_alme_request(char *alme_request_type, int argc, char **argv)
     {
         struct getIntfListRequestALME *p;
 
-        p = (struct getIntfListRequestALME *)malloc(sizeof(struct getIntfListRequestALME));
-        if (NULL == p)
-        {
-            PLATFORM_PRINTF_DEBUG_ERROR("Could not allocate getIntfListRequestALME structure!\n");
-            return NULL;
-        }
+        p = (struct getIntfListRequestALME *)PLATFORM_MALLOC(sizeof(struct getIntfListRequestALME));
         p->alme_type = ALME_TYPE_GET_INTF_LIST_REQUEST;
 
         ret = (INT8U *)p;
@@ -197,12 +249,7 @@ INT8U *_build_alme_request(char *alme_request_type, int argc, char **argv)
             _asciiToMac(argv[optind], mac_address);
         }
 
-        p = (struct getMetricRequestALME *)malloc(sizeof(struct getMetricRequestALME));
-        if (NULL == p)
-        {
-            PLATFORM_PRINTF_DEBUG_ERROR("Could not allocate getMetricRequestALME structure!\n");
-            return NULL;
-        }
+        p = (struct getMetricRequestALME *)PLATFORM_MALLOC(sizeof(struct getMetricRequestALME));
         p->alme_type = ALME_TYPE_GET_METRIC_REQUEST;
         memcpy(p->interface_address, mac_address, 6);
 
@@ -220,22 +267,177 @@ INT8U *_build_alme_request(char *alme_request_type, int argc, char **argv)
             return NULL;
         }
 
-        p = (struct customCommandRequestALME *)malloc(sizeof(struct customCommandRequestALME));
-        if (NULL == p)
-        {
-            PLATFORM_PRINTF_DEBUG_ERROR("Could not allocate customCommandRequestALME structure!\n");
-            return NULL;
-        }
-        p->alme_type = ALME_TYPE_CUSTOM_COMMAND_REQUEST;
+        p = (struct customCommandRequestALME *)PLATFORM_MALLOC(sizeof(struct customCommandRequestALME));
+        p->alme_type           = ALME_TYPE_CUSTOM_COMMAND_REQUEST;
+        p->epoch               = 0;
+        p->generation          = 0;
+        p->al_mac_addresses_nr = 0;
+        p->al_mac_addresses    = NULL;
+        p->media_type          = MEDIA_TYPE_UNKNOWN;
+        p->max_phy_rate        = 0;
+        p->sections            = CUSTOM_COMMAND_QUERY_SECTION_ALL;
+        p->events              = 0;
+        p->metric_threshold    = 0;
 
         if (0 == strcmp(argv[optind], "dnd"))
         {
             p->command = CUSTOM_COMMAND_DUMP_NETWORK_DEVICES;
         }
+        else if (0 == strcmp(argv[optind], "dnds"))
+        {
+            p->command = CUSTOM_COMMAND_DUMP_NETWORK_DEVICES_SINCE;
+
+            if (optind+2 < argc)
+            {
+                p->epoch      = (INT32U)strtoul(argv[optind+1], NULL, 10);
+                p->generation = (INT32U)strtoul(argv[optind+2], NULL, 10);
+            }
+        }
+        else if (0 == strcmp(argv[optind], "dq"))
+        {
+            int i;
+
+            p->command = CUSTOM_COMMAND_QUERY_NETWORK_DEVICES;
+
+            // Each extra argument is a "key=value" filter
+            //
+            for (i=optind+1; i<argc; i++)
+            {
+                if (0 == strncmp(argv[i], "mac=", 4))
+                {
+                    p->al_mac_addresses = (INT8U (*)[6])PLATFORM_REALLOC(p->al_mac_addresses, sizeof(INT8U[6]) * (p->al_mac_addresses_nr + 1));
+                    _asciiToMac(&argv[i][4], p->al_mac_addresses[p->al_mac_addresses_nr]);
+                    p->al_mac_addresses_nr++;
+                }
+                else if (0 == strncmp(argv[i], "media=", 6))
+                {
+                    p->media_type = (INT16U)strtoul(&argv[i][6], NULL, 0);
+                }
+                else if (0 == strncmp(argv[i], "rate_below=", 11))
+                {
+                    p->max_phy_rate = (INT16U)strtoul(&argv[i][11], NULL, 0);
+                }
+                else if (0 == strncmp(argv[i], "show=", 5))
+                {
+                    char *section;
+                    char *saveptr;
+                    INT8U j;
+
+                    p->sections = 0;
+
+                    for (section = strtok_r(&argv[i][5], ",", &saveptr); NULL != section; section = strtok_r(NULL, ",", &saveptr))
+                    {
+                        for (j=0; j<sizeof(query_sections)/sizeof(query_sections[0]); j++)
+                        {
+                            if (0 == strcmp(section, query_sections[j].name))
+                            {
+                                p->sections |= query_sections[j].flag;
+                                break;
+                            }
+                        }
+                        if (j == sizeof(query_sections)/sizeof(query_sections[0]))
+                        {
+                            PLATFORM_PRINTF_DEBUG_ERROR("Unknown section '%s'\n", section);
+                            free_1905_ALME_structure((INT8U *)p);
+                            return NULL;
+                        }
+                    }
+                }
+                else
+                {
+                    PLATFORM_PRINTF_DEBUG_ERROR("Unknown query filter '%s'\n", argv[i]);
+                    free_1905_ALME_structure((INT8U *)p);
+                    return NULL;
+                }
+            }
+        }
+        else if (0 == strcmp(argv[optind], "dndx"))
+        {
+            p->command = CUSTOM_COMMAND_EXPORT_NETWORK_DEVICES;
+        }
+        else if (0 == strcmp(argv[optind], "dmh"))
+        {
+            p->command = CUSTOM_COMMAND_DUMP_METRICS_HISTORY;
+        }
+        else if (0 == strcmp(argv[optind], "dmu"))
+        {
+            p->command = CUSTOM_COMMAND_DUMP_MEMORY_USAGE;
+        }
+        else if (0 == strcmp(argv[optind], "dpq"))
+        {
+            p->command = CUSTOM_COMMAND_DUMP_PENDING_QUERIES;
+        }
+        else if (0 == strcmp(argv[optind], "dtn"))
+        {
+            p->command = CUSTOM_COMMAND_DUMP_NOTIFICATIONS;
+        }
+        else if (0 == strcmp(argv[optind], "drs"))
+        {
+            p->command = CUSTOM_COMMAND_DUMP_RECEIVE_STATS;
+        }
+        else if (0 == strcmp(argv[optind], "dfr"))
+        {
+            p->command = CUSTOM_COMMAND_DUMP_FLIGHT_RECORDER;
+        }
+        else if (0 == strcmp(argv[optind], "ev"))
+        {
+            int i;
+
+            p->command = CUSTOM_COMMAND_SUBSCRIBE_EVENTS;
+            p->events  = CUSTOM_COMMAND_EVENTS_ALL;
+
+            // Each extra argument is a "key=value" filter
+            //
+            for (i=optind+1; i<argc; i++)
+            {
+                if (0 == strncmp(argv[i], "mac=", 4))
+                {
+                    p->al_mac_addresses = (INT8U (*)[6])PLATFORM_REALLOC(p->al_mac_addresses, sizeof(INT8U[6]) * (p->al_mac_addresses_nr + 1));
+                    _asciiToMac(&argv[i][4], p->al_mac_addresses[p->al_mac_addresses_nr]);
+                    p->al_mac_addresses_nr++;
+                }
+                else if (0 == strncmp(argv[i], "events=", 7))
+                {
+                    char *event;
+                    char *saveptr;
+                    INT8U j;
+
+                    p->events = 0;
+
+                    for (event = strtok_r(&argv[i][7], ",", &saveptr); NULL != event; event = strtok_r(NULL, ",", &saveptr))
+                    {
+                        for (j=1; j<sizeof(event_names)/sizeof(event_names[0]); j++)
+                        {
+                            if (0 == strcmp(event, event_names[j]))
+                            {
+                                p->events |= 1 << j;
+                                break;
+                            }
+                        }
+                        if (j == sizeof(event_names)/sizeof(event_names[0]))
+                        {
+                            PLATFORM_PRINTF_DEBUG_ERROR("Unknown event '%s'\n", event);
+                            free_1905_ALME_structure((INT8U *)p);
+                            return NULL;
+                        }
+                    }
+                }
+                else if (0 == strncmp(argv[i], "threshold=", 10))
+                {
+                    p->metric_threshold = (INT8U)strtoul(&argv[i][10], NULL, 0);
+                }
+                else
+                {
+                    PLATFORM_PRINTF_DEBUG_ERROR("Unknown events filter '%s'\n", argv[i]);
+                    free_1905_ALME_structure((INT8U *)p);
+                    return NULL;
+                }
+            }
+        }
         else
         {
             PLATFORM_PRINTF_DEBUG_ERROR("Invalid arguments for 'ALME-CUSTOM-COMMAND' message\n");
-            free(p);
+            PLATFORM_FREE(p);
             return NULL;
         }
 
@@ -249,6 +451,408 @@ INT8U *_build_alme_request(char *alme_request_type, int argc, char **argv)
     return ret;
 }
 
+// Print the contents of a binary export of the AL devices database (the reply
+// to a "CUSTOM_COMMAND_EXPORT_NETWORK_DEVICES" command, whose format is
+// described in "1905_alme.h") in the same way the text dump is printed.
+//
+// Returns '0' if the export is malformed, '1' otherwise.
+//
+static INT8U _printNetworkDevicesExport(INT8U *buffer, INT32U len)
+{
+    INT8U  *p;
+    INT8U  *end;
+    INT8U   version;
+    INT32U  generation;
+    INT8U   devices_nr;
+    INT16U  links_nr;
+    INT8U   i;
+    INT16U  j;
+
+    char    prefix[100];
+
+    p   = buffer;
+    end = buffer + len;
+
+    #define EXPORT_NEEDS(n)  if ((INT32U)(end - p) < (INT32U)(n)) { PLATFORM_PRINTF_DEBUG_ERROR("Truncated export\n"); return 0; }
+
+    EXPORT_NEEDS(4+1+4+1);
+    if (0 != memcmp(p, CUSTOM_COMMAND_EXPORT_MAGIC, 4))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Invalid export magic\n");
+        return 0;
+    }
+    p += 4;
+    _E1B(&p, &version);
+    if (CUSTOM_COMMAND_EXPORT_VERSION != version)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Unsupported export version (%d)\n", version);
+        return 0;
+    }
+    _E4B(&p, &generation);
+    _E1B(&p, &devices_nr);
+
+    PLATFORM_PRINTF("\n");
+    PLATFORM_PRINTF("  generation: %u\n", generation);
+    PLATFORM_PRINTF("  device_nr: %d\n", devices_nr);
+
+    for (i=0; i<devices_nr; i++)
+    {
+        INT32U  device_generation;
+        INT32U  update_timestamp;
+        INT32U  length;
+        INT8U  *next;
+        INT16U  tlvs_nr;
+
+        EXPORT_NEEDS(4+4+4);
+        _E4B(&p, &device_generation);
+        _E4B(&p, &update_timestamp);
+        _E4B(&p, &length);
+
+        EXPORT_NEEDS(length);
+        next = p + length;
+
+        PLATFORM_PRINTF("  device[%d]->update timestamp: %u\n", i, update_timestamp);
+        PLATFORM_PRINTF("  device[%d]->generation: %u\n", i, device_generation);
+
+        EXPORT_NEEDS(2);
+        _E2B(&p, &tlvs_nr);
+
+        for (j=0; j<tlvs_nr; j++)
+        {
+            INT8U  *tlv;
+            INT16U  tlv_len;
+
+            // Each TLV is "type (1 byte) + length (2 bytes) + value"
+            //
+            if (next - p < 3)
+            {
+                PLATFORM_PRINTF_DEBUG_ERROR("Truncated export\n");
+                return 0;
+            }
+            tlv_len = (p[1] << 8) | p[2];
+            if (next - p < 3 + tlv_len)
+            {
+                PLATFORM_PRINTF_DEBUG_ERROR("Truncated export\n");
+                return 0;
+            }
+
+            snprintf(prefix, sizeof(prefix), "  device[%d]->tlv[%d]->", i, j);
+
+            if (NULL == (tlv = parse_1905_TLV_from_packet(p)))
+            {
+                PLATFORM_PRINTF("%sunparseable TLV (type = %d)\n", prefix, *p);
+            }
+            else
+            {
+                visit_1905_TLV_structure(tlv, print_callback, PLATFORM_PRINTF, prefix);
+                free_1905_TLV_structure(tlv);
+            }
+
+            p += 3 + tlv_len;
+        }
+
+        p = next;
+    }
+
+    EXPORT_NEEDS(2);
+    _E2B(&p, &links_nr);
+
+    PLATFORM_PRINTF("  link_nr: %d\n", links_nr);
+
+    for (j=0; j<links_nr; j++)
+    {
+        INT8U   name_len;
+        char    name[256];
+        INT8U   al_mac[6];
+        INT8U   mac[6];
+        INT32U  link_generation;
+
+        EXPORT_NEEDS(1);
+        _E1B(&p, &name_len);
+        EXPORT_NEEDS(name_len+6+6+4);
+        _EnB(&p, name, name_len);
+        name[name_len] = 0x0;
+        _EnB(&p, al_mac, 6);
+        _EnB(&p, mac, 6);
+        _E4B(&p, &link_generation);
+
+        PLATFORM_PRINTF("  link[%d]->local_interface: %s\n", j, name);
+        PLATFORM_PRINTF("  link[%d]->neighbor_al_mac_address: %02x:%02x:%02x:%02x:%02x:%02x\n", j, al_mac[0], al_mac[1], al_mac[2], al_mac[3], al_mac[4], al_mac[5]);
+        PLATFORM_PRINTF("  link[%d]->neighbor_mac_address: %02x:%02x:%02x:%02x:%02x:%02x\n", j, mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+        PLATFORM_PRINTF("  link[%d]->generation: %u\n", j, link_generation);
+    }
+
+    #undef EXPORT_NEEDS
+
+    return 1;
+}
+
+#ifndef _FLAVOUR_X86_WINDOWS_MINGW_
+// Read the topology image that the AL entity publishes in the POSIX shared
+// memory object called 'name' (see "struct topologyImageHeader" in
+// "1905_alme.h") and print it.
+//
+// Returns '0' if there was a problem, '1' otherwise.
+//
+static INT8U _printTopologyImage(const char *name)
+{
+    int                         fd;
+    struct stat                 st;
+    INT8U                      *image;
+    INT32U                      image_size;
+    struct topologyImageHeader  header;
+    INT8U                      *export_buffer;
+    INT8U                       ret;
+
+    if (-1 == (fd = shm_open(name, O_RDONLY, 0)))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("shm_open('%s') returned with errno=%d (%s)\n", name, errno, strerror(errno));
+        return 0;
+    }
+    if (0 != fstat(fd, &st) || st.st_size < (off_t)sizeof(struct topologyImageHeader))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Topology image '%s' is empty\n", name);
+        close(fd);
+        return 0;
+    }
+
+    image_size = st.st_size;
+    if (MAP_FAILED == (image = (INT8U *)mmap(NULL, image_size, PROT_READ, MAP_SHARED, fd, 0)))
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("mmap('%s') returned with errno=%d (%s)\n", name, errno, strerror(errno));
+        close(fd);
+        return 0;
+    }
+
+    export_buffer = NULL;
+
+    while (1)
+    {
+        INT32U sequence;
+
+        sequence = ((volatile struct topologyImageHeader *)image)->sequence;
+        if (1 == (sequence & 1))
+        {
+            // The AL entity is updating it right now
+            //
+            continue;
+        }
+        __sync_synchronize();
+
+        memcpy(&header, image, sizeof(header));
+
+        if (header.size > image_size)
+        {
+            // The AL entity has enlarged the region
+            //
+            munmap(image, image_size);
+            image_size = header.size;
+            if (MAP_FAILED == (image = (INT8U *)mmap(NULL, image_size, PROT_READ, MAP_SHARED, fd, 0)))
+            {
+                PLATFORM_PRINTF_DEBUG_ERROR("mmap('%s') returned with errno=%d (%s)\n", name, errno, strerror(errno));
+                close(fd);
+                if (NULL != export_buffer)
+                {
+                    PLATFORM_FREE(export_buffer);
+                }
+                return 0;
+            }
+            continue;
+        }
+        if (header.len > image_size - sizeof(header))
+        {
+            // Inconsistent copy (it is being updated)
+            //
+            continue;
+        }
+
+        export_buffer = (INT8U *)PLATFORM_REALLOC(export_buffer, header.len + 1);
+        memcpy(export_buffer, image + sizeof(header), header.len);
+
+        __sync_synchronize();
+        if (sequence == ((volatile struct topologyImageHeader *)image)->sequence)
+        {
+            break;
+        }
+    }
+
+    munmap(image, image_size);
+    close(fd);
+
+    if (0 != memcmp(header.magic, TOPOLOGY_IMAGE_MAGIC, 4) || TOPOLOGY_IMAGE_VERSION != header.version)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("Invalid topology image\n");
+        PLATFORM_FREE(export_buffer);
+        return 0;
+    }
+
+    PLATFORM_PRINTF_DEBUG_INFO("Topology image sequence %d, %d byte(s) long\n", header.sequence, header.len);
+
+    ret = _printNetworkDevicesExport(export_buffer, header.len);
+    PLATFORM_FREE(export_buffer);
+
+    return ret;
+}
+#endif
+
+// Print one of the messages of the reply to a "CUSTOM_COMMAND_SUBSCRIBE_EVENTS"
+// command (each of them contains an event, whose format is described in
+// "1905_alme.h") as soon as it is received.
+//
+static void _printEvent(INT8U *alme_message, int alme_message_len)
+{
+    struct customCommandResponseALME *m;
+
+    INT8U  *p;
+    INT8U   type;
+    INT32U  sequence;
+    INT32U  timestamp;
+    INT8U   al_mac_address[6];
+    INT16U  len;
+
+    m = (struct customCommandResponseALME *)parse_1905_ALME_from_packet(alme_message);
+    if (NULL == m || ALME_TYPE_CUSTOM_COMMAND_RESPONSE != m->alme_type)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("ERROR: Cannot parse event\n");
+        if (NULL != m)
+        {
+            free_1905_ALME_structure((INT8U *)m);
+        }
+        return;
+    }
+    if (0 == m->bytes_nr)
+    {
+        // End of the subscription
+        //
+        free_1905_ALME_structure((INT8U *)m);
+        return;
+    }
+    if (m->bytes_nr < CUSTOM_COMMAND_EVENT_HEADER_LEN)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("ERROR: Truncated event\n");
+        free_1905_ALME_structure((INT8U *)m);
+        return;
+    }
+
+    p   = (INT8U *)m->bytes;
+    len = m->bytes_nr - CUSTOM_COMMAND_EVENT_HEADER_LEN;
+
+    _E1B(&p, &type);
+    _E4B(&p, &sequence);
+    _E4B(&p, &timestamp);
+    _EnB(&p, al_mac_address, 6);
+
+    PLATFORM_PRINTF("#%u @%u %s %02x:%02x:%02x:%02x:%02x:%02x", sequence, timestamp, type < sizeof(event_names)/sizeof(event_names[0]) ? event_names[type] : "unknown", al_mac_address[0], al_mac_address[1], al_mac_address[2], al_mac_address[3], al_mac_address[4], al_mac_address[5]);
+
+    if ((CUSTOM_COMMAND_EVENT_SUBSCRIBED == type) && len >= 2)
+    {
+        INT16U events;
+
+        _E2B(&p, &events);
+        PLATFORM_PRINTF(" events=0x%04x", events);
+    }
+    else if ((CUSTOM_COMMAND_EVENT_NEIGHBOR_UP == type || CUSTOM_COMMAND_EVENT_NEIGHBOR_DOWN == type) && len >= 6)
+    {
+        PLATFORM_PRINTF(" interface=%02x:%02x:%02x:%02x:%02x:%02x", p[0], p[1], p[2], p[3], p[4], p[5]);
+    }
+    else if (CUSTOM_COMMAND_EVENT_DEVICE_CHANGED == type && len >= 4)
+    {
+        INT32U generation;
+
+        _E4B(&p, &generation);
+        PLATFORM_PRINTF(" generation=%u", generation);
+    }
+    else if (CUSTOM_COMMAND_EVENT_LINK_METRIC == type && len >= 6+6+6+1+2+2)
+    {
+        INT8U  metric;
+        INT16U previous;
+        INT16U value;
+
+        PLATFORM_PRINTF(" neighbor=%02x:%02x:%02x:%02x:%02x:%02x", p[0],  p[1],  p[2],  p[3],  p[4],  p[5]);
+        PLATFORM_PRINTF(" link=%02x:%02x:%02x:%02x:%02x:%02x",     p[6],  p[7],  p[8],  p[9],  p[10], p[11]);
+        PLATFORM_PRINTF("->%02x:%02x:%02x:%02x:%02x:%02x",         p[12], p[13], p[14], p[15], p[16], p[17]);
+        p += 18;
+
+        _E1B(&p, &metric);
+        _E2B(&p, &previous);
+        _E2B(&p, &value);
+        PLATFORM_PRINTF(" %s=%d (was %d)", CUSTOM_COMMAND_EVENT_METRIC_RSSI == metric ? "rssi" : "mac_throughput", value, previous);
+    }
+    else if (CUSTOM_COMMAND_EVENT_PUSH_BUTTON == type && len >= 1+6)
+    {
+        INT8U stage;
+
+        _E1B(&p, &stage);
+        PLATFORM_PRINTF(" %s interface=%02x:%02x:%02x:%02x:%02x:%02x", stage < sizeof(push_button_stage_names)/sizeof(push_button_stage_names[0]) ? push_button_stage_names[stage] : "unknown", p[0], p[1], p[2], p[3], p[4], p[5]);
+    }
+    PLATFORM_PRINTF("\n");
+    fflush(stdout);
+
+    free_1905_ALME_structure((INT8U *)m);
+}
+
+// Send/receive exactly 'len' bytes of 'buffer' through socket 'sock'.
+//
+// If there is a problem these functions return "0", otherwise they return "1"
+//
+static int _sendAll(int sock, INT8U *buffer, int len)
+{
+    ssize_t sent;
+    int     total_sent;
+
+    total_sent = 0;
+    while (total_sent < len)
+    {
+#ifndef _FLAVOUR_X86_WINDOWS_MINGW_
+        sent = send(sock, buffer + total_sent, len - total_sent, 0);
+#else
+        sent = send(sock, (const char *)(buffer + total_sent), len - total_sent, 0);
+#endif
+        if (-1 == sent)
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("send() failed with errno=%d (%s)\n", errno, strerror(errno));
+            return 0;
+        }
+
+        total_sent += sent;
+    }
+
+    return 1;
+}
+static int _recvAll(int sock, INT8U *buffer, int len)
+{
+    ssize_t received;
+    int     total_received;
+
+    total_received = 0;
+    while (total_received < len)
+    {
+#ifndef _FLAVOUR_X86_WINDOWS_MINGW_
+        received = recv(sock, buffer + total_received, len - total_received, 0);
+#else
+        received = recv(sock, (char *)(buffer + total_received), len - total_received, 0);
+#endif
+        if (-1 == received)
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("recv() failed with errno=%d (%s)\n", errno, strerror(errno));
+            return 0;
+        }
+        if (0 == received)
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("Connection closed by the AL entity\n");
+            return 0;
+        }
+
+        total_received += received;
+    }
+
+    return 1;
+}
+
+// Id used for the only request sent on each connection
+//
+#define ALME_REQUEST_ID  (1)
+
 // Sends an ALME REQUEST message to an AL entity:
 //
 //   - 'server_ip_and_port' is a string containing the "IP:port" where the AL
@@ -259,28 +863,33 @@ INT8U *_build_alme_request(char *alme_request_type, int argc, char **argv)
 //
 //   - 'alme_request_len' is the number of bytes of 'alme_request'
 //
-//   - 'alme_reply' is a pointer to a buffer which is 'alme_reply_len' bytes
-//      long where the response from the AL entity (either an ALME RESPONSE or
-//      an ALME CONFIRMATION message) will be placed.
+//   - 'alme_reply' is an output argument where a pointer to a newly allocated
+//      buffer containing the response from the AL entity (either an ALME
+//      RESPONSE or an ALME CONFIRMATION message) will be placed. Long responses
+//      are made of several consecutive ALME messages.
+//
+//   - 'alme_reply_len' is an output argument that will contain the length of
+//     the reply.
 //
-//   - 'alme_request_len' is the capacity of the 'alme_reply' buffer. It is also
-//     used as an output argument that will contain the actual length of the
-//     reply.
+//   - 'message_callback', if not NULL, is called with each message of the
+//     reply as soon as it is received (instead of accumulating them in
+//     'alme_reply'). This is needed for replies that never end, such as the
+//     one to a "CUSTOM_COMMAND_SUBSCRIBE_EVENTS" command.
 //
 // Note that the caller is responsible for freeing both 'alme_request' and
-// 'alme_response' after they are no longer needed (ie. this function does not
-// allocate/free memory at all).
+// 'alme_reply' after they are no longer needed.
 //
-int _sendAlmeRequestAndWaitForReply(char *server_ip_and_port, INT8U *alme_request, int alme_request_len, INT8U *alme_reply, int *alme_reply_len)
+int _sendAlmeRequestAndWaitForReply(char *server_ip_and_port, INT8U *alme_request, int alme_request_len, INT8U **alme_reply, int *alme_reply_len, void (*message_callback)(INT8U *alme_message, int alme_message_len))
 {
     int sock;
 
     struct sockaddr_in server;
 
-    ssize_t total_sent;
+    INT8U   header[ALME_FRAME_HEADER_LEN];
 
     ssize_t received;
     ssize_t total_received;
+    ssize_t capacity;
 
     char *aux;
     char *ip;
@@ -320,81 +929,69 @@ int _sendAlmeRequestAndWaitForReply(char *server_ip_and_port, INT8U *alme_reques
         return 0;
     }
      
-    // Send the ALME REQUEST message
+    // Send the ALME REQUEST message, preceded by its frame header (see
+    // "ALME_FRAME_HEADER_LEN"). Only one request is sent, thus its id does not
+    // really matter.
     //
-    PLATFORM_PRINTF_DEBUG_INFO("Sending ALME request message (%d byte(s) long)...\n", alme_request_len);
-    total_sent = 0;
-    do
-    {
-        ssize_t sent;
-
-#ifndef _FLAVOUR_X86_WINDOWS_MINGW_
-        sent = send(sock, alme_request, alme_request_len, 0);
-#else
-        sent = send(sock, (const char *)alme_request, alme_request_len, 0);
-#endif
+    header[0] = ALME_FRAME_MARKER;
+    header[1] = 0x0;
+    header[2] = (alme_request_len >> 8) & 0xff;
+    header[3] = (alme_request_len     ) & 0xff;
+    header[4] = 0x0;
+    header[5] = 0x0;
+    header[6] = 0x0;
+    header[7] = ALME_REQUEST_ID;
 
-        if (-1 == sent)
-        {
-            PLATFORM_PRINTF_DEBUG_ERROR("send() failed with errno=%d (%s)\n", errno, strerror(errno));
-            return 0;
-        }
-#ifndef _FLAVOUR_X86_WINDOWS_MINGW_
-        PLATFORM_PRINTF_DEBUG_INFO("%zd byte(s) sent\n", sent);
-#else
-        PLATFORM_PRINTF_DEBUG_INFO("%d byte(s) sent\n", sent);
-#endif
-
-        total_sent += sent;
-    } while (total_sent < alme_request_len);
-
-    // Close the socket for writing. This will inform the other end that we
-    // are done (ie. send a "FIN" TCP packet)
-    //
-    PLATFORM_PRINTF_DEBUG_INFO("ALME request sent. Closing writing end of the socket descriptor...\n");
-#ifndef _FLAVOUR_X86_WINDOWS_MINGW_
-    if (-1 == shutdown(sock, SHUT_WR))
-#else
-    if (-1 == shutdown(sock, SD_SEND))
-#endif
+    PLATFORM_PRINTF_DEBUG_INFO("Sending ALME request message (%d byte(s) long)...\n", alme_request_len);
+    if (0 == _sendAll(sock, header, ALME_FRAME_HEADER_LEN) || 0 == _sendAll(sock, alme_request, alme_request_len))
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("shutdown(\"SHUT_WR\") failed with errno=%d (%s)\n", errno, strerror(errno));
         return 0;
     }
-         
-    // Receive a reply from the server
+
+    // Receive the reply from the server: one or more frames, the last of them
+    // with the "ALME_FRAME_FLAG_LAST" flag set
     //
     PLATFORM_PRINTF_DEBUG_INFO("Waiting for the ALME reply...\n");
     total_received = 0;
-#ifndef _FLAVOUR_X86_WINDOWS_MINGW_
-    while( (received = recv(sock, alme_reply + total_received, *alme_reply_len - total_received, 0)) > 0 )
-#else
-    while( (received = recv(sock, (char *)(alme_reply + total_received), *alme_reply_len - total_received, 0)) > 0 )
-#endif
+    capacity       = 16*MAX_NETWORK_SEGMENT_SIZE;
+    *alme_reply    = (INT8U *)PLATFORM_MALLOC(capacity);
+    do
     {
-        // Keep reading until the server closes the connection
-        //
-        if (-1 == received)
+        if (0 == _recvAll(sock, header, ALME_FRAME_HEADER_LEN))
         {
-            PLATFORM_PRINTF_DEBUG_ERROR("recv() failed with errno=%d (%s)\n", errno, strerror(errno));
             return 0;
         }
-#ifndef _FLAVOUR_X86_WINDOWS_MINGW_
-        PLATFORM_PRINTF_DEBUG_INFO("%zd byte(s) received\n", received);
-#else
-        PLATFORM_PRINTF_DEBUG_INFO("%d byte(s) received\n", received);
-#endif
-
-        total_received += received;
+        if (ALME_FRAME_MARKER != header[0] || ALME_REQUEST_ID != header[7])
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("Invalid ALME reply frame\n");
+            return 0;
+        }
 
-        if (total_received >= *alme_reply_len)
+        received = (header[2] << 8) | header[3];
+        while (total_received + received > capacity)
         {
-            // This message is too big. 
+            // Make room for more data (doubling the buffer size, so that very
+            // long replies do not require too many reallocations)
             //
-            PLATFORM_PRINTF_DEBUG_ERROR("Error! Received message is too big\n");
+            capacity    = 2 * capacity;
+            *alme_reply = (INT8U *)PLATFORM_REALLOC(*alme_reply, capacity);
+        }
+
+        if (0 == _recvAll(sock, *alme_reply + total_received, received))
+        {
             return 0;
         }
-    }
+        if (NULL != message_callback)
+        {
+            if (received > 0)
+            {
+                message_callback(*alme_reply, received);
+            }
+            continue;
+        }
+        total_received += received;
+
+    } while (0 == (header[1] & ALME_FRAME_FLAG_LAST));
 
 #ifndef _FLAVOUR_X86_WINDOWS_MINGW_
     PLATFORM_PRINTF_DEBUG_INFO("ALME reply received (%zd bytes in total). Closing socket...\n", total_received);
@@ -428,6 +1025,7 @@ int main(int argc, char *argv[])
     int   c;
     char *al_ip_address_and_tcp_port = NULL;
     char *alme_request_type          = NULL;
+    char *topology_image_name        = NULL;
 
     INT8U  *alme_request_structure    = NULL;
     INT8U  *alme_request_payload      = NULL;
@@ -435,11 +1033,15 @@ int main(int argc, char *argv[])
 
     int verbosity_counter = 1; // Only ERROR and WARNING messages
 
-    #define MAX_REPLY_SIZE (100*MAX_NETWORK_SEGMENT_SIZE)
-
     INT8U  *alme_reply_structure;
-    INT8U   alme_reply_payload[MAX_REPLY_SIZE];
-    int     alme_reply_payload_len = MAX_REPLY_SIZE;
+    INT8U  *alme_reply_payload     = NULL;
+    int     alme_reply_payload_len = 0;
+    int     alme_reply_payload_i;
+
+    INT8U   export_requested = 0;
+    INT8U   events_requested = 0;
+    INT8U  *export_buffer    = NULL;
+    INT32U  export_len       = 0;
 
     char aux[300*1024];
 
@@ -453,7 +1055,7 @@ int main(int argc, char *argv[])
     WSAStartup(versionWanted, &wsaData);
 #endif
 
-    while ((c = getopt (argc, argv, "va:m:h")) != -1)
+    while ((c = getopt (argc, argv, "va:m:s:h")) != -1)
     {
         switch (c)
         {
@@ -482,6 +1084,15 @@ int main(int argc, char *argv[])
                 alme_request_type = optarg; 
                 break;
             }
+
+            case 's':
+            {
+                // Name of the shared memory object where the AL publishes its
+                // topology image (ex: "/al_topology")
+                //
+                topology_image_name = optarg;
+                break;
+            }
             case 'h':
             {
                 // Help
@@ -489,6 +1100,7 @@ int main(int argc, char *argv[])
                 PLATFORM_PRINTF("HLE entity (build %s)\n", _BUILD_NUMBER_);
                 PLATFORM_PRINTF("\n");
                 PLATFORM_PRINTF("Usage:  %s  [-v] -a <ip address>:<tcp port> -m <ALME request type> [ALME arguments]\n", argv[0]);
+                PLATFORM_PRINTF("        %s  [-v] -s <topology image name>\n", argv[0]);
                 PLATFORM_PRINTF("\n");
                 PLATFORM_PRINTF("  where...\n");
                 PLATFORM_PRINTF("\n");
@@ -497,18 +1109,47 @@ int main(int argc, char *argv[])
                 PLATFORM_PRINTF("\n");
                 PLATFORM_PRINTF("    * <ip address>:<tcp port> are used to identify the ALME listening socket used by the AL we want to query/control\n");
                 PLATFORM_PRINTF("\n");
+                PLATFORM_PRINTF("    * <topology image name> is the name of the shared memory object where a local AL publishes its data model\n");
+                PLATFORM_PRINTF("      (see its '-t' option). It is read and printed (the same way 'dndx' does) without sending any request.\n");
+                PLATFORM_PRINTF("\n");
                 PLATFORM_PRINTF("    * <ALME request type> can be any of the following (some of them use extra arguments):\n");
                 PLATFORM_PRINTF("        - ALME-GET-INTF-LIST.request                 <--- Get information regarding the queried AL interfaces\n");
                 PLATFORM_PRINTF("        - ALME-GET-METRIC.request                    <--- Get metrics between the queried AL and *all* of its neighbors\n");
                 PLATFORM_PRINTF("        - ALME-GET-METRIC.request xx:xx:xx:xx:xx:xx  <--- Get metrics between the queried AL and the neighbor whose AL MAC address matches the provided one\n");
                 PLATFORM_PRINTF("        - ALME-CUSTOM-COMMAND.request <command>      <--- Custom (non-standard) commands. Possible values and their effect:\n");
                 PLATFORM_PRINTF("                                                            - dnd : dump network devices. Returns a text dump of the AL internal devices database\n");
+                PLATFORM_PRINTF("                                                            - dnds [epoch generation] : same as 'dnd', but only returns the devices and links created, changed or removed after <generation> (<epoch> and <generation> are the ones returned by the previous query)\n");
+                PLATFORM_PRINTF("                                                            - dq [filters] : same as 'dnd', but only returns the devices matching all the given filters. Each filter is one of:\n");
+                PLATFORM_PRINTF("                                                                - mac=xx:xx:xx:xx:xx:xx : only this AL MAC address (can be present more than once)\n");
+                PLATFORM_PRINTF("                                                                - media=<type> : only devices with an interface of this 1905 media type (ex: 0x0101 for 802.11g)\n");
+                PLATFORM_PRINTF("                                                                - rate_below=<Mbps> : only devices with a link whose PHY rate is below this value (and only those links metrics)\n");
+                PLATFORM_PRINTF("                                                                - show=<section>[,<section>...] : only return these parts of each device. Sections: info, bridges, non1905, 1905, poweroff, l2, phy, profile, id, url, ips, metrics, ext\n");
+                PLATFORM_PRINTF("                                                            - dndx : same as 'dnd', but the AL entity returns a (much smaller) binary export, which is then decoded and printed\n");
+                PLATFORM_PRINTF("                                                            - dmh : dump metrics history. Returns a text dump of the raw/minute/hour metrics samples of every link\n");
+                PLATFORM_PRINTF("                                                            - dmu : dump memory usage. Returns the live/peak memory used by each subsystem (requires MEMORY_ACCOUNTING)\n");
+                PLATFORM_PRINTF("                                                            - dpq : dump pending queries. Returns the queries still waiting for a response and the round trip times of each query type\n");
+                PLATFORM_PRINTF("                                                            - dtn : dump topology notifications. Returns the number of topology changes and how many of them were folded into each notification sent on each interface\n");
+                PLATFORM_PRINTF("                                                            - drs : dump receive stats. Returns the frames per second of the receive pipeline and the processing time and allocations of each CMDU type\n");
+                PLATFORM_PRINTF("                                                            - dfr : dump flight recorder. Saves the last frames received and transmitted by the AL entity (pcapng) to the file given to it with '-f'\n");
+                PLATFORM_PRINTF("                                                            - ev [filters] : subscribe to events. Prints topology, metric and push button events as the AL entity reports them (until interrupted). Each filter is one of:\n");
+                PLATFORM_PRINTF("                                                                - mac=xx:xx:xx:xx:xx:xx : only events about this AL MAC address (can be present more than once)\n");
+                PLATFORM_PRINTF("                                                                - events=<event>[,<event>...] : only these events (all of them by default). Events: up, down, changed, removed, metric, pbc\n");
+                PLATFORM_PRINTF("                                                                - threshold=<percentage> : only report a link metric when it changes by more than this percentage since the last one reported\n");
                 PLATFORM_PRINTF("\n");
                 exit(0);
             }
         }
     }
 
+#ifndef _FLAVOUR_X86_WINDOWS_MINGW_
+    if (NULL != topology_image_name)
+    {
+        PLATFORM_PRINTF_DEBUG_SET_VERBOSITY_LEVEL(verbosity_counter);
+
+        return 1 == _printTopologyImage(topology_image_name) ? 0 : 1;
+    }
+#endif
+
     if (NULL == al_ip_address_and_tcp_port)
     {
         PLATFORM_PRINTF_DEBUG_ERROR("ERROR: You *must* provide an AL address (example: '-a 10.9.123.1:9077')\n");
@@ -530,6 +1171,14 @@ int main(int argc, char *argv[])
         PLATFORM_PRINTF_DEBUG_ERROR("ERROR: The ALME REQUEST structure could not be build.\n");
         exit(1);
     }
+    if (ALME_TYPE_CUSTOM_COMMAND_REQUEST == *alme_request_structure && CUSTOM_COMMAND_EXPORT_NETWORK_DEVICES == ((struct customCommandRequestALME *)alme_request_structure)->command)
+    {
+        export_requested = 1;
+    }
+    if (ALME_TYPE_CUSTOM_COMMAND_REQUEST == *alme_request_structure && CUSTOM_COMMAND_SUBSCRIBE_EVENTS == ((struct customCommandRequestALME *)alme_request_structure)->command)
+    {
+        events_requested = 1;
+    }
     PLATFORM_PRINTF_DEBUG_INFO("Displaying contents of the ALME REQUEST that is going to be sent:\n");
     visit_1905_ALME_structure(alme_request_structure, print_callback, PLATFORM_PRINTF_DEBUG_INFO, "");
 
@@ -556,34 +1205,110 @@ int main(int argc, char *argv[])
     // Send that bit stream to the AL entity and wait for a response
     //
     PLATFORM_PRINTF_DEBUG_INFO("Sending bit stream to %s (len = %d)...\n", al_ip_address_and_tcp_port, alme_request_payload_len);
-    if (0 == _sendAlmeRequestAndWaitForReply(al_ip_address_and_tcp_port, alme_request_payload, alme_request_payload_len, alme_reply_payload, &alme_reply_payload_len))
+    if (0 == _sendAlmeRequestAndWaitForReply(al_ip_address_and_tcp_port, alme_request_payload, alme_request_payload_len, &alme_reply_payload, &alme_reply_payload_len, 1 == events_requested ? _printEvent : NULL))
     {
         PLATFORM_PRINTF_DEBUG_ERROR("ERROR: AL communication problem\n");
         exit(1);
     }
     free_1905_ALME_packet(alme_request_payload);
 
+    if (1 == events_requested)
+    {
+        // Events have already been printed as they arrived. The AL entity only
+        // ends the reply when the subscription could not be accepted.
+        //
+        PLATFORM_PRINTF_DEBUG_WARNING("The AL entity has ended the events subscription\n");
+        PLATFORM_FREE(alme_reply_payload);
+        return 0;
+    }
+
     PLATFORM_PRINTF_DEBUG_INFO("Displaying bit stream associated to the ALME RESPONSE/CONFIRMATION structure (%d byte(s) long):\n", alme_reply_payload_len);
     aux[0] = 0;
     for (i=0; i<alme_reply_payload_len; i++)
     {
         char item[10];
 
+        // One line every 32 bytes (replies can be very long, thus they are not
+        // accumulated in a single string)
+        //
         sprintf(item, "0x%02x ", alme_reply_payload[i]);
         strcat(aux, item);
+
+        if (31 == i%32 || i == alme_reply_payload_len-1)
+        {
+            PLATFORM_PRINTF_DEBUG_INFO("%s\n", aux);
+            aux[0] = 0;
+        }
     }
-    PLATFORM_PRINTF_DEBUG_INFO("%s\n", aux);
 
-    // Convert the response back into a structure and print it to stdout
+    if (0 == alme_reply_payload_len)
+    {
+        PLATFORM_PRINTF_DEBUG_ERROR("ERROR: Empty ALME RESPONSE/CONFIRMATION\n");
+        exit(1);
+    }
+
+    // Convert the response back into a structure and print it to stdout.
+    //
+    // Long "ALME-CUSTOM-COMMAND.response" replies are split by the AL entity
+    // into several consecutive messages, each of them containing a piece of
+    // the text, which are printed one after the other.
     //
-    alme_reply_structure = parse_1905_ALME_from_packet(alme_reply_payload);
-    if (NULL == alme_reply_structure)
+    alme_reply_payload_i = 0;
+    while (alme_reply_payload_i < alme_reply_payload_len)
+    {
+        alme_reply_structure = parse_1905_ALME_from_packet(alme_reply_payload + alme_reply_payload_i);
+        if (NULL == alme_reply_structure)
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("ERROR: Cannot parse ALME RESPONSE/CONFIRMATION\n");
+            break;
+        }
+
+        if (ALME_TYPE_CUSTOM_COMMAND_RESPONSE != *alme_reply_structure)
+        {
+            visit_1905_ALME_structure(alme_reply_structure, print_callback, PLATFORM_PRINTF, "");
+            free_1905_ALME_structure(alme_reply_structure);
+            break;
+        }
+        else
+        {
+            struct customCommandResponseALME *p;
+
+            p = (struct customCommandResponseALME *)alme_reply_structure;
+
+            if (p->bytes_nr > 0 && NULL != p->bytes && 1 == export_requested)
+            {
+                // Binary export: accumulate all pieces (without their NULL
+                // terminator) and decode them at the end
+                //
+                export_buffer = (INT8U *)PLATFORM_REALLOC(export_buffer, export_len + p->bytes_nr - 1);
+                memcpy(export_buffer + export_len, p->bytes, p->bytes_nr - 1);
+                export_len += p->bytes_nr - 1;
+            }
+            else if (p->bytes_nr > 0 && NULL != p->bytes)
+            {
+                p->bytes[p->bytes_nr-1] = 0x0;
+                PLATFORM_PRINTF("%s", p->bytes);
+            }
+
+            alme_reply_payload_i += 3 + p->bytes_nr;  // alme_type + length + bytes
+            free_1905_ALME_structure(alme_reply_structure);
+        }
+    }
+    PLATFORM_FREE(alme_reply_payload);
+
+    if (1 == export_requested)
     {
-        PLATFORM_PRINTF_DEBUG_ERROR("ERROR: Cannot parse ALME RESPONSE/CONFIRMATION\n");
+        PLATFORM_PRINTF_DEBUG_INFO("Binary export is %d byte(s) long\n", export_len);
+
+        if (0 == _printNetworkDevicesExport(export_buffer, export_len))
+        {
+            PLATFORM_PRINTF_DEBUG_ERROR("ERROR: Cannot decode the binary export\n");
+        }
+        if (NULL != export_buffer)
+        {
+            PLATFORM_FREE(export_buffer);
+        }
     }
-    visit_1905_ALME_structure(alme_reply_structure, print_callback, PLATFORM_PRINTF, "");
 
     return 0;
 }
-
-